@@ -0,0 +1,103 @@
+/** AllocatorBench.cpp - Ticket Number Allocation Contention Benchmark
+ *
+ *	Hands out ticket numbers on 1, 2, 4, ... 32 threads three ways and
+ *	reports numbers per second and nanoseconds per number:
+ *
+ *		mutex		a counter behind a global mutex, as ticket creation works today
+ *		atomic		a TicketNumberAllocator with a block size of 1 (one atomic add per number)
+ *		blocks		a TicketNumberAllocator with the default block size
+ *
+ *		AllocatorBench [count]		count numbers per run (default 20,000,000)
+ *
+ *	The gap column counts numbers reserved but never handed out, the
+ *	unused tails of the threads' last blocks.
+ *
+ *	@version	2020.09
+ *	@see		TicketNumberAllocator.h
+*/
+
+#include <atomic>		// for the checksum
+#include <cstdlib>		// for strtoull
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <mutex>		// for mutex
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../TicketNumberAllocator.h"
+
+using namespace std;
+
+/** LockedCounter
+ *	The global mutex a service uses when nothing else hands out numbers.
+ */
+class LockedCounter
+{
+public:
+	int Next()
+	{
+		lock_guard<mutex> lock(myMutex);
+		return ++myLast;
+	}
+
+	int HighWaterMark() const { return myLast; }
+
+private:
+	int myLast = 0;	// the last number handed out
+	mutex myMutex;	// guards myLast
+};
+
+/** Run()
+ *	Splits count numbers between threads, prints the time taken and checks
+ *	each thread's numbers increase.
+ */
+template <typename Allocator>
+static void Run(const char* name, Allocator& allocator, const unsigned threads, const size_t count)
+{
+	atomic<size_t> outOfOrder{ 0 };	// numbers not above the thread's previous one
+	vector<thread> workers;
+
+	BenchSupport::Stopwatch timer;
+	for (unsigned t = 0; t < threads; t++)
+	{
+		workers.emplace_back([&]()
+		{
+			int last = 0;		// the previous number
+			size_t wrong = 0;	// numbers not above it
+			for (size_t i = 0; i < count / threads; i++)
+			{
+				const auto number = allocator.Next();
+				wrong += number <= last;
+				last = number;
+			}
+			outOfOrder.fetch_add(wrong);
+		});
+	}
+	for (auto& worker : workers)
+		worker.join();
+	const auto seconds = timer.Seconds();
+	const auto handedOut = count / threads * threads;
+
+	cout << setw(8) << threads << "  " << left << setw(8) << name << right << fixed << setprecision(0)
+		<< setw(14) << handedOut / seconds << setprecision(1) << setw(10) << seconds * 1e9 / handedOut
+		<< setw(10) << static_cast<size_t>(allocator.HighWaterMark()) - handedOut << setw(10) << outOfOrder.load() << endl;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000000;
+
+	cout << count << " numbers per run, " << thread::hardware_concurrency() << " cores" << endl << endl;
+	cout << setw(8) << "threads" << "  " << left << setw(8) << "kind" << right << setw(14) << "numbers/s" << setw(10) << "ns/number"
+		<< setw(10) << "gap" << setw(10) << "unordered" << endl;
+	for (unsigned threads = 1; threads <= 32; threads *= 2)
+	{
+		LockedCounter locked;
+		TicketNumberAllocator atomicAllocator(1);
+		TicketNumberAllocator blockAllocator;
+		Run("mutex", locked, threads, count);
+		Run("atomic", atomicAllocator, threads, count);
+		Run("blocks", blockAllocator, threads, count);
+	}
+	return 0;
+}
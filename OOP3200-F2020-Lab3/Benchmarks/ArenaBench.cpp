@@ -0,0 +1,92 @@
+/** ArenaBench.cpp - Arena Description Storage Benchmark
+ *
+ *	Loads a synthetic batch of tickets two ways and reports the time, heap
+ *	allocations and peak RSS of each: "heap" keeps the tickets in a plain
+ *	vector, so every description is its own heap allocation; "arena" keeps
+ *	them in a TicketBatch. Peak RSS is per process, so run each mode
+ *	separately:
+ *
+ *		ArenaBench heap [count]
+ *		ArenaBench arena [count]
+ *
+ *	The count defaults to 10,000,000 tickets.
+ *
+ *	@version	2020.09
+ *	@see		TicketBatch.h
+*/
+
+#include <cstdio>		// for printf and snprintf
+#include <cstdlib>		// for strtoull
+#include <cstring>		// for strcmp
+#include <vector>		// for the heap mode
+#include "BenchSupport.h"
+#include "../TicketBatch.h"
+
+using namespace std;
+
+/** MakeTicket()
+ *	Builds the fields of synthetic ticket number i. Descriptions are long
+ *	enough to need a heap allocation in a std::string.
+ */
+static void MakeTicket(const size_t i, char* client_id, const size_t client_size, char* description, const size_t description_size)
+{
+	snprintf(client_id, client_size, "CLIENT-%04zu", i % 5000);
+	snprintf(description, description_size, "Printer on floor %zu will not print, reported as ticket %zu", i % 40, i);
+}
+
+/** Report()
+ *	Prints the measurements for one phase.
+ */
+static void Report(const char* phase, const double seconds, const size_t allocations, const size_t count)
+{
+	printf("%-8s %10.3f s %12zu allocs %8.2f allocs/ticket\n", phase, seconds, allocations, static_cast<double>(allocations) / count);
+}
+
+int main(const int argc, char* argv[])
+{
+	const bool arena = argc > 1 && strcmp(argv[1], "arena") == 0;		// which mode to run
+	const size_t count = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000;	// tickets to load
+	char clientId[32];			// fields of the next ticket
+	char description[96];
+	BenchSupport::Stopwatch timer;
+
+	printf("%s mode, %zu tickets\n", arena ? "arena" : "heap", count);
+	const auto startAllocations = BenchSupport::allocations.load();
+
+	if (arena)
+	{
+		auto batch = new TicketBatch();
+		batch->Reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			MakeTicket(i, clientId, sizeof(clientId), description, sizeof(description));
+			batch->Add(static_cast<int>(i + 1), clientId, 1 + i % 28, 1 + i % 12, 2000 + i % 100, description, i % 3 != 0);
+		}
+		Report("load", timer.Seconds(), BenchSupport::allocations.load() - startAllocations, count);
+
+		const auto freesBefore = BenchSupport::deallocations.load();
+		timer.Restart();
+		delete batch;
+		printf("%-8s %10.3f s %12zu frees\n", "release", timer.Seconds(), BenchSupport::deallocations.load() - freesBefore);
+	}
+	else
+	{
+		auto tickets = new vector<ExtendedWorkTicket>();
+		tickets->reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			MakeTicket(i, clientId, sizeof(clientId), description, sizeof(description));
+			tickets->emplace_back();
+			tickets->back().SetWorkTicket(static_cast<int>(i + 1), clientId, 1 + i % 28, 1 + i % 12, 2000 + i % 100, description, i % 3 != 0);
+		}
+		Report("load", timer.Seconds(), BenchSupport::allocations.load() - startAllocations, count);
+
+		const auto freesBefore = BenchSupport::deallocations.load();
+		timer.Restart();
+		delete tickets;
+		printf("%-8s %10.3f s %12zu frees\n", "release", timer.Seconds(), BenchSupport::deallocations.load() - freesBefore);
+	}
+
+	printf("peak RSS %zu KB\n", BenchSupport::PeakRssKb());
+	return 0;
+}
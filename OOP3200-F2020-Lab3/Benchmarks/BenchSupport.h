@@ -0,0 +1,157 @@
+/** BenchSupport.h - Benchmark Support
+ *
+ *	Shared helpers for the benchmark programs in this folder: a global
+ *	allocation counter (this header replaces operator new and delete, so
+ *	include it in exactly one source file per program), the process's peak
+ *	resident set size, and a stopwatch.
+ *
+ *	@version	2020.09
+*/
+
+#pragma once
+#ifndef _BENCH_SUPPORT_H
+
+#define _BENCH_SUPPORT_H
+
+#include <atomic>		// for the allocation counters
+#include <chrono>		// for steady_clock
+#include <cstddef>		// for size_t
+#include <cstdlib>		// for malloc and free
+#include <new>			// for bad_alloc
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+class BenchSupport
+{
+public:
+	/** Allocation Counters
+	 *	The number of calls to operator new and delete, and the bytes requested.
+	 */
+	static atomic<size_t> allocations;
+	static atomic<size_t> deallocations;
+	static atomic<size_t> allocated_bytes;
+
+	/** PeakRssKb()
+	 *	Returns the peak resident set size of the process so far.
+	 *	@return (size_t) - kilobytes
+	 */
+	static size_t PeakRssKb();
+
+	/** Stopwatch
+	 *	Measures elapsed wall-clock time from construction or the last Restart().
+	 */
+	class Stopwatch
+	{
+	public:
+		Stopwatch() : myStart(chrono::steady_clock::now()) {}
+		void Restart() { myStart = chrono::steady_clock::now(); }
+		double Seconds() const { return chrono::duration<double>(chrono::steady_clock::now() - myStart).count(); }
+
+	private:
+		chrono::steady_clock::time_point myStart; // when timing started
+	};
+};
+
+atomic<size_t> BenchSupport::allocations{ 0 };
+atomic<size_t> BenchSupport::deallocations{ 0 };
+atomic<size_t> BenchSupport::allocated_bytes{ 0 };
+
+// BenchSupport::PeakRssKb
+size_t BenchSupport::PeakRssKb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss) / 1024; // bytes on macOS
+#else
+	return static_cast<size_t>(usage.ru_maxrss);		// kilobytes on Linux
+#endif
+#endif
+}
+
+/***************************************************************************
+ *	COUNTING ALLOCATION FUNCTIONS
+ *	The array and nothrow forms forward to these by default. The aligned
+ *	forms are replaced too, since pmr::new_delete_resource() uses them.
+ ***************************************************************************/
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // malloc and free are the real pair here
+#endif
+
+void* operator new(const size_t size)
+{
+	BenchSupport::allocations.fetch_add(1, memory_order_relaxed);
+	BenchSupport::allocated_bytes.fetch_add(size, memory_order_relaxed);
+	if (void* memory = malloc(size == 0 ? 1 : size))
+		return memory;
+	throw bad_alloc();
+}
+
+void* operator new(const size_t size, const align_val_t alignment)
+{
+	const auto align = static_cast<size_t>(alignment);
+	const auto rounded = (size + align - 1) / align * align; // aligned_alloc needs a multiple of the alignment
+
+	BenchSupport::allocations.fetch_add(1, memory_order_relaxed);
+	BenchSupport::allocated_bytes.fetch_add(size, memory_order_relaxed);
+#ifdef _WIN32
+	if (void* memory = _aligned_malloc(rounded == 0 ? align : rounded, align))
+#else
+	if (void* memory = aligned_alloc(align, rounded == 0 ? align : rounded))
+#endif
+		return memory;
+	throw bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	if (memory != nullptr)
+	{
+		BenchSupport::deallocations.fetch_add(1, memory_order_relaxed);
+		free(memory);
+	}
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, align_val_t) noexcept
+{
+	if (memory != nullptr)
+	{
+		BenchSupport::deallocations.fetch_add(1, memory_order_relaxed);
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+}
+
+void operator delete(void* memory, size_t, const align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+/** BusinessDayBench.cpp - SLA Due Date Benchmark
+ *
+ *	Computes a due date a number of business days after each of a set of
+ *	synthetic ticket dates, and the business days from each ticket date to a
+ *	fixed date, two ways, and reports ns/ticket and allocs/ticket for each:
+ *
+ *		BusinessDayBench [count] [sla]		count tickets (default 1,000,000),
+ *											sla business days (default 10)
+ *
+ *		loop		step MyDate::operator++ a day at a time, checking
+ *					GetDayOfWeek() and searching a holiday list, as SLA
+ *					code did before BusinessCalendar
+ *		calendar	BusinessCalendar::AddBusinessDays() and
+ *					BusinessDaysBetween() on WorkTicket::GetDate(), and
+ *					AddBusinessDays() on WorkTicket::GetPackedDate()
+ *
+ *	Both use the same holidays (four a year) and must agree on every ticket.
+ *
+ *	@version	2020.09
+ *	@see		BusinessCalendar.h
+*/
+
+#include <algorithm>	// for find
+#include <cstdlib>		// for strtoull and atoi
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <string>		// for string
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../BusinessCalendar.h"
+#include "../WorkTicket.h"
+
+using namespace std;
+
+/** IsBusinessDay()
+ *	The loop's test: not a Saturday or Sunday and not in the holiday list.
+ */
+static bool IsBusinessDay(const MyDate& date, const vector<MyDate>& holidays)
+{
+	const auto dayName = date.GetDayOfWeek();
+	if (dayName == "Saturday" || dayName == "Sunday")
+		return false;
+	return find(holidays.begin(), holidays.end(), date) == holidays.end();
+}
+
+/** Report()
+ *	Prints one result line.
+ */
+static void Report(const char* name, const size_t count, const double seconds, const size_t allocations)
+{
+	cout << left << setw(12) << name << right << fixed << setprecision(1)
+		<< setw(12) << seconds * 1e9 / count << " ns/ticket"
+		<< setw(10) << setprecision(2) << static_cast<double>(allocations) / count << " allocs/ticket" << endl;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+	const auto sla = argc > 2 ? atoi(argv[2]) : 10;
+
+	vector<MyDate> holidays;
+	for (int year = BusinessCalendar::first_year; year <= BusinessCalendar::last_year; year++)
+	{
+		holidays.emplace_back(1, 1, year);
+		holidays.emplace_back(1, 7, year);
+		holidays.emplace_back(25, 12, year);
+		holidays.emplace_back(26, 12, year);
+	}
+
+	// tickets over 2000-2098, so every due date stays in the window
+	vector<WorkTicket> tickets;
+	tickets.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		tickets.emplace_back(static_cast<int>(i + 1), "CLIENT", static_cast<int>(1 + i % 12), static_cast<int>(1 + i % 28), static_cast<int>(2000 + i % 99), "Printer on floor 3 will not print");
+	const MyDate reportDate(1, 1, 2099); // business days from each ticket to this
+	cout << count << " tickets, due " << sla << " business days after the ticket date" << endl;
+
+	vector<MyDate> loopDue;
+	vector<int> loopAge;
+	{
+		loopDue.reserve(count);
+		loopAge.reserve(count);
+		const auto allocations = BenchSupport::allocations.load();
+		BenchSupport::Stopwatch timer;
+		for (const auto& ticket : tickets)
+		{
+			auto due = ticket.GetDate();
+			for (int left = sla; left > 0;)
+			{
+				++due;
+				if (IsBusinessDay(due, holidays))
+					left--;
+			}
+			loopDue.push_back(due);
+		}
+		Report("loop due", count, timer.Seconds(), BenchSupport::allocations.load() - allocations);
+
+		// counting to a date years away is the case that hurts, so only a sample is timed
+		const auto sample = count < 1000 ? count : 1000;
+		const auto ageAllocations = BenchSupport::allocations.load();
+		timer.Restart();
+		for (size_t i = 0; i < sample; i++)
+		{
+			int age = 0; // business days after the ticket date, up to and including reportDate
+			for (auto day = tickets[i].GetDate(); day < reportDate;)
+			{
+				++day;
+				age += IsBusinessDay(day, holidays);
+			}
+			loopAge.push_back(age);
+		}
+		Report("loop age", sample, timer.Seconds(), BenchSupport::allocations.load() - ageAllocations);
+	}
+
+	{
+		BenchSupport::Stopwatch timer;
+		const BusinessCalendar calendar(holidays);
+		cout << left << setw(12) << "calendar" << right << fixed << setprecision(2) << setw(12) << timer.Seconds() * 1e3 << " ms to build" << endl;
+
+		size_t mismatches = 0; // tickets the two ways disagree on
+		vector<MyDate> due;
+		due.reserve(count);
+		const auto dueAllocations = BenchSupport::allocations.load();
+		timer.Restart();
+		for (const auto& ticket : tickets)
+			due.push_back(calendar.AddBusinessDays(ticket.GetDate(), sla));
+		Report("calendar due", count, timer.Seconds(), BenchSupport::allocations.load() - dueAllocations);
+
+		// the PackedDate form skips converting to and from MyDate
+		vector<PackedDate> packedDue;
+		packedDue.reserve(count);
+		const auto packedAllocations = BenchSupport::allocations.load();
+		timer.Restart();
+		for (const auto& ticket : tickets)
+			packedDue.push_back(calendar.AddBusinessDays(ticket.GetPackedDate(), sla));
+		Report("  packed", count, timer.Seconds(), BenchSupport::allocations.load() - packedAllocations);
+
+		vector<int> age;
+		age.reserve(count);
+		const auto ageAllocations = BenchSupport::allocations.load();
+		timer.Restart();
+		for (const auto& ticket : tickets)
+			age.push_back(calendar.BusinessDaysBetween(ticket.GetDate(), reportDate));
+		Report("calendar age", count, timer.Seconds(), BenchSupport::allocations.load() - ageAllocations);
+
+		for (size_t i = 0; i < count; i++)
+			mismatches += !(due[i] == loopDue[i]) || packedDue[i] != PackedDate(loopDue[i]) || (i < loopAge.size() && age[i] != loopAge[i]);
+		cout << mismatches << " mismatches" << endl;
+		return mismatches == 0 ? 0 : 1;
+	}
+}
@@ -0,0 +1,402 @@
+/** CoreBench.cpp - Core Type Benchmark Suite
+ *
+ *	Times the operations everything else is built on: MyDate conversions,
+ *	formatting and stepping (against a DateRange), WorkTicket::SetWorkTicket
+ *	validation, and WorkTicket formatting, copying and assignment, plus one
+ *	macro case that runs them together the way a report does. Reports ns/op,
+ *	allocs/op and ops/s for each, and can save the results as a baseline and
+ *	compare a later run against it:
+ *
+ *		CoreBench [options]
+ *			--filter text		run only the cases whose names contain text
+ *			--time seconds		minimum time per measurement (default 0.1)
+ *			--save file			write the results to file as a baseline
+ *			--compare file		compare the results with a saved baseline
+ *			--threshold percent	slower than this is a regression (default 10)
+ *			--stats text|json	dump the Instrumentation counters afterwards
+ *
+ *	Each case is run in batches large enough to take the minimum time, and the
+ *	fastest of five batches is reported, so a busy host makes the numbers
+ *	worse less often than a single long run would. With --compare the program
+ *	returns 1 if any case got slower than the threshold or allocates more than
+ *	it did, so a build script can fail on a regression.
+ *
+ *	The baseline is a text file with one tab-separated line per case: the
+ *	name, ns/op and allocs/op.
+ *
+ *	--stats only has counters to dump in a build with LAB3_INSTRUMENTATION
+ *	defined, and the times are then those of the instrumented code.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+ *	@see		DateRange.h
+ *	@see		WorkTicket.h
+ *	@see		Instrumentation.h
+*/
+
+#include <cstdlib>		// for strtod
+#include <cstring>		// for strcmp
+#include <fstream>		// for the baseline file
+#include <functional>	// for function
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <map>			// for the baseline
+#include <sstream>		// for ostringstream
+#include <string>		// for string
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../MyDate.h"
+#include "../DateRange.h"
+#include "../WorkTicket.h"
+
+using namespace std;
+
+/** Case
+ *	One benchmark: run() performs the operation a number of times and returns
+ *	a checksum of the results, so the work cannot be optimized away.
+ */
+struct Case
+{
+	string name;
+	function<size_t(size_t)> run;
+};
+
+/** Result
+ *	What one case measured.
+ */
+struct Result
+{
+	double nsPerOp;
+	double allocsPerOp;
+};
+
+const size_t input_count = 1024; // inputs per case; a power of two so i & mask picks one
+
+volatile size_t sink = 0; // where the checksums go
+
+/** Measure()
+ *	Finds a batch size that takes at least min_seconds, then returns the
+ *	fastest of five batches of that size.
+ *	@param test (const Case&) - the case to run
+ *	@param min_seconds (double) - the minimum time per batch
+ *	@return (Result) - ns/op and allocs/op
+ */
+static Result Measure(const Case& test, const double min_seconds)
+{
+	size_t iterations = 1; // operations per batch
+	for (;;)
+	{
+		BenchSupport::Stopwatch timer;
+		sink = sink + test.run(iterations);
+		const auto seconds = timer.Seconds();
+		if (seconds >= min_seconds)
+			break;
+		// aim a little past the minimum, but never grow more than a hundredfold at once
+		const auto scale = seconds > 0 ? min_seconds * 1.2 / seconds : 100.0;
+		iterations = static_cast<size_t>(iterations * (scale < 100.0 ? (scale > 2.0 ? scale : 2.0) : 100.0));
+	}
+
+	Result best{ 0, 0 };
+	for (int repeat = 0; repeat < 5; repeat++)
+	{
+		const auto allocations = BenchSupport::allocations.load();
+		BenchSupport::Stopwatch timer;
+		sink = sink + test.run(iterations);
+		const auto nsPerOp = timer.Seconds() * 1e9 / iterations;
+		if (repeat == 0 || nsPerOp < best.nsPerOp)
+			best.nsPerOp = nsPerOp;
+		best.allocsPerOp = static_cast<double>(BenchSupport::allocations.load() - allocations) / iterations;
+	}
+	return best;
+}
+
+/** MakeCases()
+ *	Builds the inputs and the cases that use them.
+ *	@return (vector<Case>) - every case, in the order they are reported
+ */
+static vector<Case> MakeCases()
+{
+	const auto mask = input_count - 1;
+	vector<long> dayNumbers;	// spread over the years a ticket may have
+	vector<MyDate> dates;
+	vector<WorkTicket> tickets;
+	for (size_t i = 0; i < input_count; i++)
+	{
+		const auto day = static_cast<int>(1 + i % 28);
+		const auto month = static_cast<int>(1 + i % 12);
+		const auto year = static_cast<int>(2000 + i % 100);
+		dayNumbers.push_back(MyDate::DayNumber(day, month, year));
+		dates.emplace_back(day, month, year);
+		tickets.emplace_back(static_cast<int>(i + 1), "CLIENT-" + to_string(i % 50), month, day, year, "Printer on floor " + to_string(i % 40) + " will not print");
+	}
+
+	vector<Case> cases;
+
+	// MyDate conversions
+	cases.push_back({ "MyDate long()", [=](const size_t n)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += static_cast<long>(dates[i & mask]);
+		return sum;
+	} });
+	cases.push_back({ "MyDate(long)", [=](const size_t n)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += MyDate(dayNumbers[i & mask]).GetDay();
+		return sum;
+	} });
+	cases.push_back({ "MyDate + int", [=](const size_t n)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += (dates[i & mask] + static_cast<int>(i & mask)).GetMonth();
+		return sum;
+	} });
+
+	// MyDate formatting
+	cases.push_back({ "MyDate string()", [=](const size_t n)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += static_cast<string>(dates[i & mask]).size();
+		return sum;
+	} });
+	cases.push_back({ "MyDate <<", [=](const size_t n)
+	{
+		ostringstream out; // reused, as a report reuses its stream
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			out.seekp(0);
+			out << dates[i & mask];
+			sum += static_cast<size_t>(out.tellp());
+		}
+		return sum;
+	} });
+
+	// walking the calendar a day at a time, about 45 years at a time
+	cases.push_back({ "MyDate ++", [=](const size_t n)
+	{
+		MyDate date;
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			if (i % 16384 == 0)
+				date = MyDate(1, 1, 2000);
+			++date;
+			sum += date.GetDay();
+		}
+		return sum;
+	} });
+	cases.push_back({ "DateRange day", [=](const size_t n)
+	{
+		const DateRange days(MyDate(1, 1, 2000), MyDate(1, 1, 2045));
+		auto day = days.begin();
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++, ++day)
+		{
+			if (day == days.end())
+				day = days.begin();
+			sum += (*day).GetDay();
+		}
+		return sum;
+	} });
+
+	// WorkTicket validation
+	cases.push_back({ "SetWorkTicket valid", [=](const size_t n)
+	{
+		WorkTicket ticket;
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			const auto& date = dates[i & mask];
+			sum += ticket.SetWorkTicket(static_cast<int>(i + 1), "CLIENT-7", date.GetDay(), date.GetMonth(), date.GetYear(), "Printer on floor 3 will not print");
+		}
+		return sum;
+	} });
+	cases.push_back({ "SetWorkTicket invalid", [=](const size_t n)
+	{
+		WorkTicket ticket;
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += ticket.SetWorkTicket(static_cast<int>(i + 1), "CLIENT-7", 30, 2, 2000 + static_cast<int>(i % 100), "Printer on floor 3 will not print");
+		return sum;
+	} });
+
+	// WorkTicket formatting, copy and assign
+	cases.push_back({ "WorkTicket string()", [=](const size_t n)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+			sum += static_cast<string>(tickets[i & mask]).size();
+		return sum;
+	} });
+	cases.push_back({ "WorkTicket copy", [=](const size_t n)
+	{
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			const WorkTicket copy(tickets[i & mask]);
+			sum += copy.GetTicketNumber();
+		}
+		return sum;
+	} });
+	cases.push_back({ "WorkTicket assign", [=](const size_t n)
+	{
+		WorkTicket target;
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			target = tickets[i & mask];
+			sum += target.GetTicketNumber();
+		}
+		return sum;
+	} });
+
+	// a report: validate each ticket's fields, then write it out
+	cases.push_back({ "report (macro)", [=](const size_t n)
+	{
+		ostringstream out;
+		WorkTicket ticket;
+		size_t sum = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			if ((i & mask) == 0)
+				out.str(string()); // start a new page of input_count tickets
+			const auto& source = tickets[i & mask];
+			const auto date = source.GetDate();
+			if (ticket.SetWorkTicket(source.GetTicketNumber(), source.GetClientIdView(), date.GetDay(), date.GetMonth(), date.GetYear(), source.GetDescriptionView()))
+				out << ticket;
+			sum += static_cast<size_t>(out.tellp());
+		}
+		return sum;
+	} });
+
+	return cases;
+}
+
+/** LoadBaseline()
+ *	Reads a baseline written by --save.
+ *	@param path (const string&) - the file to read
+ *	@param baseline (map<string, Result>&) - receives the results by case name
+ *	@return (bool) - false if the file could not be opened
+ */
+static bool LoadBaseline(const string& path, map<string, Result>& baseline)
+{
+	ifstream in(path);
+	if (!in)
+		return false;
+	string line;
+	while (getline(in, line))
+	{
+		const auto nameEnd = line.find('\t');
+		if (nameEnd == string::npos)
+			continue;
+		istringstream fields(line.substr(nameEnd + 1));
+		Result result{ 0, 0 };
+		if (fields >> result.nsPerOp >> result.allocsPerOp)
+			baseline[line.substr(0, nameEnd)] = result;
+	}
+	return true;
+}
+
+int main(const int argc, char* argv[])
+{
+	string filter;			// only the cases containing this
+	double minSeconds = 0.1;	// per batch
+	string savePath;		// where to save the results, if anywhere
+	string comparePath;		// the baseline to compare with, if any
+	double threshold = 10;	// percent slower that counts as a regression
+	string stats;			// how to dump the counters, if at all
+
+	for (int i = 1; i < argc; i++)
+	{
+		const auto hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--filter") == 0 && hasValue)
+			filter = argv[++i];
+		else if (strcmp(argv[i], "--time") == 0 && hasValue)
+			minSeconds = strtod(argv[++i], nullptr);
+		else if (strcmp(argv[i], "--save") == 0 && hasValue)
+			savePath = argv[++i];
+		else if (strcmp(argv[i], "--compare") == 0 && hasValue)
+			comparePath = argv[++i];
+		else if (strcmp(argv[i], "--threshold") == 0 && hasValue)
+			threshold = strtod(argv[++i], nullptr);
+		else if (strcmp(argv[i], "--stats") == 0 && hasValue && (strcmp(argv[i + 1], "text") == 0 || strcmp(argv[i + 1], "json") == 0))
+			stats = argv[++i];
+		else
+		{
+			cerr << "usage: CoreBench [--filter text] [--time seconds] [--save file] [--compare file] [--threshold percent] [--stats text|json]" << endl;
+			return 2;
+		}
+	}
+
+	map<string, Result> baseline;
+	const auto comparing = !comparePath.empty() && LoadBaseline(comparePath, baseline);
+	if (!comparePath.empty() && !comparing)
+		cout << "no baseline at " << comparePath << " yet; save one with --save" << endl << endl;
+
+	cout << left << setw(24) << "case" << right << setw(12) << "ns/op" << setw(12) << "allocs/op" << setw(14) << "ops/s";
+	if (comparing)
+		cout << setw(12) << "base ns/op" << setw(10) << "change";
+	cout << endl;
+
+	vector<pair<string, Result>> results;
+	int regressions = 0; // cases slower or allocating more than the baseline
+	for (const auto& test : MakeCases())
+	{
+		if (test.name.find(filter) == string::npos)
+			continue;
+		const auto result = Measure(test, minSeconds);
+		results.emplace_back(test.name, result);
+
+		cout << left << setw(24) << test.name << right << fixed << setprecision(1) << setw(12) << result.nsPerOp
+			<< setprecision(2) << setw(12) << result.allocsPerOp << setprecision(0) << setw(14) << 1e9 / result.nsPerOp;
+		if (comparing)
+		{
+			const auto found = baseline.find(test.name);
+			if (found == baseline.end())
+				cout << setw(12) << "-" << setw(10) << "new";
+			else
+			{
+				const auto change = (result.nsPerOp / found->second.nsPerOp - 1) * 100;
+				const auto moreAllocations = result.allocsPerOp > found->second.allocsPerOp + 0.005;
+				cout << setprecision(1) << setw(12) << found->second.nsPerOp << showpos << setw(9) << change << '%' << noshowpos;
+				if (change > threshold || moreAllocations)
+				{
+					cout << (moreAllocations ? "  REGRESSION (allocations)" : "  REGRESSION");
+					regressions++;
+				}
+			}
+		}
+		cout << endl;
+	}
+
+	if (!savePath.empty())
+	{
+		ofstream out(savePath);
+		for (const auto& result : results)
+			out << result.first << '\t' << setprecision(3) << fixed << result.second.nsPerOp << '\t' << result.second.allocsPerOp << '\n';
+		if (!out)
+		{
+			cerr << "could not write " << savePath << endl;
+			return 2;
+		}
+		cout << endl << "saved the baseline to " << savePath << endl;
+	}
+	if (!stats.empty())
+	{
+		cout << endl;
+		if (!Instrumentation::enabled)
+			cout << "(built without LAB3_INSTRUMENTATION, so nothing was counted)" << endl;
+		if (stats == "json")
+			Instrumentation::WriteJson(cout, Instrumentation::Collect());
+		else
+			Instrumentation::WriteText(cout, Instrumentation::Collect());
+	}
+	if (comparing)
+		cout << endl << regressions << " regression(s) beyond " << threshold << "%" << endl;
+	return regressions > 0 ? 1 : 0;
+}
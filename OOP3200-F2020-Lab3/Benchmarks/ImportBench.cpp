@@ -0,0 +1,78 @@
+/** ImportBench.cpp - CSV Import Throughput Benchmark
+ *
+ *	Imports a CSV file, or a synthetic one held in memory, into a
+ *	WorkTicketStore with 1, 2, 4, ... threads up to one per core, and reports
+ *	records/s and MB/s for each:
+ *
+ *		ImportBench [count]			synthetic CSV with count records (default 2,000,000)
+ *		ImportBench --file path		an existing CSV file with no header
+ *
+ *	About one synthetic record in ten is quoted with embedded commas, quotes
+ *	and line breaks, and one in twenty is invalid.
+ *
+ *	@version	2020.09
+ *	@see		TicketImporter.h
+*/
+
+#include <cstdlib>		// for strtoull
+#include <cstring>		// for strcmp
+#include <fstream>		// for ifstream
+#include <iostream>		// for cout
+#include <sstream>		// for stringstream
+#include <string>		// for string
+#include <thread>		// for hardware_concurrency
+#include "BenchSupport.h"
+#include "../TicketImporter.h"
+
+using namespace std;
+
+/** MakeCsv()
+ *	Builds a synthetic CSV export.
+ */
+static string MakeCsv(const size_t count)
+{
+	string csv; // the export
+	csv.reserve(count * 64);
+	for (size_t i = 1; i <= count; i++)
+	{
+		csv += to_string(i);
+		csv += ",CLIENT-" + to_string(i % 5000) + ",";
+		csv += to_string(i % 20 == 0 ? 2150 : 2000 + i % 100) + "-" + to_string(1 + i % 12) + "-" + to_string(1 + i % 28) + ",";
+		if (i % 10 == 0)
+			csv += "\"Printer on floor " + to_string(i % 40) + ", says \"\"PC LOAD LETTER\"\"\nagain\"";
+		else
+			csv += "Printer on floor " + to_string(i % 40) + " will not print";
+		csv += i % 3 == 0 ? ",closed\n" : "\n";
+	}
+	return csv;
+}
+
+int main(const int argc, char* argv[])
+{
+	string text; // the CSV to import
+
+	if (argc > 2 && strcmp(argv[1], "--file") == 0)
+	{
+		ifstream file(argv[2], ios::binary);
+		stringstream contents;
+		contents << file.rdbuf();
+		text = contents.str();
+	}
+	else
+	{
+		text = MakeCsv(argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000);
+	}
+
+	const auto cores = max(1u, thread::hardware_concurrency());
+	cout << text.size() / (1024 * 1024) << " MB, " << cores << " cores" << endl;
+	for (unsigned threads = 1; ; threads = min(threads * 2, cores))
+	{
+		WorkTicketStore store;
+		const auto result = TicketImporter(',', false, threads).Import(text, store);
+		cout << result << endl;
+		if (threads == cores)
+			break;
+	}
+	cout << "peak RSS " << BenchSupport::PeakRssKb() << " KB" << endl;
+	return 0;
+}
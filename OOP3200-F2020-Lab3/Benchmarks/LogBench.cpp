@@ -0,0 +1,109 @@
+/** LogBench.cpp - Write-Ahead Log Group Commit Benchmark
+ *
+ *	Appends ticket changes to a TicketLog from 1, 4, 16 and 64 threads with
+ *	each Durability option, and a few commit delays, and reports changes per
+ *	second, changes per sync and the time each change waited:
+ *
+ *		LogBench [path] [seconds]	the log file to use (default LogBench.log,
+ *									deleted afterwards), seconds per run (default 0.5)
+ *
+ *	The first row is the baseline: one thread that writes and syncs every
+ *	change on its own, which is what a log without group commit does.
+ *
+ *	@version	2020.09
+ *	@see		TicketLog.h
+*/
+
+#include <atomic>		// for the stop flag
+#include <cstdio>		// for remove
+#include <cstdlib>		// for strtod
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <string>		// for string
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../TicketLog.h"
+
+using namespace std;
+
+/** Run()
+ *	Appends changes from a number of threads for a number of seconds and
+ *	prints what the log did.
+ */
+static void Run(const string& path, const char* name, const TicketLog::Options& options, const unsigned threads, const double seconds)
+{
+	remove(path.c_str());
+	atomic<bool> stop{ false };	// set when time is up
+	TicketLog::Stats stats;		// what the log did
+	double elapsed = 0;			// seconds, including the final flush
+	{
+		TicketLog log(path, options);
+		vector<thread> workers;
+		BenchSupport::Stopwatch timer;
+		for (unsigned t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&, t]()
+			{
+				// a mix of the changes a ticket system makes
+				for (int i = 0; !stop.load(memory_order_relaxed); i++)
+				{
+					const auto ticketNumber = static_cast<int>(t * 10000000 + i + 1);
+					if (i % 4 == 0)
+						log.Insert(ticketNumber, "CLIENT-" + to_string(i % 5000), PackedDate(1 + i % 28, 1 + i % 12, 2020), "Printer on floor 3 will not print", true);
+					else if (i % 4 == 1)
+						log.SetDescription(ticketNumber - 1, "Printer on floor 3 prints blank pages");
+					else if (i % 4 == 2)
+						log.SetWorkTicket(ticketNumber - 2, "CLIENT-7", 2, 3, 2020, "Toner replaced; printing again");
+					else
+						log.Close(ticketNumber - 3);
+				}
+			});
+		}
+		this_thread::sleep_for(chrono::duration<double>(seconds));
+		stop.store(true);
+		for (auto& worker : workers)
+			worker.join();
+		log.Flush();
+		elapsed = timer.Seconds();
+		stats = log.GetStats();
+	}
+	remove(path.c_str());
+
+	const auto waited = options.durability == TicketLog::Durability::Commit ? elapsed * threads / stats.records * 1e6 : 0;
+	cout << left << setw(24) << name << right << setw(8) << threads << fixed << setprecision(0) << setw(14) << stats.records / elapsed
+		<< setw(12) << stats.syncs << setprecision(1) << setw(14) << (stats.syncs > 0 ? static_cast<double>(stats.records) / stats.syncs : 0)
+		<< setw(12) << waited << endl;
+}
+
+int main(const int argc, char* argv[])
+{
+	const string path = argc > 1 ? argv[1] : "LogBench.log";
+	const auto seconds = argc > 2 ? strtod(argv[2], nullptr) : 0.5;
+
+	cout << left << setw(24) << "durability" << right << setw(8) << "threads" << setw(14) << "changes/s" << setw(12) << "syncs"
+		<< setw(14) << "changes/sync" << setw(12) << "wait us" << endl;
+
+	TicketLog::Options options;
+	options.max_batch_bytes = 1; // write and sync every change on its own
+	Run(path, "sync each (baseline)", options, 1, seconds);
+
+	options.max_batch_bytes = TicketLog::Options().max_batch_bytes;
+	for (const unsigned threads : { 1u, 4u, 16u, 64u })
+		Run(path, "commit", options, threads, seconds);
+
+	options.commit_delay = chrono::microseconds(1000);
+	for (const unsigned threads : { 16u, 64u })
+		Run(path, "commit, 1 ms delay", options, threads, seconds);
+
+	options.durability = TicketLog::Durability::Deferred;
+	options.commit_delay = chrono::microseconds(10000);
+	for (const unsigned threads : { 1u, 16u })
+		Run(path, "deferred, 10 ms", options, threads, seconds);
+
+	options.durability = TicketLog::Durability::Buffered;
+	options.commit_delay = chrono::microseconds(0);
+	for (const unsigned threads : { 1u, 16u })
+		Run(path, "buffered", options, threads, seconds);
+	return 0;
+}
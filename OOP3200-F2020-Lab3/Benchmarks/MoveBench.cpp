@@ -0,0 +1,95 @@
+/** MoveBench.cpp - Ticket Copy vs Move Allocation Benchmark
+ *
+ *	Loads tickets into a vector that is not reserved, so it reallocates as
+ *	it grows, and counts the heap allocations per ticket. The copy-only run
+ *	uses a ticket type with no move operations, as WorkTicket was before it
+ *	had them, so every reallocation deep-copies every description:
+ *
+ *		MoveBench [count]		count tickets (default 1,000,000)
+ *
+ *	With moves, a ticket costs one allocation for its description plus the
+ *	vector's own log2(count) reallocations. The program exits with 1 if the
+ *	move run takes any more than that, so a change that brings back deep
+ *	copies on growth fails it.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+*/
+
+#include <cstdlib>		// for strtoull
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <string>		// for string
+#include <type_traits>	// for is_nothrow_move_constructible
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../ExtendedWorkTicket.h"
+
+using namespace std;
+
+static_assert(is_nothrow_move_constructible<WorkTicket>::value, "vector<WorkTicket> must move, not copy, when it grows");
+static_assert(is_nothrow_move_constructible<ExtendedWorkTicket>::value, "vector<ExtendedWorkTicket> must move, not copy, when it grows");
+
+/** CopyOnlyTicket
+ *	An ExtendedWorkTicket that can only be copied.
+ */
+class CopyOnlyTicket : public ExtendedWorkTicket
+{
+public:
+	using ExtendedWorkTicket::ExtendedWorkTicket;
+	CopyOnlyTicket(const CopyOnlyTicket& original) = default;
+	CopyOnlyTicket& operator=(const CopyOnlyTicket& original) = default;
+};
+
+/** Load()
+ *	Builds count tickets, appends them to an empty vector and prints the
+ *	allocations and time taken.
+ *	@return (size_t) - the allocations over one per ticket and one per
+ *		reallocation of the vector; 0 when every ticket was moved
+ */
+template <typename Ticket>
+static size_t Load(const char* name, const size_t count, const vector<string>& clients, const vector<string>& descriptions)
+{
+	size_t reallocations = 0; // times the vector grew
+	const auto allocations = BenchSupport::allocations.load();
+	BenchSupport::Stopwatch timer;
+	{
+		vector<Ticket> tickets; // not reserved, so it reallocates as it grows
+		for (size_t i = 1; i <= count; i++)
+		{
+			const auto capacity = tickets.capacity();
+			tickets.push_back(Ticket(static_cast<int>(i), clients[i % clients.size()], 1 + i % 12, 1 + i % 12, 2000 + i % 100,
+				descriptions[i % descriptions.size()], true));
+			reallocations += tickets.capacity() != capacity;
+		}
+	}
+	const auto seconds = timer.Seconds();
+	const auto used = BenchSupport::allocations.load() - allocations;
+
+	cout << left << setw(10) << name << right << fixed << setprecision(1)
+		<< setw(10) << seconds * 1e9 / count << " ns/ticket"
+		<< setw(10) << setprecision(2) << static_cast<double>(used) / count << " allocs/ticket"
+		<< setw(12) << used << " allocs" << endl;
+	return used > count + reallocations ? used - count - reallocations : 0;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+
+	vector<string> clients;		 // interned up front, so the table's growth is not counted
+	vector<string> descriptions; // too long for the small string buffer, so each copy allocates
+	for (size_t i = 0; i < 5000; i++)
+		ClientIdTable::Shared().Intern(clients.emplace_back("CLIENT-" + to_string(i)));
+	for (size_t i = 0; i < 40; i++)
+		descriptions.push_back("Printer on floor " + to_string(i) + " will not print anything at all");
+
+	Load<CopyOnlyTicket>("copy", count, clients, descriptions);
+	const auto extra = Load<ExtendedWorkTicket>("move", count, clients, descriptions);
+	if (extra != 0)
+	{
+		cout << "move: " << extra << " allocations over one per ticket and one per reallocation" << endl;
+		return 1;
+	}
+	return 0;
+}
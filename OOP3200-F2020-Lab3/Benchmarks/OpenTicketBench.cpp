@@ -0,0 +1,111 @@
+/** OpenTicketBench.cpp - Open Ticket Bitmap Benchmark
+ *
+ *	Counts, filters and closes open tickets three ways: by touching every
+ *	ExtendedWorkTicket object, by scanning a WorkTicketStore's open flag
+ *	column, and through the store's open ticket TicketBitmap:
+ *
+ *		OpenTicketBench [count]		count tickets (default 10,000,000)
+ *
+ *	Tickets are numbered in order and the older ones are mostly closed, as
+ *	in a real ticket system; about a quarter are open.
+ *
+ *	@version	2020.09
+ *	@see		TicketBitmap.h
+*/
+
+#include <cstdlib>		// for strtoull
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <random>		// for mt19937
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../WorkTicketStore.h"
+
+using namespace std;
+
+/** Time()
+ *	Runs a task repeatedly for at least a tenth of a second and prints the
+ *	time per run and its result.
+ */
+template <typename Task>
+static void Time(const char* name, Task task)
+{
+	size_t result = 0;	// what the task returned
+	size_t runs = 0;	// how many times it ran
+	BenchSupport::Stopwatch timer;
+	do
+	{
+		result = task();
+		runs++;
+	} while (timer.Seconds() < 0.1);
+	cout << left << setw(40) << name << right << fixed << setprecision(1) << setw(12) << timer.Seconds() / runs * 1e6 << " us"
+		<< setw(12) << result << endl;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+
+	// the same tickets as objects and in a store
+	vector<ExtendedWorkTicket> tickets;
+	WorkTicketStore store;
+	mt19937 random(2020);
+	tickets.reserve(count);
+	store.Reserve(count);
+	for (size_t i = 1; i <= count; i++)
+	{
+		const auto open = random() % count < i / 2; // newer tickets are more likely to be open
+		tickets.emplace_back(static_cast<int>(i), "CLIENT", 1, 1, 2020, "Printer", open);
+		store.Insert(static_cast<int>(i), "CLIENT", PackedDate(1, 1, 2020), "Printer", open);
+	}
+
+	// a filter from another search: every fiftieth ticket
+	vector<int> filter;
+	for (size_t i = 50; i <= count; i += 50)
+		filter.push_back(static_cast<int>(i));
+	const TicketBitmap filterBitmap(filter);
+
+	cout << count << " tickets, " << store.CountOpen() << " open; open bitmap " << store.OpenTickets().Bytes() / 1024
+		<< " KB, flag column " << count / 1024 << " KB" << endl << endl;
+
+	Time("count open: every object", [&]()
+	{
+		size_t open = 0;
+		for (const auto& ticket : tickets)
+			open += ticket.IsOpen();
+		return open;
+	});
+	Time("count open: flag column", [&]()
+	{
+		size_t open = 0;
+		for (const auto flag : store.OpenFlags())
+			open += flag;
+		return open;
+	});
+	Time("count open: bitmap", [&]() { return store.CountOpen(); });
+
+	Time("open in filter: objects by number", [&]()
+	{
+		size_t open = 0;
+		for (const auto ticketNumber : filter)
+			open += tickets[ticketNumber - 1].IsOpen();
+		return open;
+	});
+	Time("open in filter: bitmap AndCount", [&]() { return store.CountOpen(filterBitmap); });
+	Time("open in filter: bitmap & (materialized)", [&]() { return (store.OpenTickets() & filterBitmap).Count(); });
+
+	// batch close the filtered tickets once each way
+	BenchSupport::Stopwatch timer;
+	size_t closed = 0; // tickets that were open
+	for (const auto ticketNumber : filter)
+	{
+		auto& ticket = tickets[ticketNumber - 1];
+		closed += ticket.IsOpen();
+		ticket.CloseTicket();
+	}
+	cout << left << setw(40) << "batch close: objects" << right << setw(12) << timer.Seconds() * 1e6 << " us" << setw(12) << closed << endl;
+	timer.Restart();
+	closed = store.Close(filterBitmap);
+	cout << left << setw(40) << "batch close: store" << right << setw(12) << timer.Seconds() * 1e6 << " us" << setw(12) << closed << endl;
+	return 0;
+}
@@ -0,0 +1,175 @@
+/** RegistryBench.cpp - Concurrent Registry Scalability Benchmark
+ *
+ *	Runs a 90/10 read/write mix on 1, 2, 4, ... 32 threads against a
+ *	TicketRegistry and, for comparison, against a map of ExtendedWorkTickets
+ *	guarded by one shared_mutex, and reports the operations per second and
+ *	the speedup over one thread for each:
+ *
+ *		RegistryBench [count] [seconds]		count tickets (default 1,000,000),
+ *											seconds per run (default 0.5)
+ *
+ *	Reads look up a random ticket. Writes are split evenly between
+ *	SetWorkTicket() on a random ticket and Close(). Speedup past the number
+ *	of cores only shows that adding threads does not make things worse.
+ *
+ *	@version	2020.09
+ *	@see		TicketRegistry.h
+*/
+
+#include <atomic>			// for the stop flag
+#include <cstdlib>			// for strtoull and strtod
+#include <iomanip>			// for setw
+#include <iostream>			// for cout
+#include <mutex>			// for unique_lock
+#include <random>			// for minstd_rand
+#include <shared_mutex>		// for shared_mutex
+#include <string>			// for string
+#include <thread>			// for thread
+#include <unordered_map>	// for the locked baseline
+#include <vector>			// for vector
+#include "BenchSupport.h"
+#include "../TicketRegistry.h"
+
+using namespace std;
+
+/** LockedTickets
+ *	What sharing tickets between threads takes without the registry: one
+ *	map and one lock, shared by readers and exclusive for writers.
+ */
+class LockedTickets
+{
+public:
+	void Insert(const ExtendedWorkTicket& ticket) { myTickets.emplace(ticket.GetTicketNumber(), ticket); }
+
+	bool Find(const int ticket_number, TicketRegistry::TicketView& view) const
+	{
+		shared_lock<shared_mutex> lock(myMutex);
+		const auto found = myTickets.find(ticket_number);
+		if (found == myTickets.end())
+			return false;
+		view.ticketNumber = ticket_number;
+		view.clientHandle = found->second.GetClientHandle();
+		view.date = found->second.GetPackedDate();
+		view.isOpen = found->second.IsOpen();
+		view.description = found->second.GetDescriptionView(); // only valid under the lock; the benchmark just checks its size
+		return true;
+	}
+
+	bool SetWorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
+	{
+		unique_lock<shared_mutex> lock(myMutex);
+		const auto found = myTickets.find(ticket_number);
+		return found != myTickets.end() && found->second.SetWorkTicket(ticket_number, client_id, day, month, year, description);
+	}
+
+	bool Close(const int ticket_number)
+	{
+		unique_lock<shared_mutex> lock(myMutex);
+		const auto found = myTickets.find(ticket_number);
+		if (found == myTickets.end())
+			return false;
+		found->second.CloseTicket();
+		return true;
+	}
+
+private:
+	unordered_map<int, ExtendedWorkTicket> myTickets;	// by ticket number
+	mutable shared_mutex myMutex;						// guards myTickets
+};
+
+/** Run()
+ *	Runs the mix on a number of threads for a number of seconds.
+ *	@return (double) - operations per second, across all threads
+ */
+template <typename Tickets>
+static double Run(Tickets& tickets, const unsigned threads, const size_t count, const double seconds, const vector<string>& clients)
+{
+	atomic<bool> stop{ false };		// set when time is up
+	atomic<size_t> operations{ 0 };	// done by every thread
+	atomic<size_t> checksum{ 0 };	// what the reads saw, so they are not optimized away
+	vector<thread> workers;
+
+	BenchSupport::Stopwatch timer;
+	for (unsigned t = 0; t < threads; t++)
+	{
+		workers.emplace_back([&, t]()
+		{
+			minstd_rand random(2020 + t);
+			size_t done = 0;	// operations by this thread
+			size_t sum = 0;		// description lengths read
+			TicketRegistry::TicketView view;
+			while (!stop.load(memory_order_relaxed))
+			{
+				// a batch between looks at the clock
+				for (int i = 0; i < 256; i++)
+				{
+					const auto draw = random();
+					const auto ticketNumber = static_cast<int>(draw % count + 1);
+					if (draw % 10 != 0)
+					{
+						if (tickets.Find(ticketNumber, view))
+							sum += view.description.size();
+					}
+					else if (draw % 20 == 0)
+					{
+						tickets.SetWorkTicket(ticketNumber, clients[draw % clients.size()], 1 + draw % 28, 1 + draw % 12, 2020, "Updated by a worker thread");
+					}
+					else
+					{
+						tickets.Close(ticketNumber);
+					}
+				}
+				done += 256;
+			}
+			operations.fetch_add(done);
+			checksum.fetch_add(sum);
+		});
+	}
+
+	this_thread::sleep_for(chrono::duration<double>(seconds));
+	stop.store(true);
+	for (auto& worker : workers)
+		worker.join();
+	const auto elapsed = timer.Seconds();
+	return operations.load() / elapsed;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+	const auto seconds = argc > 2 ? strtod(argv[2], nullptr) : 0.5;
+
+	vector<string> clients;
+	for (size_t i = 0; i < 5000; i++)
+		clients.push_back("CLIENT-" + to_string(i));
+
+	TicketRegistry registry;
+	LockedTickets locked;
+	for (size_t i = 1; i <= count; i++)
+	{
+		const ExtendedWorkTicket ticket(static_cast<int>(i), clients[i % clients.size()], 1 + i % 28, 1 + i % 12, 2000 + i % 100,
+			"Printer on floor " + to_string(i % 40) + " will not print", true);
+		registry.Insert(ticket);
+		locked.Insert(ticket);
+	}
+
+	cout << count << " tickets, " << registry.ShardCount() << " shards, " << thread::hardware_concurrency() << " cores; 90% reads, 10% writes" << endl << endl;
+	cout << setw(8) << "threads" << setw(16) << "registry op/s" << setw(10) << "speedup" << setw(16) << "locked op/s" << setw(10) << "speedup" << endl;
+
+	double registryBase = 0;	// one thread, registry
+	double lockedBase = 0;		// one thread, locked map
+	for (unsigned threads = 1; threads <= 32; threads *= 2)
+	{
+		const auto registryRate = Run(registry, threads, count, seconds, clients);
+		const auto lockedRate = Run(locked, threads, count, seconds, clients);
+		if (threads == 1)
+		{
+			registryBase = registryRate;
+			lockedBase = lockedRate;
+		}
+		cout << setw(8) << threads << fixed << setprecision(0) << setw(16) << registryRate << setprecision(2) << setw(10) << registryRate / registryBase
+			<< setprecision(0) << setw(16) << lockedRate << setprecision(2) << setw(10) << lockedRate / lockedBase << endl;
+	}
+	cout << endl << "peak RSS " << BenchSupport::PeakRssKb() / 1024 << " MB" << endl;
+	return 0;
+}
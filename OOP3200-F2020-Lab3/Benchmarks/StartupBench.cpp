@@ -0,0 +1,139 @@
+/** StartupBench.cpp - Snapshot and Log Tail Startup Benchmark
+ *
+ *	Builds a store of synthetic tickets with a TicketLog of every change,
+ *	snapshots it in the background while more changes are made, and then
+ *	times the two ways to start up again:
+ *
+ *		StartupBench [count] [tail] [directory]		count tickets (default 10,000,000),
+ *													tail changes after the snapshot (default 100,000),
+ *													scratch directory (default StartupBench, deleted afterwards)
+ *
+ *		replay log		replay every record of the log into an empty store,
+ *						keeping every index up to date, as startup works without snapshots
+ *		snapshot + tail	TicketSnapshots::Recover(): load the newest snapshot
+ *						and replay only the records after it, then open the
+ *						log for writing without reading it again
+ *
+ *	The date and text indexes are rebuilt the first time they are used after
+ *	a snapshot is loaded, so those rebuilds are timed on their own.
+ *
+ *	@version	2020.09
+ *	@see		TicketSnapshots.h
+*/
+
+#include <cstdlib>		// for strtoull
+#include <filesystem>	// for remove_all
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <string>		// for string
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../TicketSnapshots.h"
+
+using namespace std;
+
+/** Report()
+ *	Prints one timed step.
+ */
+static void Report(const char* step, const double seconds, const string& note = string())
+{
+	cout << left << setw(28) << step << right << fixed << setprecision(3) << setw(10) << seconds << " s  " << note << endl;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+	const auto tail = argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000;
+	const string directory = argc > 3 ? argv[3] : "StartupBench";
+	const auto logPath = (filesystem::path(directory) / "tickets.log").string();
+
+	filesystem::remove_all(directory);
+	vector<string> clients;
+	for (size_t i = 0; i < 5000; i++)
+		clients.push_back("CLIENT-" + to_string(i));
+
+	cout << count << " tickets, " << tail << " changes after the snapshot" << endl << endl;
+	{
+		TicketSnapshots snapshots(directory);
+		TicketLog::Options options;
+		options.durability = TicketLog::Durability::Buffered; // the setup is not what is being timed
+		TicketLog log(logPath, options);
+		WorkTicketStore store;
+		store.DeferIndexes();
+		store.Reserve(count, count * 40);
+
+		const auto change = [&](const size_t i)
+		{
+			const auto ticketNumber = static_cast<int>(i % count + 1);
+			if (i < count)
+			{
+				const PackedDate date(1 + i % 28, 1 + i % 12, 2000 + i % 100);
+				const auto description = "Printer on floor " + to_string(i % 40) + " will not print";
+				log.Insert(ticketNumber, clients[i % clients.size()], date, description, true);
+				store.Insert(ticketNumber, clients[i % clients.size()], date, description, true);
+			}
+			else if (i % 2 == 0)
+			{
+				log.Close(ticketNumber);
+				store.Close(ticketNumber);
+			}
+			else
+			{
+				log.SetDescription(ticketNumber, "Toner replaced; printing again");
+				store.SetDescription(ticketNumber, "Toner replaced; printing again");
+			}
+		};
+
+		BenchSupport::Stopwatch timer;
+		for (size_t i = 0; i < count; i++)
+			change(i);
+		Report("build store and log", timer.Seconds());
+
+		// the snapshot is written while the tail is changed
+		timer.Restart();
+		snapshots.WriteInBackground(store, log);
+		Report("snapshot pause", timer.Seconds(), "(changes held off while the columns are copied)");
+		for (size_t i = count; i < count + tail; i++)
+			change(i);
+		snapshots.Wait();
+		Report("snapshot written", timer.Seconds(), "(in the background, " + to_string(tail) + " changes made meanwhile)");
+		log.Flush();
+	}
+	cout << endl;
+
+	// without snapshots: the whole log
+	{
+		WorkTicketStore store;
+		BenchSupport::Stopwatch timer;
+		const auto result = TicketLog::Replay(logPath, store, 0);
+		Report("replay log", timer.Seconds(), to_string(result.replayed) + " records, " + to_string(store.Size()) + " tickets");
+	}
+
+	// with them: the newest snapshot and the tail
+	{
+		WorkTicketStore store;
+		TicketSnapshots snapshots(directory);
+		BenchSupport::Stopwatch timer;
+		const auto recovery = snapshots.Recover(store, logPath);
+		Report("snapshot + tail", timer.Seconds(), to_string(recovery.snapshotTickets) + " tickets loaded, "
+			+ to_string(recovery.log.replayed) + " of " + to_string(recovery.log.records) + " records replayed");
+
+		// opening the log again reads nothing the recovery already checked
+		TicketLog::Options options;
+		options.first_lsn = recovery.NextLsn();
+		options.scan_from = recovery.log.validBytes;
+		TicketLog log(logPath, options);
+		Report("  + reopen log", timer.Seconds(), "(ready for changes)");
+
+		timer.Restart();
+		const auto dated = store.CountByDate(PackedDate(1, 1, 2000), PackedDate(31, 12, 2099));
+		Report("  first date query", timer.Seconds(), "(rebuilds the date index; " + to_string(dated) + " tickets)");
+		timer.Restart();
+		const auto printers = store.TextIndex().MatchAll("printer").size();
+		Report("  first text search", timer.Seconds(), "(rebuilds the text index; " + to_string(printers) + " tickets)");
+	}
+
+	cout << endl << "peak RSS " << BenchSupport::PeakRssKb() / 1024 << " MB" << endl;
+	filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,152 @@
+/** TextSearchBench.cpp - Description Search Benchmark
+ *
+ *	Fills a WorkTicketStore with synthetic tickets and times searches of
+ *	their descriptions through the TicketTextIndex against a linear
+ *	substring scan of every description:
+ *
+ *		TextSearchBench [count]		count tickets (default 10,000,000)
+ *
+ *	Descriptions are six to ten words drawn from a Zipf-distributed
+ *	vocabulary of 20,000 words, led by common English and support words,
+ *	and one in two hundred contains "password reset". Some searches match a
+ *	handful of tickets and some match a fifth of them.
+ *
+ *	@version	2020.09
+ *	@see		TicketTextIndex.h
+*/
+
+#include <algorithm>	// for upper_bound
+#include <cstdlib>		// for strtoull
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <random>		// for mt19937
+#include <string>		// for string
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../WorkTicketStore.h"
+
+using namespace std;
+
+/** Query
+ *	One search to time.
+ */
+struct Query
+{
+	const char* kind;	// "all", "any" or "phrase"
+	const char* text;	// the words
+};
+
+/** Vocabulary
+ *	Words ranked by frequency, and a Zipf sampler over them.
+ */
+class Vocabulary
+{
+public:
+	Vocabulary()
+	{
+		myWords = { "the", "not", "is", "in", "on", "will", "after", "cannot", "printer", "user", "email", "screen",
+			"network", "laptop", "slow", "error", "password", "reset", "outlook", "vpn", "login", "print", "toner",
+			"blank", "keyboard", "battery", "update", "crashes", "jammed", "missing", "floor", "low" };
+		while (myWords.size() < 20000)
+			myWords.push_back("part" + to_string(myWords.size()));
+
+		// the chance of rank r is proportional to 1 / (r + 1)
+		double total = 0;
+		for (size_t rank = 0; rank < myWords.size(); rank++)
+			myCumulative.push_back(total += 1.0 / (rank + 1));
+	}
+
+	const string& Sample(mt19937& random) const
+	{
+		const auto point = uniform_real_distribution<double>(0, myCumulative.back())(random);
+		const auto rank = upper_bound(myCumulative.begin(), myCumulative.end(), point) - myCumulative.begin();
+		return myWords[min(static_cast<size_t>(rank), myWords.size() - 1)];
+	}
+
+private:
+	vector<string> myWords;			// by rank
+	vector<double> myCumulative;	// running total of the weights
+};
+
+/** MakeDescription()
+ *	Builds one synthetic description.
+ */
+static string MakeDescription(const Vocabulary& vocabulary, mt19937& random)
+{
+	string description; // the words, separated by spaces
+	const auto length = 6 + random() % 5;
+	for (unsigned i = 0; i < length; i++)
+	{
+		if (!description.empty())
+			description += ' ';
+		description += vocabulary.Sample(random);
+	}
+	if (random() % 200 == 0)
+		description += " password reset";
+	return description;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+
+	// build the store, indexing as it goes
+	WorkTicketStore store;
+	const Vocabulary vocabulary;
+	mt19937 random(2020);
+	BenchSupport::Stopwatch timer;
+	store.Reserve(count, count * 48);
+	for (size_t i = 1; i <= count; i++)
+		store.Insert(static_cast<int>(i), "CLIENT-" + to_string(i % 5000), PackedDate(1 + i % 28, 1 + i % 12, 2000 + i % 100), MakeDescription(vocabulary, random), true);
+	cout << count << " tickets loaded in " << fixed << setprecision(2) << timer.Seconds() << " s; index "
+		<< store.TextIndex().WordCount() << " words, " << store.TextIndex().PostingBytes() / (1024 * 1024) << " MB of postings; peak RSS "
+		<< BenchSupport::PeakRssKb() / 1024 << " MB" << endl << endl;
+
+	const Query queries[] = {
+		{ "phrase", "password reset" },
+		{ "phrase", "printer will not print" },
+		{ "phrase", "printer is slow" },
+		{ "all", "part12345 printer" },
+		{ "all", "toner jammed" },
+		{ "all", "vpn slow network" },
+		{ "all", "the not" },
+		{ "any", "part777 part7777" },
+		{ "any", "outlook keyboard" },
+	};
+
+	cout << left << setw(8) << "kind" << setw(24) << "words" << right << setw(10) << "matches" << setw(12) << "index us"
+		<< setw(12) << "scan us" << setw(12) << "scan hits" << endl;
+	for (const auto& query : queries)
+	{
+		const auto& index = store.TextIndex();
+		const auto kind = string(query.kind);
+		const auto search = [&]()
+		{
+			return kind == "all" ? index.MatchAll(query.text) : kind == "any" ? index.MatchAny(query.text) : index.MatchPhrase(query.text);
+		};
+
+		// repeat the search for at least a tenth of a second
+		size_t matches = 0;	// tickets found
+		size_t runs = 0;	// searches made
+		timer.Restart();
+		do
+		{
+			matches = search().size();
+			runs++;
+		} while (timer.Seconds() < 0.1);
+		const auto indexSeconds = timer.Seconds() / runs;
+
+		// today's search: a substring scan of every description, for the phrase or,
+		// as a lower bound for the other kinds, just the first word
+		timer.Restart();
+		size_t scanned = 0; // descriptions containing it
+		const auto needle = kind == "phrase" ? string(query.text) : string(query.text).substr(0, string(query.text).find(' '));
+		for (WorkTicketStore::Row row = 0; row < store.Size(); row++)
+			scanned += store.GetDescription(row).find(needle) != string_view::npos;
+		const auto scanSeconds = timer.Seconds();
+
+		cout << left << setw(8) << query.kind << setw(24) << query.text << right << setw(10) << matches
+			<< setw(12) << setprecision(1) << indexSeconds * 1e6 << setw(12) << setprecision(0) << scanSeconds * 1e6 << setw(12) << scanned << endl;
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+/** ValidationBench.cpp - Throwing vs Non-Throwing Validation Benchmark
+ *
+ *	Validates the same dirty input, half of it invalid, through the throwing
+ *	API (SetTicketNumber and SetDate inside try/catch) and through the
+ *	non-throwing one (WorkTicket::Validate and WorkTicket::TryMake), and
+ *	reports ns/op and allocs/op for each:
+ *
+ *		ValidationBench [count]		count inputs (default 1,000,000)
+ *
+ *	@version	2020.09
+ *	@see		ValidationError.h
+*/
+
+#include <cstdlib>		// for strtoull
+#include <iomanip>		// for setw
+#include <iostream>		// for cout
+#include <string>		// for string
+#include <vector>		// for vector
+#include "BenchSupport.h"
+#include "../WorkTicket.h"
+
+using namespace std;
+
+/** Input
+ *	One set of ticket fields to validate.
+ */
+struct Input
+{
+	int ticketNumber;
+	int day;
+	int month;
+	int year;
+};
+
+/** MakeInputs()
+ *	Builds count inputs; every second one is invalid in one of four ways.
+ */
+static vector<Input> MakeInputs(const size_t count)
+{
+	vector<Input> inputs; // the inputs
+	inputs.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		Input input{ static_cast<int>(i + 1), static_cast<int>(1 + i % 28), static_cast<int>(1 + i % 12), static_cast<int>(2000 + i % 100) };
+		if (i % 2 == 1)
+		{
+			switch (i / 2 % 4)
+			{
+			case 0: input.ticketNumber = -1; break;
+			case 1: input.year = 2150; break;
+			case 2: input.month = 13; break;
+			default: input.day = 31; input.month = 2; break;
+			}
+		}
+		inputs.push_back(input);
+	}
+	return inputs;
+}
+
+/** Report()
+ *	Prints one result line.
+ */
+static void Report(const char* name, const size_t count, const size_t valid, const double seconds, const size_t allocations)
+{
+	cout << left << setw(10) << name << right << fixed << setprecision(1)
+		<< setw(10) << seconds * 1e9 / count << " ns/op"
+		<< setw(10) << setprecision(2) << static_cast<double>(allocations) / count << " allocs/op"
+		<< setw(10) << valid << " valid" << endl;
+}
+
+int main(const int argc, char* argv[])
+{
+	const auto count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+	const auto inputs = MakeInputs(count);
+
+	// the throwing API
+	{
+		size_t valid = 0; // inputs that passed
+		const auto allocations = BenchSupport::allocations.load();
+		BenchSupport::Stopwatch timer;
+		for (const auto& input : inputs)
+		{
+			try
+			{
+				WorkTicket ticket;
+				ticket.SetTicketNumber(input.ticketNumber);
+				ticket.SetDate(input.day, input.month, input.year);
+				valid++;
+			}
+			catch (const exception&)
+			{
+			}
+		}
+		Report("throwing", count, valid, timer.Seconds(), BenchSupport::allocations.load() - allocations);
+	}
+
+	// Validate() only checks the fields
+	{
+		size_t valid = 0; // inputs that passed
+		const auto allocations = BenchSupport::allocations.load();
+		BenchSupport::Stopwatch timer;
+		for (const auto& input : inputs)
+		{
+			if (WorkTicket::Validate(input.ticketNumber, "CLIENT", input.day, input.month, input.year, "Printer").Ok())
+				valid++;
+		}
+		Report("Validate", count, valid, timer.Seconds(), BenchSupport::allocations.load() - allocations);
+	}
+
+	// TryMake() also builds the valid tickets
+	{
+		size_t valid = 0; // inputs that passed
+		const auto allocations = BenchSupport::allocations.load();
+		BenchSupport::Stopwatch timer;
+		for (const auto& input : inputs)
+		{
+			if (const auto ticket = WorkTicket::TryMake(input.ticketNumber, "CLIENT", input.day, input.month, input.year, "Printer"))
+				valid++;
+		}
+		Report("TryMake", count, valid, timer.Seconds(), BenchSupport::allocations.load() - allocations);
+	}
+
+	return 0;
+}
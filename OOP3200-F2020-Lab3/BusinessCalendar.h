@@ -0,0 +1,209 @@
+/** BusinessCalendar.h - Business Day Calendar
+ *
+ *	The BusinessCalendar class does business day arithmetic for SLA due
+ *	dates over the 2000-2099 window WorkTicket::SetDate() allows. It is built
+ *	once from the weekend days and a set of holidays, and keeps two tables
+ *	over the window's 36,525 days:
+ *
+ *		- for every day, the number of business days before it (a prefix
+ *		  count), so "business days between" is one subtraction;
+ *		- every business day in order, so "add N business days" is the
+ *		  business day N places after the date's prefix count.
+ *
+ *	Both are O(1) and never step through the days between, where stepping
+ *	MyDate::operator++ and checking GetDayOfWeek() and a holiday list costs a
+ *	day number round trip, a string and a search per day. The tables are two
+ *	bytes an entry, about 125 KB together.
+ *
+ *	Dates and results outside 1/1/2000 - 31/12/2099 throw out_of_range.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+ *	@see		WorkTicket.h
+*/
+
+#pragma once
+#ifndef _BUSINESS_CALENDAR_H
+
+#define _BUSINESS_CALENDAR_H
+
+#include <cstddef>		// for size_t
+#include <cstdint>		// for fixed width integers
+#include <stdexcept>	// for out_of_range
+#include <vector>		// for the tables
+#include "MyDate.h"
+#include "PackedDate.h"
+
+using namespace std;
+
+class BusinessCalendar
+{
+public:
+	static constexpr int first_year = 2000;	// the years WorkTicket::SetDate() allows
+	static constexpr int last_year = 2099;
+
+	/** Weekday
+	 *	The days of the week, in the order of MyDate::GetDayOfWeek(): a day
+	 *	number modulo 7 is its Weekday.
+	 */
+	enum class Weekday : uint8_t
+	{
+		Sunday,
+		Monday,
+		Tuesday,
+		Wednesday,
+		Thursday,
+		Friday,
+		Saturday
+	};
+
+	/** Parameterized Constructor
+	 *	Builds the tables. Holidays on a weekend day, and the same holiday
+	 *	twice, make no difference.
+	 *	@param holidays (vector<MyDate>) - dates that are not business days
+	 *	@param weekend (vector<Weekday>) - days of the week that are not business days
+	 *	@throws (out_of_range) if a holiday is outside 2000-2099
+	 */
+	explicit BusinessCalendar(const vector<MyDate>& holidays = vector<MyDate>(),
+		const vector<Weekday>& weekend = { Weekday::Saturday, Weekday::Sunday });
+
+	/***************************************************************************
+	*	QUERIES
+	*	Each has a MyDate form, for e.g. WorkTicket::GetDate(), and a
+	*	PackedDate form, for e.g. WorkTicket::GetPackedDate() and the columns
+	*	of a WorkTicketStore, which skips the day number conversion.
+	***************************************************************************/
+
+	/** IsBusinessDay()
+	 *	@return (bool) - false on a weekend day or holiday
+	 *	@throws (out_of_range) if the date is outside 2000-2099
+	 */
+	bool IsBusinessDay(const MyDate& date) const { return IsBusinessDay(PackedDate(date)); }
+	bool IsBusinessDay(PackedDate date) const;
+
+	/** AddBusinessDays()
+	 *	The business day a number of business days after (or before) a date,
+	 *	e.g. a Friday plus 1 is the next Monday, and so is a Saturday plus 1.
+	 *	@param date (MyDate or PackedDate) - the date to count from; need not be a business day
+	 *	@param business_days (int) - how many business days on, or back if negative; 0 returns date
+	 *	@return (MyDate or PackedDate) - the business day reached
+	 *	@throws (out_of_range) if the date or the result is outside 2000-2099
+	 */
+	MyDate AddBusinessDays(const MyDate& date, const int business_days) const
+	{
+		return MyDate(static_cast<long>(AddBusinessDays(PackedDate(date), business_days).DayNumber()));
+	}
+	PackedDate AddBusinessDays(PackedDate date, int business_days) const;
+
+	/** BusinessDaysBetween()
+	 *	The business days after from, up to and including to; negative, the
+	 *	business days from to up to but not including from, if to is earlier.
+	 *	AddBusinessDays(from, BusinessDaysBetween(from, to)) is to whenever to
+	 *	is a business day.
+	 *	@return (int) - the signed number of business days
+	 *	@throws (out_of_range) if either date is outside 2000-2099
+	 */
+	int BusinessDaysBetween(const MyDate& from, const MyDate& to) const
+	{
+		return BusinessDaysBetween(PackedDate(from), PackedDate(to));
+	}
+	int BusinessDaysBetween(PackedDate from, PackedDate to) const;
+
+	/** BusinessDayCount()
+	 *	@return (size_t) - the business days in the whole window
+	 */
+	size_t BusinessDayCount() const { return myBusinessDays.size(); }
+
+private:
+	static constexpr long window_start = MyDate::DayNumber(1, 1, first_year);	// day number of the first day
+	static constexpr long window_days = MyDate::DayNumber(1, 1, last_year + 1) - window_start; // 36,525
+	static_assert(window_days < 65536, "the tables hold window offsets in 16 bits");
+
+	/** Offset()
+	 *	A date's position in the window.
+	 *	@throws (out_of_range) if the date is outside it
+	 */
+	static long Offset(PackedDate date);
+
+	vector<uint16_t> myBusinessBefore;	// for each day, and one past the last, the business days before it
+	vector<uint16_t> myBusinessDays;	// the offset of every business day, in order
+};
+
+/***************************************************************************
+ *	CONSTRUCTOR DEFINITIONS
+ ***************************************************************************/
+
+ // BusinessCalendar::Parameterized Constructor
+BusinessCalendar::BusinessCalendar(const vector<MyDate>& holidays, const vector<Weekday>& weekend)
+{
+	vector<bool> closed(window_days, false); // weekend days and holidays
+	bool weekendDays[7] = {};				// by Weekday
+	for (const auto day : weekend)
+		weekendDays[static_cast<int>(day)] = true;
+	for (long offset = 0; offset < window_days; offset++)
+		closed[offset] = weekendDays[(window_start + offset) % 7];
+	for (const auto& holiday : holidays)
+		closed[Offset(PackedDate(holiday))] = true;
+
+	myBusinessBefore.resize(window_days + 1);
+	myBusinessDays.reserve(window_days);
+	for (long offset = 0; offset < window_days; offset++)
+	{
+		myBusinessBefore[offset] = static_cast<uint16_t>(myBusinessDays.size());
+		if (!closed[offset])
+			myBusinessDays.push_back(static_cast<uint16_t>(offset));
+	}
+	myBusinessBefore[window_days] = static_cast<uint16_t>(myBusinessDays.size());
+}
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // BusinessCalendar::IsBusinessDay
+bool BusinessCalendar::IsBusinessDay(const PackedDate date) const
+{
+	const auto offset = Offset(date);
+	return myBusinessBefore[offset + 1] != myBusinessBefore[offset];
+}
+
+// BusinessCalendar::AddBusinessDays
+PackedDate BusinessCalendar::AddBusinessDays(const PackedDate date, const int business_days) const
+{
+	const auto offset = Offset(date);
+	if (business_days == 0)
+		return date;
+
+	// forward: the business days up to and including date come first; back: those before it
+	const long index = business_days > 0
+		? static_cast<long>(myBusinessBefore[offset + 1]) + business_days - 1
+		: static_cast<long>(myBusinessBefore[offset]) + business_days;
+	if (index < 0 || index >= static_cast<long>(myBusinessDays.size()))
+		throw out_of_range("The result must be between 01/01/2000 and 31/12/2099. ");
+	return PackedDate(window_start + myBusinessDays[index]);
+}
+
+// BusinessCalendar::BusinessDaysBetween
+int BusinessCalendar::BusinessDaysBetween(const PackedDate from, const PackedDate to) const
+{
+	const auto fromOffset = Offset(from);
+	const auto toOffset = Offset(to);
+	if (toOffset >= fromOffset) // (from, to]
+		return static_cast<int>(myBusinessBefore[toOffset + 1]) - myBusinessBefore[fromOffset + 1];
+	return static_cast<int>(myBusinessBefore[toOffset]) - myBusinessBefore[fromOffset]; // minus [to, from)
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // BusinessCalendar::Offset
+long BusinessCalendar::Offset(const PackedDate date)
+{
+	const long offset = date.DayNumber() - window_start;
+	if (offset < 0 || offset >= window_days)
+		throw out_of_range("Date must be between 01/01/2000 and 31/12/2099. ");
+	return offset;
+}
+
+#endif
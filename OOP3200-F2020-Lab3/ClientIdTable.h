@@ -0,0 +1,272 @@
+/** ClientIdTable.h - Client ID Symbol Table
+ *
+ *	The ClientIdTable class interns client IDs: each distinct ID is stored
+ *	once and identified by a 32 bit handle. WorkTicket keeps only the handle,
+ *	so millions of tickets for a few thousand clients share a few thousand
+ *	strings, and comparing or grouping tickets by client compares integers.
+ *
+ *	Interned text never moves or is freed, so the string_views handed out
+ *	stay valid for the life of the program. Looking up the text of a handle,
+ *	and the handle of an ID already interned, takes no lock: the text to
+ *	handle index is an open addressing table of atomic slots that only the
+ *	thread holding the mutex adds to. Only interning a new ID takes the
+ *	mutex, so writers interning the same few thousand IDs do not queue on it.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+*/
+
+#pragma once
+#ifndef _CLIENT_ID_TABLE_H
+
+#define _CLIENT_ID_TABLE_H
+
+#include <atomic>			// for the segment pointers and index slots
+#include <cstdint>			// for uint32_t
+#include <cstring>			// for memcpy
+#include <memory>			// for unique_ptr
+#include <mutex>			// for mutex
+#include <stdexcept>		// for length_error
+#include <string_view>		// for string_view and its hash
+#include <vector>			// for the character chunks and index tables
+
+using namespace std;
+
+class ClientIdTable
+{
+public:
+	static constexpr uint32_t empty_handle = 0;			// the handle of "", interned up front
+	static constexpr uint32_t no_handle = UINT32_MAX;	// returned by Find() for an unknown ID
+
+	/** Shared()
+	 *	The table used by every WorkTicket and WorkTicketStore.
+	 *	@return (ClientIdTable by ref) - the shared table
+	 */
+	static ClientIdTable& Shared()
+	{
+		static ClientIdTable table;
+		return table;
+	}
+
+	/** Default Constructor
+	 *	Creates a table holding only the empty ID.
+	 */
+	ClientIdTable() { Intern(string_view()); }
+
+	ClientIdTable(const ClientIdTable&) = delete;
+	ClientIdTable& operator=(const ClientIdTable&) = delete;
+
+	~ClientIdTable();
+
+	/** Intern()
+	 *	Returns the handle of a client ID, adding it if it is new. Takes no
+	 *	lock unless it is new.
+	 *	@param client_id (string_view) - the client ID
+	 *	@return (uint32_t) - its handle
+	 *	@throws (length_error) if the table is full
+	 */
+	uint32_t Intern(string_view client_id);
+
+	/** Find()
+	 *	Returns the handle of a client ID without adding it or locking.
+	 *	@return (uint32_t) - its handle, or no_handle if it was never interned
+	 */
+	uint32_t Find(string_view client_id) const;
+
+	/** View()
+	 *	Returns the text of a handle without copying or locking.
+	 *	@param handle (uint32_t) - a handle returned by Intern()
+	 *	@return (string_view) - the client ID; valid for the life of the table
+	 */
+	string_view View(const uint32_t handle) const
+	{
+		return mySegments[handle >> segment_bits].load(memory_order_acquire)[handle & (segment_size - 1)];
+	}
+
+	/** Size()
+	 *	Returns the number of distinct client IDs, including the empty one.
+	 */
+	uint32_t Size() const { return mySize.load(memory_order_acquire); }
+
+private:
+	static constexpr uint32_t segment_bits = 12;					// 4096 handles per segment
+	static constexpr uint32_t segment_size = 1u << segment_bits;
+	static constexpr uint32_t max_segments = 4096;					// 16M handles in all
+	static constexpr size_t chunk_size = 64 * 1024;					// bytes per character chunk
+	static constexpr uint32_t initial_index_size = 1024;			// index slots to start with
+
+	/** IndexTable
+	 *	The text to handle index: open addressing with linear probing. A slot
+	 *	holds 0 while empty, then the ID's hash in its high 32 bits and its
+	 *	handle + 1 in the low 32 bits, and never changes again. A table is
+	 *	kept at most half full; a fuller one is replaced by one twice the
+	 *	size, and the old one is kept, since readers may still be probing it.
+	 */
+	struct IndexTable
+	{
+		explicit IndexTable(const uint32_t size) : mask(size - 1), slots(new atomic<uint64_t>[size]()) {}
+
+		uint32_t mask;							// slot count - 1; the slot count is a power of 2
+		unique_ptr<atomic<uint64_t>[]> slots;	// value-initialized, so empty
+	};
+
+	/** Hash()
+	 *	The hash of a client ID.
+	 */
+	static uint64_t Hash(const string_view client_id) { return static_cast<uint64_t>(hash<string_view>()(client_id)); }
+
+	/** Lookup()
+	 *	Probes an index table for a client ID without locking.
+	 *	@return (uint32_t) - its handle, or no_handle if it is not in the table
+	 */
+	uint32_t Lookup(const IndexTable& table, string_view client_id, uint64_t hash) const;
+
+	/** AddToIndex()
+	 *	Adds a handle to the current index table, first growing it if it would
+	 *	be more than half full. Called with the mutex held.
+	 */
+	void AddToIndex(uint32_t handle, uint64_t hash);
+
+	/** StoreText()
+	 *	Copies text into the character chunks, where it never moves.
+	 */
+	string_view StoreText(string_view text);
+
+	atomic<string_view*> mySegments[max_segments] = {};	// handle to text, allocated a segment at a time
+	atomic<uint32_t> mySize{ 0 };						// handles issued
+	vector<unique_ptr<char[]>> myChunks;				// interned characters
+	char* myChunk = nullptr;							// the chunk being filled
+	size_t myChunkUsed = chunk_size;					// bytes used in that chunk
+	atomic<const IndexTable*> myIndex{ nullptr };		// the current text to handle index
+	vector<unique_ptr<IndexTable>> myIndexTables;		// every index table there has been; the last is current
+	mutable mutex myMutex;								// guards everything but the segment and index reads
+};
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // ClientIdTable::Destructor
+ClientIdTable::~ClientIdTable()
+{
+	for (auto& segment : mySegments)
+		delete[] segment.load(memory_order_relaxed);
+}
+
+// ClientIdTable::Intern
+uint32_t ClientIdTable::Intern(const string_view client_id)
+{
+	// an ID already interned is found without locking
+	const auto hash = Hash(client_id);
+	const auto index = myIndex.load(memory_order_acquire);
+	if (index != nullptr)
+	{
+		const auto found = Lookup(*index, client_id, hash);
+		if (found != no_handle)
+			return found;
+	}
+
+	lock_guard<mutex> lock(myMutex);
+
+	// another thread may have added it since, or the table read above may have been replaced
+	if (myIndex.load(memory_order_relaxed) != nullptr)
+	{
+		const auto found = Lookup(*myIndex.load(memory_order_relaxed), client_id, hash);
+		if (found != no_handle)
+			return found;
+	}
+
+	const auto handle = mySize.load(memory_order_relaxed); // the new handle
+	if (handle >= segment_size * max_segments)
+		throw length_error("Too many client IDs. ");
+
+	// publish a new segment before any handle in it is returned
+	auto& segment = mySegments[handle >> segment_bits];
+	if (segment.load(memory_order_relaxed) == nullptr)
+		segment.store(new string_view[segment_size], memory_order_release);
+
+	// the text is in place before the index slot that leads readers to it is published
+	segment.load(memory_order_relaxed)[handle & (segment_size - 1)] = StoreText(client_id);
+	AddToIndex(handle, hash);
+	mySize.store(handle + 1, memory_order_release);
+	return handle;
+}
+
+// ClientIdTable::Find
+uint32_t ClientIdTable::Find(const string_view client_id) const
+{
+	const auto index = myIndex.load(memory_order_acquire);
+	return index == nullptr ? no_handle : Lookup(*index, client_id, Hash(client_id));
+}
+
+// ClientIdTable::Lookup
+uint32_t ClientIdTable::Lookup(const IndexTable& table, const string_view client_id, const uint64_t hash) const
+{
+	const auto tag = static_cast<uint32_t>(hash >> 32);
+	for (auto slot = static_cast<uint32_t>(hash) & table.mask;; slot = (slot + 1) & table.mask)
+	{
+		const auto entry = table.slots[slot].load(memory_order_acquire);
+		if (entry == 0)
+			return no_handle;
+
+		const auto handle = static_cast<uint32_t>(entry) - 1;
+		if (static_cast<uint32_t>(entry >> 32) == tag && View(handle) == client_id)
+			return handle;
+	}
+}
+
+// ClientIdTable::AddToIndex
+void ClientIdTable::AddToIndex(const uint32_t handle, const uint64_t hash)
+{
+	const auto insert = [](IndexTable& table, const uint32_t entry_handle, const uint64_t entry_hash)
+	{
+		auto slot = static_cast<uint32_t>(entry_hash) & table.mask;
+		while (table.slots[slot].load(memory_order_relaxed) != 0)
+			slot = (slot + 1) & table.mask;
+		table.slots[slot].store((entry_hash >> 32 << 32) | (entry_handle + 1), memory_order_release);
+	};
+
+	// the first table, or one twice the size holding every handle so far, published whole
+	const auto count = static_cast<uint64_t>(handle) + 1; // handles in the index once this one is added
+	if (myIndexTables.empty() || count * 2 > static_cast<uint64_t>(myIndexTables.back()->mask) + 1)
+	{
+		const auto size = myIndexTables.empty() ? initial_index_size : (myIndexTables.back()->mask + 1) * 2;
+		myIndexTables.push_back(make_unique<IndexTable>(size));
+		for (uint32_t existing = 0; existing < handle; existing++)
+			insert(*myIndexTables.back(), existing, Hash(View(existing)));
+		insert(*myIndexTables.back(), handle, hash);
+		myIndex.store(myIndexTables.back().get(), memory_order_release);
+		return;
+	}
+	insert(*myIndexTables.back(), handle, hash);
+}
+
+// ClientIdTable::StoreText
+string_view ClientIdTable::StoreText(const string_view text)
+{
+	if (text.empty())
+		return string_view();
+
+	// long IDs get a chunk of their own
+	if (text.size() > chunk_size / 4)
+	{
+		myChunks.emplace_back(new char[text.size()]);
+		memcpy(myChunks.back().get(), text.data(), text.size());
+		return string_view(myChunks.back().get(), text.size());
+	}
+
+	// start a new chunk when this one is full; its tail is left unused
+	if (myChunkUsed + text.size() > chunk_size)
+	{
+		myChunks.emplace_back(new char[chunk_size]);
+		myChunk = myChunks.back().get();
+		myChunkUsed = 0;
+	}
+
+	const auto destination = myChunk + myChunkUsed;
+	memcpy(destination, text.data(), text.size());
+	myChunkUsed += text.size();
+	return string_view(destination, text.size());
+}
+
+#endif
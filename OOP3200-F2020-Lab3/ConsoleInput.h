@@ -4,6 +4,7 @@
 #define MY_CONSOLE_INPUT_H
 
 #include <limits> 
+#include <climits>  // for limits of an int INT_MIN and INT_MAX
 #include <cfloat>  // for limits of a double DBL_MIN and DBL_MAX
 
 class ConsoleInput
@@ -0,0 +1,473 @@
+/** DateBatch.h - Batch Date Conversion
+ *
+ *	The DateBatch class converts whole arrays of dates between day numbers and
+ *	day/month/year in one call, instead of one MyDate at a time through
+ *	operator long() and MyDate(long). The dates are held structure-of-arrays
+ *	style: one array of day numbers, or separate year, month and day arrays.
+ *
+ *	Each conversion has a scalar kernel and, on x86, SSE4.2 and AVX2 kernels.
+ *	The best kernel the CPU supports is picked once at run time. Every kernel
+ *	applies the same validation as MyDate::SetYear/SetMonth/SetDay and produces
+ *	identical results.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+*/
+
+#pragma once
+#ifndef _DATE_BATCH_H
+
+#define _DATE_BATCH_H
+
+#include <bitset>		// for counting mask bits
+#include <cstddef>		// for size_t
+#include <cstdint>		// for fixed width integers
+#include <cstring>		// for memcpy
+#include "MyDate.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DATE_BATCH_X86
+#include <immintrin.h>	// for SSE4.2 and AVX2 intrinsics
+#if defined(_MSC_VER)
+#include <intrin.h>		// for __cpuid
+#endif
+#endif
+
+// GCC and Clang need the instruction set enabled per function; MSVC does not
+#if defined(DATE_BATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define DATE_BATCH_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DATE_BATCH_TARGET(isa)
+#endif
+
+using namespace std;
+
+class DateBatch
+{
+public:
+
+	/** Kernel
+	 *	The instruction sets a conversion can be run with.
+	 */
+	enum class Kernel { Scalar, Sse42, Avx2 };
+
+	/** BestKernel()
+	 *	Returns the fastest kernel the CPU supports. Detected once.
+	 *	@return (Kernel) - the kernel used when none is specified
+	 */
+	static Kernel BestKernel();
+
+	/** ToDayNumbers()
+	 *	Converts arrays of years, months and days to day numbers. Entries that
+	 *	are not valid dates are set to day number 0.
+	 *	@param year (const uint16_t*) - the years (1-9999)
+	 *	@param month (const uint8_t*) - the months (1-12)
+	 *	@param day (const uint8_t*) - the days of the month
+	 *	@param days (int32_t*) - stores the days since 1/1/0001
+	 *	@param count (size_t) - the number of dates
+	 *	@param kernel (Kernel) - the kernel to use; defaults to BestKernel()
+	 *	@return (size_t) - the number of invalid dates
+	 */
+	static size_t ToDayNumbers(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, size_t count)
+	{
+		return ToDayNumbers(year, month, day, days, count, BestKernel());
+	}
+	static size_t ToDayNumbers(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, size_t count, Kernel kernel);
+
+	/** FromDayNumbers()
+	 *	Converts an array of day numbers to years, months, days and days of
+	 *	the week. Day numbers outside 1-3652059 are set to all zeros.
+	 *	@param days (const int32_t*) - the days since 1/1/0001
+	 *	@param year (uint16_t*) - stores the years
+	 *	@param month (uint8_t*) - stores the months
+	 *	@param day (uint8_t*) - stores the days of the month
+	 *	@param weekday (uint8_t*) - stores the days of the week, 0 for Sunday
+	 *	                            to 6 for Saturday (may be nullptr)
+	 *	@param count (size_t) - the number of dates
+	 *	@param kernel (Kernel) - the kernel to use; defaults to BestKernel()
+	 *	@return (size_t) - the number of invalid day numbers
+	 */
+	static size_t FromDayNumbers(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, size_t count)
+	{
+		return FromDayNumbers(days, year, month, day, weekday, count, BestKernel());
+	}
+	static size_t FromDayNumbers(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, size_t count, Kernel kernel);
+
+private:
+	static constexpr int32_t last_day = 3652059; // 31 Dec 9999
+
+	/***************************************************************************
+	*	KERNELS
+	*	The vector kernels convert whole blocks and finish any remainder with
+	*	the scalar kernel.
+	***************************************************************************/
+	static size_t ToDayNumbersScalar(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, size_t count);
+	static size_t FromDayNumbersScalar(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, size_t count);
+#ifdef DATE_BATCH_X86
+	static size_t ToDayNumbersSse42(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, size_t count);
+	static size_t ToDayNumbersAvx2(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, size_t count);
+	static size_t FromDayNumbersSse42(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, size_t count);
+	static size_t FromDayNumbersAvx2(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, size_t count);
+#endif
+};
+
+/***************************************************************************
+ *	DISPATCH DEFINITIONS
+ ***************************************************************************/
+
+ // DateBatch::BestKernel
+DateBatch::Kernel DateBatch::BestKernel()
+{
+	static const Kernel best = []
+	{
+		auto kernel = Kernel::Scalar; // always available
+#if defined(DATE_BATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			kernel = Kernel::Avx2;
+		else if (__builtin_cpu_supports("sse4.2"))
+			kernel = Kernel::Sse42;
+#elif defined(DATE_BATCH_X86) && defined(_MSC_VER)
+		int info[4] = { 0, 0, 0, 0 };
+		__cpuid(info, 1);
+		const bool sse42 = (info[2] & (1 << 20)) != 0;
+		// AVX also needs the OS to save the YMM registers (OSXSAVE + XCR0)
+		const bool avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		const bool avx2 = avx && (info[1] & (1 << 5)) != 0;
+		if (avx2)
+			kernel = Kernel::Avx2;
+		else if (sse42)
+			kernel = Kernel::Sse42;
+#endif
+		return kernel;
+	}();
+	return best;
+}
+
+// DateBatch::ToDayNumbers
+size_t DateBatch::ToDayNumbers(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, const size_t count, const Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef DATE_BATCH_X86
+	case Kernel::Avx2:
+		return ToDayNumbersAvx2(year, month, day, days, count);
+	case Kernel::Sse42:
+		return ToDayNumbersSse42(year, month, day, days, count);
+#endif
+	default:
+		return ToDayNumbersScalar(year, month, day, days, count);
+	}
+}
+
+// DateBatch::FromDayNumbers
+size_t DateBatch::FromDayNumbers(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, const size_t count, const Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef DATE_BATCH_X86
+	case Kernel::Avx2:
+		return FromDayNumbersAvx2(days, year, month, day, weekday, count);
+	case Kernel::Sse42:
+		return FromDayNumbersSse42(days, year, month, day, weekday, count);
+#endif
+	default:
+		return FromDayNumbersScalar(days, year, month, day, weekday, count);
+	}
+}
+
+/***************************************************************************
+ *	SCALAR KERNEL DEFINITIONS
+ ***************************************************************************/
+
+ // DateBatch::ToDayNumbersScalar
+size_t DateBatch::ToDayNumbersScalar(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, const size_t count)
+{
+	size_t invalid = 0; // counter for the invalid dates
+
+	for (size_t i = 0; i < count; i++)
+	{
+		// the same rules as MyDate::SetYear, SetMonth and SetDay
+		if (year[i] >= 1 && year[i] <= 9999 && month[i] >= 1 && month[i] <= 12
+			&& day[i] >= 1 && day[i] <= MyDate::DaysInMonth(month[i], year[i]))
+		{
+			days[i] = static_cast<int32_t>(MyDate::DayNumber(day[i], month[i], year[i]));
+		}
+		else
+		{
+			days[i] = 0;
+			invalid++;
+		}
+	}
+	return invalid;
+}
+
+// DateBatch::FromDayNumbersScalar
+size_t DateBatch::FromDayNumbersScalar(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, const size_t count)
+{
+	size_t invalid = 0; // counter for the invalid day numbers
+
+	for (size_t i = 0; i < count; i++)
+	{
+		int newDay = 0;		// unpacked day
+		int newMonth = 0;	// unpacked month
+		int newYear = 0;	// unpacked year
+		int newWeekday = 0;	// day of the week, 0 for Sunday
+
+		if (days[i] >= 1 && days[i] <= last_day)
+		{
+			MyDate::FromDayNumber(days[i], newDay, newMonth, newYear);
+			newWeekday = days[i] % 7; // same as MyDate::GetDayOfWeek()
+		}
+		else
+		{
+			invalid++;
+		}
+
+		year[i] = static_cast<uint16_t>(newYear);
+		month[i] = static_cast<uint8_t>(newMonth);
+		day[i] = static_cast<uint8_t>(newDay);
+		if (weekday != nullptr)
+			weekday[i] = static_cast<uint8_t>(newWeekday);
+	}
+	return invalid;
+}
+
+#ifdef DATE_BATCH_X86
+/***************************************************************************
+ *	VECTOR KERNEL DEFINITIONS
+ *
+ *	Day/month/year to day number uses 32 bit integer lanes. The divisions by
+ *	constants are multiply-and-shift sequences, exact over the valid range:
+ *	x / 100 == (x * 5243) >> 19 and x / 400 == (x * 5243) >> 21 for x <= 10000,
+ *	x / 5 == (x * 13108) >> 16 for x <= 1700.
+ *
+ *	Day number to day/month/year uses double lanes: every quotient is below
+ *	2^22, so a correctly rounded division followed by floor() is exact.
+ ***************************************************************************/
+
+ // DateBatch::ToDayNumbersSse42
+DATE_BATCH_TARGET("sse4.2")
+size_t DateBatch::ToDayNumbersSse42(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, const size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t invalid = 0;	// counter for the invalid dates
+	size_t i = 0;		// index of the current block of 4
+
+	for (; i + 4 <= count; i += 4)
+	{
+		int32_t packedMonths = 0;	// 4 months
+		int32_t packedDays = 0;		// 4 days
+		memcpy(&packedMonths, month + i, sizeof(packedMonths));
+		memcpy(&packedDays, day + i, sizeof(packedDays));
+
+		const __m128i y = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(year + i)));
+		const __m128i m = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packedMonths));
+		const __m128i d = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packedDays));
+
+		// leap year: divisible by 4 and either not by 100 or also by 400
+		const __m128i century = _mm_srli_epi32(_mm_mullo_epi32(y, _mm_set1_epi32(5243)), 19);
+		const __m128i yearOfCentury = _mm_sub_epi32(y, _mm_mullo_epi32(century, _mm_set1_epi32(100)));
+		const __m128i leap = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(y, _mm_set1_epi32(3)), zero),
+			_mm_or_si128(_mm_xor_si128(_mm_cmpeq_epi32(yearOfCentury, zero), _mm_set1_epi32(-1)),
+				_mm_cmpeq_epi32(_mm_and_si128(century, _mm_set1_epi32(3)), zero)));
+
+		// days in month: 30 or 31 alternating, switching phase in August; Feb is 28 or 29
+		__m128i limit = _mm_add_epi32(_mm_set1_epi32(30), _mm_and_si128(_mm_add_epi32(m, _mm_srli_epi32(m, 3)), _mm_set1_epi32(1)));
+		limit = _mm_blendv_epi8(limit, _mm_sub_epi32(_mm_set1_epi32(28), leap), _mm_cmpeq_epi32(m, _mm_set1_epi32(2)));
+
+		const __m128i valid = _mm_and_si128(
+			_mm_and_si128(_mm_cmpgt_epi32(y, zero), _mm_cmplt_epi32(y, _mm_set1_epi32(10000))),
+			_mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(m, zero), _mm_cmplt_epi32(m, _mm_set1_epi32(13))),
+				_mm_and_si128(_mm_cmpgt_epi32(d, zero), _mm_cmpgt_epi32(_mm_add_epi32(limit, _mm_set1_epi32(1)), d))));
+
+		// same steps as MyDate::DayNumber
+		const __m128i march = _mm_cmpgt_epi32(m, _mm_set1_epi32(2));
+		const __m128i shiftedYear = _mm_add_epi32(y, _mm_andnot_si128(march, _mm_set1_epi32(-1)));
+		const __m128i era = _mm_srli_epi32(_mm_mullo_epi32(shiftedYear, _mm_set1_epi32(5243)), 21);
+		const __m128i yearOfEra = _mm_sub_epi32(shiftedYear, _mm_mullo_epi32(era, _mm_set1_epi32(400)));
+		const __m128i shiftedMonth = _mm_blendv_epi8(_mm_add_epi32(m, _mm_set1_epi32(9)), _mm_sub_epi32(m, _mm_set1_epi32(3)), march);
+		const __m128i monthStart = _mm_add_epi32(_mm_mullo_epi32(shiftedMonth, _mm_set1_epi32(153)), _mm_set1_epi32(2));
+		const __m128i dayOfYear = _mm_add_epi32(_mm_srli_epi32(_mm_mullo_epi32(monthStart, _mm_set1_epi32(13108)), 16), _mm_sub_epi32(d, _mm_set1_epi32(1)));
+		const __m128i dayOfEra = _mm_add_epi32(_mm_sub_epi32(_mm_add_epi32(_mm_mullo_epi32(yearOfEra, _mm_set1_epi32(365)), _mm_srli_epi32(yearOfEra, 2)),
+			_mm_srli_epi32(_mm_mullo_epi32(yearOfEra, _mm_set1_epi32(5243)), 19)), dayOfYear);
+		const __m128i dayNumber = _mm_sub_epi32(_mm_add_epi32(_mm_mullo_epi32(era, _mm_set1_epi32(146097)), dayOfEra), _mm_set1_epi32(305));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(days + i), _mm_and_si128(dayNumber, valid));
+		invalid += 4 - bitset<4>(_mm_movemask_ps(_mm_castsi128_ps(valid))).count();
+	}
+	return invalid + ToDayNumbersScalar(year + i, month + i, day + i, days + i, count - i);
+}
+
+// DateBatch::ToDayNumbersAvx2
+DATE_BATCH_TARGET("avx2")
+size_t DateBatch::ToDayNumbersAvx2(const uint16_t* year, const uint8_t* month, const uint8_t* day, int32_t* days, const size_t count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	size_t invalid = 0;	// counter for the invalid dates
+	size_t i = 0;		// index of the current block of 8
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i y = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(year + i)));
+		const __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(month + i)));
+		const __m256i d = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(day + i)));
+
+		// leap year: divisible by 4 and either not by 100 or also by 400
+		const __m256i century = _mm256_srli_epi32(_mm256_mullo_epi32(y, _mm256_set1_epi32(5243)), 19);
+		const __m256i yearOfCentury = _mm256_sub_epi32(y, _mm256_mullo_epi32(century, _mm256_set1_epi32(100)));
+		const __m256i leap = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(y, _mm256_set1_epi32(3)), zero),
+			_mm256_or_si256(_mm256_xor_si256(_mm256_cmpeq_epi32(yearOfCentury, zero), _mm256_set1_epi32(-1)),
+				_mm256_cmpeq_epi32(_mm256_and_si256(century, _mm256_set1_epi32(3)), zero)));
+
+		// days in month: 30 or 31 alternating, switching phase in August; Feb is 28 or 29
+		__m256i limit = _mm256_add_epi32(_mm256_set1_epi32(30), _mm256_and_si256(_mm256_add_epi32(m, _mm256_srli_epi32(m, 3)), _mm256_set1_epi32(1)));
+		limit = _mm256_blendv_epi8(limit, _mm256_sub_epi32(_mm256_set1_epi32(28), leap), _mm256_cmpeq_epi32(m, _mm256_set1_epi32(2)));
+
+		const __m256i valid = _mm256_and_si256(
+			_mm256_and_si256(_mm256_cmpgt_epi32(y, zero), _mm256_cmpgt_epi32(_mm256_set1_epi32(10000), y)),
+			_mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(m, zero), _mm256_cmpgt_epi32(_mm256_set1_epi32(13), m)),
+				_mm256_and_si256(_mm256_cmpgt_epi32(d, zero), _mm256_cmpgt_epi32(_mm256_add_epi32(limit, _mm256_set1_epi32(1)), d))));
+
+		// same steps as MyDate::DayNumber
+		const __m256i march = _mm256_cmpgt_epi32(m, _mm256_set1_epi32(2));
+		const __m256i shiftedYear = _mm256_add_epi32(y, _mm256_andnot_si256(march, _mm256_set1_epi32(-1)));
+		const __m256i era = _mm256_srli_epi32(_mm256_mullo_epi32(shiftedYear, _mm256_set1_epi32(5243)), 21);
+		const __m256i yearOfEra = _mm256_sub_epi32(shiftedYear, _mm256_mullo_epi32(era, _mm256_set1_epi32(400)));
+		const __m256i shiftedMonth = _mm256_blendv_epi8(_mm256_add_epi32(m, _mm256_set1_epi32(9)), _mm256_sub_epi32(m, _mm256_set1_epi32(3)), march);
+		const __m256i monthStart = _mm256_add_epi32(_mm256_mullo_epi32(shiftedMonth, _mm256_set1_epi32(153)), _mm256_set1_epi32(2));
+		const __m256i dayOfYear = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(monthStart, _mm256_set1_epi32(13108)), 16), _mm256_sub_epi32(d, _mm256_set1_epi32(1)));
+		const __m256i dayOfEra = _mm256_add_epi32(_mm256_sub_epi32(_mm256_add_epi32(_mm256_mullo_epi32(yearOfEra, _mm256_set1_epi32(365)), _mm256_srli_epi32(yearOfEra, 2)),
+			_mm256_srli_epi32(_mm256_mullo_epi32(yearOfEra, _mm256_set1_epi32(5243)), 19)), dayOfYear);
+		const __m256i dayNumber = _mm256_sub_epi32(_mm256_add_epi32(_mm256_mullo_epi32(era, _mm256_set1_epi32(146097)), dayOfEra), _mm256_set1_epi32(305));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(days + i), _mm256_and_si256(dayNumber, valid));
+		invalid += 8 - bitset<8>(_mm256_movemask_ps(_mm256_castsi256_ps(valid))).count();
+	}
+	return invalid + ToDayNumbersScalar(year + i, month + i, day + i, days + i, count - i);
+}
+
+// DateBatch::FromDayNumbersSse42
+DATE_BATCH_TARGET("sse4.2")
+size_t DateBatch::FromDayNumbersSse42(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, const size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t invalid = 0;	// counter for the invalid day numbers
+	size_t i = 0;		// index of the current block of 4
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(days + i));
+		const __m128i valid = _mm_and_si128(_mm_cmpgt_epi32(n, zero), _mm_cmplt_epi32(n, _mm_set1_epi32(last_day + 1)));
+		const __m128i safe = _mm_blendv_epi8(_mm_set1_epi32(1), n, valid); // keep invalid lanes in range
+
+		__m128i fields[4][2];	// year, month, day, weekday for each half
+		for (int half = 0; half < 2; half++)
+		{
+			// same steps as MyDate::FromDayNumber, 2 lanes at a time
+			const __m128d x = _mm_cvtepi32_pd(half == 0 ? safe : _mm_srli_si128(safe, 8));
+			const __m128d z = _mm_add_pd(x, _mm_set1_pd(305));
+			const __m128d era = _mm_floor_pd(_mm_div_pd(z, _mm_set1_pd(146097)));
+			const __m128d dayOfEra = _mm_sub_pd(z, _mm_mul_pd(era, _mm_set1_pd(146097)));
+			const __m128d yearOfEra = _mm_floor_pd(_mm_div_pd(_mm_sub_pd(_mm_add_pd(_mm_sub_pd(dayOfEra,
+				_mm_floor_pd(_mm_div_pd(dayOfEra, _mm_set1_pd(1460)))),
+				_mm_floor_pd(_mm_div_pd(dayOfEra, _mm_set1_pd(36524)))),
+				_mm_floor_pd(_mm_div_pd(dayOfEra, _mm_set1_pd(146096)))), _mm_set1_pd(365)));
+			const __m128d dayOfYear = _mm_sub_pd(dayOfEra, _mm_sub_pd(_mm_add_pd(_mm_mul_pd(yearOfEra, _mm_set1_pd(365)),
+				_mm_floor_pd(_mm_div_pd(yearOfEra, _mm_set1_pd(4)))), _mm_floor_pd(_mm_div_pd(yearOfEra, _mm_set1_pd(100)))));
+			const __m128d shiftedMonth = _mm_floor_pd(_mm_div_pd(_mm_add_pd(_mm_mul_pd(dayOfYear, _mm_set1_pd(5)), _mm_set1_pd(2)), _mm_set1_pd(153)));
+			const __m128d d = _mm_add_pd(_mm_sub_pd(dayOfYear, _mm_floor_pd(_mm_div_pd(_mm_add_pd(_mm_mul_pd(shiftedMonth, _mm_set1_pd(153)), _mm_set1_pd(2)), _mm_set1_pd(5)))), _mm_set1_pd(1));
+			const __m128d early = _mm_cmpge_pd(shiftedMonth, _mm_set1_pd(10)); // January or February
+			const __m128d m = _mm_sub_pd(_mm_add_pd(shiftedMonth, _mm_set1_pd(3)), _mm_and_pd(early, _mm_set1_pd(12)));
+			const __m128d y = _mm_add_pd(_mm_add_pd(yearOfEra, _mm_mul_pd(era, _mm_set1_pd(400))), _mm_and_pd(early, _mm_set1_pd(1)));
+			const __m128d w = _mm_sub_pd(x, _mm_mul_pd(_mm_floor_pd(_mm_div_pd(x, _mm_set1_pd(7))), _mm_set1_pd(7)));
+
+			fields[0][half] = _mm_cvttpd_epi32(y);
+			fields[1][half] = _mm_cvttpd_epi32(m);
+			fields[2][half] = _mm_cvttpd_epi32(d);
+			fields[3][half] = _mm_cvttpd_epi32(w);
+		}
+
+		// narrow the 4 lanes of each field, zeroing the invalid ones
+		const __m128i valid16 = _mm_packs_epi32(valid, zero);
+		const __m128i valid8 = _mm_packs_epi16(valid16, zero);
+		__m128i narrow[4];
+		for (int field = 0; field < 4; field++)
+			narrow[field] = _mm_and_si128(_mm_packus_epi32(_mm_unpacklo_epi64(fields[field][0], fields[field][1]), zero), valid16);
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(year + i), narrow[0]);
+		const int32_t packedMonths = _mm_cvtsi128_si32(_mm_and_si128(_mm_packus_epi16(narrow[1], zero), valid8));
+		const int32_t packedDays = _mm_cvtsi128_si32(_mm_and_si128(_mm_packus_epi16(narrow[2], zero), valid8));
+		memcpy(month + i, &packedMonths, sizeof(packedMonths));
+		memcpy(day + i, &packedDays, sizeof(packedDays));
+		if (weekday != nullptr)
+		{
+			const int32_t packedWeekdays = _mm_cvtsi128_si32(_mm_and_si128(_mm_packus_epi16(narrow[3], zero), valid8));
+			memcpy(weekday + i, &packedWeekdays, sizeof(packedWeekdays));
+		}
+		invalid += 4 - bitset<4>(_mm_movemask_ps(_mm_castsi128_ps(valid))).count();
+	}
+	return invalid + FromDayNumbersScalar(days + i, year + i, month + i, day + i, weekday == nullptr ? nullptr : weekday + i, count - i);
+}
+
+// DateBatch::FromDayNumbersAvx2
+DATE_BATCH_TARGET("avx2")
+size_t DateBatch::FromDayNumbersAvx2(const int32_t* days, uint16_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, const size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t invalid = 0;	// counter for the invalid day numbers
+	size_t i = 0;		// index of the current block of 8
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i n = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(days + i));
+		const __m256i valid = _mm256_and_si256(_mm256_cmpgt_epi32(n, _mm256_setzero_si256()), _mm256_cmpgt_epi32(_mm256_set1_epi32(last_day + 1), n));
+		const __m256i safe = _mm256_blendv_epi8(_mm256_set1_epi32(1), n, valid); // keep invalid lanes in range
+
+		__m128i fields[4][2];	// year, month, day, weekday for each half
+		for (int half = 0; half < 2; half++)
+		{
+			// same steps as MyDate::FromDayNumber, 4 lanes at a time
+			const __m256d x = _mm256_cvtepi32_pd(half == 0 ? _mm256_castsi256_si128(safe) : _mm256_extracti128_si256(safe, 1));
+			const __m256d z = _mm256_add_pd(x, _mm256_set1_pd(305));
+			const __m256d era = _mm256_floor_pd(_mm256_div_pd(z, _mm256_set1_pd(146097)));
+			const __m256d dayOfEra = _mm256_sub_pd(z, _mm256_mul_pd(era, _mm256_set1_pd(146097)));
+			const __m256d yearOfEra = _mm256_floor_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_add_pd(_mm256_sub_pd(dayOfEra,
+				_mm256_floor_pd(_mm256_div_pd(dayOfEra, _mm256_set1_pd(1460)))),
+				_mm256_floor_pd(_mm256_div_pd(dayOfEra, _mm256_set1_pd(36524)))),
+				_mm256_floor_pd(_mm256_div_pd(dayOfEra, _mm256_set1_pd(146096)))), _mm256_set1_pd(365)));
+			const __m256d dayOfYear = _mm256_sub_pd(dayOfEra, _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(yearOfEra, _mm256_set1_pd(365)),
+				_mm256_floor_pd(_mm256_div_pd(yearOfEra, _mm256_set1_pd(4)))), _mm256_floor_pd(_mm256_div_pd(yearOfEra, _mm256_set1_pd(100)))));
+			const __m256d shiftedMonth = _mm256_floor_pd(_mm256_div_pd(_mm256_add_pd(_mm256_mul_pd(dayOfYear, _mm256_set1_pd(5)), _mm256_set1_pd(2)), _mm256_set1_pd(153)));
+			const __m256d d = _mm256_add_pd(_mm256_sub_pd(dayOfYear, _mm256_floor_pd(_mm256_div_pd(_mm256_add_pd(_mm256_mul_pd(shiftedMonth, _mm256_set1_pd(153)), _mm256_set1_pd(2)), _mm256_set1_pd(5)))), _mm256_set1_pd(1));
+			const __m256d early = _mm256_cmp_pd(shiftedMonth, _mm256_set1_pd(10), _CMP_GE_OQ); // January or February
+			const __m256d m = _mm256_sub_pd(_mm256_add_pd(shiftedMonth, _mm256_set1_pd(3)), _mm256_and_pd(early, _mm256_set1_pd(12)));
+			const __m256d y = _mm256_add_pd(_mm256_add_pd(yearOfEra, _mm256_mul_pd(era, _mm256_set1_pd(400))), _mm256_and_pd(early, _mm256_set1_pd(1)));
+			const __m256d w = _mm256_sub_pd(x, _mm256_mul_pd(_mm256_floor_pd(_mm256_div_pd(x, _mm256_set1_pd(7))), _mm256_set1_pd(7)));
+
+			fields[0][half] = _mm256_cvttpd_epi32(y);
+			fields[1][half] = _mm256_cvttpd_epi32(m);
+			fields[2][half] = _mm256_cvttpd_epi32(d);
+			fields[3][half] = _mm256_cvttpd_epi32(w);
+		}
+
+		// narrow the 8 lanes of each field, zeroing the invalid ones
+		const __m128i valid16 = _mm_packs_epi32(_mm256_castsi256_si128(valid), _mm256_extracti128_si256(valid, 1));
+		const __m128i valid8 = _mm_packs_epi16(valid16, zero);
+		__m128i narrow[4];
+		for (int field = 0; field < 4; field++)
+			narrow[field] = _mm_and_si128(_mm_packus_epi32(fields[field][0], fields[field][1]), valid16);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(year + i), narrow[0]);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(month + i), _mm_and_si128(_mm_packus_epi16(narrow[1], zero), valid8));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(day + i), _mm_and_si128(_mm_packus_epi16(narrow[2], zero), valid8));
+		if (weekday != nullptr)
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(weekday + i), _mm_and_si128(_mm_packus_epi16(narrow[3], zero), valid8));
+		invalid += 8 - bitset<8>(_mm256_movemask_ps(_mm256_castsi256_ps(valid))).count();
+	}
+	return invalid + FromDayNumbersScalar(days + i, year + i, month + i, day + i, weekday == nullptr ? nullptr : weekday + i, count - i);
+}
+#endif
+
+#endif
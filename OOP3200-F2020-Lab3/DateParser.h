@@ -0,0 +1,247 @@
+/** DateParser.h - Date Parser
+ *
+ *	The DateParser class reads dates from text without prompting, copying or
+ *	throwing. It accepts the dd/mm/yyyy format that MyDate's operator << writes
+ *	and the ISO-8601 yyyy-mm-dd format, and reports problems with a status code.
+ *	ParseColumn() reads a whole buffer of delimited dates in one call, e.g. a
+ *	column loaded from a file or received from a socket.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+*/
+
+#pragma once
+#ifndef _DATE_PARSER_H
+
+#define _DATE_PARSER_H
+
+#include <cstddef>		// for size_t
+#include <string_view>	// for string_view
+#include "MyDate.h"
+#include "PackedDate.h"
+
+using namespace std;
+
+class DateParser
+{
+public:
+
+	/** Status
+	 *	The result of parsing one date.
+	 */
+	enum class Status
+	{
+		Ok,				// parsed a valid date
+		Empty,			// there was no text
+		BadFormat,		// not dd/mm/yyyy or yyyy-mm-dd
+		InvalidYear,	// the year is not between 1 and 9999
+		InvalidMonth,	// the month is not between 1 and 12
+		InvalidDay		// the day is not valid for the month and year
+	};
+
+	/** ColumnResult
+	 *	The totals returned by ParseColumn().
+	 */
+	struct ColumnResult
+	{
+		size_t count;	// the number of dates read, valid or not
+		size_t invalid;	// the number of those that were not valid
+	};
+
+	/** Parse()
+	 *	Parses a single date. Leading and trailing spaces, tabs and carriage
+	 *	returns are ignored. The date is only changed if the status is Ok.
+	 *	@param text (string_view) - the text to parse
+	 *	@param date (MyDate or PackedDate by ref) - stores the parsed date
+	 *	@return (Status) - Ok, or the reason the text is not a valid date
+	 */
+	static Status Parse(string_view text, MyDate& date);
+	static Status Parse(string_view text, PackedDate& date);
+
+	/** ParseColumn()
+	 *	Parses every date in a buffer, e.g. one per line. An empty final field
+	 *	(a trailing delimiter) is ignored. Invalid dates are stored as the
+	 *	default PackedDate and counted.
+	 *	@param column (string_view) - the dates, separated by the delimiter
+	 *	@param delimiter (char) - the character between dates, e.g. '\n'
+	 *	@param dates (PackedDate*) - stores the parsed dates
+	 *	@param status (Status*) - stores the status of each date (may be nullptr)
+	 *	@param capacity (size_t) - the most dates to read
+	 *	@return (ColumnResult) - the number of dates read and how many were invalid
+	 */
+	static ColumnResult ParseColumn(string_view column, char delimiter, PackedDate* dates, Status* status, size_t capacity);
+
+	/** Describe()
+	 *	Returns a short description of a status, for error reports.
+	 *	@param status (Status) - the status to describe
+	 *	@return (const char*) - the description
+	 */
+	static const char* Describe(Status status);
+
+private:
+	/** ParseFields()
+	 *	Splits the text into day, month and year and validates them the same
+	 *	way as MyDate::SetYear, SetMonth and SetDay.
+	 */
+	static Status ParseFields(string_view text, int& day, int& month, int& year);
+
+	/** ReadNumber()
+	 *	Reads 1 to max_digits decimal digits starting at position.
+	 *	@return (bool) - false if there was no digit
+	 */
+	static bool ReadNumber(string_view text, size_t& position, size_t max_digits, int& value);
+};
+
+/***************************************************************************
+ *	PUBLIC STATIC METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // DateParser::Parse (MyDate)
+DateParser::Status DateParser::Parse(const string_view text, MyDate& date)
+{
+	int day = 0;	// parsed day
+	int month = 0;	// parsed month
+	int year = 0;	// parsed year
+
+	const auto status = ParseFields(text, day, month, year);
+	if (status == Status::Ok)
+		date = MyDate(day, month, year); // already validated, will not throw
+	return status;
+}
+
+// DateParser::Parse (PackedDate)
+DateParser::Status DateParser::Parse(const string_view text, PackedDate& date)
+{
+	int day = 0;	// parsed day
+	int month = 0;	// parsed month
+	int year = 0;	// parsed year
+
+	const auto status = ParseFields(text, day, month, year);
+	if (status == Status::Ok)
+		date = PackedDate(MyDate::DayNumber(day, month, year)); // already validated, will not throw
+	return status;
+}
+
+// DateParser::ParseColumn
+DateParser::ColumnResult DateParser::ParseColumn(const string_view column, const char delimiter, PackedDate* dates, Status* status, const size_t capacity)
+{
+	ColumnResult result = { 0, 0 };	// the totals to return
+	size_t start = 0;				// the start of the current field
+
+	while (start < column.size() && result.count < capacity)
+	{
+		// find the end of this field
+		auto end = column.find(delimiter, start);
+		if (end == string_view::npos)
+			end = column.size();
+
+		PackedDate date;	// default date for invalid fields
+		const auto fieldStatus = Parse(column.substr(start, end - start), date);
+		if (fieldStatus != Status::Ok)
+			result.invalid++;
+
+		dates[result.count] = date;
+		if (status != nullptr)
+			status[result.count] = fieldStatus;
+		result.count++;
+
+		start = end + 1; // skip the delimiter
+	}
+	return result;
+}
+
+// DateParser::Describe
+const char* DateParser::Describe(const Status status)
+{
+	switch (status)
+	{
+	case Status::Ok:
+		return "valid date";
+	case Status::Empty:
+		return "missing date";
+	case Status::BadFormat:
+		return "date must be formatted dd/mm/yyyy or yyyy-mm-dd";
+	case Status::InvalidYear:
+		return "year must be between 0001 and 9999";
+	case Status::InvalidMonth:
+		return "month must be between 1 and 12";
+	default:
+		return "day is not valid for the month";
+	}
+}
+
+/***************************************************************************
+ *	PRIVATE STATIC METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // DateParser::ParseFields
+DateParser::Status DateParser::ParseFields(string_view text, int& day, int& month, int& year)
+{
+	// trim spaces, tabs and carriage returns
+	const auto first = text.find_first_not_of(" \t\r");
+	if (first == string_view::npos)
+		return Status::Empty;
+	text = text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+
+	size_t position = 0;	// position in the text
+	int leading = 0;		// the first number: the day or (ISO) the year
+
+	if (!ReadNumber(text, position, 4, leading) || position >= text.size())
+		return Status::BadFormat;
+
+	const char separator = text[position]; // '/' or '-' decides the format
+	if (separator == '/' && position <= 2)
+	{
+		// dd/mm/yyyy
+		day = leading;
+		position++;
+		if (!ReadNumber(text, position, 2, month) || position >= text.size() || text[position++] != '/'
+			|| !ReadNumber(text, position, 4, year))
+			return Status::BadFormat;
+	}
+	else if (separator == '-')
+	{
+		// yyyy-mm-dd
+		year = leading;
+		position++;
+		if (!ReadNumber(text, position, 2, month) || position >= text.size() || text[position++] != '-'
+			|| !ReadNumber(text, position, 2, day))
+			return Status::BadFormat;
+	}
+	else
+	{
+		return Status::BadFormat;
+	}
+
+	if (position != text.size())
+		return Status::BadFormat; // trailing characters
+
+	// the same rules as MyDate::SetYear, SetMonth and SetDay
+	switch (MyDate::Validate(day, month, year).Code())
+	{
+	case ValidationCode::Ok:
+		return Status::Ok;
+	case ValidationCode::InvalidYear:
+		return Status::InvalidYear;
+	case ValidationCode::InvalidMonth:
+		return Status::InvalidMonth;
+	default:
+		return Status::InvalidDay;
+	}
+}
+
+// DateParser::ReadNumber
+bool DateParser::ReadNumber(const string_view text, size_t& position, const size_t max_digits, int& value)
+{
+	const auto start = position; // where the digits begin
+
+	value = 0;
+	while (position < text.size() && position - start < max_digits && text[position] >= '0' && text[position] <= '9')
+	{
+		value = value * 10 + (text[position] - '0');
+		position++;
+	}
+	return position > start;
+}
+
+#endif
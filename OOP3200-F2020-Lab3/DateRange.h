@@ -0,0 +1,217 @@
+/** DateRange.h - Calendar Date Ranges
+ *
+ *	The DateRange class is the dates from a first date up to, but not
+ *	including, a last date, a day, a week or a month apart. It works with
+ *	range-based for loops and the standard algorithms, e.g.
+ *
+ *		for (const MyDate day : DateRange(first, last))
+ *		for (const MyDate month : DateRange(first, last, DateRange::Step::Month))
+ *
+ *	Its iterator keeps the day, month and year and steps them directly,
+ *	rolling the day over at MyDate::DaysInMonth() and the month over at
+ *	December, where MyDate::operator++ converts the date to a day number and
+ *	back on every step.
+ *
+ *	Stepping by month keeps the day of the month of the first date, or the
+ *	last day of a shorter month: from 31/01/2000 the dates are 31/01/2000,
+ *	29/02/2000, 31/03/2000, 30/04/2000, and so on.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+*/
+
+#pragma once
+#ifndef _DATE_RANGE_H
+
+#define _DATE_RANGE_H
+
+#include <algorithm>	// for min
+#include <cstddef>		// for size_t and ptrdiff_t
+#include <cstdint>		// for uint8_t
+#include <iterator>		// for forward_iterator_tag
+#include "MyDate.h"
+
+using namespace std;
+
+class DateRange
+{
+public:
+
+	/** Step
+	 *	How far apart the dates are.
+	 */
+	enum class Step : uint8_t
+	{
+		Day,
+		Week,	// seven days
+		Month	// the same day of the next month, or its last day if that is earlier
+	};
+
+	/** const_iterator
+	 *	Walks the dates in order.
+	 */
+	class const_iterator
+	{
+	public:
+		using iterator_category = forward_iterator_tag;
+		using value_type = MyDate;
+		using difference_type = ptrdiff_t;
+		using pointer = const MyDate*;
+		using reference = MyDate;
+
+		const_iterator() = default;
+		const_iterator(const int day, const int month, const int year, const int anchor_day, const Step step)
+			: myDay(day), myMonth(month), myYear(year), myAnchorDay(anchor_day), myStep(step) {}
+
+		MyDate operator*() const { return MyDate(myDay, myMonth, myYear); }
+		const_iterator& operator++();
+		const_iterator operator++(int) { auto original = *this; ++*this; return original; }
+		bool operator==(const const_iterator& compare) const { return myDay == compare.myDay && myMonth == compare.myMonth && myYear == compare.myYear; }
+		bool operator!=(const const_iterator& compare) const { return !(*this == compare); }
+
+		/** Accessors
+		 *	The current date's fields, without building a MyDate.
+		 */
+		int GetDay() const { return myDay; }
+		int GetMonth() const { return myMonth; }
+		int GetYear() const { return myYear; }
+
+	private:
+		int myDay = 1;			// the current date
+		int myMonth = 1;
+		int myYear = 2000;
+		int myAnchorDay = 1;	// the day of the month a Month step aims for
+		Step myStep = Step::Day;	// how far each step goes
+	};
+
+	/** Parameterized Constructor
+	 *	The dates from first up to, but not including, last. The range is
+	 *	empty if last is not after first.
+	 *	@param first (MyDate) - the first date
+	 *	@param last (MyDate) - one past the last date
+	 *	@param step (Step) - how far apart the dates are
+	 */
+	DateRange(const MyDate& first, const MyDate& last, Step step = Step::Day);
+
+	/***************************************************************************
+	*	ACCESSORS
+	***************************************************************************/
+
+	Step GetStep() const { return myStep; }
+	size_t Size() const { return mySize; }		// the number of dates, in constant time
+	bool Empty() const { return mySize == 0; }
+
+	const_iterator begin() const { return myBegin; }
+	const_iterator end() const { return myEnd; }
+
+private:
+	/** AddMonths()
+	 *	Moves a day/month/year a number of months on, keeping anchor_day or
+	 *	the last day of a shorter month.
+	 */
+	static void AddMonths(long months, int anchor_day, int& day, int& month, int& year);
+
+	Step myStep;				// how far apart the dates are
+	size_t mySize;				// the number of dates
+	const_iterator myBegin;		// the first date
+	const_iterator myEnd;		// the first date the steps reach at or after the last date
+};
+
+/***************************************************************************
+ *	CONSTRUCTOR DEFINITIONS
+ ***************************************************************************/
+
+ // DateRange::Parameterized Constructor
+DateRange::DateRange(const MyDate& first, const MyDate& last, const Step step) : myStep(step), mySize(0)
+{
+	const auto firstDay = first.GetDay();
+	const auto firstMonth = first.GetMonth();
+	const auto firstYear = first.GetYear();
+	myBegin = const_iterator(firstDay, firstMonth, firstYear, firstDay, step);
+	myEnd = myBegin;
+	if (!(first < last))
+		return;
+
+	// find the end, the first step at or after last, directly
+	int day = firstDay;
+	int month = firstMonth;
+	int year = firstYear;
+	if (step == Step::Month)
+	{
+		auto months = (last.GetYear() - firstYear) * 12L + (last.GetMonth() - firstMonth); // steps to reach last's month
+		AddMonths(months, firstDay, day, month, year);
+		if (day < last.GetDay()) // still before last, so one more
+		{
+			months++;
+			AddMonths(1, firstDay, day, month, year);
+		}
+		mySize = static_cast<size_t>(months);
+	}
+	else
+	{
+		const long days = last - first;		// always positive here
+		const long stride = step == Step::Week ? 7 : 1;
+		const long steps = (days + stride - 1) / stride;
+		MyDate::FromDayNumber(first.GetDayNumber() + steps * stride, day, month, year); // not validated; may be past 31/12/9999
+		mySize = static_cast<size_t>(steps);
+	}
+	myEnd = const_iterator(day, month, year, firstDay, step);
+}
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // DateRange::const_iterator::operator++ (Prefix Increment)
+DateRange::const_iterator& DateRange::const_iterator::operator++()
+{
+	switch (myStep)
+	{
+	case Step::Day:
+		if (++myDay > MyDate::DaysInMonth(myMonth, myYear))
+		{
+			myDay = 1;
+			if (++myMonth > 12)
+			{
+				myMonth = 1;
+				myYear++;
+			}
+		}
+		break;
+	case Step::Week:
+	{
+		const auto daysInMonth = MyDate::DaysInMonth(myMonth, myYear);
+		myDay += 7;
+		if (myDay > daysInMonth) // a week never spans more than one month end
+		{
+			myDay -= daysInMonth;
+			if (++myMonth > 12)
+			{
+				myMonth = 1;
+				myYear++;
+			}
+		}
+		break;
+	}
+	default: // Step::Month
+		if (++myMonth > 12)
+		{
+			myMonth = 1;
+			myYear++;
+		}
+		myDay = min(myAnchorDay, MyDate::DaysInMonth(myMonth, myYear));
+		break;
+	}
+	return *this;
+}
+
+// DateRange::AddMonths
+void DateRange::AddMonths(const long months, const int anchor_day, int& day, int& month, int& year)
+{
+	const auto monthIndex = year * 12L + (month - 1) + months; // months since January of year 0
+	year = static_cast<int>(monthIndex / 12);
+	month = static_cast<int>(monthIndex % 12) + 1;
+	day = min(anchor_day, MyDate::DaysInMonth(month, year));
+}
+
+#endif
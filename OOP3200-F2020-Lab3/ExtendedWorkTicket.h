@@ -17,13 +17,60 @@ public:
 
 	//Default constructor 
 	ExtendedWorkTicket() : WorkTicket(), isOpen(true){ }
+
+	// Allocator-aware constructors (see WorkTicket)
+	explicit ExtendedWorkTicket(const allocator_type& allocator) : WorkTicket(allocator), isOpen(true) { }
+	ExtendedWorkTicket(const ExtendedWorkTicket& original, const allocator_type& allocator) : WorkTicket(original, allocator), isOpen(original.isOpen) { }
+	ExtendedWorkTicket(ExtendedWorkTicket&& original, const allocator_type& allocator) : WorkTicket(move(original), allocator), isOpen(original.isOpen) { }
+
+	// Copy and move (see WorkTicket); moving never throws, so vectors move tickets when they grow
+	ExtendedWorkTicket(const ExtendedWorkTicket& original) = default;
+	ExtendedWorkTicket(ExtendedWorkTicket&& original) noexcept = default;
+	ExtendedWorkTicket& operator=(const ExtendedWorkTicket& original) = default;
+	ExtendedWorkTicket& operator=(ExtendedWorkTicket&& original) = default;
 	
 	//Parameterized constructor?
-	ExtendedWorkTicket(int ticket_number, const string& client_id, int day, int month, int year, const string& description, bool isOpen);
+	ExtendedWorkTicket(int ticket_number, string_view client_id, int day, int month, int year, string_view description, bool isOpen);
+
+	// Sets all the attributes, including the open flag, if the parameters are valid
+	using WorkTicket::SetWorkTicket;
+	bool SetWorkTicket(int ticket_number, string_view client_id, int day, int month, int year, string_view description, bool isOpen);
+
+	// Makes a ticket without throwing, with the same rules as WorkTicket::TryMake
+	static Expected<ExtendedWorkTicket> TryMake(int ticket_number, string_view client_id, int day, int month, int year, string_view description, bool isOpen);
 
 	bool IsOpen() const { return isOpen; }
-	void CloseOpen() { isOpen = false; }
+	void CloseTicket() { isOpen = false; }
+	void CloseOpen() { CloseTicket(); } // the original name, kept for existing callers
 	
 };
 
+// ExtendedWorkTicket::Parameterized Constructor definition
+ExtendedWorkTicket::ExtendedWorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description, const bool isOpen)
+	: WorkTicket(ticket_number, client_id, day, month, year, description), isOpen(isOpen)
+{
+}
+
+// ExtendedWorkTicket::SetWorkTicket definition
+bool ExtendedWorkTicket::SetWorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description, const bool isOpen)
+{
+	// the open flag only changes if the rest of the ticket is valid
+	const auto valid = WorkTicket::SetWorkTicket(ticket_number, client_id, day, month, year, description);
+	if (valid)
+		this->isOpen = isOpen;
+	return valid;
+}
+
+// ExtendedWorkTicket::TryMake definition
+Expected<ExtendedWorkTicket> ExtendedWorkTicket::TryMake(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description, const bool isOpen)
+{
+	const auto error = Validate(ticket_number, client_id, day, month, year, description);
+	if (!error.Ok())
+		return error;
+
+	ExtendedWorkTicket ticket;
+	ticket.SetWorkTicket(ticket_number, client_id, day, month, year, description, isOpen); // already validated
+	return ticket;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,467 @@
+/** Instrumentation.h - Hot Path Counters and Latency Histograms
+ *
+ *	The Instrumentation class counts what the core types do (day number
+ *	conversions, stream formatting, WorkTicket copies and the exceptions the
+ *	setters throw) and records how long the main operations take in latency
+ *	histograms. It is compiled out unless LAB3_INSTRUMENTATION is defined:
+ *	the LAB3_COUNT() and LAB3_TIME() macros the other headers use expand to
+ *	nothing, so a normal build has no cost at all.
+ *
+ *	When it is compiled in, each thread records into its own counters, which
+ *	only that thread writes, so recording is a plain increment with no
+ *	locked instruction and no shared cache line. Collect() adds up every
+ *	thread's counters on demand, including those of threads that have
+ *	exited, and WriteText() and WriteJson() dump the result for a person or
+ *	a script to read.
+ *
+ *	Histograms have four buckets for every power of two nanoseconds, so a
+ *	percentile is reported as the top of its bucket, at most 25% above the
+ *	true value.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+ *	@see		WorkTicket.h
+*/
+
+#pragma once
+#ifndef _INSTRUMENTATION_H
+
+#define _INSTRUMENTATION_H
+
+#include <algorithm>	// for find, min and max
+#include <array>		// for the counters and buckets
+#include <atomic>		// for the per-thread counters
+#include <chrono>		// for steady_clock
+#include <cstddef>		// for size_t
+#include <cstdint>		// for fixed width integers
+#include <iomanip>		// for setw
+#include <memory>		// for unique_ptr
+#include <mutex>		// for the thread list
+#include <ostream>		// for the dumps
+#include <vector>		// for the thread list
+
+#ifdef _MSC_VER
+#include <intrin.h>		// for _BitScanReverse64
+#endif
+
+using namespace std;
+
+class Instrumentation
+{
+public:
+#ifdef LAB3_INSTRUMENTATION
+	static constexpr bool enabled = true;	// whether the macros record anything
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	/** Counter
+	 *	What is counted.
+	 */
+	enum class Counter : uint8_t
+	{
+		ToDayNumber,		// MyDate::DayNumber(): a day/month/year to a day number
+		FromDayNumber,		// MyDate::FromDayNumber(): a day number to a day/month/year
+		StringStream,		// a stringstream built to format a WorkTicket as a string
+		StreamOutput,		// a MyDate or WorkTicket written with operator <<
+		TicketCopy,			// WorkTicket copy constructions
+		TicketAssign,		// WorkTicket copy assignments
+		TicketNumberThrow,	// exceptions thrown by WorkTicket::SetTicketNumber()
+		TicketDateThrow,	// exceptions thrown by WorkTicket::SetDate()
+		DayThrow,			// exceptions thrown by MyDate::SetDay()
+		count
+	};
+
+	/** Operation
+	 *	What is timed.
+	 */
+	enum class Operation : uint8_t
+	{
+		SetWorkTicket,		// WorkTicket::SetWorkTicket()
+		TicketString,		// WorkTicket::operator string()
+		TicketOutput,		// operator <<(ostream&, const WorkTicket&)
+		DateString,			// MyDate::operator string()
+		DateOutput,			// operator <<(ostream&, const MyDate&)
+		count
+	};
+
+	static constexpr size_t counter_count = static_cast<size_t>(Counter::count);
+	static constexpr size_t operation_count = static_cast<size_t>(Operation::count);
+	static constexpr size_t bucket_count = 252;	// 0-7 ns exactly, then four buckets per power of two up to 2^64
+
+	/** Histogram
+	 *	The merged latencies of one operation.
+	 */
+	struct Histogram
+	{
+		uint64_t count = 0;		// operations recorded
+		uint64_t totalNs = 0;	// their total time
+		uint64_t maxNs = 0;		// the slowest
+		array<uint64_t, bucket_count> buckets{};	// operations by BucketOf() their time
+
+		/** Mean() / Percentile()
+		 *	@param fraction (double) - e.g. 0.99 for the 99th percentile
+		 *	@return (uint64_t) - nanoseconds; 0 if nothing was recorded
+		 */
+		uint64_t Mean() const { return count == 0 ? 0 : totalNs / count; }
+		uint64_t Percentile(double fraction) const;
+	};
+
+	/** Stats
+	 *	Every thread's counters added up by Collect().
+	 */
+	struct Stats
+	{
+		array<uint64_t, counter_count> counters{};
+		array<Histogram, operation_count> histograms{};
+		size_t threads = 0;		// threads that recorded anything, including those that have exited
+
+		uint64_t operator[](const Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+		const Histogram& operator[](const Operation operation) const { return histograms[static_cast<size_t>(operation)]; }
+	};
+
+	/** Count() / Record()
+	 *	Add to this thread's counters. Used through the macros below.
+	 *	@param counter (Counter) - what happened
+	 *	@param operation (Operation) - what was timed
+	 *	@param nanoseconds (uint64_t) - how long it took
+	 */
+	static void Count(Counter counter);
+	static void Record(Operation operation, uint64_t nanoseconds);
+
+	/** Collect()
+	 *	Adds up every thread's counters. Threads may keep recording while this
+	 *	runs; what they record meanwhile may or may not be included.
+	 *	@return (Stats) - the totals since the start or the last Reset()
+	 */
+	static Stats Collect();
+
+	/** Reset()
+	 *	Sets every thread's counters to zero. Anything a thread records while
+	 *	this runs may be lost.
+	 */
+	static void Reset();
+
+	/** WriteText() / WriteJson()
+	 *	Dump the totals as aligned text, or as one JSON object of the form
+	 *	{"threads": n, "counters": {"name": n, ...}, "operations": {"name":
+	 *	{"count": n, "mean_ns": n, "p50_ns": n, "p90_ns": n, "p99_ns": n,
+	 *	"max_ns": n, "buckets": [[upper_ns, n], ...]}, ...}}, where buckets
+	 *	lists only the buckets that are not empty.
+	 *	@param out (ostream&) - where to write
+	 *	@param stats (const Stats&) - the totals to write
+	 */
+	static void WriteText(ostream& out, const Stats& stats);
+	static void WriteJson(ostream& out, const Stats& stats);
+
+	/** Names
+	 *	@return (const char*) - the snake_case name the dumps use
+	 */
+	static const char* Name(Counter counter);
+	static const char* Name(Operation operation);
+
+	/** BucketOf() / BucketUpper()
+	 *	The histogram bucket of a time, and the largest time in a bucket.
+	 */
+	static size_t BucketOf(uint64_t nanoseconds);
+	static uint64_t BucketUpper(size_t bucket);
+
+	/** ScopedTimer
+	 *	Records the time from its construction to its destruction.
+	 */
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(const Operation operation) : myOperation(operation), myStart(chrono::steady_clock::now()) {}
+		~ScopedTimer() { Record(myOperation, static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - myStart).count())); }
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	private:
+		Operation myOperation;					// what is being timed
+		chrono::steady_clock::time_point myStart;	// when it started
+	};
+
+private:
+	/** ThreadStats
+	 *	One thread's counters. Only the owning thread writes them, with a
+	 *	relaxed load and store rather than a locked add; they are atomic so
+	 *	Collect() may read them from another thread.
+	 */
+	struct ThreadStats
+	{
+		struct Latencies
+		{
+			atomic<uint64_t> count{ 0 };
+			atomic<uint64_t> totalNs{ 0 };
+			atomic<uint64_t> maxNs{ 0 };
+			array<atomic<uint64_t>, bucket_count> buckets{};
+		};
+		array<atomic<uint64_t>, counter_count> counters{};
+		array<Latencies, operation_count> latencies{};
+	};
+
+	/** Registry
+	 *	The live threads' counters, and the totals of threads that have exited.
+	 */
+	struct Registry
+	{
+		mutex lock;					// guards both members
+		vector<ThreadStats*> live;	// owned by each thread's ThreadSlot
+		Stats retired;				// added up when a thread exits
+	};
+
+	/** ThreadSlot
+	 *	Registers a thread's counters the first time it records, and moves
+	 *	them into the retired totals when the thread exits.
+	 */
+	class ThreadSlot
+	{
+	public:
+		ThreadSlot();
+		~ThreadSlot();
+		ThreadStats& Counters() { return *myStats; }
+
+	private:
+		unique_ptr<ThreadStats> myStats;	// this thread's counters
+	};
+
+	static Registry& GetRegistry();
+	static ThreadStats& Local();
+	static void Add(Stats& totals, const ThreadStats& thread);
+	static void Bump(atomic<uint64_t>& counter, const uint64_t amount = 1) { counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed); }
+};
+
+/***************************************************************************
+ *	MACROS
+ *	LAB3_COUNT(Counter) counts one event. LAB3_COUNT_CONSTEXPR is the same
+ *	for constexpr functions: it does nothing while the compiler evaluates a
+ *	constant expression. LAB3_TIME(Operation) times the rest of the scope it
+ *	is in.
+ ***************************************************************************/
+
+#ifdef LAB3_INSTRUMENTATION
+#define LAB3_COUNT(counter) Instrumentation::Count(Instrumentation::Counter::counter)
+#define LAB3_COUNT_CONSTEXPR(counter) do { if (!__builtin_is_constant_evaluated()) LAB3_COUNT(counter); } while (false)
+#define LAB3_TIME(operation) const Instrumentation::ScopedTimer lab3ScopedTimer(Instrumentation::Operation::operation)
+#else
+#define LAB3_COUNT(counter) ((void)0)
+#define LAB3_COUNT_CONSTEXPR(counter) ((void)0)
+#define LAB3_TIME(operation) ((void)0)
+#endif
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // Instrumentation::Histogram::Percentile
+uint64_t Instrumentation::Histogram::Percentile(const double fraction) const
+{
+	if (count == 0)
+		return 0;
+	const auto rank = static_cast<uint64_t>(fraction * count + 0.5); // operations at or below the answer
+	uint64_t seen = 0;
+	for (size_t bucket = 0; bucket < bucket_count; bucket++)
+	{
+		seen += buckets[bucket];
+		if (seen >= rank && seen > 0)
+			return min(BucketUpper(bucket), maxNs);
+	}
+	return maxNs;
+}
+
+// Instrumentation::Count
+void Instrumentation::Count(const Counter counter)
+{
+	Bump(Local().counters[static_cast<size_t>(counter)]);
+}
+
+// Instrumentation::Record
+void Instrumentation::Record(const Operation operation, const uint64_t nanoseconds)
+{
+	auto& latencies = Local().latencies[static_cast<size_t>(operation)];
+	Bump(latencies.count);
+	Bump(latencies.totalNs, nanoseconds);
+	if (nanoseconds > latencies.maxNs.load(memory_order_relaxed))
+		latencies.maxNs.store(nanoseconds, memory_order_relaxed);
+	Bump(latencies.buckets[BucketOf(nanoseconds)]);
+}
+
+// Instrumentation::Collect
+Instrumentation::Stats Instrumentation::Collect()
+{
+	auto& registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	auto totals = registry.retired;
+	for (const auto* thread : registry.live)
+	{
+		Add(totals, *thread);
+		totals.threads++;
+	}
+	return totals;
+}
+
+// Instrumentation::Reset
+void Instrumentation::Reset()
+{
+	auto& registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	registry.retired = Stats();
+	for (auto* thread : registry.live)
+	{
+		for (auto& counter : thread->counters)
+			counter.store(0, memory_order_relaxed);
+		for (auto& latencies : thread->latencies)
+		{
+			latencies.count.store(0, memory_order_relaxed);
+			latencies.totalNs.store(0, memory_order_relaxed);
+			latencies.maxNs.store(0, memory_order_relaxed);
+			for (auto& bucket : latencies.buckets)
+				bucket.store(0, memory_order_relaxed);
+		}
+	}
+}
+
+// Instrumentation::WriteText
+void Instrumentation::WriteText(ostream& out, const Stats& stats)
+{
+	out << "threads " << stats.threads << "\n\n" << left << setw(24) << "counter" << right << setw(16) << "count" << "\n";
+	for (size_t counter = 0; counter < counter_count; counter++)
+		out << left << setw(24) << Name(static_cast<Counter>(counter)) << right << setw(16) << stats.counters[counter] << "\n";
+
+	out << "\n" << left << setw(24) << "operation" << right << setw(12) << "count" << setw(10) << "mean ns"
+		<< setw(10) << "p50 ns" << setw(10) << "p90 ns" << setw(10) << "p99 ns" << setw(12) << "max ns" << "\n";
+	for (size_t operation = 0; operation < operation_count; operation++)
+	{
+		const auto& histogram = stats.histograms[operation];
+		out << left << setw(24) << Name(static_cast<Operation>(operation)) << right << setw(12) << histogram.count
+			<< setw(10) << histogram.Mean() << setw(10) << histogram.Percentile(0.5) << setw(10) << histogram.Percentile(0.9)
+			<< setw(10) << histogram.Percentile(0.99) << setw(12) << histogram.maxNs << "\n";
+	}
+	out.flush();
+}
+
+// Instrumentation::WriteJson
+void Instrumentation::WriteJson(ostream& out, const Stats& stats)
+{
+	out << "{\"threads\": " << stats.threads << ", \"counters\": {";
+	for (size_t counter = 0; counter < counter_count; counter++)
+		out << (counter == 0 ? "" : ", ") << '"' << Name(static_cast<Counter>(counter)) << "\": " << stats.counters[counter];
+
+	out << "}, \"operations\": {";
+	for (size_t operation = 0; operation < operation_count; operation++)
+	{
+		const auto& histogram = stats.histograms[operation];
+		out << (operation == 0 ? "" : ", ") << '"' << Name(static_cast<Operation>(operation)) << "\": {\"count\": " << histogram.count
+			<< ", \"mean_ns\": " << histogram.Mean() << ", \"p50_ns\": " << histogram.Percentile(0.5)
+			<< ", \"p90_ns\": " << histogram.Percentile(0.9) << ", \"p99_ns\": " << histogram.Percentile(0.99)
+			<< ", \"max_ns\": " << histogram.maxNs << ", \"buckets\": [";
+		auto first = true; // no comma before the first bucket
+		for (size_t bucket = 0; bucket < bucket_count; bucket++)
+		{
+			if (histogram.buckets[bucket] == 0)
+				continue;
+			out << (first ? "" : ", ") << '[' << BucketUpper(bucket) << ", " << histogram.buckets[bucket] << ']';
+			first = false;
+		}
+		out << "]}";
+	}
+	out << "}}\n";
+	out.flush();
+}
+
+// Instrumentation::Name (counter)
+const char* Instrumentation::Name(const Counter counter)
+{
+	static const char* const names[counter_count] = { "to_day_number", "from_day_number", "string_stream", "stream_output",
+		"ticket_copy", "ticket_assign", "ticket_number_throw", "ticket_date_throw", "day_throw" };
+	return names[static_cast<size_t>(counter)];
+}
+
+// Instrumentation::Name (operation)
+const char* Instrumentation::Name(const Operation operation)
+{
+	static const char* const names[operation_count] = { "set_work_ticket", "ticket_string", "ticket_output", "date_string", "date_output" };
+	return names[static_cast<size_t>(operation)];
+}
+
+// Instrumentation::BucketOf
+size_t Instrumentation::BucketOf(const uint64_t nanoseconds)
+{
+	if (nanoseconds < 8)
+		return static_cast<size_t>(nanoseconds);
+#ifdef _MSC_VER
+	unsigned long highBit;
+	_BitScanReverse64(&highBit, nanoseconds);
+#else
+	const auto highBit = 63 - __builtin_clzll(nanoseconds);
+#endif
+	// the power of two, then which quarter of it
+	return 8 + (static_cast<size_t>(highBit) - 3) * 4 + static_cast<size_t>((nanoseconds >> (highBit - 2)) & 3);
+}
+
+// Instrumentation::BucketUpper
+uint64_t Instrumentation::BucketUpper(const size_t bucket)
+{
+	if (bucket < 8)
+		return bucket;
+	const auto highBit = (bucket - 8) / 4 + 3;		// the power of two
+	const auto quarter = (bucket - 8) % 4;			// which quarter of it
+	const auto width = uint64_t(1) << (highBit - 2);	// times in the bucket
+	return ((4 + quarter) << (highBit - 2)) + (width - 1);
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // Instrumentation::ThreadSlot::Constructor
+Instrumentation::ThreadSlot::ThreadSlot() : myStats(new ThreadStats())
+{
+	auto& registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	registry.live.push_back(myStats.get());
+}
+
+// Instrumentation::ThreadSlot::Destructor
+Instrumentation::ThreadSlot::~ThreadSlot()
+{
+	auto& registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	Add(registry.retired, *myStats);
+	registry.retired.threads++;
+	registry.live.erase(find(registry.live.begin(), registry.live.end(), myStats.get()));
+}
+
+// Instrumentation::GetRegistry
+Instrumentation::Registry& Instrumentation::GetRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+// Instrumentation::Local
+Instrumentation::ThreadStats& Instrumentation::Local()
+{
+	static thread_local ThreadSlot slot; // registered on this thread's first use
+	return slot.Counters();
+}
+
+// Instrumentation::Add
+void Instrumentation::Add(Stats& totals, const ThreadStats& thread)
+{
+	for (size_t counter = 0; counter < counter_count; counter++)
+		totals.counters[counter] += thread.counters[counter].load(memory_order_relaxed);
+	for (size_t operation = 0; operation < operation_count; operation++)
+	{
+		const auto& latencies = thread.latencies[operation];
+		auto& histogram = totals.histograms[operation];
+		histogram.count += latencies.count.load(memory_order_relaxed);
+		histogram.totalNs += latencies.totalNs.load(memory_order_relaxed);
+		histogram.maxNs = max(histogram.maxNs, latencies.maxNs.load(memory_order_relaxed));
+		for (size_t bucket = 0; bucket < bucket_count; bucket++)
+			histogram.buckets[bucket] += latencies.buckets[bucket].load(memory_order_relaxed);
+	}
+}
+
+#endif
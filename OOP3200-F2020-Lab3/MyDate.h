@@ -25,12 +25,29 @@
 #include <sstream>		// for stringstream
 #include <stdexcept>	// for standard exceptions
 #include <ctime>		// for time related items
+#include <charconv>		// for to_chars_result
+#include <cstdio>		// for snprintf
+#include <cstring>		// for memcpy and strlen
+#include <string_view>	// for string_view
+#include "ValidationError.h"	// for non-throwing validation
+#include "Instrumentation.h"	// for LAB3_COUNT and LAB3_TIME
 using namespace std;
 
 class MyDate
 {
 public:
 
+	/** Format
+	 *	The text formats a date can be written in by ToChars().
+	 *	Short	- dd/mm/yyyy, the format operator << uses
+	 *	Iso		- yyyy-mm-dd (ISO-8601)
+	 *	Long	- e.g. "Saturday, October 17th, 2020", the format operator string uses
+	 */
+	enum class Format { Short, Iso, Long };
+
+	// the most characters ToChars() writes, e.g. "Wednesday, September 30th, 9999"
+	static constexpr size_t max_format_length = 32;
+
 	/***************************************************************************
 	*	CONSTRUCTORS
 	***************************************************************************/
@@ -38,7 +55,7 @@ public:
 	/** Default Constructor
 	 *	Initializes the day/month/year fields to 1/1/2000.
 	 */
-	MyDate() :myDay(1), myMonth(1), myYear(2000) {}
+	constexpr MyDate() :myDay(1), myMonth(1), myYear(2000) {}
 
 	/** Parametrized Constructor
 	 *	Sets the day/month/year fields to parameters.
@@ -46,13 +63,19 @@ public:
 	 *	@param month (int) - the month to set to
 	 *	@param year (int) - the year to set to
 	 */
-	MyDate(const int day, const int month, const int year) { MyDate::SetDate(day, month, year); }
+	constexpr MyDate(const int day, const int month, const int year) : myDay(1), myMonth(1), myYear(1)
+	{
+		// same as MyDate::SetDate(), which is virtual and cannot be constexpr
+		SetYear(year);
+		SetMonth(month);
+		SetDay(day);
+	}
 
 	/** Copy Constructor
 	 *	Sets the day/month/year fields to an existing objects day/month/year fields.
 	 *	@param copy (MyDate) - the existing object to copy
 	 */
-	MyDate(const MyDate& copy) : myDay(copy.myDay), myMonth(copy.myMonth), myYear(copy.myYear) {}
+	constexpr MyDate(const MyDate& copy) : myDay(copy.myDay), myMonth(copy.myMonth), myYear(copy.myYear) {}
 
 	/** Long Constructor
 	 *	Sets the day/month/year fields from a long. Also used to
@@ -60,7 +83,7 @@ public:
 	 *	@param days_since (long) - the days since 1/1/0001
 	 *	@throws (out_of_range) if the parameter is < 1.
 	 */
-	MyDate(long days_since);
+	constexpr MyDate(long days_since);
 
 	/***************************************************************************
 	*	PUBLIC MUTATORS
@@ -80,9 +103,9 @@ public:
 	 *	@param (int) - the value to set to
 	 *	@throws (out_of_range) if the parameter is out of a valid range
 	 */
-	void SetYear(int year);
-	void SetMonth(int month);
-	void SetDay(int day);
+	constexpr void SetYear(int year);
+	constexpr void SetMonth(int month);
+	constexpr void SetDay(int day);
 
 	/***************************************************************************
 	*	PUBLIC ACCESSORS
@@ -92,7 +115,7 @@ public:
 	 *	Determines if the year stored in the object is a leap year.
 	 *	@return (bool) - true for leap year, false for non-leap year.
 	 */
-	bool IsLeapYear() const { return IsLeapYear(myYear); }
+	constexpr bool IsLeapYear() const { return IsLeapYear(myYear); }
 
 	/** GetDayOfWeek()
 	 *	Returns the day of the week the date stored in the object is.
@@ -104,9 +127,16 @@ public:
 	 *	Gets the value stored in the corresponding.
 	 *	@return (int) - the value stored in the field
 	 */
-	int GetMonth() const { return myMonth; }
-	int GetYear() const { return myYear; }
-	int GetDay() const { return myDay; }
+	constexpr int GetMonth() const { return myMonth; }
+	constexpr int GetYear() const { return myYear; }
+	constexpr int GetDay() const { return myDay; }
+
+	/** GetDayNumber()
+	 *	Returns the date as a day number. Same as operator long(), which is
+	 *	virtual and therefore cannot be used in constant expressions.
+	 *	@return (long) - the number of days since 1/1/0001
+	 */
+	constexpr long GetDayNumber() const { return DayNumber(myDay, myMonth, myYear); }
 
 	/***************************************************************************
 	*	STATIC METHODS
@@ -115,7 +145,101 @@ public:
 	 *	Determines if the year passed as a parameter is a leap year.
 	 *	@return (bool) - true for leap year, false for non-leap year.
 	 */
-	static bool IsLeapYear(int year);
+	static constexpr bool IsLeapYear(int year);
+
+	/** DaysInMonth(int, int)
+	 *	Returns the number of days in a month, allowing for leap years.
+	 *	@param month (int) - the month (1-12)
+	 *	@param year (int) - the year the month is in
+	 *	@return (int) - the highest valid day of that month, e.g. 31
+	 */
+	static constexpr int DaysInMonth(const int month, const int year) { return (month == 2 && IsLeapYear(year)) ? 29 : day_limits[month]; }
+
+	/** DayNumber(int, int, int)
+	 *	Converts a day/month/year to the number of days since 1/1/0001 in
+	 *	constant time. The year is shifted to start in March so the leap day
+	 *	falls at the end of it, then whole 400 year eras (146097 days) are
+	 *	counted separately from the days within the era.
+	 *	@param day (int) - the day of the month
+	 *	@param month (int) - the month (1-12)
+	 *	@param year (int) - the year (1+)
+	 *	@return (long) - the day number; 1/1/0001 is day 1
+	 */
+	static constexpr long DayNumber(const int day, const int month, const int year)
+	{
+		LAB3_COUNT_CONSTEXPR(ToDayNumber);
+		const long shifted_year = year - (month <= 2 ? 1 : 0);	// year starting 1 March
+		const long era = shifted_year / 400;						// 400 year era
+		const long year_of_era = shifted_year - era * 400;			// [0, 399]
+		const long day_of_year = (153L * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // [0, 365]
+		const long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year; // [0, 146096]
+
+		// 1/1/0001 is 306 days after 1/3/0000
+		return era * 146097 + day_of_era - 305;
+	}
+
+	/** FromDayNumber(long, int&, int&, int&)
+	 *	The inverse of DayNumber(); splits a number of days since 1/1/0001
+	 *	into a day/month/year in constant time.
+	 *	@param day_number (long) - the days since 1/1/0001 (1+)
+	 *	@param day (int by ref) - stores the day of the month
+	 *	@param month (int by ref) - stores the month
+	 *	@param year (int by ref) - stores the year
+	 */
+	static constexpr void FromDayNumber(const long day_number, int& day, int& month, int& year)
+	{
+		LAB3_COUNT_CONSTEXPR(FromDayNumber);
+		const long days = day_number + 305;							// days since 1/3/0000
+		const long era = days / 146097;								// 400 year era
+		const long day_of_era = days - era * 146097;				// [0, 146096]
+		const long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365; // [0, 399]
+		const long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100); // [0, 365]
+		const long shifted_month = (5 * day_of_year + 2) / 153;		// [0, 11], March is 0
+
+		day = static_cast<int>(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+		month = static_cast<int>(shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+		year = static_cast<int>(year_of_era + era * 400 + (month <= 2 ? 1 : 0));
+	}
+
+	/** Validation
+	 *	Check values without throwing. Each returns the error the matching
+	 *	mutator or constructor would throw, or an Ok error if it would not.
+	 *	ValidateDay() assumes the month and year are valid; Validate() checks
+	 *	the year, then the month, then the day, as SetDate() does.
+	 *	@return (ValidationError) - the result
+	 */
+	static constexpr ValidationError ValidateYear(const int year)
+	{
+		return year >= 1 && year <= 9999 ? ValidationError() : ValidationError(ValidationCode::InvalidYear, year);
+	}
+	static constexpr ValidationError ValidateMonth(const int month)
+	{
+		return month >= 1 && month <= 12 ? ValidationError() : ValidationError(ValidationCode::InvalidMonth, month);
+	}
+	static constexpr ValidationError ValidateDay(const int day, const int month, const int year)
+	{
+		return day >= 1 && day <= DaysInMonth(month, year) ? ValidationError()
+			: ValidationError(ValidationCode::InvalidDay, day, month_names[month], year, DaysInMonth(month, year));
+	}
+	static constexpr ValidationError ValidateDayNumber(const long day_number)
+	{
+		return day_number >= 1L && day_number <= 3652059L ? ValidationError() : ValidationError(ValidationCode::InvalidDayNumber, day_number);
+	}
+	static constexpr ValidationError Validate(const int day, const int month, const int year)
+	{
+		const auto yearError = ValidateYear(year);
+		if (!yearError.Ok())
+			return yearError;
+		const auto monthError = ValidateMonth(month);
+		return monthError.Ok() ? ValidateDay(day, month, year) : monthError;
+	}
+
+	/** TryMake()
+	 *	Makes a date without throwing.
+	 *	@return (Expected<MyDate>) - the date, or why the parameters are not a valid date
+	 */
+	static Expected<MyDate> TryMake(int day, int month, int year);
+	static Expected<MyDate> TryMake(long day_number);
 
 	/** Today()
 	 *	Returns the current date as a MyDate object.
@@ -132,54 +256,54 @@ public:
 	 *	@param  days (int) - the number of days to add
 	 *	@return (MyDate) - the new date.
 	 */
-	MyDate operator+(int days) const;
+	constexpr MyDate operator+(int days) const;
 
 	/** operator - (int) (Subtract days)
 	 *	Subtracts a specified number of days from this date and returns it.
 	 *	@param  days (int) - the number of days to subtract
 	 *	@return (MyDate) - the new date.
 	 */
-	MyDate operator-(int days) const;
+	constexpr MyDate operator-(int days) const;
 
 	/** operator - (MyDate) (Subtract a MyDate) **NEW!**
 	 *	Subtracts a specified date from this date and returns it.
 	 *	@param  aDate (MyDate) - the number of days to subtract
 	 *	@return (long) - the number of days difference.
 	 */
-	long operator-(const MyDate& aDate) const { return static_cast<long>(*(this)) - static_cast<long>(aDate); }
+	constexpr long operator-(const MyDate& aDate) const { return GetDayNumber() - aDate.GetDayNumber(); }
 
 	/** operator = (Assignment)
 	 *	Assigns the member values of a specified date to this date.
 	 *	@param  copy (MyDate by const ref) - the date being compared to
 	 *	@return (MyDate by ref) - returns this date
 	 */
-	MyDate& operator=(const MyDate& copy);
+	constexpr MyDate& operator=(const MyDate& copy);
 
 	/** operator -= (Shorthand Subtract Assignment)
 	 *	Subtracts a specified number of days from this date.
 	 *	@param  days (int) - the number of days to subtract
 	 *	@return (MyDate by ref) - this date.
 	 */
-	MyDate& operator-=(const int days) { return *(this) = *(this) - days; }
+	constexpr MyDate& operator-=(const int days) { return *(this) = *(this) - days; }
 
 	/** operator += (Shorthand Addition Assignment)
 	 *	Adds a specified number of days to this date.
 	 *	@param  days (int) - the number of days to subtract
 	 *	@return (MyDate by ref) - this date.
 	 */
-	MyDate& operator+=(const int days) { return *(this) = *(this) + days; }
+	constexpr MyDate& operator+=(const int days) { return *(this) = *(this) + days; }
 
 	/** operator ++ (Prefix Increment)
 	 *	Adds one day to this date.
 	 *	@return (MyDate by ref) - this date.
 	 */
-	MyDate& operator++() { return *(this) = *(this) + 1; }
+	constexpr MyDate& operator++() { return *(this) = *(this) + 1; }
 
 	/** operator ++ (Postfix Increment)
 	 *	Adds one day to this date.
 	 *	@return (MyDate) - the original date.
 	 */
-	MyDate operator++(int)
+	constexpr MyDate operator++(int)
 	{
 		MyDate original_date = *(this); // copy this date
 		*(this) = *(this) + 1; // modify this date
@@ -190,13 +314,13 @@ public:
 	 *	Subtracts one day from this date.
 	 *	@return (MyDate by ref) - this date.
 	 */
-	MyDate& operator--() { return *(this) = *(this) - 1; }
+	constexpr MyDate& operator--() { return *(this) = *(this) - 1; }
 
 	/** operator -- (Postfix Increment)
 	 *	Subtracts one day from this date.
 	 *	@return (MyDate) - the original date.
 	 */
-	MyDate operator--(int)
+	constexpr MyDate operator--(int)
 	{
 		auto original_date = *(this); // copy this date
 		*(this) = *(this) - 1; // modify this date
@@ -208,7 +332,7 @@ public:
 	 *	@param  compare (MyDate by const ref) - the date being compared to
 	 *	@return (bool) - true if the dates are the same, false if not
 	 */
-	bool operator==(const MyDate& compare) const
+	constexpr bool operator==(const MyDate& compare) const
 	{
 		return (myDay == compare.myDay &&
 			myMonth == compare.myMonth &&
@@ -220,7 +344,7 @@ public:
 	 *	@param  compare (MyDate by const ref) - the date being compared to
 	 *	@return (bool) - false if the dates are the same, true if not
 	 */
-	bool operator!=(const MyDate& compare) const
+	constexpr bool operator!=(const MyDate& compare) const
 	{
 		return (!(myDay == compare.myDay &&
 			myMonth == compare.myMonth &&
@@ -232,28 +356,28 @@ public:
 	 *	@param  compare (MyDate by const ref) - the date being compared to
 	 *	@return (bool) - returns true if this date is < the parameter date, false if not
 	 */
-	bool operator<(const MyDate& compare) const { return static_cast<long>(*this) < static_cast<long>(compare); }
+	constexpr bool operator<(const MyDate& compare) const { return GetDayNumber() < compare.GetDayNumber(); }
 
 	/** operator > (Greater than)
 	 *	Compares two dates
 	 *	@param  compare (MyDate by const ref) - the date being compared to
 	 *	@return (bool) - returns true if this date is > the parameter date, false if not
 	 */
-	bool operator>(const MyDate& compare) const { return static_cast<long>(*this) > static_cast<long>(compare); }
+	constexpr bool operator>(const MyDate& compare) const { return GetDayNumber() > compare.GetDayNumber(); }
 
 	/** operator <= (Less than or equal to)
 	 *	Compares two dates
 	 *	@param  compare (MyDate by const ref) - the date being compared to
 	 *	@return (bool) - returns true if this date is <= the parameter date, false if not
 	 */
-	bool operator<=(const MyDate& compare) const { return static_cast<long>(*this) <= static_cast<long>(compare); }
+	constexpr bool operator<=(const MyDate& compare) const { return GetDayNumber() <= compare.GetDayNumber(); }
 
 	/** operator > (Greater than or equal to)
 	 *	Compares two dates
 	 *	@param  compare (MyDate by const ref) - the date being compared to
 	 *	@return (bool) - returns true if this date is >= the parameter date, false if not
 	 */
-	bool operator>=(const MyDate& compare) const { return static_cast<long>(*this) >= static_cast<long>(compare); }
+	constexpr bool operator>=(const MyDate& compare) const { return GetDayNumber() >= compare.GetDayNumber(); }
 
 
 	/** operator (long) (Typecast)
@@ -268,12 +392,23 @@ public:
 	 */
 	virtual operator string() const;
 
+	/** ToChars()
+	 *	Writes the date into a caller-supplied buffer without allocating, in the
+	 *	manner of std::to_chars. No terminating null is written.
+	 *	@param  first (char*) - the start of the buffer
+	 *	@param  last (char*) - one past the end of the buffer
+	 *	@param  format (Format) - the format to write; defaults to dd/mm/yyyy
+	 *	@return (to_chars_result) - one past the last character written and errc(),
+	 *	                            or last and errc::value_too_large if the buffer is too small
+	 */
+	to_chars_result ToChars(char* first, char* last, Format format = Format::Short) const;
+
 	/** operator [char] (Subscript)
 	 *	Returns the day, month or year value depending on the parameter specified
 	 *  @param  value_type (char) - 'd' for day, 'm' for month, 'y' for year
 	 *	@return (int) - the day, month or year value
 	 */
-	int operator[](char value_type) const;
+	constexpr int operator[](char value_type) const;
 
 	/***************************************************************************
 	*	OPERATOR FRIENDS (NEW!)
@@ -306,154 +441,65 @@ protected: //**NEW!**
 /***************************************************************************
 *	PRIVATE STATIC DATA MEMBERS
 ***************************************************************************/
-	static const int day_limits[];		// the limit of the day based on the month, e.g. 31
-	static const string month_names[];	// the month names e.g. "January"
-	static const string days_of_week[];	// the day of week names e.g. "Sunday"
-}; // End of MyDate class declaration section
+	// the limit of the day based on the month, e.g. 31. Index 0 not used.
+	static constexpr int day_limits[] = { -1, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	// the month names e.g. "January"
+	static constexpr const char* month_names[] = { "Not Used", "January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December" };
+	// the day of week names e.g. "Sunday"
+	static constexpr const char* days_of_week[] = { "Not Used", "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
 
 /***************************************************************************
- *	STATIC DATA MEMBER DEFINITIONS
- ***************************************************************************/
-
-const int MyDate::day_limits[] = { -1, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 }; // Index 0 not used.
-
-const string MyDate::month_names[] = { "Not Used", "January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December" };
-
-const string MyDate::days_of_week[] = { "Not Used", "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+*	PRIVATE STATIC METHODS
+***************************************************************************/
+	/** WriteDigits()
+	 *	Writes a non-negative value padded with zeros to a minimum width.
+	 *	@return (char*) - one past the last digit written
+	 */
+	static char* WriteDigits(char* out, int value, int width);
+}; // End of MyDate class declaration section
 
 /***************************************************************************
  *	CONSTRUCTOR DEFINITIONS
  ***************************************************************************/
  // MyDate(long) definition
-MyDate::MyDate(const long day_number)
+constexpr MyDate::MyDate(const long day_number) : myDay(1), myMonth(1), myYear(1)
 {
-	const auto last_day = 3652059L; // 31 Dec 9999
-
-	// if the parameter is valid
-	if (day_number >= 1L && day_number <= last_day)
-	{
-		// Local variables
-		auto day = 1;	// temporary day
-		auto month = 1;	// temporary month
-		auto year = 1;	// temporary year
-		int day_limit;	// the highest day of any given month
-
-		// Loop from 1 to the parameter 
-		for (int i = 1; i < day_number; i++)
-		{
-			// determine the highest day for the current month
-			day_limit = day_limits[month];
-			// adjust if it is a leap year and Feb
-			if (IsLeapYear(year) && month == 2)
-			{
-				day_limit = 29;
-			}
+	// throw if the parameter is not between 1/1/0001 and 31/12/9999
+	ValidateDayNumber(day_number).ThrowIfError();
 
-			// increase the day counter by 1
-			day++;
-
-			// if the day counter exceeded the limit for this month:
-			if (day > day_limit)
-			{
-				month++; // roll to the next month
-				day = 1; // reset to the 1st
-
-				// if the month counter exceeded December (12)
-				if (month > 12)
-				{
-					year++; // roll to the next year
-					month = 1; // reset to Jan (1)
-				}
-			} // end of adjustment for roll-over
-		} // end of counting up to parameter
-
-		// Sets the fields to the day/month/year counters
-		myDay = day;
-		myMonth = month;
-		myYear = year;
-	}
-	else // Otherwise, parameter was not valid
-	{
-		// Build an error string
-		stringstream errorMessage;
-		errorMessage << day_number << " is an invalid value for a day number.\nValue must be greater than 0.";
-		// throw exception
-		throw out_of_range(errorMessage.str());
-	}
+	// Sets the fields directly from the day number
+	FromDayNumber(day_number, myDay, myMonth, myYear);
 }
 
 /***************************************************************************
  *	MUTATOR DEFINITIONS
  ***************************************************************************/
  // MyDate::SetYear 
-void MyDate::SetYear(const int year)
+constexpr void MyDate::SetYear(const int year)
 {
-	const auto max_year = 9999; // max possible year
-	const auto min_year = 1; // min possible year
-
-	// if the year is in range
-	if (year >= min_year && year <= max_year)
-	{
-		myYear = year; // set the year field
-	}
-	else // otherwise
-	{
-		// Build an error msg
-		stringstream errorMessage;
-		errorMessage << year << " is an invalid value for year.\nValue must be between "
-			<< setfill('0') << setw(4) << min_year << " and "
-			<< setw(4) << max_year << " inclusive.";
-		// throw an exception
-		throw out_of_range(errorMessage.str());
-	}
+	// throw if the year is out of range
+	ValidateYear(year).ThrowIfError();
+	myYear = year; // set the year field
 }
 // MyDate::SetMonth
-void MyDate::SetMonth(int month)
+constexpr void MyDate::SetMonth(int month)
 {
-	const auto max_month = 12; // max possible month
-	const auto min_month = 1; // min possible month	
-
-	// if the month is in range
-	if (month >= min_month && month <= max_month)
-	{
-		myMonth = month; // set the month field
-	}
-	else // otherwise
-	{
-		// Build an error msg
-		stringstream errorMessage;
-		errorMessage << month << " is an invalid value for month.\nValue must be between "
-			<< min_month << " and " << max_month << " inclusive.";
-		// throw an exception
-		throw out_of_range(errorMessage.str());
-	}
+	// throw if the month is out of range
+	ValidateMonth(month).ThrowIfError();
+	myMonth = month; // set the month field
 }
 
 // MyDate::SetDay
-void MyDate::SetDay(const int day)
+constexpr void MyDate::SetDay(const int day)
 {
-	const auto min_day = 1;// min possible day
-	auto max_day = day_limits[myMonth]; // max possible day (depends on month)
-
-	// if it is Feb and a leap year
-	if (IsLeapYear() && myMonth == 2)
-		max_day = 29; // set the max to 29
-
-	// if the day is in range
-	if (day >= min_day && day <= max_day)
+	// throw if the day is out of range (depends on month and leap year)
+	const auto error = ValidateDay(day, myMonth, myYear);
+	if (!error.Ok())
 	{
-		myDay = day; // set the day field
-	}
-	else // otherwise
-	{
-		// Build an error msg
-		stringstream errorMessage;
-		errorMessage << day << " is an invalid value for a day in " << month_names[myMonth] << " "
-			<< setfill('0') << setw(4) << myYear << ".\nValue must be between "
-			<< min_day << " and " << max_day << " inclusive.";
-		// throw an exception
-		throw out_of_range(errorMessage.str());
+		LAB3_COUNT_CONSTEXPR(DayThrow);
+		error.Throw();
 	}
+	myDay = day; // set the day field
 }
 
 
@@ -468,7 +514,7 @@ void MyDate::SetDay(const int day)
   ***************************************************************************/
 
   // MyDate::IsLeapYear(int)
-bool MyDate::IsLeapYear(const int year)
+constexpr bool MyDate::IsLeapYear(const int year)
 {
 	/*
 	In the Gregorian calendar 3 criteria must be taken into account to identify leap years:
@@ -501,13 +547,35 @@ bool MyDate::IsLeapYear(const int year)
 	return leapYear;
 }
 
+// MyDate::TryMake (day, month, year)
+Expected<MyDate> MyDate::TryMake(const int day, const int month, const int year)
+{
+	const auto error = Validate(day, month, year);
+	if (!error.Ok())
+		return error;
+	return MyDate(day, month, year); // will not throw
+}
+
+// MyDate::TryMake (day number)
+Expected<MyDate> MyDate::TryMake(const long day_number)
+{
+	const auto error = ValidateDayNumber(day_number);
+	if (!error.Ok())
+		return error;
+	return MyDate(day_number); // will not throw
+}
+
 // MyDate::Today() definition
 MyDate MyDate::Today()
 {
 	MyDate today; // the object to set to today and return
 	auto the_time = time(nullptr); // get the current time/date
 	tm time_structure{};
+#ifdef _WIN32
 	localtime_s(&time_structure, &the_time); // convert to a tm structure
+#else
+	localtime_r(&the_time, &time_structure); // the POSIX form, arguments reversed
+#endif
 	today.myDay = time_structure.tm_mday; // set the day
 	today.myMonth = time_structure.tm_mon + 1; // set the month (tm_mon is months from Jan <0-11>)
 	today.myYear = time_structure.tm_year + 1900; // set the year (tm_year is years since 1900)
@@ -520,27 +588,27 @@ MyDate MyDate::Today()
  ***************************************************************************/
 
  // operator + (Addition)
-MyDate MyDate::operator+(const int days) const
+constexpr MyDate MyDate::operator+(const int days) const
 {
 	MyDate newDate; // create a new empty date
-	long thisDateNumber = static_cast<long>(*this); // store this date as a long
+	long thisDateNumber = GetDayNumber(); // store this date as a long
 	thisDateNumber += days; // add the number of days to it
-	newDate = static_cast<MyDate>(thisDateNumber); // set the new date based on the long
+	newDate = MyDate(thisDateNumber); // set the new date based on the long
 	return newDate; // return the new date
 }
 
 // operator - (Subtraction)
-MyDate MyDate::operator-(int days) const
+constexpr MyDate MyDate::operator-(int days) const
 {
 	MyDate newDate; // create a new empty date
-	long thisDateNumber = static_cast<long>(*this); // store this date as a long
+	long thisDateNumber = GetDayNumber(); // store this date as a long
 	thisDateNumber -= days; // subtract the number of days from it
-	newDate = static_cast<MyDate>(thisDateNumber); // set the new date based on the long
+	newDate = MyDate(thisDateNumber); // set the new date based on the long
 	return newDate; // return the new date
 }
 
 // operator = (Assignment)
-MyDate& MyDate::operator=(const MyDate& copy)
+constexpr MyDate& MyDate::operator=(const MyDate& copy)
 {
 	// assign each member the corresponding 
 	// member from the copy object
@@ -551,82 +619,91 @@ MyDate& MyDate::operator=(const MyDate& copy)
 	return *(this);
 }
 
-// MyDate::operator string definition		
+// MyDate::operator string definition
 MyDate::operator string() const
 {
-	stringstream dateString; // string stream to build the formatted date string
-	int postFixDigit;		 // the last digit of the day value
+	LAB3_TIME(DateString);
+	char buffer[max_format_length];	// the formatted date
+	const auto result = ToChars(buffer, buffer + max_format_length, Format::Long);
 
-	// Stream the day of the week, followed by month name and day value 
-	dateString << GetDayOfWeek() << ", " << month_names[myMonth] << " " << myDay;
+	// return the formatted string
+	return string(buffer, result.ptr);
+}
 
-	// determine the last digit of the day value
-	postFixDigit = myDay % 10;
+// MyDate::ToChars definition
+to_chars_result MyDate::ToChars(char* first, char* last, const Format format) const
+{
+	char buffer[max_format_length];	// the formatted date
+	char* out = buffer;				// the next character to write
 
-	// determine and stream the approriate post-fix
-	if (postFixDigit == 1 && myDay != 11)
-	{
-		dateString << "st";
-	}
-	else if (postFixDigit == 2 && myDay != 12)
+	switch (format)
 	{
-		dateString << "nd";
-	}
-	else if (postFixDigit == 3 && myDay != 13)
+	case Format::Iso: // yyyy-mm-dd
+		out = WriteDigits(out, myYear, 4);
+		*out++ = '-';
+		out = WriteDigits(out, myMonth, 2);
+		*out++ = '-';
+		out = WriteDigits(out, myDay, 2);
+		break;
+	case Format::Long: // e.g. Saturday, October 17th, 2020
 	{
-		dateString << "rd";
+		const char* dayName = days_of_week[GetDayNumber() % 7 + 1];
+		const char* monthName = month_names[myMonth];
+		const char* postFix = "th"; // the post-fix for the day value
+		const int postFixDigit = myDay % 10; // the last digit of the day value
+
+		// determine the approriate post-fix
+		if (postFixDigit == 1 && myDay != 11)
+			postFix = "st";
+		else if (postFixDigit == 2 && myDay != 12)
+			postFix = "nd";
+		else if (postFixDigit == 3 && myDay != 13)
+			postFix = "rd";
+
+		// the day of the week, followed by month name and day value
+		memcpy(out, dayName, strlen(dayName));
+		out += strlen(dayName);
+		*out++ = ',';
+		*out++ = ' ';
+		memcpy(out, monthName, strlen(monthName));
+		out += strlen(monthName);
+		*out++ = ' ';
+		out = WriteDigits(out, myDay, 1);
+		*out++ = postFix[0];
+		*out++ = postFix[1];
+
+		// the year, showing 4 digits (minimum)
+		*out++ = ',';
+		*out++ = ' ';
+		out = WriteDigits(out, myYear, 4);
+		break;
 	}
-	else
-	{
-		dateString << "th";
+	default: // dd/mm/yyyy
+		out = WriteDigits(out, myDay, 2);
+		*out++ = '/';
+		out = WriteDigits(out, myMonth, 2);
+		*out++ = '/';
+		out = WriteDigits(out, myYear, 4);
+		break;
 	}
 
-	// stream the year, showing 4 digits (minimum) 
-	dateString << ", " << setfill('0') << setw(4) << myYear;
-
-	// return the formatted string
-	return dateString.str();
+	// copy to the caller's buffer if it fits
+	const auto length = out - buffer;
+	if (length > last - first)
+		return { last, errc::value_too_large };
+	memcpy(first, buffer, length);
+	return { first + length, errc() };
 }
 
 // MyDate::operator long definition
 MyDate::operator long() const
 {
-	long dayNumber = 0; // counter for the days since 1/1/0001
-	int leapYears = 0;	// counter for the leap years since 1/1/0001
-
-	// Add 365 for each year up to but not including this year
-	dayNumber = (myYear - 1) * 365;
-
-	// Count the leap years up to but not including this year
-	for (int year = 1; year < myYear; year++)
-	{
-		if (IsLeapYear(year))
-			leapYears++;
-	}
-	// Add 1 more day for each leap year found
-	dayNumber += leapYears;
-
-	// Add the number of days in each month for each month of this year
-	// up to but not including this month
-	for (int i = 1; i < myMonth; i++)
-	{
-		dayNumber += day_limits[i];
-	}
-	// Add the days for this month
-	dayNumber += myDay;
-
-	// if this is a leap year and it is past 28 Feb
-	if (IsLeapYear() && myMonth > 2)
-	{
-		dayNumber++;
-	}
-
-	// return the sum.
-	return dayNumber;
+	// return the days since 1/1/0001
+	return GetDayNumber();
 }
 
 // operator [char] (Subscript)
-int MyDate::operator[](const char value_type) const
+constexpr int MyDate::operator[](const char value_type) const
 {
 	int value = 0; // value to return
 	switch (value_type) // based on the parameter char
@@ -644,23 +721,46 @@ int MyDate::operator[](const char value_type) const
 		value = myYear; // get year
 		break;
 	default: // error, throw invalid_argument exception
-		// Build an error msg
-		stringstream errorMessage;
-		errorMessage << value_type << " is an invalid parameter. Options are \'d\', \'m\', or \'y\'";
-		// throw an exception
-		throw invalid_argument(errorMessage.str());
+		ValidationError(ValidationCode::InvalidSubscript, value_type).Throw();
 	}
 	return value;
 }
 
+/***************************************************************************
+ *	PRIVATE STATIC METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // MyDate::WriteDigits
+char* MyDate::WriteDigits(char* out, int value, const int width)
+{
+	char digits[10];	// the digits in reverse order
+	int count = 0;		// the number of digits
+
+	do
+	{
+		digits[count++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	// pad with zeros, then write the digits in order
+	for (int i = count; i < width; i++)
+		*out++ = '0';
+	while (count > 0)
+		*out++ = digits[--count];
+	return out;
+}
+
 // operator << (Insertion/Output)
 ostream& operator<<(ostream& out, const MyDate& the_date)
 {
-	// output the date in the format dd/mm/yyyy
-	out << setfill('0')
-		<< setw(2) << the_date.myDay << '/'
-		<< setw(2) << the_date.myMonth << '/'
-		<< setw(4) << the_date.myYear << setfill(' ');
+	LAB3_TIME(DateOutput);
+	LAB3_COUNT(StreamOutput);
+
+	// output the date in the format dd/mm/yyyy; as a string_view, it is padded to
+	// the stream's width() with its fill() and adjustment, and width() is reset
+	char buffer[MyDate::max_format_length];
+	const auto result = the_date.ToChars(buffer, buffer + MyDate::max_format_length);
+	out << string_view(buffer, static_cast<size_t>(result.ptr - buffer));
 	return out;  // return the output stream
 }
 
@@ -691,4 +791,50 @@ istream& operator>>(istream& in, MyDate& the_date)
 	return in; // return the input stream
 }
 
+/***************************************************************************
+ *	USER-DEFINED LITERAL
+ ***************************************************************************/
+
+#if defined(__cpp_consteval)
+#define MY_DATE_LITERAL consteval	// always evaluated at compile time
+#else
+#define MY_DATE_LITERAL constexpr	// evaluated at compile time in constant expressions
+#endif
+
+/** operator "" _date (Date Literal)
+ *	Builds a MyDate from an ISO-8601 literal, e.g. "2020-10-17"_date.
+ *	An invalid literal used to initialize a constexpr variable (or any literal
+ *	when compiled as C++20) fails to compile; otherwise it throws at run time.
+ *	@param  text (const char*) - the literal, formatted yyyy-mm-dd
+ *	@param  length (size_t) - the length of the literal
+ *	@return (MyDate) - the date
+ *	@throws (invalid_argument) if the literal is not formatted yyyy-mm-dd
+ *	@throws (out_of_range) if the literal is not a valid date
+ */
+MY_DATE_LITERAL MyDate operator"" _date(const char* text, const size_t length)
+{
+	int fields[3] = { 0, 0, 0 };			// year, month, day
+	const size_t widths[3] = { 4, 2, 2 };	// digits in each field
+	size_t position = 0;					// position in the literal
+
+	for (int field = 0; field < 3; field++)
+	{
+		// each field is a fixed number of digits, separated by '-'
+		if (field > 0 && (position >= length || text[position++] != '-'))
+			throw invalid_argument("A date literal must be formatted yyyy-mm-dd.");
+
+		for (size_t digit = 0; digit < widths[field]; digit++, position++)
+		{
+			if (position >= length || text[position] < '0' || text[position] > '9')
+				throw invalid_argument("A date literal must be formatted yyyy-mm-dd.");
+			fields[field] = fields[field] * 10 + (text[position] - '0');
+		}
+	}
+	if (position != length)
+		throw invalid_argument("A date literal must be formatted yyyy-mm-dd.");
+
+	// the constructor validates the values
+	return MyDate(fields[2], fields[1], fields[0]);
+}
+
 #endif
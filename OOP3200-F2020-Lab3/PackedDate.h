@@ -0,0 +1,162 @@
+/** PackedDate.h - Packed Date Value Type
+ *
+ *	The PackedDate class stores a Gregorian date as a single 32 bit day number
+ *	(days since 1/1/0001, the same numbering MyDate uses for its long
+ *	conversions). It is trivially copyable and 4 bytes wide, so large arrays of
+ *	dates can be copied with memcpy and stored compactly, while converting
+ *	losslessly to and from MyDate whenever the full API is needed.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+*/
+
+#pragma once
+#ifndef _PACKED_DATE_H
+
+#define _PACKED_DATE_H
+
+#include <cstdint>		// for int32_t
+#include <string>		// for to_string
+#include <stdexcept>	// for standard exceptions
+#include <type_traits>	// for is_trivially_copyable
+#include "MyDate.h"
+
+using namespace std;
+
+class PackedDate
+{
+public:
+
+	/***************************************************************************
+	*	CONSTRUCTORS
+	***************************************************************************/
+
+	/** Default Constructor
+	 *	Initializes the date to 1/1/2000, the same as MyDate.
+	 */
+	constexpr PackedDate() : myDayNumber(MyDate::DayNumber(1, 1, 2000)) {}
+
+	/** Parametrized Constructor
+	 *	Sets the date to the day/month/year parameters.
+	 *	@param day (int) - the day to set to
+	 *	@param month (int) - the month to set to
+	 *	@param year (int) - the year to set to
+	 *	@throws (out_of_range) if the parameters are not a valid date.
+	 */
+	constexpr PackedDate(const int day, const int month, const int year)
+		: myDayNumber(static_cast<int32_t>(MyDate::DayNumber(day, month, year)))
+	{
+		int checkDay = 0;	// day after the round trip
+		int checkMonth = 0;	// month after the round trip
+		int checkYear = 0;	// year after the round trip
+
+		// an out of range day or month will not survive the round trip
+		MyDate::FromDayNumber(myDayNumber, checkDay, checkMonth, checkYear);
+		if (year < 1 || year > 9999 || checkDay != day || checkMonth != month || checkYear != year)
+		{
+			throw out_of_range(to_string(day) + "/" + to_string(month) + "/" + to_string(year) + " is an invalid date.");
+		}
+	}
+
+	/** Long Constructor
+	 *	Sets the date from a day number.
+	 *	@param day_number (long) - the days since 1/1/0001
+	 *	@throws (out_of_range) if the parameter is not between 1 and 3652059.
+	 */
+	explicit constexpr PackedDate(const long day_number) : myDayNumber(static_cast<int32_t>(day_number))
+	{
+		if (day_number < 1L || day_number > last_day)
+		{
+			throw out_of_range(to_string(day_number) + " is an invalid value for a day number.\nValue must be greater than 0.");
+		}
+	}
+
+	/** MyDate Constructor
+	 *	Packs an existing MyDate. Also used to convert a MyDate to a PackedDate.
+	 *	@param date (MyDate by const ref) - the date to pack
+	 */
+	PackedDate(const MyDate& date) : myDayNumber(static_cast<int32_t>(MyDate::DayNumber(date.GetDay(), date.GetMonth(), date.GetYear()))) {}
+
+	/***************************************************************************
+	*	PUBLIC ACCESSORS
+	***************************************************************************/
+
+	/** DayNumber()
+	 *	Returns the stored day number.
+	 *	@return (int32_t) - the number of days since 1/1/0001
+	 */
+	constexpr int32_t DayNumber() const { return myDayNumber; }
+
+	/** Individual Property Accessors (Gets)
+	 *	Unpacks the corresponding field.
+	 *	@return (int) - the day, month or year
+	 */
+	constexpr int GetDay() const { int day = 0, month = 0, year = 0; MyDate::FromDayNumber(myDayNumber, day, month, year); return day; }
+	constexpr int GetMonth() const { int day = 0, month = 0, year = 0; MyDate::FromDayNumber(myDayNumber, day, month, year); return month; }
+	constexpr int GetYear() const { int day = 0, month = 0, year = 0; MyDate::FromDayNumber(myDayNumber, day, month, year); return year; }
+
+	/** ToMyDate()
+	 *	Unpacks the date into a MyDate object.
+	 *	@return (MyDate) - the same date as a MyDate
+	 */
+	MyDate ToMyDate() const { return MyDate(static_cast<long>(myDayNumber)); }
+
+	/***************************************************************************
+	*	OPERATOR METHODS
+	***************************************************************************/
+
+	/** operator (MyDate) (Typecast)
+	 *	Typecasts this date as a MyDate.
+	 *	@return (MyDate) - the same date as a MyDate
+	 */
+	operator MyDate() const { return ToMyDate(); }
+
+	/** ToChars()
+	 *	Writes the date into a caller-supplied buffer without allocating.
+	 *	@see MyDate::ToChars()
+	 */
+	to_chars_result ToChars(char* first, char* last, const MyDate::Format format = MyDate::Format::Short) const
+	{
+		return ToMyDate().ToChars(first, last, format);
+	}
+
+	/** operator + / - (Add or subtract days)
+	 *	Adds or subtracts a number of days and returns the new date.
+	 *	@param  days (int) - the number of days
+	 *	@return (PackedDate) - the new date.
+	 *	@throws (out_of_range) if the result is not a valid date.
+	 */
+	constexpr PackedDate operator+(const int days) const { return PackedDate(static_cast<long>(myDayNumber) + days); }
+	constexpr PackedDate operator-(const int days) const { return PackedDate(static_cast<long>(myDayNumber) - days); }
+
+	/** operator - (PackedDate) (Subtract a PackedDate)
+	 *	@param  aDate (PackedDate) - the date to subtract
+	 *	@return (long) - the number of days difference.
+	 */
+	constexpr long operator-(const PackedDate aDate) const { return static_cast<long>(myDayNumber) - aDate.myDayNumber; }
+
+	/** Comparison operators
+	 *	Compare the day numbers directly; no unpacking is needed.
+	 */
+	constexpr bool operator==(const PackedDate compare) const { return myDayNumber == compare.myDayNumber; }
+	constexpr bool operator!=(const PackedDate compare) const { return myDayNumber != compare.myDayNumber; }
+	constexpr bool operator<(const PackedDate compare) const { return myDayNumber < compare.myDayNumber; }
+	constexpr bool operator>(const PackedDate compare) const { return myDayNumber > compare.myDayNumber; }
+	constexpr bool operator<=(const PackedDate compare) const { return myDayNumber <= compare.myDayNumber; }
+	constexpr bool operator>=(const PackedDate compare) const { return myDayNumber >= compare.myDayNumber; }
+
+	/** operator << (Insertion/Output)
+	 *	Inserts a date into an ostream in the same dd/mm/yyyy format as MyDate.
+	 */
+	friend ostream& operator<<(ostream& out, const PackedDate the_date) { return out << the_date.ToMyDate(); }
+
+private:
+	static constexpr long last_day = 3652059L; // 31 Dec 9999
+
+	int32_t myDayNumber; // days since 1/1/0001
+};
+
+static_assert(sizeof(PackedDate) == 4, "PackedDate must stay 4 bytes");
+static_assert(is_trivially_copyable<PackedDate>::value, "PackedDate must stay trivially copyable");
+
+#endif
@@ -0,0 +1,103 @@
+/** BusinessCalendarTest.cpp - Business Day Calendar Test
+ *
+ *	Checks BusinessCalendar against stepping a day at a time with
+ *	GetDayOfWeek() and a holiday list, for two different weekends: every
+ *	day of the window for IsBusinessDay(), random dates and counts for
+ *	AddBusinessDays() and BusinessDaysBetween(), and the window's limits.
+ *
+ *	@version	2020.09
+ *	@see		BusinessCalendar.h
+*/
+
+#include <algorithm>	// for find
+#include <random>		// for mt19937
+#include <stdexcept>	// for out_of_range
+#include <string>		// for string
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../BusinessCalendar.h"
+
+using namespace std;
+
+/** IsBusinessDay()
+ *	The slow test: not a weekend day by name, and not in the holiday list.
+ */
+static bool IsBusinessDay(const MyDate& date, const vector<MyDate>& holidays, const vector<string>& weekend)
+{
+	if (find(weekend.begin(), weekend.end(), date.GetDayOfWeek()) != weekend.end())
+		return false;
+	return find(holidays.begin(), holidays.end(), date) == holidays.end();
+}
+
+/** CheckAgainstLoop()
+ *	One weekend, against the slow test.
+ */
+static void CheckAgainstLoop(const vector<MyDate>& holidays, const vector<BusinessCalendar::Weekday>& weekend,
+	const vector<string>& weekend_names, const unsigned seed)
+{
+	const BusinessCalendar calendar(holidays, weekend);
+	const auto isBusinessDay = [&](const long day_number) { return IsBusinessDay(MyDate(day_number), holidays, weekend_names); };
+	const long first = MyDate::DayNumber(1, 1, BusinessCalendar::first_year);
+	const long last = MyDate::DayNumber(31, 12, BusinessCalendar::last_year);
+	for (long dayNumber = first; dayNumber <= last; dayNumber++)
+		LAB3_CHECK(calendar.IsBusinessDay(MyDate(dayNumber)) == isBusinessDay(dayNumber));
+
+	mt19937 random(seed);
+	for (int i = 0; i < 3000; i++)
+	{
+		const long from = first + 20 + random() % (last - first - 40);
+		const int businessDays = static_cast<int>(random() % 41) - 20;
+		auto expected = MyDate(from);
+		for (int left = businessDays < 0 ? -businessDays : businessDays; left > 0;)
+		{
+			if (businessDays > 0)
+				++expected;
+			else
+				--expected;
+			left -= IsBusinessDay(expected, holidays, weekend_names);
+		}
+		LAB3_CHECK(calendar.AddBusinessDays(MyDate(from), businessDays) == expected);
+
+		const long to = from + static_cast<long>(random() % 61) - 30;
+		int between = 0;
+		for (long day = from + 1; day <= to; day++)
+			between += isBusinessDay(day);
+		for (long day = to; day < from; day++)
+			between -= isBusinessDay(day);
+		LAB3_CHECK(calendar.BusinessDaysBetween(MyDate(from), MyDate(to)) == between);
+		if (calendar.IsBusinessDay(MyDate(to)))
+			LAB3_CHECK(calendar.AddBusinessDays(MyDate(from), between) == MyDate(to));
+	}
+}
+
+/** CheckLimits()
+ *	Known dates, and dates and results outside the window.
+ */
+static void CheckLimits()
+{
+	const BusinessCalendar calendar;
+	LAB3_CHECK(calendar.AddBusinessDays(MyDate(17, 10, 2020), 1) == MyDate(19, 10, 2020));	// Saturday
+	LAB3_CHECK(calendar.AddBusinessDays(MyDate(16, 10, 2020), 1) == MyDate(19, 10, 2020));	// Friday
+	LAB3_CHECK(calendar.AddBusinessDays(MyDate(19, 10, 2020), -1) == MyDate(16, 10, 2020));
+	LAB3_CHECK(calendar.AddBusinessDays(MyDate(4, 1, 2000), -1) == MyDate(3, 1, 2000));
+	LAB3_CHECK_THROWS(calendar.AddBusinessDays(MyDate(3, 1, 2000), -1), out_of_range);	// the first business day
+	LAB3_CHECK_THROWS(calendar.AddBusinessDays(MyDate(30, 12, 2099), 5), out_of_range);
+	LAB3_CHECK_THROWS(calendar.IsBusinessDay(MyDate(31, 12, 1999)), out_of_range);
+	LAB3_CHECK_THROWS(BusinessCalendar({ MyDate(1, 1, 2100) }), out_of_range);
+}
+
+int main()
+{
+	vector<MyDate> holidays;
+	for (int year = BusinessCalendar::first_year; year <= BusinessCalendar::last_year; year++)
+	{
+		holidays.emplace_back(1, 1, year);
+		holidays.emplace_back(1, 7, year);
+		holidays.emplace_back(25, 12, year);
+		holidays.emplace_back(26, 12, year);
+	}
+	CheckAgainstLoop(holidays, { BusinessCalendar::Weekday::Saturday, BusinessCalendar::Weekday::Sunday }, { "Saturday", "Sunday" }, 42);
+	CheckAgainstLoop(holidays, { BusinessCalendar::Weekday::Friday, BusinessCalendar::Weekday::Saturday }, { "Friday", "Saturday" }, 43);
+	CheckLimits();
+	return TestSupport::Result("BusinessCalendarTest");
+}
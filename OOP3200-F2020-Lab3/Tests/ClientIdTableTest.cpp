@@ -0,0 +1,79 @@
+/** ClientIdTableTest.cpp - Client ID Symbol Table Test
+ *
+ *	Interns overlapping sets of client IDs from several threads at once,
+ *	enough to grow the index many times while other threads look IDs up,
+ *	then checks that every ID has one handle, that handles are dense and
+ *	View() gives back the ID, and that Find() never adds.
+ *
+ *	@version	2020.09
+ *	@see		ClientIdTable.h
+*/
+
+#include <string>		// for string and to_string
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../ClientIdTable.h"
+
+using namespace std;
+
+static const int id_count = 60000;	// distinct IDs interned
+static const int thread_count = 4;
+
+/** ClientId()
+ *	The ith client ID; a few are long enough for a chunk of their own.
+ */
+static string ClientId(const int i)
+{
+	return i % 10007 == 0 ? string(20000, 'L') + to_string(i) : "CLIENT-" + to_string(i);
+}
+
+int main()
+{
+	ClientIdTable table;
+	LAB3_CHECK(table.Size() == 1 && table.Find("") == ClientIdTable::empty_handle);
+
+	// each thread interns every ID, starting at a different place, so they race on the new ones
+	vector<vector<uint32_t>> handles(thread_count, vector<uint32_t>(id_count));
+	vector<thread> threads;
+	for (int t = 0; t < thread_count; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (int n = 0; n < id_count; n++)
+			{
+				const int i = (n + t * id_count / thread_count) % id_count;
+				handles[t][i] = table.Intern(ClientId(i));
+				LAB3_CHECK(table.Find(ClientId(i)) == handles[t][i]);
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	LAB3_CHECK(table.Size() == static_cast<uint32_t>(id_count + 1));
+	vector<char> seen(id_count + 1, 0);
+	for (int i = 0; i < id_count; i++)
+	{
+		const auto handle = handles[0][i];
+		for (int t = 1; t < thread_count; t++)
+			LAB3_CHECK(handles[t][i] == handle);
+		if (!LAB3_CHECK(handle != ClientIdTable::empty_handle && handle <= static_cast<uint32_t>(id_count)))
+			continue;
+		LAB3_CHECK(!seen[handle]);
+		seen[handle] = 1;
+		LAB3_CHECK(table.View(handle) == ClientId(i));
+		LAB3_CHECK(table.Intern(ClientId(i)) == handle);
+	}
+
+	LAB3_CHECK(table.Find("CLIENT-NONE") == ClientIdTable::no_handle);
+	LAB3_CHECK(table.Size() == static_cast<uint32_t>(id_count + 1));
+	LAB3_CHECK(table.Intern("") == ClientIdTable::empty_handle);
+
+	// the shared table is a separate one
+	LAB3_CHECK(ClientIdTable::Shared().Find("CLIENT-1") == ClientIdTable::no_handle);
+	const auto shared = ClientIdTable::Shared().Intern("CLIENT-1");
+	LAB3_CHECK(ClientIdTable::Shared().View(shared) == "CLIENT-1");
+
+	return TestSupport::Result("ClientIdTableTest");
+}
@@ -0,0 +1,210 @@
+/** DateBatchTest.cpp - Batch Date Conversion Test
+ *
+ *	Runs every kernel this CPU supports over every day number from 1/1/0001
+ *	to 31/12/9999, plus day numbers and dates just outside the range, and
+ *	checks that each produces exactly what the scalar kernel does and what
+ *	MyDate::DayNumber() and FromDayNumber() do. Then converts short runs
+ *	around leap days at every length up to a few vectors and every start
+ *	offset, so the vector loops' tails are covered, and checks that nothing
+ *	past the end of a run is written.
+ *
+ *	@version	2020.09
+ *	@see		DateBatch.h
+*/
+
+#include <cstdint>		// for fixed width integers
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../DateBatch.h"
+
+using namespace std;
+
+static const int32_t last_day_number = 3652059; // 31/12/9999
+
+/** Kernels()
+ *	Returns the kernels this CPU supports. Each one implies those before it.
+ */
+static vector<DateBatch::Kernel> Kernels()
+{
+	vector<DateBatch::Kernel> kernels{ DateBatch::Kernel::Scalar };
+	if (DateBatch::BestKernel() != DateBatch::Kernel::Scalar)
+		kernels.push_back(DateBatch::Kernel::Sse42);
+	if (DateBatch::BestKernel() == DateBatch::Kernel::Avx2)
+		kernels.push_back(DateBatch::Kernel::Avx2);
+	return kernels;
+}
+
+/** Dates
+ *	Dates held structure-of-arrays style, as DateBatch takes them.
+ */
+struct Dates
+{
+	explicit Dates(const size_t count) : year(count), month(count), day(count), weekday(count) {}
+
+	vector<uint16_t> year;
+	vector<uint8_t> month;
+	vector<uint8_t> day;
+	vector<uint8_t> weekday;
+};
+
+/** CheckFullRange()
+ *	Every day number, and every valid and nearly valid date, converts the
+ *	same through every kernel and through MyDate.
+ */
+static void CheckFullRange()
+{
+	// day numbers 1 to the last, with invalid ones at both ends
+	vector<int32_t> days;
+	for (int32_t day = -3; day <= last_day_number + 3; day++)
+		days.push_back(day);
+	days.push_back(INT32_MIN);
+	days.push_back(INT32_MAX);
+	const size_t invalidDays = 4 + 3 + 2; // -3 to 0, three past the last, and the two limits
+
+	Dates expected(days.size());
+	LAB3_CHECK(DateBatch::FromDayNumbers(days.data(), expected.year.data(), expected.month.data(), expected.day.data(), expected.weekday.data(),
+		days.size(), DateBatch::Kernel::Scalar) == invalidDays);
+	size_t mismatches = 0;
+	for (size_t i = 0; i < days.size(); i++)
+	{
+		int day = 0, month = 0, year = 0;
+		const bool valid = days[i] >= 1 && days[i] <= last_day_number;
+		if (valid)
+			MyDate::FromDayNumber(days[i], day, month, year);
+		if (expected.year[i] != year || expected.month[i] != month || expected.day[i] != day
+			|| expected.weekday[i] != (valid ? days[i] % 7 : 0))
+			mismatches++;
+	}
+	LAB3_CHECK(mismatches == 0);
+
+	for (const auto kernel : Kernels())
+	{
+		Dates actual(days.size());
+		LAB3_CHECK(DateBatch::FromDayNumbers(days.data(), actual.year.data(), actual.month.data(), actual.day.data(), actual.weekday.data(),
+			days.size(), kernel) == invalidDays);
+		LAB3_CHECK(actual.year == expected.year && actual.month == expected.month && actual.day == expected.day && actual.weekday == expected.weekday);
+
+		Dates noWeekday(days.size());
+		DateBatch::FromDayNumbers(days.data(), noWeekday.year.data(), noWeekday.month.data(), noWeekday.day.data(), nullptr, days.size(), kernel);
+		LAB3_CHECK(noWeekday.year == expected.year && noWeekday.month == expected.month && noWeekday.day == expected.day);
+	}
+
+	// every valid date back to its day number, then dates just past each rule
+	Dates dates(0);
+	for (size_t i = 0; i < days.size(); i++)
+	{
+		if (expected.year[i] == 0)
+			continue;
+		dates.year.push_back(expected.year[i]);
+		dates.month.push_back(expected.month[i]);
+		dates.day.push_back(expected.day[i]);
+	}
+	const size_t validDates = dates.year.size();
+	const struct { uint16_t year; uint8_t month; uint8_t day; } invalid[] = {
+		{ 0, 1, 1 }, { 10000, 1, 1 }, { 65535, 12, 31 }, { 2020, 0, 1 }, { 2020, 13, 1 }, { 2020, 255, 1 },
+		{ 2020, 1, 0 }, { 2020, 1, 32 }, { 2020, 4, 31 }, { 2020, 2, 30 }, { 2020, 2, 255 },
+		{ 2021, 2, 29 }, { 1900, 2, 29 }, { 2100, 2, 29 }, { 1, 2, 29 }, { 9999, 2, 29 },
+	};
+	for (const auto& date : invalid)
+	{
+		dates.year.push_back(date.year);
+		dates.month.push_back(date.month);
+		dates.day.push_back(date.day);
+	}
+
+	vector<int32_t> expectedDays(dates.year.size());
+	LAB3_CHECK(DateBatch::ToDayNumbers(dates.year.data(), dates.month.data(), dates.day.data(), expectedDays.data(), expectedDays.size(),
+		DateBatch::Kernel::Scalar) == sizeof(invalid) / sizeof(invalid[0]));
+	mismatches = 0;
+	for (size_t i = 0; i < expectedDays.size(); i++)
+		if (expectedDays[i] != (i < validDates ? static_cast<int32_t>(MyDate::DayNumber(dates.day[i], dates.month[i], dates.year[i])) : 0))
+			mismatches++;
+	LAB3_CHECK(mismatches == 0);
+	LAB3_CHECK(expectedDays.front() == 1 && expectedDays[validDates - 1] == last_day_number);
+
+	for (const auto kernel : Kernels())
+	{
+		vector<int32_t> actual(dates.year.size(), -1);
+		LAB3_CHECK(DateBatch::ToDayNumbers(dates.year.data(), dates.month.data(), dates.day.data(), actual.data(), actual.size(), kernel)
+			== sizeof(invalid) / sizeof(invalid[0]));
+		LAB3_CHECK(actual == expectedDays);
+	}
+}
+
+/** CheckTails()
+ *	Runs of every length from 0 to a few vectors, starting at every offset
+ *	into a run of dates around leap days, convert the same through every
+ *	kernel, and the entries past each run are left alone.
+ */
+static void CheckTails()
+{
+	// 26/2 to 3/3 in leap and common years, and a few invalid dates among them
+	Dates dates(0);
+	const uint16_t years[] = { 1, 4, 100, 400, 1900, 2000, 2020, 2021, 2100, 9996, 9999 };
+	for (const auto year : years)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			const uint8_t month = i < 4 ? 2 : 3;
+			const uint8_t day = i < 4 ? static_cast<uint8_t>(26 + i) : static_cast<uint8_t>(i - 3);
+			dates.year.push_back(year);
+			dates.month.push_back(month);
+			dates.day.push_back(day);
+		}
+		dates.year.push_back(year);
+		dates.month.push_back(2);
+		dates.day.push_back(30);
+	}
+
+	vector<int32_t> days(dates.year.size());
+	DateBatch::ToDayNumbers(dates.year.data(), dates.month.data(), dates.day.data(), days.data(), days.size(), DateBatch::Kernel::Scalar);
+	days.push_back(0);
+	days.push_back(last_day_number + 1);
+	days.push_back(last_day_number);
+
+	const int32_t day_sentinel = -7;		// written past each run; must survive
+	const uint8_t byte_sentinel = 0xEE;	// likewise
+	const size_t longest = 3 * 8 + 1;		// three AVX2 vectors and one more
+	for (const auto kernel : Kernels())
+	{
+		size_t mismatches = 0;
+		for (size_t start = 0; start + longest <= dates.year.size(); start++)
+		{
+			for (size_t count = 0; count <= longest; count++)
+			{
+				vector<int32_t> expected(count + 1, day_sentinel), actual(count + 1, day_sentinel);
+				const auto expectedInvalid = DateBatch::ToDayNumbers(&dates.year[start], &dates.month[start], &dates.day[start], expected.data(), count, DateBatch::Kernel::Scalar);
+				const auto actualInvalid = DateBatch::ToDayNumbers(&dates.year[start], &dates.month[start], &dates.day[start], actual.data(), count, kernel);
+				if (actual != expected || actualInvalid != expectedInvalid || actual[count] != day_sentinel)
+					mismatches++;
+			}
+		}
+		for (size_t start = 0; start + longest <= days.size(); start++)
+		{
+			for (size_t count = 0; count <= longest; count++)
+			{
+				Dates expected(count + 1), actual(count + 1);
+				for (auto* out : { &expected, &actual })
+				{
+					out->year.assign(count + 1, byte_sentinel);
+					out->month.assign(count + 1, byte_sentinel);
+					out->day.assign(count + 1, byte_sentinel);
+					out->weekday.assign(count + 1, byte_sentinel);
+				}
+				const auto expectedInvalid = DateBatch::FromDayNumbers(&days[start], expected.year.data(), expected.month.data(), expected.day.data(), expected.weekday.data(), count, DateBatch::Kernel::Scalar);
+				const auto actualInvalid = DateBatch::FromDayNumbers(&days[start], actual.year.data(), actual.month.data(), actual.day.data(), actual.weekday.data(), count, kernel);
+				if (actual.year != expected.year || actual.month != expected.month || actual.day != expected.day || actual.weekday != expected.weekday
+					|| actualInvalid != expectedInvalid || actual.year[count] != byte_sentinel || actual.weekday[count] != byte_sentinel)
+					mismatches++;
+			}
+		}
+		LAB3_CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	CheckFullRange();
+	CheckTails();
+	return TestSupport::Result("DateBatchTest");
+}
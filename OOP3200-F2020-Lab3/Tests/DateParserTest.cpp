@@ -0,0 +1,172 @@
+/** DateParserTest.cpp - Date Parser Test
+ *
+ *	Checks that Parse() reads both formats into a MyDate and a PackedDate,
+ *	maps each broken MyDate rule to its status, refuses bad separators,
+ *	extra digits and trailing text, and leaves the date alone when it fails;
+ *	that ParseColumn() reports each field and honours its capacity; and that
+ *	Describe() has a distinct message for every status.
+ *
+ *	@version	2020.09
+ *	@see		DateParser.h
+*/
+
+#include <cstring>		// for strcmp
+#include <sstream>		// for ostringstream
+#include <string>		// for string
+#include <string_view>	// for string_view
+#include "TestSupport.h"
+#include "../DateParser.h"
+
+using namespace std;
+
+using Status = DateParser::Status;
+
+/** CheckParse()
+ *	The text parses with the status given, into both date types, and a
+ *	valid date is the one given.
+ */
+static void CheckParse(const string_view text, const Status expected, const int day = 0, const int month = 0, const int year = 0)
+{
+	MyDate date(9, 9, 1999);
+	PackedDate packed(9, 9, 1999);
+	const auto status = DateParser::Parse(text, date);
+	if (!LAB3_CHECK(status == expected && DateParser::Parse(text, packed) == expected))
+		cerr << "\twhile parsing \"" << text << "\"" << endl;
+	if (expected == Status::Ok)
+	{
+		LAB3_CHECK(date == MyDate(day, month, year));
+		LAB3_CHECK(packed == PackedDate(day, month, year));
+	}
+	else
+	{
+		LAB3_CHECK(date == MyDate(9, 9, 1999) && packed == PackedDate(9, 9, 1999)); // untouched
+	}
+}
+
+/** CheckFormats()
+ *	Both formats, padded or not, and the whole range of years.
+ */
+static void CheckFormats()
+{
+	CheckParse("25/12/2020", Status::Ok, 25, 12, 2020);
+	CheckParse("5/1/2020", Status::Ok, 5, 1, 2020);
+	CheckParse("05/01/0001", Status::Ok, 5, 1, 1);
+	CheckParse("31/12/9999", Status::Ok, 31, 12, 9999);
+	CheckParse("1/1/1", Status::Ok, 1, 1, 1);
+	CheckParse("2020-12-25", Status::Ok, 25, 12, 2020);
+	CheckParse("2020-1-5", Status::Ok, 5, 1, 2020);
+	CheckParse("1-1-1", Status::Ok, 1, 1, 1);
+	CheckParse("29/02/2000", Status::Ok, 29, 2, 2000);
+	CheckParse("2024-02-29", Status::Ok, 29, 2, 2024);
+	CheckParse(" \t13/01/2021\r", Status::Ok, 13, 1, 2021);
+	CheckParse("2021-01-13\r\n", Status::BadFormat);	// only spaces, tabs and \r are trimmed
+
+	// what MyDate writes, it reads
+	const MyDate written(7, 11, 2019);
+	ostringstream text;
+	text << written;
+	MyDate read;
+	LAB3_CHECK(DateParser::Parse(text.str(), read) == Status::Ok && read == written);
+}
+
+/** CheckRules()
+ *	Each MyDate::Validate() code maps to its status, year first, then month, then day.
+ */
+static void CheckRules()
+{
+	CheckParse("", Status::Empty);
+	CheckParse(" \t\r ", Status::Empty);
+
+	CheckParse("1/1/0", Status::InvalidYear);
+	CheckParse("0000-01-01", Status::InvalidYear);
+	CheckParse("32/13/0", Status::InvalidYear);		// the year is checked first
+	CheckParse("1/0/2020", Status::InvalidMonth);
+	CheckParse("2020-13-01", Status::InvalidMonth);
+	CheckParse("32/13/2020", Status::InvalidMonth);	// then the month
+	CheckParse("0/1/2020", Status::InvalidDay);
+	CheckParse("32/1/2020", Status::InvalidDay);
+	CheckParse("31/4/2020", Status::InvalidDay);
+	CheckParse("29/2/2021", Status::InvalidDay);
+	CheckParse("29/2/1900", Status::InvalidDay);
+	CheckParse("2100-02-29", Status::InvalidDay);
+	CheckParse("2020-02-30", Status::InvalidDay);
+}
+
+/** CheckBadFormats()
+ *	Wrong or mixed separators, too many digits, missing fields and extra text.
+ */
+static void CheckBadFormats()
+{
+	const char* bad[] = {
+		"25.12.2020", "25 12 2020", "25/12-2020", "2020-12/25", "2020/12/25", "25-12-2020",
+		"25/12/", "25//2020", "/12/2020", "2020--25", "2020-12-", "-12-25", "25/12", "2020-12", "2020",
+		"025/12/2020", "25/012/2020", "25/12/02020", "20201-12-25", "2020-012-25", "2020-12-025",
+		"99999999999/1/2020", "25/12/2020x", "25/12/2020 1", "x25/12/2020", "+5/12/2020", "-5/12/2020",
+		"2020-12-25T00:00", "25/ 12/2020",
+	};
+	for (const auto text : bad)
+		CheckParse(text, Status::BadFormat);
+
+	// an embedded NUL is text like any other
+	CheckParse(string_view("1/1/2020\0", 9), Status::BadFormat);
+}
+
+/** CheckColumn()
+ *	Every field is parsed and reported in order, invalid ones as the
+ *	default date, and reading stops at the capacity.
+ */
+static void CheckColumn()
+{
+	const string_view column = "1/1/2020\n2020-02-29\r\n\n31/4/2020\nnot a date\n 9/9/9999 \n";
+	const Status expected[] = { Status::Ok, Status::Ok, Status::Empty, Status::InvalidDay, Status::BadFormat, Status::Ok };
+	const PackedDate expectedDates[] = { PackedDate(1, 1, 2020), PackedDate(29, 2, 2020), PackedDate(), PackedDate(), PackedDate(), PackedDate(9, 9, 9999) };
+
+	PackedDate dates[8];
+	Status status[8];
+	auto result = DateParser::ParseColumn(column, '\n', dates, status, 8);
+	LAB3_CHECK(result.count == 6 && result.invalid == 3); // the trailing delimiter adds no field
+	for (size_t i = 0; i < 6; i++)
+		LAB3_CHECK(status[i] == expected[i] && dates[i] == expectedDates[i]);
+
+	// a smaller capacity stops early, and the statuses are optional
+	PackedDate few[3];
+	result = DateParser::ParseColumn(column, '\n', few, nullptr, 3);
+	LAB3_CHECK(result.count == 3 && result.invalid == 1);
+	LAB3_CHECK(few[1] == PackedDate(29, 2, 2020));
+	LAB3_CHECK(DateParser::ParseColumn(column, '\n', few, nullptr, 0).count == 0);
+
+	// any delimiter, an empty column, and a final field with no delimiter
+	result = DateParser::ParseColumn("2020-01-02,3/4/2021,,5/6/2022", ',', dates, status, 8);
+	LAB3_CHECK(result.count == 4 && result.invalid == 1);
+	LAB3_CHECK(dates[0] == PackedDate(2, 1, 2020) && dates[1] == PackedDate(3, 4, 2021) && status[2] == Status::Empty && dates[3] == PackedDate(5, 6, 2022));
+	result = DateParser::ParseColumn("", '\n', dates, status, 8);
+	LAB3_CHECK(result.count == 0 && result.invalid == 0);
+	result = DateParser::ParseColumn("\n", '\n', dates, status, 8);
+	LAB3_CHECK(result.count == 1 && result.invalid == 1 && status[0] == Status::Empty);
+}
+
+/** CheckDescribe()
+ *	Every status has its own message.
+ */
+static void CheckDescribe()
+{
+	const Status all[] = { Status::Ok, Status::Empty, Status::BadFormat, Status::InvalidYear, Status::InvalidMonth, Status::InvalidDay };
+	for (const auto a : all)
+	{
+		LAB3_CHECK(DateParser::Describe(a) != nullptr && DateParser::Describe(a)[0] != '\0');
+		for (const auto b : all)
+			LAB3_CHECK((a == b) == (strcmp(DateParser::Describe(a), DateParser::Describe(b)) == 0));
+	}
+	LAB3_CHECK(string(DateParser::Describe(Status::BadFormat)).find("dd/mm/yyyy") != string::npos);
+	LAB3_CHECK(string(DateParser::Describe(Status::InvalidYear)).find("9999") != string::npos);
+}
+
+int main()
+{
+	CheckFormats();
+	CheckRules();
+	CheckBadFormats();
+	CheckColumn();
+	CheckDescribe();
+	return TestSupport::Result("DateParserTest");
+}
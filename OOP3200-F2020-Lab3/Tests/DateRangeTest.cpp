@@ -0,0 +1,110 @@
+/** DateRangeTest.cpp - Date Range Test
+ *
+ *	Checks the dates of day, week and month DateRanges, and their Size(),
+ *	against MyDate day numbers for ranges of many lengths starting on every
+ *	third day over two years, then the limits and the standard algorithms.
+ *
+ *	@version	2020.09
+ *	@see		DateRange.h
+*/
+
+#include <algorithm>	// for min, count_if and find
+#include <iterator>		// for distance
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../DateRange.h"
+
+using namespace std;
+
+/** ExpectedMonths()
+ *	The same day of each month from first, or the month's last day, before last.
+ */
+static vector<MyDate> ExpectedMonths(const MyDate& first, const MyDate& last)
+{
+	vector<MyDate> months;
+	for (int k = 0;; k++)
+	{
+		const int year = first.GetYear() + (first.GetMonth() - 1 + k) / 12;
+		const int month = (first.GetMonth() - 1 + k) % 12 + 1;
+		const MyDate date(min(first.GetDay(), MyDate::DaysInMonth(month, year)), month, year);
+		if (!(date < last))
+			return months;
+		months.push_back(date);
+	}
+}
+
+/** CheckRanges()
+ *	Every step, from each start, over lengths either side of week, month
+ *	and year boundaries.
+ */
+static void CheckRanges()
+{
+	const long start = MyDate::DayNumber(1, 1, 1999);
+	for (long first = start; first < start + 800; first += 3)
+	{
+		for (const long length : { 0L, 1L, 2L, 6L, 7L, 8L, 27L, 28L, 29L, 30L, 31L, 59L, 60L, 61L, 365L, 366L, 400L, 1500L })
+		{
+			const MyDate firstDate(first), lastDate(first + length);
+
+			const DateRange days(firstDate, lastDate);
+			vector<long> dayNumbers;
+			for (const MyDate day : days)
+				dayNumbers.push_back(static_cast<long>(day));
+			LAB3_CHECK(static_cast<long>(dayNumbers.size()) == length && days.Size() == dayNumbers.size());
+			for (size_t i = 0; i < dayNumbers.size(); i++)
+				LAB3_CHECK(dayNumbers[i] == first + static_cast<long>(i));
+
+			const DateRange weeks(firstDate, lastDate, DateRange::Step::Week);
+			dayNumbers.clear();
+			for (const MyDate week : weeks)
+				dayNumbers.push_back(static_cast<long>(week));
+			LAB3_CHECK(static_cast<long>(dayNumbers.size()) == (length + 6) / 7 && weeks.Size() == dayNumbers.size());
+			for (size_t i = 0; i < dayNumbers.size(); i++)
+				LAB3_CHECK(dayNumbers[i] == first + 7 * static_cast<long>(i));
+
+			const DateRange months(firstDate, lastDate, DateRange::Step::Month);
+			const vector<MyDate> monthDates(months.begin(), months.end());
+			LAB3_CHECK(months.Size() == monthDates.size());
+			LAB3_CHECK(monthDates == ExpectedMonths(firstDate, lastDate));
+		}
+	}
+}
+
+/** CheckLimits()
+ *	Empty ranges, and ranges whose end is past 31/12/9999.
+ */
+static void CheckLimits()
+{
+	LAB3_CHECK(DateRange(MyDate(5, 5, 2005), MyDate(1, 5, 2005)).Empty());
+	LAB3_CHECK(DateRange(MyDate(5, 5, 2005), MyDate(5, 5, 2005)).Empty());
+
+	const DateRange lastWeek(MyDate(25, 12, 9999), MyDate(31, 12, 9999), DateRange::Step::Week);
+	LAB3_CHECK(lastWeek.Size() == 1);
+	LAB3_CHECK(distance(lastWeek.begin(), lastWeek.end()) == 1);
+	LAB3_CHECK(DateRange(MyDate(31, 1, 9999), MyDate(31, 12, 9999), DateRange::Step::Month).Size() == 11);
+}
+
+/** CheckAlgorithms()
+ *	The iterator with the standard algorithms.
+ */
+static void CheckAlgorithms()
+{
+	const DateRange year(MyDate(1, 1, 2000), MyDate(1, 1, 2001));
+	LAB3_CHECK(distance(year.begin(), year.end()) == 366);
+	LAB3_CHECK(count_if(year.begin(), year.end(), [](const MyDate& date) { return date.GetDay() == 29 && date.GetMonth() == 2; }) == 1);
+	const auto march = find(year.begin(), year.end(), MyDate(1, 3, 2000));
+	LAB3_CHECK(march != year.end() && march.GetMonth() == 3);
+
+	const DateRange months(MyDate(31, 1, 2000), MyDate(1, 1, 2001), DateRange::Step::Month);
+	const vector<MyDate> dates(months.begin(), months.end());
+	LAB3_CHECK(dates.size() == 12);
+	LAB3_CHECK(dates[1] == MyDate(29, 2, 2000) && dates[2] == MyDate(31, 3, 2000));
+}
+
+int main()
+{
+	CheckRanges();
+	CheckLimits();
+	CheckAlgorithms();
+	return TestSupport::Result("DateRangeTest");
+}
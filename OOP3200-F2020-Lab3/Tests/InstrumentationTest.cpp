@@ -0,0 +1,98 @@
+/** InstrumentationTest.cpp - Hot Path Counter Test
+ *
+ *	Checks the latency histogram's buckets, and that counts made on several
+ *	threads, collected while they run, add up exactly. Instrumentation is
+ *	compiled in for this program whatever LAB3_INSTRUMENTATION is set to
+ *	for the rest of the build.
+ *
+ *	@version	2020.09
+ *	@see		Instrumentation.h
+*/
+
+#ifndef LAB3_INSTRUMENTATION
+#define LAB3_INSTRUMENTATION
+#endif
+
+#include <cstdint>		// for uint64_t
+#include <exception>	// for exception
+#include <sstream>		// for ostringstream
+#include <string>		// for string
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../WorkTicket.h"
+
+using namespace std;
+
+/** CheckBuckets()
+ *	Every value falls in a bucket whose upper bound is at least the value
+ *	and whose previous bucket's is less.
+ */
+static void CheckBuckets()
+{
+	for (const uint64_t nanoseconds : { 0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 100ull, 1000000ull, ~0ull })
+	{
+		const auto bucket = Instrumentation::BucketOf(nanoseconds);
+		LAB3_CHECK(bucket < Instrumentation::bucket_count);
+		LAB3_CHECK(Instrumentation::BucketUpper(bucket) >= nanoseconds);
+		if (bucket > 0)
+			LAB3_CHECK(Instrumentation::BucketUpper(bucket - 1) < nanoseconds);
+	}
+}
+
+/** CheckThreadCounts()
+ *	Four threads each make 1,000 of a set of counted calls.
+ */
+static void CheckThreadCounts()
+{
+	vector<thread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([]()
+		{
+			WorkTicket ticket;
+			for (int i = 0; i < 1000; i++)
+			{
+				try { ticket.SetTicketNumber(-1); } catch (const exception&) {}
+				try { ticket.SetDate(31, 2, 2001); } catch (const exception&) {}
+				MyDate date(1, 2, 2001);
+				try { date.SetDay(30); } catch (const exception&) {}
+				const WorkTicket copy(ticket);
+				ticket = copy;
+				(void)static_cast<string>(ticket);
+			}
+		});
+	}
+	for (int i = 0; i < 20; i++)
+		Instrumentation::Collect(); // while they run
+	for (auto& thread : threads)
+		thread.join();
+
+	const auto stats = Instrumentation::Collect();
+	LAB3_CHECK(stats[Instrumentation::Counter::TicketNumberThrow] == 4000);
+	LAB3_CHECK(stats[Instrumentation::Counter::TicketDateThrow] == 4000);
+	LAB3_CHECK(stats[Instrumentation::Counter::DayThrow] == 4000);
+	LAB3_CHECK(stats[Instrumentation::Counter::TicketCopy] == 4000);
+	LAB3_CHECK(stats[Instrumentation::Counter::TicketAssign] == 4000);
+	LAB3_CHECK(stats[Instrumentation::Counter::StringStream] == 4000);
+	LAB3_CHECK(stats[Instrumentation::Operation::TicketString].count == 4000);
+	LAB3_CHECK(stats.threads == 4);
+
+	ostringstream text, json;
+	Instrumentation::WriteText(text, stats);
+	Instrumentation::WriteJson(json, stats);
+	LAB3_CHECK(text.str().find("ticket_copy") != string::npos);
+	LAB3_CHECK(json.str().find("\"ticket_copy\": 4000") != string::npos);
+
+	Instrumentation::Reset();
+	LAB3_CHECK(Instrumentation::Collect()[Instrumentation::Counter::TicketCopy] == 0);
+}
+
+static_assert(MyDate::DayNumber(1, 1, 2000) > 0, "counting must not stop DayNumber() being constexpr");
+
+int main()
+{
+	CheckBuckets();
+	CheckThreadCounts();
+	return TestSupport::Result("InstrumentationTest");
+}
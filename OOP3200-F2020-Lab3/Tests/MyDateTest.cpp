@@ -0,0 +1,146 @@
+/** MyDateTest.cpp - Date Arithmetic Test
+ *
+ *	Checks MyDate::DayNumber() and FromDayNumber() for every day from
+ *	1/1/0001 to 31/12/9999 (day numbers 1 to 3,652,059) against the loops
+ *	MyDate used before them: MyDate(long) walked forward a day at a time
+ *	from 1/1/0001, and operator long() added up the days of every earlier
+ *	year and month. Then checks that day numbers outside the range throw,
+ *	and that operator<< pads to the stream's width like any other insertion.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+*/
+
+#include <iomanip>		// for setw and setfill
+#include <sstream>		// for ostringstream
+#include <stdexcept>	// for out_of_range
+#include <string>		// for string
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../MyDate.h"
+#include "../PackedDate.h"
+
+using namespace std;
+
+static const long last_day_number = 3652059L; // 31/12/9999
+
+/** LoopDayNumber()
+ *	The old operator long(): 365 days for every earlier year, one more for
+ *	each earlier leap year, then the days of the earlier months and the day.
+ *	@param leap_years_before (vector<long>) - the old loop's count of leap years before each year
+ */
+static long LoopDayNumber(const int day, const int month, const int year, const vector<long>& leap_years_before)
+{
+	static const int day_limits[] = { -1, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	long dayNumber = (year - 1) * 365L + leap_years_before[year];
+	for (int i = 1; i < month; i++)
+		dayNumber += day_limits[i];
+	dayNumber += day;
+	if (MyDate::IsLeapYear(year) && month > 2)
+		dayNumber++;
+	return dayNumber;
+}
+
+/** CheckEveryDay()
+ *	Walks day, month and year forward as the old MyDate(long) did, and
+ *	compares both conversions on every day.
+ */
+static void CheckEveryDay()
+{
+	// the old operator long() counted these with a loop over the earlier years, every time
+	vector<long> leapYearsBefore(10001, 0);
+	for (int year = 2; year <= 10000; year++)
+		leapYearsBefore[year] = leapYearsBefore[year - 1] + MyDate::IsLeapYear(year - 1);
+
+	int day = 1;
+	int month = 1;
+	int year = 1;
+	size_t mismatches = 0; // counted here, so a broken engine reports a few days rather than millions
+	for (long dayNumber = 1; dayNumber <= last_day_number; dayNumber++)
+	{
+		int fromDay = 0, fromMonth = 0, fromYear = 0;
+		MyDate::FromDayNumber(dayNumber, fromDay, fromMonth, fromYear);
+		const bool matches = fromDay == day && fromMonth == month && fromYear == year
+			&& MyDate::DayNumber(day, month, year) == dayNumber
+			&& LoopDayNumber(day, month, year, leapYearsBefore) == dayNumber;
+		if (!matches && mismatches++ < TestSupport::max_reported)
+		{
+			LAB3_CHECK(fromDay == day && fromMonth == month && fromYear == year);
+			LAB3_CHECK(MyDate::DayNumber(day, month, year) == dayNumber);
+			LAB3_CHECK(LoopDayNumber(day, month, year, leapYearsBefore) == dayNumber);
+		}
+
+		// the old day-by-day walk
+		if (++day > MyDate::DaysInMonth(month, year))
+		{
+			day = 1;
+			if (++month > 12)
+			{
+				month = 1;
+				year++;
+			}
+		}
+	}
+	LAB3_CHECK(mismatches == 0);
+	LAB3_CHECK(day == 1 && month == 1 && year == 10000); // one past 31/12/9999
+
+	// the constructor and typecast go through the same pair
+	for (const long dayNumber : { 1L, 59L, 60L, 365L, 366L, 730120L, 737000L, last_day_number })
+	{
+		const MyDate date(dayNumber);
+		LAB3_CHECK(static_cast<long>(date) == dayNumber);
+		LAB3_CHECK(date.GetDayNumber() == dayNumber);
+	}
+	LAB3_CHECK(MyDate(1L) == MyDate(1, 1, 1));
+	LAB3_CHECK(MyDate(last_day_number) == MyDate(31, 12, 9999));
+	LAB3_CHECK(MyDate(730120L) == MyDate(1, 1, 2000));
+}
+
+/** CheckOutOfRange()
+ *	Day numbers before 1/1/0001 or after 31/12/9999 throw, with the old message.
+ */
+static void CheckOutOfRange()
+{
+	for (const long dayNumber : { 0L, -1L, last_day_number + 1 })
+	{
+		LAB3_CHECK_THROWS(MyDate date(dayNumber), out_of_range);
+		LAB3_CHECK(!MyDate::TryMake(dayNumber).HasValue());
+	}
+	try
+	{
+		MyDate date(0L);
+	}
+	catch (const out_of_range& error)
+	{
+		LAB3_CHECK(string(error.what()) == "0 is an invalid value for a day number.\nValue must be greater than 0.");
+	}
+}
+
+/** CheckStreamOutput()
+ *	operator<< honours setw(), setfill() and left, and resets the width
+ *	so it does not carry over to the next insertion.
+ */
+static void CheckStreamOutput()
+{
+	const MyDate date(5, 3, 2020);
+	ostringstream out;
+	out << "[" << setw(14) << date << "][" << date << "]";
+	LAB3_CHECK(out.str() == "[    05/03/2020][05/03/2020]");
+
+	out.str("");
+	out << left << setfill('*') << setw(12) << date << "|" << setw(4) << date << "|";
+	LAB3_CHECK(out.str() == "05/03/2020**|05/03/2020|");
+	LAB3_CHECK(out.width() == 0);
+
+	out.str("");
+	out << right << setfill(' ') << setw(11) << PackedDate(date) << "|";
+	LAB3_CHECK(out.str() == " 05/03/2020|");
+}
+
+int main()
+{
+	CheckEveryDay();
+	CheckOutOfRange();
+	CheckStreamOutput();
+	return TestSupport::Result("MyDateTest");
+}
@@ -0,0 +1,132 @@
+/** PackedDateTest.cpp - Packed Date Value Type Test
+ *
+ *	Checks that every day number from 1/1/0001 to 31/12/9999 packs and
+ *	unpacks to the same date as MyDate, in both directions and as text,
+ *	that the constructors throw for exactly the dates and day numbers
+ *	MyDate rejects, and that arithmetic and comparisons work on the day
+ *	number and throw at the ends of the range.
+ *
+ *	@version	2020.09
+ *	@see		PackedDate.h
+*/
+
+#include <sstream>		// for ostringstream
+#include <stdexcept>	// for out_of_range
+#include "TestSupport.h"
+#include "../PackedDate.h"
+
+using namespace std;
+
+static const long last_day_number = 3652059L; // 31/12/9999
+
+/** CheckEveryDay()
+ *	Each day number gives MyDate's date, and the date gives it back.
+ */
+static void CheckEveryDay()
+{
+	size_t mismatches = 0;
+	for (long dayNumber = 1; dayNumber <= last_day_number; dayNumber++)
+	{
+		int day = 0, month = 0, year = 0;
+		MyDate::FromDayNumber(dayNumber, day, month, year);
+		const PackedDate packed(dayNumber);
+		mismatches += packed.DayNumber() != dayNumber || packed.GetDay() != day || packed.GetMonth() != month || packed.GetYear() != year
+			|| PackedDate(day, month, year) != packed;
+
+		// the MyDate conversions are slower, so sample them
+		if (dayNumber % 997 == 0 || dayNumber < 800 || dayNumber > last_day_number - 800)
+		{
+			const MyDate date(day, month, year);
+			mismatches += packed.ToMyDate() != date || static_cast<MyDate>(packed) != date || PackedDate(date) != packed;
+		}
+	}
+	LAB3_CHECK(mismatches == 0);
+
+	LAB3_CHECK(PackedDate() == PackedDate(1, 1, 2000) && PackedDate().ToMyDate() == MyDate());
+	LAB3_CHECK(PackedDate(1, 1, 1).DayNumber() == 1 && PackedDate(31, 12, 9999).DayNumber() == last_day_number);
+}
+
+/** CheckText()
+ *	A packed date is written exactly as its MyDate is.
+ */
+static void CheckText()
+{
+	const MyDate::Format formats[] = { MyDate::Format::Short, MyDate::Format::Iso, MyDate::Format::Long };
+	for (const auto date : { PackedDate(1, 1, 1), PackedDate(29, 2, 2000), PackedDate(3, 10, 2020), PackedDate(31, 12, 9999) })
+	{
+		for (const auto format : formats)
+		{
+			char packedText[MyDate::max_format_length], dateText[MyDate::max_format_length];
+			const auto packedEnd = date.ToChars(packedText, packedText + sizeof(packedText), format);
+			const auto dateEnd = date.ToMyDate().ToChars(dateText, dateText + sizeof(dateText), format);
+			LAB3_CHECK(packedEnd.ec == errc() && string(packedText, packedEnd.ptr) == string(dateText, dateEnd.ptr));
+		}
+		ostringstream packedOut, dateOut;
+		packedOut << date;
+		dateOut << date.ToMyDate();
+		LAB3_CHECK(packedOut.str() == dateOut.str());
+	}
+}
+
+/** CheckInvalid()
+ *	The constructors throw for what MyDate rejects, and only that.
+ */
+static void CheckInvalid()
+{
+	size_t mismatches = 0;
+	for (const int year : { -1, 0, 1, 4, 100, 1900, 2000, 2021, 2100, 9999, 10000 })
+	{
+		for (int month = -1; month <= 13; month++)
+		{
+			for (int day = -1; day <= 32; day++)
+			{
+				bool thrown = false;
+				try
+				{
+					PackedDate date(day, month, year);
+				}
+				catch (const out_of_range&)
+				{
+					thrown = true;
+				}
+				mismatches += thrown == MyDate::Validate(day, month, year).Ok();
+			}
+		}
+	}
+	LAB3_CHECK(mismatches == 0);
+
+	LAB3_CHECK_THROWS(PackedDate(0L), out_of_range);
+	LAB3_CHECK_THROWS(PackedDate(-1L), out_of_range);
+	LAB3_CHECK_THROWS(PackedDate(last_day_number + 1), out_of_range);
+}
+
+/** CheckArithmetic()
+ *	Adding, subtracting and comparing work on the day number.
+ */
+static void CheckArithmetic()
+{
+	constexpr PackedDate leapDay(29, 2, 2020); // usable in constant expressions
+	static_assert(leapDay + 1 == PackedDate(1, 3, 2020), "adding crosses the month");
+	static_assert(leapDay - 59 == PackedDate(1, 1, 2020), "subtracting crosses the year");
+	static_assert(PackedDate(1, 1, 2021) - leapDay == 307, "the difference is in days");
+
+	LAB3_CHECK(leapDay + 366 == PackedDate(1, 3, 2021));
+	LAB3_CHECK(leapDay + -366 == PackedDate(28, 2, 2019));
+	LAB3_CHECK(PackedDate(1, 1, 1) - PackedDate(31, 12, 9999) == 1 - last_day_number);
+	LAB3_CHECK(PackedDate(1, 1, 1) + static_cast<int>(last_day_number - 1) == PackedDate(31, 12, 9999));
+	LAB3_CHECK_THROWS(PackedDate(1, 1, 1) - 1, out_of_range);
+	LAB3_CHECK_THROWS(PackedDate(31, 12, 9999) + 1, out_of_range);
+
+	const PackedDate earlier(31, 12, 2019), later(1, 1, 2020);
+	LAB3_CHECK(earlier < later && earlier <= later && later > earlier && later >= earlier && earlier != later);
+	LAB3_CHECK(!(later < earlier) && !(earlier == later) && earlier <= earlier && earlier >= earlier);
+}
+
+int main()
+{
+	CheckEveryDay();
+	CheckText();
+	CheckInvalid();
+	CheckArithmetic();
+	return TestSupport::Result("PackedDateTest");
+}
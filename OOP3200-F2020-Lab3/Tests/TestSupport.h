@@ -0,0 +1,99 @@
+/** TestSupport.h - Test Support
+ *
+ *	Shared helpers for the test programs in this folder, which ctest runs
+ *	(see CMakeLists.txt). Each test is a plain program: LAB3_CHECK() and
+ *	LAB3_CHECK_THROWS() report a failed check with its file and line and
+ *	carry on, and main returns TestSupport::Result(), which is non-zero if
+ *	any check failed. Include it in exactly one source file per program.
+ *
+ *	ctest runs the tests in a scratch folder, so files they write go in the
+ *	current directory.
+ *
+ *	@version	2020.09
+*/
+
+#pragma once
+#ifndef _TEST_SUPPORT_H
+
+#define _TEST_SUPPORT_H
+
+#include <atomic>		// for the check counters
+#include <cstddef>		// for size_t
+#include <iostream>		// for cout and cerr
+#include <mutex>		// for mutex
+
+using namespace std;
+
+class TestSupport
+{
+public:
+	static constexpr size_t max_reported = 20; // failed checks printed before the rest are only counted
+
+	/** Check Counters
+	 *	The number of checks made, and the number that failed.
+	 */
+	static atomic<size_t> checks;
+	static atomic<size_t> failures;
+
+	/** Check()
+	 *	Counts a check and prints it if it failed. Safe to call from any thread.
+	 *	@param passed (bool) - the result of the check
+	 *	@param condition (const char*) - the check, as written
+	 *	@param file (const char*) - the file it is in
+	 *	@param line (int) - the line it is on
+	 *	@return (bool) - passed
+	 */
+	static bool Check(bool passed, const char* condition, const char* file, int line);
+
+	/** Result()
+	 *	Prints the number of checks and failures.
+	 *	@param name (const char*) - the test's name
+	 *	@return (int) - the exit code for main: 0 if every check passed, otherwise 1
+	 */
+	static int Result(const char* name);
+
+private:
+	static mutex myOutputMutex; // keeps failure lines from different threads apart
+};
+
+atomic<size_t> TestSupport::checks{ 0 };
+atomic<size_t> TestSupport::failures{ 0 };
+mutex TestSupport::myOutputMutex;
+
+// TestSupport::Check
+bool TestSupport::Check(const bool passed, const char* condition, const char* file, const int line)
+{
+	checks.fetch_add(1, memory_order_relaxed);
+	if (!passed && failures.fetch_add(1, memory_order_relaxed) < max_reported)
+	{
+		lock_guard<mutex> lock(myOutputMutex);
+		cerr << file << "(" << line << "): check failed: " << condition << endl;
+	}
+	return passed;
+}
+
+// TestSupport::Result
+int TestSupport::Result(const char* name)
+{
+	cout << name << ": " << checks.load() << " checks, " << failures.load() << " failed" << endl;
+	return failures.load() == 0 ? 0 : 1;
+}
+
+/** LAB3_CHECK(condition)
+ *	Checks that condition is true.
+ */
+#define LAB3_CHECK(condition) TestSupport::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+/** LAB3_CHECK_THROWS(statement, exception_type)
+ *	Checks that statement throws exception_type.
+ */
+#define LAB3_CHECK_THROWS(statement, exception_type)												\
+	do																								\
+	{																								\
+		bool lab3Thrown = false;																	\
+		try { statement; }																			\
+		catch (const exception_type&) { lab3Thrown = true; }										\
+		TestSupport::Check(lab3Thrown, #statement " throws " #exception_type, __FILE__, __LINE__);	\
+	} while (false)
+
+#endif
@@ -0,0 +1,142 @@
+/** TextIndexTest.cpp - Description Text Index Test
+ *
+ *	Inserts and rewrites random descriptions in a WorkTicketStore, then
+ *	checks TicketTextIndex::MatchAll(), MatchAny(), MatchPhrase() and
+ *	TicketCount() on random queries against a brute-force search of every
+ *	description's words.
+ *
+ *	@version	2020.09
+ *	@see		TicketTextIndex.h
+*/
+
+#include <algorithm>	// for find and equal
+#include <map>			// for map
+#include <random>		// for mt19937
+#include <string>		// for string
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../WorkTicketStore.h"
+
+using namespace std;
+
+/** Words()
+ *	The index's words of a text, in order.
+ */
+static vector<string> Words(const string_view text)
+{
+	vector<string> words;
+	TicketTextIndex::Tokenize(text, [&](const string& word, uint32_t) { words.push_back(word); });
+	return words;
+}
+
+/** Contains()
+ *	Whether a word list contains a word.
+ */
+static bool Contains(const vector<string>& words, const string& word)
+{
+	return find(words.begin(), words.end(), word) != words.end();
+}
+
+/** ContainsPhrase()
+ *	Whether a word list contains a phrase's words next to each other and in order.
+ */
+static bool ContainsPhrase(const vector<string>& words, const vector<string>& phrase)
+{
+	if (phrase.empty())
+		return false;
+	for (size_t start = 0; start + phrase.size() <= words.size(); start++)
+	{
+		if (equal(phrase.begin(), phrase.end(), words.begin() + start))
+			return true;
+	}
+	return false;
+}
+
+int main()
+{
+	mt19937 random(7);
+	const char* vocabulary[] = { "printer", "Toner", "password", "reset", "PC", "load", "letter", "the", "a",
+		"network", "down", "VPN", "x", "y", "z", "caf\xC3\xA9" };
+	const auto randomText = [&]()
+	{
+		string text;
+		const int words = random() % 12;
+		for (int i = 0; i < words; i++)
+		{
+			text += vocabulary[random() % 16];
+			text += random() % 4 == 0 ? "-" : (random() % 5 == 0 ? ", " : " ");
+		}
+		return text;
+	};
+
+	// inserts, then a mix of inserts and rewrites; expected keeps every ticket's description
+	WorkTicketStore store;
+	map<int, string> expected;
+	for (int step = 0; step < 60000; step++)
+	{
+		const int operation = random() % 10;
+		if (operation < 7)
+		{
+			const int ticketNumber = step < 20000 ? step + 1 : 1 + random() % 200000;
+			auto text = randomText();
+			if (text.empty())
+				text = "x";
+			if (store.Insert(ticketNumber, "C", PackedDate(MyDate(1, 1, 2020)), text, true))
+				expected[ticketNumber] = text;
+		}
+		else if (!expected.empty())
+		{
+			auto ticket = expected.lower_bound(1 + random() % 200000);
+			if (ticket == expected.end())
+				ticket = expected.begin();
+			auto text = randomText();
+			if (text.empty())
+				text = "y";
+			if (operation < 9)
+				LAB3_CHECK(store.SetDescription(ticket->first, text));
+			else
+				LAB3_CHECK(store.SetWorkTicket(ticket->first, "D", 2, 2, 2021, text));
+			ticket->second = text;
+		}
+	}
+
+	const auto& index = store.TextIndex();
+	vector<pair<int, vector<string>>> ticketWords; // in ticket number order, as the index returns them
+	for (const auto& ticket : expected)
+		ticketWords.emplace_back(ticket.first, Words(ticket.second));
+
+	for (int query = 0; query < 1500; query++)
+	{
+		const auto text = randomText();
+		const auto queryWords = Words(text);
+		vector<int> all, any, phrase;
+		for (const auto& ticket : ticketWords)
+		{
+			bool hasAll = !queryWords.empty();
+			bool hasAny = false;
+			for (const auto& word : queryWords)
+			{
+				if (Contains(ticket.second, word))
+					hasAny = true;
+				else
+					hasAll = false;
+			}
+			if (hasAll)
+				all.push_back(ticket.first);
+			if (hasAny)
+				any.push_back(ticket.first);
+			if (ContainsPhrase(ticket.second, queryWords))
+				phrase.push_back(ticket.first);
+		}
+		LAB3_CHECK(index.MatchAll(text) == all);
+		LAB3_CHECK(index.MatchAny(text) == any);
+		LAB3_CHECK(index.MatchPhrase(text) == phrase);
+	}
+
+	size_t printers = 0;
+	for (const auto& ticket : ticketWords)
+		printers += Contains(ticket.second, "printer");
+	LAB3_CHECK(index.TicketCount("Printer") == printers);
+
+	return TestSupport::Result("TextIndexTest");
+}
@@ -0,0 +1,144 @@
+/** TicketBatchTest.cpp - Arena-Backed Ticket Batch Test
+ *
+ *	Checks that a batch adds exactly the tickets SetWorkTicket() accepts,
+ *	in order, loads the valid records from a reader, keeps its descriptions
+ *	in a handful of arena blocks rather than one allocation each, and gives
+ *	every block back when it is cleared or destroyed.
+ *
+ *	@version	2020.09
+ *	@see		TicketBatch.h
+*/
+
+#include <memory_resource>	// for memory_resource
+#include <string>			// for string and to_string
+#include "TestSupport.h"
+#include "../TicketBatch.h"
+
+using namespace std;
+
+/** CountingResource
+ *	Passes allocations to new and delete and counts them, to see what the
+ *	batch's arena asks of the memory behind it.
+ */
+class CountingResource : public pmr::memory_resource
+{
+public:
+	size_t allocations = 0;	// blocks allocated
+	size_t live = 0;		// bytes allocated and not yet freed
+
+private:
+	void* do_allocate(const size_t bytes, const size_t alignment) override
+	{
+		allocations++;
+		live += bytes;
+		return pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* block, const size_t bytes, const size_t alignment) override
+	{
+		live -= bytes;
+		pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+	}
+	bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/** Description()
+ *	A description too long for the small string buffer.
+ */
+static string Description(const int ticket_number)
+{
+	return "ticket " + to_string(ticket_number) + " needs a new toner cartridge and a long description";
+}
+
+/** CheckAdd()
+ *	Valid tickets are added in order; invalid ones add nothing.
+ */
+static void CheckAdd()
+{
+	TicketBatch batch;
+	LAB3_CHECK(batch.Add(1, "C1", 13, 1, 2020, Description(1), true));
+	LAB3_CHECK(!batch.Add(0, "C1", 1, 1, 2020, "zero", true));
+	LAB3_CHECK(!batch.Add(2, "", 1, 1, 2020, "no client", true));
+	LAB3_CHECK(!batch.Add(2, "C2", 1, 1, 2020, "", true));
+	LAB3_CHECK(!batch.Add(2, "C2", 29, 2, 2021, "no such day", true));
+	LAB3_CHECK(!batch.Add(2, "C2", 1, 1, 1999, "too early", true));
+	LAB3_CHECK(batch.Add(2, "C2", 29, 2, 2024, Description(2), false));
+	LAB3_CHECK(batch.Add(2, "C2", 1, 3, 2024, "a repeated number is kept", true));
+
+	if (LAB3_CHECK(batch.Size() == 3))
+	{
+		LAB3_CHECK(batch[0].GetTicketNumber() == 1 && batch[0].GetClientIdView() == "C1" && batch[0].GetDate() == MyDate(13, 1, 2020)
+			&& batch[0].GetDescriptionView() == Description(1) && batch[0].IsOpen());
+		LAB3_CHECK(batch[1].GetTicketNumber() == 2 && batch[1].GetDate() == MyDate(29, 2, 2024) && !batch[1].IsOpen());
+		LAB3_CHECK(batch[2].GetDescriptionView() == "a repeated number is kept");
+	}
+	size_t count = 0;
+	for (const auto& ticket : batch)
+		count += ticket.GetTicketNumber() > 0;
+	LAB3_CHECK(count == 3);
+
+	// tickets can be changed in place
+	batch[1].SetDescription("replaced");
+	LAB3_CHECK(batch[1].GetDescriptionView() == "replaced");
+}
+
+/** CheckLoad()
+ *	Loading a reader adds its valid records, in order.
+ */
+static void CheckLoad()
+{
+	const string text = "1\tC1\t01/02/2020\tfirst\n"
+		"\n"
+		"2\tC2\t2020-02-30\tno such day\n"
+		"3\tC3\t13/12/2021\tthird\tclosed\n"
+		"0\tC4\t01/01/2020\tzero\n";
+	TicketReader reader(text);
+	TicketBatch batch;
+	LAB3_CHECK(batch.Load(reader) == 2);
+	LAB3_CHECK(reader.GetErrors().size() == 2);
+	if (LAB3_CHECK(batch.Size() == 2))
+	{
+		LAB3_CHECK(batch[0].GetTicketNumber() == 1 && batch[0].GetDate() == MyDate(1, 2, 2020) && batch[0].GetDescriptionView() == "first");
+		LAB3_CHECK(batch[1].GetTicketNumber() == 3 && batch[1].GetDate() == MyDate(13, 12, 2021) && !batch[1].IsOpen());
+	}
+}
+
+/** CheckArena()
+ *	Descriptions come from a few large blocks, all freed by Clear() and by
+ *	the destructor, and the batch can be refilled after clearing.
+ */
+static void CheckArena()
+{
+	const int ticket_count = 20000;
+	CountingResource counting;
+	const auto previous = pmr::set_default_resource(&counting); // the arena's upstream
+	{
+		TicketBatch batch(64 * 1024);
+		batch.Reserve(ticket_count);
+		for (int i = 1; i <= ticket_count; i++)
+			batch.Add(i, "C" + to_string(i % 10), 1 + i % 28, 1 + i % 12, 2000 + i % 100, Description(i), i % 2 == 0);
+		LAB3_CHECK(batch.Size() == static_cast<size_t>(ticket_count));
+		LAB3_CHECK(counting.allocations < 50);	// not one per description
+		LAB3_CHECK(counting.live >= ticket_count * Description(1).size());
+
+		size_t mismatches = 0;
+		for (int i = 1; i <= ticket_count; i++)
+			mismatches += batch[i - 1].GetDescriptionView() != Description(i) || batch[i - 1].GetDate() != MyDate(1 + i % 28, 1 + i % 12, 2000 + i % 100);
+		LAB3_CHECK(mismatches == 0);
+
+		batch.Clear();
+		LAB3_CHECK(batch.Size() == 0 && counting.live == 0);
+
+		LAB3_CHECK(batch.Add(7, "C7", 1, 1, 2020, Description(7), true));
+		LAB3_CHECK(batch.Size() == 1 && batch[0].GetDescriptionView() == Description(7) && counting.live > 0);
+	}
+	LAB3_CHECK(counting.live == 0);
+	pmr::set_default_resource(previous);
+}
+
+int main()
+{
+	CheckAdd();
+	CheckLoad();
+	CheckArena();
+	return TestSupport::Result("TicketBatchTest");
+}
@@ -0,0 +1,132 @@
+/** TicketBitmapTest.cpp - Ticket Number Bitmap Test
+ *
+ *	Checks TicketBitmap's adds, removes, lookups and set operations against
+ *	set<int> on random ticket numbers, dense and sparse, and that the open
+ *	ticket bitmap of a WorkTicketStore stays in step with its open flags
+ *	through single and batch closes.
+ *
+ *	@version	2020.09
+ *	@see		TicketBitmap.h
+*/
+
+#include <algorithm>	// for is_sorted, shuffle and the set operations
+#include <iterator>		// for inserter
+#include <random>		// for mt19937
+#include <set>			// for set
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../WorkTicketStore.h"
+
+using namespace std;
+
+/** ToSet()
+ *	A bitmap's ticket numbers, checking that TicketNumbers() is sorted and
+ *	agrees with Count().
+ */
+static set<int> ToSet(const TicketBitmap& bitmap)
+{
+	const auto ticketNumbers = bitmap.TicketNumbers();
+	LAB3_CHECK(is_sorted(ticketNumbers.begin(), ticketNumbers.end()));
+	LAB3_CHECK(ticketNumbers.size() == bitmap.Count());
+	return set<int>(ticketNumbers.begin(), ticketNumbers.end());
+}
+
+/** CheckSetOperations()
+ *	Random bitmaps, with ranges that make sparse and dense containers,
+ *	against set<int>.
+ */
+static void CheckSetOperations(mt19937& random)
+{
+	for (int round = 0; round < 40; round++)
+	{
+		TicketBitmap a, b;
+		set<int> expectedA, expectedB;
+		const int range = round % 4 == 0 ? 300000 : (round % 4 == 1 ? 70000 : 2000000);
+		const int count = random() % 60000;
+		for (int i = 0; i < count; i++)
+		{
+			const int ticketNumber = 1 + random() % range;
+			LAB3_CHECK(a.Add(ticketNumber) == expectedA.insert(ticketNumber).second);
+			const int other = round % 2 ? ticketNumber + 1 : 1 + random() % range;
+			if (random() % 3)
+				LAB3_CHECK(b.Add(other) == expectedB.insert(other).second);
+		}
+		for (int i = 0; i < count / 3; i++)
+		{
+			const int ticketNumber = 1 + random() % range;
+			LAB3_CHECK(a.Remove(ticketNumber) == (expectedA.erase(ticketNumber) == 1));
+		}
+		LAB3_CHECK(!a.Add(0) && !a.Add(-5) && !a.Contains(0));
+		LAB3_CHECK(ToSet(a) == expectedA && ToSet(b) == expectedB);
+		for (int i = 0; i < 1000; i++)
+		{
+			const int ticketNumber = 1 + random() % range;
+			LAB3_CHECK(a.Contains(ticketNumber) == (expectedA.count(ticketNumber) == 1));
+		}
+
+		set<int> intersection, both, difference;
+		set_intersection(expectedA.begin(), expectedA.end(), expectedB.begin(), expectedB.end(), inserter(intersection, intersection.end()));
+		set_union(expectedA.begin(), expectedA.end(), expectedB.begin(), expectedB.end(), inserter(both, both.end()));
+		set_difference(expectedA.begin(), expectedA.end(), expectedB.begin(), expectedB.end(), inserter(difference, difference.end()));
+		LAB3_CHECK(ToSet(a & b) == intersection);
+		LAB3_CHECK(ToSet(a | b) == both);
+		LAB3_CHECK(ToSet(a - b) == difference);
+		LAB3_CHECK(a.AndCount(b) == intersection.size());
+
+		TicketBitmap rebuilt = a;
+		rebuilt &= b;
+		rebuilt |= a - b;
+		LAB3_CHECK(rebuilt == a);
+		LAB3_CHECK(TicketBitmap(vector<int>(expectedA.begin(), expectedA.end())) == a);
+		vector<int> shuffled(expectedA.begin(), expectedA.end());
+		shuffle(shuffled.begin(), shuffled.end(), random);
+		shuffled.push_back(-3); // ignored
+		LAB3_CHECK(TicketBitmap(shuffled) == a);
+	}
+}
+
+/** CheckStoreOpenTickets()
+ *	WorkTicketStore::CountOpen() against a count of its open flags.
+ */
+static void CheckStoreOpenTickets(mt19937& random)
+{
+	WorkTicketStore store;
+	for (int i = 1; i <= 200000; i++)
+		store.Insert(i, "C", PackedDate(MyDate(1, 1, 2020)), "printer jam", i % 3 != 0);
+	const auto countFlags = [&]()
+	{
+		size_t open = 0;
+		for (const auto flag : store.OpenFlags())
+			open += flag;
+		return open;
+	};
+	LAB3_CHECK(store.CountOpen() == countFlags());
+
+	for (int i = 0; i < 5000; i++)
+		store.Close(1 + random() % 250000); // some are not in the store
+	LAB3_CHECK(store.CountOpen() == countFlags());
+
+	vector<int> batch;
+	for (int i = 0; i < 50000; i++)
+		batch.push_back(1 + random() % 300000);
+	const auto before = store.CountOpen();
+	const auto closed = store.Close(TicketBitmap(batch));
+	LAB3_CHECK(store.CountOpen() == before - closed);
+	LAB3_CHECK(store.CountOpen() == countFlags());
+	LAB3_CHECK(store.Close(TicketBitmap(batch)) == 0);
+
+	const TicketBitmap printers(store.TextIndex().MatchAll("printer"));
+	LAB3_CHECK(store.CountOpen(printers) == store.CountOpen());
+
+	ExtendedWorkTicket ticket;
+	ticket.CloseTicket();
+	LAB3_CHECK(!ticket.IsOpen());
+}
+
+int main()
+{
+	mt19937 random(17);
+	CheckSetOperations(random);
+	CheckStoreOpenTickets(random);
+	return TestSupport::Result("TicketBitmapTest");
+}
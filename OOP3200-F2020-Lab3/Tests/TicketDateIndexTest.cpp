@@ -0,0 +1,123 @@
+/** TicketDateIndexTest.cpp - Date-Ordered Ticket Index Test
+ *
+ *	Inserts, erases and moves random tickets, enough to split and empty
+ *	many blocks, and checks Count(), Between() and iteration against a
+ *	sorted set after every batch, then does the same after Assign().
+ *
+ *	@version	2020.09
+ *	@see		TicketDateIndex.h
+*/
+
+#include <iterator>		// for distance
+#include <random>		// for mt19937
+#include <set>			// for set
+#include <utility>		// for pair
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../TicketDateIndex.h"
+
+using namespace std;
+
+static const long first_day = PackedDate(1, 1, 2000).DayNumber();	// the earliest date used
+static const int day_span = 400;									// the number of days used
+
+using Reference = set<pair<int32_t, int>>; // (day number, ticket number), as the index orders them
+
+/** CheckSame()
+ *	The index holds what the set does, and counts and lists random ranges the same.
+ */
+static void CheckSame(const TicketDateIndex& index, const Reference& expected, mt19937& random)
+{
+	LAB3_CHECK(index.Size() == expected.size());
+	LAB3_CHECK(static_cast<size_t>(distance(index.begin(), index.end())) == expected.size());
+
+	auto walk = expected.begin();
+	for (const auto entry : index)
+	{
+		if (!LAB3_CHECK(walk != expected.end() && entry.date.DayNumber() == walk->first && entry.ticketNumber == walk->second))
+			break;
+		++walk;
+	}
+
+	for (int query = 0; query < 200; query++)
+	{
+		const auto from = PackedDate(first_day - 5 + static_cast<long>(random() % (day_span + 10)));
+		const auto to = PackedDate(from.DayNumber() + static_cast<long>(random() % (query % 2 == 0 ? 5 : day_span)));
+		const auto first = expected.lower_bound({ from.DayNumber(), 0 });
+		const auto last = expected.lower_bound({ to.DayNumber() + 1, 0 });
+		const auto count = static_cast<size_t>(distance(first, last));
+
+		LAB3_CHECK(index.Count(from, to) == count);
+		LAB3_CHECK(index.Count(to, from) == (from == to ? count : 0));
+		const auto numbers = index.TicketNumbers(from, to);
+		if (!LAB3_CHECK(numbers.size() == count))
+			continue;
+		auto match = first;
+		for (const auto number : numbers)
+			LAB3_CHECK(number == (match++)->second);
+	}
+}
+
+int main()
+{
+	mt19937 random(7);
+	TicketDateIndex index;
+	Reference expected;
+	LAB3_CHECK(index.Count(PackedDate(1, 1, 2000), PackedDate(31, 12, 2099)) == 0);
+
+	// grow past many splits, then shrink until blocks empty out
+	for (int batch = 0; batch < 20; batch++)
+	{
+		const bool growing = batch < 12;
+		for (int i = 0; i < 3000; i++)
+		{
+			const int ticketNumber = 1 + random() % 40000;
+			const PackedDate date(first_day + static_cast<long>(random() % day_span));
+			if (growing || random() % 4 == 0)
+			{
+				index.Insert(date, ticketNumber);
+				expected.insert({ date.DayNumber(), ticketNumber });
+			}
+			else if (!expected.empty())
+			{
+				// erase an entry that is there, and one that probably is not
+				auto victim = expected.lower_bound({ date.DayNumber(), 0 });
+				if (victim == expected.end())
+					victim = expected.begin();
+				LAB3_CHECK(index.Erase(PackedDate(static_cast<long>(victim->first)), victim->second));
+				expected.erase(victim);
+				LAB3_CHECK(index.Erase(date, -ticketNumber) == false);
+			}
+			if (i % 10 == 0 && !expected.empty())
+			{
+				// move the first ticket on a day to another day
+				auto found = expected.lower_bound({ date.DayNumber(), 0 });
+				const auto moving = found == expected.end() ? *expected.begin() : *found;
+				const PackedDate to(first_day + static_cast<long>(random() % day_span));
+				if (expected.count({ to.DayNumber(), moving.second }) == 0)
+				{
+					index.Move(moving.second, PackedDate(static_cast<long>(moving.first)), to);
+					expected.erase(moving);
+					expected.insert({ to.DayNumber(), moving.second });
+				}
+			}
+		}
+		CheckSame(index, expected, random);
+	}
+
+	// a bulk load gives the same answers
+	vector<TicketDateIndex::Entry> entries;
+	for (const auto& entry : expected)
+		entries.push_back({ PackedDate(static_cast<long>(entry.first)), entry.second });
+	entries.push_back(entries.front()); // a duplicate is kept once
+	TicketDateIndex assigned;
+	assigned.Assign(entries);
+	CheckSame(assigned, expected, random);
+	assigned.Insert(PackedDate(first_day), 99999);
+	expected.insert({ static_cast<int32_t>(first_day), 99999 });
+	CheckSame(assigned, expected, random);
+
+	assigned.Clear();
+	LAB3_CHECK(assigned.Size() == 0 && assigned.Count(PackedDate(1, 1, 2000), PackedDate(31, 12, 2099)) == 0);
+	return TestSupport::Result("TicketDateIndexTest");
+}
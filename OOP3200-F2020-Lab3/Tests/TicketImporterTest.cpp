@@ -0,0 +1,218 @@
+/** TicketImporterTest.cpp - Parallel Ticket Importer Test
+ *
+ *	Builds CSV exports big enough to be split between several threads and
+ *	places a record across every chunk boundary: the boundary falls on a
+ *	line break inside a quoted field, on either quote of a "" escape, on a
+ *	closing quote before \r\n, inside an unquoted field, on the first byte
+ *	of a record, and inside an invalid record. Each export is imported with
+ *	one thread and with several, into a store and into a batch, and the
+ *	tickets and line-numbered errors must be identical, and the records
+ *	across the boundaries must come out whole and on the right lines.
+ *
+ *	@version	2020.09
+ *	@see		TicketImporter.h
+*/
+
+#include <algorithm>	// for count
+#include <string>		// for string and to_string
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../TicketImporter.h"
+
+using namespace std;
+
+/** Quote()
+ *	Returns a field quoted as RFC 4180 does it, with each " doubled.
+ */
+static string Quote(const string& text)
+{
+	string quoted = "\"";
+	for (const auto c : text)
+		quoted += c == '"' ? "\"\"" : string(1, c);
+	return quoted + "\"";
+}
+
+/** Straddler
+ *	A record placed across a chunk boundary, and what importing it must give.
+ */
+struct Straddler
+{
+	int ticketNumber;		// its ticket number
+	size_t line;			// the line it starts on
+	string description;		// its description, unescaped; empty if it is invalid
+};
+
+/** Export
+ *	A generated CSV export and what it holds.
+ */
+struct Export
+{
+	string text;					// the CSV
+	size_t records = 0;				// records in it, valid or not
+	vector<Straddler> straddlers;	// the records across the boundaries
+};
+
+/** MakeExport()
+ *	Builds an export of exactly size bytes whose chunk boundaries, when
+ *	split between chunk_count threads, each fall inside a record.
+ */
+static Export MakeExport(const size_t size, const size_t chunk_count)
+{
+	const string multiline = "first line\nsays \"hi\", then \"\"\nlast"; // a description that needs quoting
+	Export csv;
+	int ticketNumber = 0;
+	size_t boundary = 1; // the next boundary to straddle
+
+	while (csv.text.size() + 1000 < size)
+	{
+		const auto next = size * boundary / chunk_count; // where TicketImporter first cuts
+		if (boundary < chunk_count && csv.text.size() + 300 >= next)
+		{
+			// the straddling record, and the byte of it that must land on the boundary
+			const int kind = static_cast<int>(boundary % 7);
+			const int number = ticketNumber + 2;
+			const string date = kind == 6 ? "30/2/2021" : "2/3/2021";
+			const string ending = kind == 4 ? "\r\n" : "\n";
+			const auto record = to_string(number) + ",STRADDLE," + date + "," + Quote(multiline) + ",closed" + ending;
+			const auto opening = record.find('"');
+			size_t at = 0;
+			switch (kind)
+			{
+			case 0: at = record.find('\n', opening); break;				// a line break inside the quotes
+			case 1: at = record.find("\"\"", opening + 1); break;		// the first quote of an escape
+			case 2: at = record.find("\"\"", opening + 1) + 1; break;	// the second quote of an escape
+			case 3: at = record.find("STRADDLE") + 3; break;			// inside an unquoted field
+			case 4: at = record.rfind('"'); break;						// the closing quote, before \r\n
+			case 5: at = 0; break;										// the first byte of the record
+			default: at = record.find('\n', opening) + 1; break;		// inside an invalid record
+			}
+
+			// a filler record whose length puts that byte on the boundary
+			const auto filler = to_string(++ticketNumber) + ",FILLER,1/1/2020,";
+			csv.text += filler + string(next - at - csv.text.size() - filler.size() - 1, 'f') + "\n";
+			const auto line = static_cast<size_t>(count(csv.text.begin(), csv.text.end(), '\n')) + 1;
+			csv.text += record;
+			csv.straddlers.push_back({ ++ticketNumber, line, kind == 6 ? "" : multiline });
+			csv.records += 2;
+			boundary++;
+			continue;
+		}
+
+		// an ordinary record, some quoted, some invalid and some repeated
+		const auto i = ++ticketNumber;
+		if (i % 53 == 0)
+			csv.text += to_string(i) + ",C" + to_string(i % 17) + ",1/1/2020\n";						// too few fields
+		else if (i % 41 == 0)
+			csv.text += to_string(i) + ",C" + to_string(i % 17) + ",31/4/2020,bad day\n";				// no such date
+		else if (i % 29 == 0)
+			csv.text += to_string(i) + ",C" + to_string(i % 17) + ",1/1/2020,\"quoted\"x,open\n";		// text after a quote
+		else if (i % 23 == 0)
+			csv.text += to_string(i - 7) + ",C" + to_string(i % 17) + ",1/1/2020,repeated\n";			// a duplicate number
+		else if (i % 5 == 0)
+			csv.text += to_string(i) + ",\"C, " + to_string(i % 17) + "\",2020-" + to_string(1 + i % 12) + "-" + to_string(1 + i % 28)
+				+ "," + Quote("job " + to_string(i) + "\nsays \"done\"") + "," + (i % 2 == 0 ? "0" : "true") + "\r\n";
+		else
+			csv.text += to_string(i) + ",C" + to_string(i % 17) + "," + to_string(1 + i % 28) + "/" + to_string(1 + i % 12) + "/20" + to_string(10 + i % 90)
+				+ ",job " + to_string(i) + (i % 3 == 0 ? ",closed\n" : "\n");
+		csv.records++;
+		if (i % 97 == 0)
+			csv.text += "\n \r\n"; // blank lines are skipped
+	}
+
+	csv.text.resize(size, '\n'); // the rest is blank lines
+	return csv;
+}
+
+/** CheckSameImport()
+ *	One thread and chunk_count threads import an export identically.
+ */
+static void CheckSameImport(const size_t chunk_count)
+{
+	const auto size = chunk_count * TicketImporter::min_chunk_size + 4099; // room for exactly chunk_count chunks
+	const auto csv = MakeExport(size, chunk_count);
+	LAB3_CHECK(csv.text.size() == size);
+	LAB3_CHECK(csv.straddlers.size() == chunk_count - 1);
+
+	WorkTicketStore serial, parallel;
+	const auto one = TicketImporter(',', false, 1).Import(csv.text, serial);
+	const auto many = TicketImporter(',', false, static_cast<unsigned>(chunk_count)).Import(csv.text, parallel);
+	LAB3_CHECK(one.threads == 1 && many.threads == chunk_count);
+	LAB3_CHECK(one.records + one.invalid == csv.records);
+	LAB3_CHECK(one.records > csv.records / 2 && one.invalid > 0);
+	LAB3_CHECK(many.records == one.records && many.invalid == one.invalid);
+
+	// the same errors on the same lines, in the same order
+	if (LAB3_CHECK(many.errors.size() == one.errors.size()))
+	{
+		size_t mismatches = 0;
+		for (size_t i = 0; i < one.errors.size(); i++)
+			mismatches += one.errors[i].line != many.errors[i].line || one.errors[i].message != many.errors[i].message;
+		LAB3_CHECK(mismatches == 0);
+	}
+
+	// the same tickets in the same rows
+	if (LAB3_CHECK(parallel.Size() == serial.Size() && serial.Size() == one.records))
+	{
+		size_t mismatches = 0;
+		for (WorkTicketStore::Row row = 0; row < serial.Size(); row++)
+			mismatches += serial.GetTicketNumber(row) != parallel.GetTicketNumber(row) || serial.GetClientId(row) != parallel.GetClientId(row)
+				|| serial.GetDate(row) != parallel.GetDate(row) || serial.GetDescription(row) != parallel.GetDescription(row)
+				|| serial.IsOpen(row) != parallel.IsOpen(row);
+		LAB3_CHECK(mismatches == 0);
+	}
+
+	// a batch, which keeps repeated numbers, gets the same tickets either way too
+	TicketBatch serialBatch, parallelBatch;
+	const auto oneBatched = TicketImporter(',', false, 1).Import(csv.text, serialBatch);
+	const auto manyBatched = TicketImporter(',', false, static_cast<unsigned>(chunk_count)).Import(csv.text, parallelBatch);
+	LAB3_CHECK(manyBatched.threads == chunk_count && parallelBatch.Size() == serialBatch.Size());
+	LAB3_CHECK(oneBatched.records + oneBatched.invalid == csv.records && serialBatch.Size() > serial.Size());
+	size_t mismatches = 0;
+	for (size_t i = 0; i < serialBatch.Size() && i < parallelBatch.Size(); i++)
+		mismatches += serialBatch[i].GetTicketNumber() != parallelBatch[i].GetTicketNumber() || serialBatch[i].GetClientIdView() != parallelBatch[i].GetClientIdView()
+			|| serialBatch[i].GetPackedDate() != parallelBatch[i].GetPackedDate() || serialBatch[i].GetDescriptionView() != parallelBatch[i].GetDescriptionView()
+			|| serialBatch[i].IsOpen() != parallelBatch[i].IsOpen();
+	LAB3_CHECK(mismatches == 0);
+
+	// the records across the boundaries come out whole, or are reported on their first line
+	for (const auto& straddler : csv.straddlers)
+	{
+		const auto row = parallel.Find(straddler.ticketNumber);
+		if (straddler.description.empty())
+		{
+			LAB3_CHECK(row == WorkTicketStore::no_row);
+			bool reported = false;
+			for (const auto& error : many.errors)
+				reported = reported || error.line == straddler.line;
+			LAB3_CHECK(reported);
+		}
+		else if (LAB3_CHECK(row != WorkTicketStore::no_row))
+		{
+			LAB3_CHECK(parallel.GetClientId(row) == "STRADDLE" && parallel.GetDescription(row) == straddler.description);
+			LAB3_CHECK(parallel.GetDate(row) == PackedDate(2, 3, 2021) && !parallel.IsOpen(row));
+		}
+	}
+}
+
+/** CheckHeader()
+ *	Only the first record is skipped as a header, however many threads parse.
+ */
+static void CheckHeader()
+{
+	const auto csv = MakeExport(3 * TicketImporter::min_chunk_size + 17, 3);
+	const auto withHeader = "number,client,date,description,open\n" + csv.text;
+	WorkTicketStore serial, parallel;
+	const auto one = TicketImporter(',', true, 1).Import(withHeader, serial);
+	const auto many = TicketImporter(',', true, 3).Import(withHeader, parallel);
+	LAB3_CHECK(one.records + one.invalid == csv.records);
+	LAB3_CHECK(many.records == one.records && many.invalid == one.invalid);
+	LAB3_CHECK(!one.errors.empty() && one.errors.front().line == many.errors.front().line && one.errors.back().line == many.errors.back().line);
+}
+
+int main()
+{
+	for (const size_t chunkCount : { 2, 3, 4, 7 })
+		CheckSameImport(chunkCount);
+	CheckHeader();
+	return TestSupport::Result("TicketImporterTest");
+}
@@ -0,0 +1,322 @@
+/** TicketLogTest.cpp - Write-Ahead Ticket Log Test
+ *
+ *	Checks TicketLog's CRC-32, that replaying a log rebuilds the same store
+ *	as the changes it recorded, that a torn tail is cut at the last whole
+ *	record at every byte, that a reopened log carries on after it, that a
+ *	corrupt record stops the replay, that reopening from a wrong scan_from
+ *	loses nothing, and that every durability mode keeps every record
+ *	written from several threads.
+ *
+ *	@version	2020.09
+ *	@see		TicketLog.h
+*/
+
+#include <algorithm>	// for upper_bound
+#include <chrono>		// for microseconds
+#include <cstdio>		// for remove
+#include <fstream>		// for ifstream and ofstream
+#include <iterator>		// for istreambuf_iterator
+#include <random>		// for mt19937
+#include <stdexcept>	// for runtime_error
+#include <string>		// for string
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../TicketLog.h"
+
+using namespace std;
+
+static const string log_path = "TicketLogTest.log";
+static const size_t record_count = 3000; // records WriteLog() writes
+
+/** ReadFile() and WriteFile()
+ *	The whole log file as bytes.
+ */
+static string ReadFile()
+{
+	ifstream file(log_path, ios::binary);
+	return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+static void WriteFile(const string& contents)
+{
+	ofstream file(log_path, ios::binary | ios::trunc);
+	file << contents;
+}
+
+/** RecordEnds()
+ *	The offset after each record of a log's bytes.
+ */
+static vector<size_t> RecordEnds(const string& contents)
+{
+	vector<size_t> ends;
+	for (size_t offset = TicketLog::header_size; offset + TicketLog::record_header_size <= contents.size();)
+	{
+		offset += TicketLog::record_header_size + LoadLittle<uint32_t>(reinterpret_cast<const unsigned char*>(contents.data()) + offset);
+		ends.push_back(offset);
+	}
+	return ends;
+}
+
+/** ScanAll()
+ *	Scans the log without visiting the records.
+ */
+static TicketLog::ScanResult ScanAll()
+{
+	return TicketLog::Scan(log_path, [](const TicketLog::Record&) {});
+}
+
+/** CheckSame()
+ *	Whether two stores hold the same tickets.
+ */
+static void CheckSame(const WorkTicketStore& expected, const WorkTicketStore& actual)
+{
+	LAB3_CHECK(expected.Size() == actual.Size());
+	for (WorkTicketStore::Row row = 0; row < expected.Size(); row++)
+	{
+		const auto match = actual.Find(expected.GetTicketNumber(row));
+		if (!LAB3_CHECK(match != WorkTicketStore::no_row))
+			continue;
+		LAB3_CHECK(expected.GetDate(row) == actual.GetDate(match));
+		LAB3_CHECK(expected.IsOpen(row) == actual.IsOpen(match));
+		LAB3_CHECK(expected.GetClientId(row) == actual.GetClientId(match));
+		LAB3_CHECK(expected.GetDescription(row) == actual.GetDescription(match));
+	}
+	LAB3_CHECK(expected.CountOpen() == actual.CountOpen());
+}
+
+/** CheckCrc32()
+ *	The standard check value, and continuing a checksum across pieces.
+ */
+static void CheckCrc32()
+{
+	LAB3_CHECK(TicketLog::Crc32("123456789", 9) == 0xCBF43926u);
+	LAB3_CHECK(TicketLog::Crc32("12345", 5, TicketLog::Crc32("", 0)) == TicketLog::Crc32("12345", 5));
+
+	string bytes(1000, '\0');
+	for (size_t i = 0; i < bytes.size(); i++)
+		bytes[i] = static_cast<char>(i * 7);
+	LAB3_CHECK(TicketLog::Crc32(bytes.data() + 3, 997) == TicketLog::Crc32(bytes.data() + 503, 497, TicketLog::Crc32(bytes.data() + 3, 500)));
+}
+
+/** WriteLog()
+ *	Logs random changes, making the same changes to expected.
+ *	@return (uint64_t) - the LSN of the 500th record
+ */
+static uint64_t WriteLog(WorkTicketStore& expected)
+{
+	mt19937 random(1);
+	uint64_t lsnAt500 = 0;
+	TicketLog::Options options;
+	options.durability = TicketLog::Durability::Buffered;
+	TicketLog log(log_path, options);
+	for (size_t i = 0; i < record_count; i++)
+	{
+		const int kind = random() % 6;
+		const int ticketNumber = 1 + random() % 800;
+		const auto client = "C" + to_string(random() % 50);
+		const auto description = "desc " + to_string(random()) + string(random() % 40, 'z');
+		const int day = 1 + random() % 28;
+		const int month = 1 + random() % 12;
+		const int year = 2000 + random() % 100;
+		switch (kind)
+		{
+		case 0:
+		case 1:
+		{
+			// a duplicate insert is logged, and ignored by the replay as by expected
+			expected.Insert(ticketNumber, client, PackedDate(day, month, year), description, random() % 2);
+			const auto row = expected.Find(ticketNumber);
+			log.Insert(ticketNumber, client, PackedDate(day, month, year), description, expected.IsOpen(row));
+			break;
+		}
+		case 2:
+			expected.SetWorkTicket(ticketNumber, client, day, month, year, description);
+			log.SetWorkTicket(ticketNumber, client, day, month, year, description);
+			break;
+		case 3:
+			expected.SetDate(ticketNumber, day, month, year);
+			log.SetDate(ticketNumber, day, month, year);
+			break;
+		case 4:
+			if (random() % 2)
+			{
+				expected.SetClientId(ticketNumber, client);
+				log.SetClientId(ticketNumber, client);
+			}
+			else
+			{
+				expected.SetDescription(ticketNumber, description);
+				log.SetDescription(ticketNumber, description);
+			}
+			break;
+		default:
+			expected.Close(ticketNumber);
+			log.Close(ticketNumber);
+			break;
+		}
+		if (i == 499)
+			lsnAt500 = log.LastLsn();
+	}
+	log.Flush();
+	LAB3_CHECK(log.DurableLsn() == record_count);
+	LAB3_CHECK(log.GetStats().syncs == 0);
+	return lsnAt500;
+}
+
+/** CheckReplay()
+ *	A whole replay, and one that skips what a snapshot would hold.
+ */
+static void CheckReplay(const WorkTicketStore& expected, const uint64_t lsn_at_500)
+{
+	WorkTicketStore replayed;
+	const auto result = TicketLog::Replay(log_path, replayed);
+	LAB3_CHECK(result.records == record_count && result.replayed == record_count);
+	LAB3_CHECK(result.lastLsn == record_count && result.validBytes == result.fileBytes);
+	CheckSame(expected, replayed);
+
+	WorkTicketStore tail;
+	LAB3_CHECK(TicketLog::Replay(log_path, tail, lsn_at_500).replayed == record_count - 500);
+}
+
+/** CheckDamage()
+ *	Torn tails, reopening a torn log, corruption and files that are not logs.
+ */
+static void CheckDamage()
+{
+	const auto full = ReadFile();
+	const auto recordEnds = RecordEnds(full);
+	LAB3_CHECK(recordEnds.size() == record_count);
+
+	// every cut within the last three records
+	for (auto cut = recordEnds[record_count - 4]; cut < full.size(); cut++)
+	{
+		WriteFile(full.substr(0, cut));
+		const auto result = ScanAll();
+		const size_t whole = upper_bound(recordEnds.begin(), recordEnds.end(), cut) - recordEnds.begin();
+		LAB3_CHECK(result.records == whole);
+		LAB3_CHECK(result.validBytes == (whole > 0 ? recordEnds[whole - 1] : TicketLog::header_size));
+	}
+
+	// reopening cuts the torn record off and carries on numbering from the last whole one
+	WriteFile(full.substr(0, full.size() - 3));
+	{
+		TicketLog log(log_path);
+		LAB3_CHECK(log.LastLsn() == record_count - 1);
+		LAB3_CHECK(log.Insert(5000, "CX", PackedDate(1, 1, 2020), "after crash", true) == record_count);
+	}
+	const auto reopened = ScanAll();
+	LAB3_CHECK(reopened.records == record_count && reopened.validBytes == reopened.fileBytes);
+
+	// a flipped bit in the middle stops the scan at the record before it
+	auto corrupt = full;
+	corrupt[recordEnds[1000] + 12] ^= 0x40;
+	WriteFile(corrupt);
+	LAB3_CHECK(ScanAll().records == 1001);
+
+	WriteFile("not a log at all, definitely");
+	LAB3_CHECK_THROWS(ScanAll(), runtime_error);
+	LAB3_CHECK_THROWS(TicketLog log(log_path), runtime_error);
+
+	// a file too short for a header is started again
+	WriteFile("WTKT");
+	{
+		TicketLog log(log_path);
+		log.Close(1);
+	}
+	LAB3_CHECK(ScanAll().records == 1);
+}
+
+/** CheckScanFrom()
+ *	Reopening with Options::scan_from where the next record starts, at the
+ *	end, and at offsets that are wrong, which must not truncate the log.
+ */
+static void CheckScanFrom()
+{
+	remove(log_path.c_str());
+	{
+		TicketLog log(log_path);
+		for (int i = 1; i <= 3; i++)
+			log.Insert(i, "C", PackedDate(), "record " + to_string(i), true);
+	}
+	const auto threeRecords = ReadFile();
+	const auto ends = RecordEnds(threeRecords);
+	if (!LAB3_CHECK(ends.size() == 3))
+		return;
+
+	const auto reopen = [&](const uint64_t scan_from, const uint64_t first_lsn)
+	{
+		WriteFile(threeRecords);
+		TicketLog::Options options;
+		options.scan_from = scan_from;
+		options.first_lsn = first_lsn;
+		TicketLog log(log_path, options);
+		LAB3_CHECK(log.LastLsn() == 3);
+		LAB3_CHECK(log.EndOffset() == threeRecords.size());
+	};
+	reopen(ends[0], 2);							// where record 2 starts
+	reopen(ends[2], 4);							// the end
+	reopen(TicketLog::header_size + 5, 4);		// inside record 1
+	reopen(ends[0] + 1, 2);						// inside record 2
+	reopen(ends[0], 3);							// a boundary, but not of the record expected
+	reopen(threeRecords.size() + 100, 4);		// past the end
+	LAB3_CHECK(ScanAll().records == 3 && ReadFile() == threeRecords);
+
+	// the boundary before a torn record: the torn bytes are cut, nothing else
+	WriteFile(threeRecords + "torn");
+	{
+		TicketLog::Options options;
+		options.scan_from = ends[2];
+		options.first_lsn = 4;
+		TicketLog log(log_path, options);
+		LAB3_CHECK(log.LastLsn() == 3);
+		LAB3_CHECK(log.Close(1) == 4);
+	}
+	const auto result = ScanAll();
+	LAB3_CHECK(result.records == 4 && result.lastLsn == 4 && result.validBytes == result.fileBytes);
+}
+
+/** CheckConcurrentWriters()
+ *	Eight threads append to one log in each durability mode.
+ */
+static void CheckConcurrentWriters()
+{
+	for (const auto mode : { TicketLog::Durability::Commit, TicketLog::Durability::Deferred, TicketLog::Durability::Buffered })
+	{
+		remove(log_path.c_str());
+		{
+			TicketLog::Options options;
+			options.durability = mode;
+			options.commit_delay = chrono::microseconds(mode == TicketLog::Durability::Commit ? 0 : 200);
+			TicketLog log(log_path, options);
+			vector<thread> threads;
+			for (int t = 0; t < 8; t++)
+			{
+				threads.emplace_back([&, t]()
+				{
+					for (int i = 0; i < 500; i++)
+						log.Insert(t * 1000 + i + 1, "C", PackedDate(), "d", true);
+				});
+			}
+			for (auto& thread : threads)
+				thread.join();
+		}
+		WorkTicketStore replayed;
+		LAB3_CHECK(TicketLog::Replay(log_path, replayed).records == 4000);
+		LAB3_CHECK(replayed.Size() == 4000);
+	}
+}
+
+int main()
+{
+	CheckCrc32();
+	remove(log_path.c_str());
+	WorkTicketStore expected;
+	const auto lsnAt500 = WriteLog(expected);
+	CheckReplay(expected, lsnAt500);
+	CheckDamage();
+	CheckScanFrom();
+	CheckConcurrentWriters();
+	remove(log_path.c_str());
+	return TestSupport::Result("TicketLogTest");
+}
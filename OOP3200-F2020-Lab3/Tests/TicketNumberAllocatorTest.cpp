@@ -0,0 +1,154 @@
+/** TicketNumberAllocatorTest.cpp - Ticket Number Allocator Test
+ *
+ *	Checks that TicketNumberAllocator hands out unique, increasing ticket
+ *	numbers from many threads at several block sizes, that Recover() and
+ *	Observe() continue above existing tickets, and that it throws instead
+ *	of wrapping past INT_MAX.
+ *
+ *	@version	2020.09
+ *	@see		TicketNumberAllocator.h
+*/
+
+#include <climits>		// for INT_MAX
+#include <cstdio>		// for remove
+#include <stdexcept>	// for overflow_error and invalid_argument
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../TicketNumberAllocator.h"
+
+using namespace std;
+
+/** CheckUnique()
+ *	Eight threads take numbers from one allocator; each thread's are
+ *	increasing and no number is handed out twice.
+ */
+static void CheckUnique(const int block_size)
+{
+	TicketNumberAllocator allocator(block_size);
+	vector<vector<int>> taken(8);
+	vector<thread> threads;
+	for (size_t t = 0; t < taken.size(); t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (int i = 0; i < 100000; i++)
+				taken[t].push_back(allocator.Next());
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	vector<char> seen(allocator.HighWaterMark() + 1, 0);
+	for (const auto& numbers : taken)
+	{
+		for (size_t i = 0; i < numbers.size(); i++)
+		{
+			LAB3_CHECK(numbers[i] > 0 && !seen[numbers[i]]);
+			seen[numbers[i]] = 1;
+			if (i > 0)
+				LAB3_CHECK(numbers[i] > numbers[i - 1]);
+		}
+	}
+}
+
+/** CheckSeveralAllocators()
+ *	Allocators used in turn on one thread keep their own blocks.
+ */
+static void CheckSeveralAllocators()
+{
+	TicketNumberAllocator first, second(64, 1000), third(8), fourth(8), fifth(8);
+	vector<char> seenFirst(10000), seenSecond(10000);
+	for (int i = 0; i < 500; i++)
+	{
+		const int a = first.Next();
+		const int b = second.Next();
+		LAB3_CHECK(!seenFirst[a]);
+		seenFirst[a] = 1;
+		LAB3_CHECK(b > 1000 && !seenSecond[b]);
+		seenSecond[b] = 1;
+		third.Next();
+		fourth.Next();
+	}
+	LAB3_CHECK(first.HighWaterMark() == 512);
+
+	const int before = first.HighWaterMark();
+	fifth.Next();
+	first.Next();
+	LAB3_CHECK(first.HighWaterMark() > before);
+}
+
+/** CheckRecovery()
+ *	Numbering continues above the tickets of a store or segment file.
+ */
+static void CheckRecovery()
+{
+	const char* path = "TicketNumberAllocatorTest.seg";
+	WorkTicketStore store;
+	store.Insert(5, "c", PackedDate(), "d", true);
+	store.Insert(4242, "c", PackedDate(), "d", false);
+	store.Insert(17, "c", PackedDate(), "d", true);
+
+	TicketNumberAllocator fromStore;
+	fromStore.Recover(store);
+	LAB3_CHECK(fromStore.HighWaterMark() == 4242);
+	LAB3_CHECK(fromStore.Next() == 4243);
+
+	TicketSegmentWriter writer;
+	writer.Add(store);
+	writer.Write(path);
+	{
+		const TicketSegmentReader segment(path);
+		TicketNumberAllocator fromSegment(1);
+		fromSegment.Observe(10);
+		fromSegment.Recover(segment);
+		LAB3_CHECK(fromSegment.Next() == 4243);
+		fromSegment.Observe(100); // lower, so no change
+		LAB3_CHECK(fromSegment.Next() == 4244);
+	}
+	remove(path);
+
+	TicketNumberAllocator empty;
+	empty.Recover(WorkTicketStore());
+	LAB3_CHECK(empty.Next() == 1);
+}
+
+/** CheckLimits()
+ *	Overflow at INT_MAX and invalid arguments.
+ */
+static void CheckLimits()
+{
+	TicketNumberAllocator nearLimit(64, INT_MAX - 3);
+	int handedOut = 0;
+	try
+	{
+		for (;;)
+		{
+			LAB3_CHECK(nearLimit.Next() >= INT_MAX - 2);
+			handedOut++;
+		}
+	}
+	catch (const overflow_error&)
+	{
+	}
+	LAB3_CHECK(handedOut == 3);
+	LAB3_CHECK_THROWS(nearLimit.Next(), overflow_error);
+
+	TicketNumberAllocator lastOne(1, INT_MAX - 1);
+	LAB3_CHECK(lastOne.Next() == INT_MAX);
+	LAB3_CHECK_THROWS(lastOne.Next(), overflow_error);
+	LAB3_CHECK(lastOne.HighWaterMark() == INT_MAX);
+
+	LAB3_CHECK_THROWS(TicketNumberAllocator(0), invalid_argument);
+	LAB3_CHECK_THROWS(TicketNumberAllocator(1, -1), invalid_argument);
+}
+
+int main()
+{
+	for (const int blockSize : { 1, 7, 64 })
+		CheckUnique(blockSize);
+	CheckSeveralAllocators();
+	CheckRecovery();
+	CheckLimits();
+	return TestSupport::Result("TicketNumberAllocatorTest");
+}
@@ -0,0 +1,144 @@
+/** TicketReaderTest.cpp - Streaming Work Ticket Reader Test
+ *
+ *	Checks that ParseRecord() and ValidateFields() accept good records and
+ *	give the right reason for each broken rule, that a reader skips bad
+ *	records and blank lines and reports each bad one with its line number,
+ *	from a stream and from a buffer, and that tickets read or constructed
+ *	with a day past 12 keep the day and month apart.
+ *
+ *	@version	2020.09
+ *	@see		TicketReader.h
+*/
+
+#include <sstream>		// for istringstream
+#include <stdexcept>	// for invalid_argument
+#include <string>		// for string
+#include <string_view>	// for string_view
+#include "TestSupport.h"
+#include "../TicketReader.h"
+
+using namespace std;
+
+/** Reason()
+ *	Why a line is not a valid record, or "" if it is.
+ */
+static string Reason(const string_view line, const char delimiter = '\t')
+{
+	TicketReader::Record record{};
+	const auto error = TicketReader::ParseRecord(line, delimiter, record);
+	return error == nullptr ? "" : error;
+}
+
+/** CheckFields()
+ *	Every rule of ParseRecord() and ValidateFields().
+ */
+static void CheckFields()
+{
+	TicketReader::Record record{};
+	LAB3_CHECK(TicketReader::ParseRecord("7\tACME-1\t25/12/2020\tPrinter jam", '\t', record) == nullptr);
+	LAB3_CHECK(record.ticketNumber == 7 && record.clientId == "ACME-1" && record.description == "Printer jam" && record.isOpen);
+	LAB3_CHECK(record.date == PackedDate(25, 12, 2020));
+	LAB3_CHECK(TicketReader::ParseRecord("8,ACME-2,2021-02-28,Toner,closed", ',', record) == nullptr);
+	LAB3_CHECK(record.ticketNumber == 8 && record.date == PackedDate(28, 2, 2021) && !record.isOpen);
+
+	for (const auto open : { "1", "true", "open" })
+		LAB3_CHECK(Reason("1\tc\t1/1/2020\td\t" + string(open)) == "");
+	for (const auto closed : { "0", "false", "closed" })
+		LAB3_CHECK(Reason("1\tc\t1/1/2020\td\t" + string(closed)) == "");
+
+	LAB3_CHECK(Reason("1\tc\t1/1/2020") == "expected ticket number, client ID, date and description");
+	LAB3_CHECK(Reason("1\tc\t1/1/2020\td\t1\textra") == "too many fields");
+	LAB3_CHECK(Reason("x1\tc\t1/1/2020\td") == "ticket number is not a whole number");
+	LAB3_CHECK(Reason("1x\tc\t1/1/2020\td") == "ticket number is not a whole number");
+	LAB3_CHECK(Reason("99999999999\tc\t1/1/2020\td") == "ticket number is not a whole number");
+	LAB3_CHECK(Reason("\tc\t1/1/2020\td") == "ticket number is not a whole number");
+	LAB3_CHECK(Reason("0\tc\t1/1/2020\td") == "ticket number must be greater than zero");
+	LAB3_CHECK(Reason("-4\tc\t1/1/2020\td") == "ticket number must be greater than zero");
+	LAB3_CHECK(Reason("1\t\t1/1/2020\td") == "client ID is empty");
+	LAB3_CHECK(Reason("1\tc\t1/1/2020\t") == "description is empty");
+	LAB3_CHECK(Reason("1\tc\t\td") == DateParser::Describe(DateParser::Status::Empty));
+	LAB3_CHECK(Reason("1\tc\t1.1.2020\td") == DateParser::Describe(DateParser::Status::BadFormat));
+	LAB3_CHECK(Reason("1\tc\t30/2/2020\td") == DateParser::Describe(DateParser::Status::InvalidDay));
+	LAB3_CHECK(Reason("1\tc\t1/13/2020\td") == DateParser::Describe(DateParser::Status::InvalidMonth));
+	LAB3_CHECK(Reason("1\tc\t31/12/1999\td") == "year must be between 2000 and 2099");
+	LAB3_CHECK(Reason("1\tc\t1/1/2100\td") == "year must be between 2000 and 2099");
+	LAB3_CHECK(Reason("1\tc\t1/1/2020\td\tmaybe") == "open flag must be 1/0, true/false or open/closed");
+
+	// fields split by another parser go through the same rules
+	const string_view fields[] = { "12", "c", "31/1/2020", "d", "false" };
+	LAB3_CHECK(TicketReader::ValidateFields(fields, 5, record) == nullptr && record.ticketNumber == 12 && !record.isOpen);
+	LAB3_CHECK(TicketReader::ValidateFields(fields, 3, record) != nullptr);
+}
+
+/** CheckLineNumbers()
+ *	Skipped records are reported with their line numbers, counting blank
+ *	lines, from a stream and from a buffer.
+ */
+static void CheckLineNumbers()
+{
+	const string text =
+		"1\tACME\t13/1/2020\tFirst\r\n"		// 1
+		"\n"								// 2: blank
+		"0\tACME\t1/1/2020\tZero\n"			// 3: bad number
+		"   \t \n"							// 4: blank
+		"2\tACME\t2020-01-31\tSecond\t0\n"	// 5
+		"3\t\t1/1/2020\tNo client\n"		// 6: empty client ID
+		"4\tACME\t31/4/2020\tBad day\r\n"	// 7: bad day
+		"5\tACME\t28/2/2099\tLast";			// 8, no line ending
+
+	for (int source = 0; source < 2; source++)
+	{
+		istringstream stream(text);
+		TicketReader reader = source == 0 ? TicketReader(stream) : TicketReader(string_view(text));
+		ExtendedWorkTicket ticket;
+		int read[3] = {};
+		int count = 0;
+		while (reader.Read(ticket))
+		{
+			if (count < 3)
+				read[count] = ticket.GetTicketNumber();
+			count++;
+			if (ticket.GetTicketNumber() == 1)
+				LAB3_CHECK(ticket.GetDate() == MyDate(13, 1, 2020) && ticket.GetDescription() == "First" && ticket.IsOpen());
+			if (ticket.GetTicketNumber() == 2)
+				LAB3_CHECK(ticket.GetDate() == MyDate(31, 1, 2020) && !ticket.IsOpen());
+		}
+		LAB3_CHECK(count == 3 && read[0] == 1 && read[1] == 2 && read[2] == 5);
+		LAB3_CHECK(reader.GetLineNumber() == 8 && reader.GetRecordCount() == 3);
+
+		const auto& errors = reader.GetErrors();
+		if (!LAB3_CHECK(errors.size() == 3))
+			continue;
+		LAB3_CHECK(errors[0].line == 3 && errors[0].message == "ticket number must be greater than zero");
+		LAB3_CHECK(errors[1].line == 6 && errors[1].message == "client ID is empty");
+		LAB3_CHECK(errors[2].line == 7 && errors[2].message == DateParser::Describe(DateParser::Status::InvalidDay));
+	}
+
+	// a plain WorkTicket is read the same way
+	TicketReader reader(string_view("9\tACME\t25/12/2021\tHoliday"));
+	WorkTicket ticket;
+	LAB3_CHECK(reader.Read(ticket) && ticket.GetTicketNumber() == 9 && ticket.GetDate() == MyDate(25, 12, 2021));
+	LAB3_CHECK(!reader.Read(ticket));
+}
+
+/** CheckConstructors()
+ *	The parameterized constructors take the day before the month.
+ */
+static void CheckConstructors()
+{
+	const WorkTicket ticket(1, "ACME", 25, 12, 2020, "Christmas");
+	LAB3_CHECK(ticket.GetDate() == MyDate(25, 12, 2020));
+	const ExtendedWorkTicket extended(2, "ACME", 31, 1, 2021, "Month end", false);
+	LAB3_CHECK(extended.GetDate() == MyDate(31, 1, 2021) && !extended.IsOpen());
+	const ExtendedWorkTicket small(3, "ACME", 2, 3, 2021, "Second of March", true);
+	LAB3_CHECK(small.GetDate().GetDay() == 2 && small.GetDate().GetMonth() == 3);
+	LAB3_CHECK_THROWS(WorkTicket(4, "ACME", 12, 25, 2020, "no 25th month"), out_of_range);
+}
+
+int main()
+{
+	CheckFields();
+	CheckLineNumbers();
+	CheckConstructors();
+	return TestSupport::Result("TicketReaderTest");
+}
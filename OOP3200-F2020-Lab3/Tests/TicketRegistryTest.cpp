@@ -0,0 +1,145 @@
+/** TicketRegistryTest.cpp - Concurrent Ticket Registry Test
+ *
+ *	Runs writer, updater and reader threads against one TicketRegistry.
+ *	Every write keeps a ticket's client ID, description and day in step
+ *	("C<k>", "D<k>..." and day k % 28 + 1), so a reader that sees a mix of
+ *	two writes fails a check. Then checks the single-threaded edge cases,
+ *	including that a ticket ExtendedWorkTicket would reject is never added.
+ *
+ *	@version	2020.09
+ *	@see		TicketRegistry.h
+*/
+
+#include <atomic>		// for atomic
+#include <random>		// for minstd_rand
+#include <string>		// for string and stoi
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../TicketRegistry.h"
+
+using namespace std;
+
+static const int ticket_count = 20000;	// tickets the writers insert
+static const int variants = 97;			// distinct client/description/day combinations
+
+/** Client() and Description()
+ *	The client ID and description of variant k.
+ */
+static string Client(const int k) { return "C" + to_string(k); }
+static string Description(const int k) { return "D" + to_string(k) + string(k % 50, 'x'); }
+
+/** CheckConcurrentAccess()
+ *	Two inserting threads, two updating threads and three reading threads.
+ */
+static void CheckConcurrentAccess(TicketRegistry& registry)
+{
+	atomic<long> failed{ 0 };	// inserts that failed and torn reads
+	atomic<long> found{ 0 };	// reads that found their ticket
+	vector<thread> threads;
+	for (int writer = 0; writer < 2; writer++)
+	{
+		threads.emplace_back([&, writer]()
+		{
+			for (int i = 1 + writer; i <= ticket_count; i += 2)
+			{
+				const int k = i % variants;
+				if (!registry.Insert(i, Client(k), PackedDate(k % 28 + 1, 1, 2020), Description(k), true))
+					failed++;
+			}
+		});
+	}
+	for (int updater = 0; updater < 2; updater++)
+	{
+		threads.emplace_back([&, updater]()
+		{
+			minstd_rand random(updater);
+			for (int j = 0; j < 200000; j++)
+			{
+				const int i = random() % ticket_count + 1;
+				const int k = random() % variants;
+				if (j % 3 == 0)
+					registry.Close(i);
+				else
+					registry.SetWorkTicket(i, Client(k), k % 28 + 1, 1, 2020, Description(k));
+			}
+		});
+	}
+	for (int reader = 0; reader < 3; reader++)
+	{
+		threads.emplace_back([&, reader]()
+		{
+			minstd_rand random(100 + reader);
+			TicketRegistry::TicketView view;
+			for (int j = 0; j < 400000; j++)
+			{
+				const int i = random() % ticket_count + 1;
+				if (registry.Find(i, view))
+				{
+					found++;
+					const int k = stoi(string(view.ClientId()).substr(1));
+					if (view.ticketNumber != i || string(view.description) != Description(k) || view.date.GetDay() != k % 28 + 1)
+						failed++;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	LAB3_CHECK(failed == 0);
+	LAB3_CHECK(found > 0);
+	LAB3_CHECK(registry.Size() == static_cast<size_t>(ticket_count));
+	for (int i = 1; i <= ticket_count; i++)
+	{
+		ExtendedWorkTicket ticket;
+		LAB3_CHECK(registry.Find(i, ticket) && ticket.GetTicketNumber() == i);
+	}
+}
+
+/** CheckEdgeCases()
+ *	Rejected inserts and updates, missing tickets and shard counts.
+ */
+static void CheckEdgeCases(TicketRegistry& registry)
+{
+	LAB3_CHECK(!registry.Insert(5, "x", PackedDate(), "y", true));	// already there
+	LAB3_CHECK(!registry.Insert(0, "x", PackedDate(), "y", true));
+
+	// the rules of WorkTicket::SetWorkTicket, so every ticket can be copied out
+	const int unused = ticket_count + 5;
+	LAB3_CHECK(!registry.Insert(unused, "x", PackedDate(), "", true));
+	LAB3_CHECK(!registry.Insert(unused, "", PackedDate(), "y", true));
+	LAB3_CHECK(!registry.Insert(unused, "x", PackedDate(31, 12, 1999), "y", true));
+	LAB3_CHECK(!registry.Insert(unused, "x", PackedDate(1, 1, 2100), "y", true));
+	ExtendedWorkTicket ticket;
+	ticket.SetWorkTicket(9, "CLIENT", 1, 2, 2020, "OLD", true);
+	LAB3_CHECK(!registry.Find(unused, ticket));
+	LAB3_CHECK(ticket.GetTicketNumber() == 9 && ticket.GetDescription() == "OLD");
+	LAB3_CHECK(registry.Insert(unused, "x", PackedDate(31, 12, 2099), "y", false));
+	LAB3_CHECK(registry.Find(unused, ticket) && ticket.GetTicketNumber() == unused && !ticket.IsOpen());
+	LAB3_CHECK(ticket.GetDate() == MyDate(31, 12, 2099) && ticket.GetClientId() == "x" && ticket.GetDescription() == "y");
+	LAB3_CHECK(!registry.Close(ticket_count + 1));
+	LAB3_CHECK(!registry.SetWorkTicket(1, "", 1, 1, 2020, "d"));
+	LAB3_CHECK(!registry.SetWorkTicket(1, "c", 30, 2, 2020, "d"));
+
+	TicketRegistry::TicketView view;
+	LAB3_CHECK(registry.Close(7));
+	LAB3_CHECK(registry.Find(7, view) && !view.isOpen);
+
+	TicketRegistry single(1);
+	for (int i = 1; i <= 1000; i++)
+		single.Insert(i * 64, "c", PackedDate(), "d", i % 2);
+	for (int i = 1; i <= 1000; i++)
+		LAB3_CHECK(single.Find(i * 64, view) && view.isOpen == (i % 2 == 1));
+	LAB3_CHECK(!single.Find(65, view));
+	LAB3_CHECK(single.ShardCount() == 1);
+	LAB3_CHECK(TicketRegistry(3).ShardCount() == 4);
+}
+
+int main()
+{
+	TicketRegistry registry(8);
+	CheckConcurrentAccess(registry);
+	CheckEdgeCases(registry);
+	return TestSupport::Result("TicketRegistryTest");
+}
@@ -0,0 +1,222 @@
+/** TicketSegmentTest.cpp - Binary Ticket Segment Test
+ *
+ *	Writes a segment and reads it back through TicketView and Load(), then
+ *	corrupts copies of it byte by byte and checks that the reader refuses
+ *	them, or that the broken row is reported rather than copied out.
+ *
+ *	@version	2020.09
+ *	@see		TicketSegment.h
+*/
+
+#include <cstdio>		// for remove
+#include <fstream>		// for ifstream and ofstream
+#include <iterator>		// for istreambuf_iterator
+#include <stdexcept>	// for runtime_error and out_of_range
+#include <string>		// for string and to_string
+#include "TestSupport.h"
+#include "../TicketSegment.h"
+
+using namespace std;
+
+static const char* path = "TicketSegmentTest.seg";			// the segment written
+static const char* broken_path = "TicketSegmentTest.bad.seg";	// the corrupted copies
+
+/** ReadFile()
+ *	Returns the bytes of a file.
+ */
+static string ReadFile(const char* file)
+{
+	ifstream in(file, ios::binary);
+	return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+/** WriteFile()
+ *	Replaces a file with the given bytes.
+ */
+static void WriteFile(const char* file, const string& bytes)
+{
+	ofstream out(file, ios::binary | ios::trunc);
+	out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+}
+
+/** Store()
+ *	Overwrites a little-endian value at a byte offset.
+ */
+template <typename T>
+static void Store(string& bytes, const size_t at, const T value)
+{
+	string encoded;
+	AppendLittle(encoded, value);
+	bytes.replace(at, encoded.size(), encoded);
+}
+
+/** Section()
+ *	Returns the byte offset of a section, as the header records it.
+ */
+static size_t Section(const string& bytes, const int section)
+{
+	return static_cast<size_t>(LoadLittle<uint64_t>(reinterpret_cast<const unsigned char*>(bytes.data()) + TicketSegmentHeader::sections_at + section * 8));
+}
+
+/** Opens()
+ *	Whether the reader accepts the bytes as a segment.
+ */
+static bool Opens(const string& bytes)
+{
+	WriteFile(broken_path, bytes);
+	try
+	{
+		TicketSegmentReader reader(broken_path);
+		return true;
+	}
+	catch (const runtime_error&)
+	{
+		return false;
+	}
+}
+
+/** CheckRoundTrip()
+ *	Every field comes back as it was added, through a view and through Load().
+ */
+static void CheckRoundTrip()
+{
+	TicketSegmentWriter writer;
+	for (int i = 1; i <= 500; i++)
+		writer.Add(i, "client" + to_string(i % 7), PackedDate(1 + i % 28, 1 + i % 12, 2000 + i % 100), "description " + to_string(i), i % 3 != 0);
+	writer.SetLogPosition(42, 4200);
+	LAB3_CHECK(writer.Size() == 500);
+	writer.Write(path);
+
+	const TicketSegmentReader reader(path);
+	LAB3_CHECK(reader.Size() == 500 && reader.ClientCount() == 7);
+	LAB3_CHECK(reader.LogLsn() == 42 && reader.LogOffset() == 4200);
+	for (size_t row = 0; row < reader.Size(); row++)
+	{
+		const int i = static_cast<int>(row) + 1;
+		const auto view = reader[row];
+		LAB3_CHECK(view.GetTicketNumber() == i);
+		LAB3_CHECK(view.GetPackedDate() == PackedDate(1 + i % 28, 1 + i % 12, 2000 + i % 100));
+		LAB3_CHECK(view.IsOpen() == (i % 3 != 0));
+		LAB3_CHECK(view.GetClientId() == "client" + to_string(i % 7));
+		LAB3_CHECK(view.GetDescription() == "description " + to_string(i));
+
+		const auto ticket = view.ToExtendedWorkTicket();
+		LAB3_CHECK(ticket.HasValue() && ticket.Value().GetTicketNumber() == i && ticket.Value().GetDate() == MyDate(1 + i % 28, 1 + i % 12, 2000 + i % 100)
+			&& ticket.Value().IsOpen() == (i % 3 != 0) && ticket.Value().GetDescription() == "description " + to_string(i));
+	}
+
+	// loading skips the numbers the store already has
+	WorkTicketStore store;
+	LAB3_CHECK(store.Insert(7, "mine", PackedDate(1, 1, 2020), "kept", true));
+	LAB3_CHECK(reader.Load(store) == 499);
+	LAB3_CHECK(store.Size() == 500);
+	LAB3_CHECK(store.GetDescription(store.Find(7)) == "kept");
+	LAB3_CHECK(store.GetClientId(store.Find(500)) == "client3" && store.IsOpen(store.Find(500)));
+
+	// a cleared writer writes an empty segment
+	writer.Clear();
+	writer.Write(broken_path);
+	const TicketSegmentReader empty(broken_path);
+	LAB3_CHECK(empty.Size() == 0 && empty.ClientCount() == 0 && empty.LogLsn() == 0);
+}
+
+/** CheckCorruptHeaders()
+ *	A short, truncated, foreign or newer file is refused.
+ */
+static void CheckCorruptHeaders()
+{
+	const auto good = ReadFile(path);
+	LAB3_CHECK(Opens(good));
+	LAB3_CHECK(!Opens(good.substr(0, TicketSegmentHeader::size - 1)));
+	LAB3_CHECK(!Opens(good.substr(0, good.size() - 1)));
+	LAB3_CHECK(!Opens(good + string(8, '\0')));
+
+	auto magic = good;
+	magic[TicketSegmentHeader::magic_at] = 'X';
+	LAB3_CHECK(!Opens(magic));
+
+	auto version = good;
+	Store(version, TicketSegmentHeader::version_at, TicketSegmentHeader::version + 1);
+	LAB3_CHECK(!Opens(version));
+
+	auto count = good;
+	Store(count, TicketSegmentHeader::ticket_count_at, uint64_t{ 1 } << 40);
+	LAB3_CHECK(!Opens(count));
+
+	auto section = good;
+	Store(section, TicketSegmentHeader::sections_at + TicketSegmentHeader::DescriptionHeap * 8, uint64_t{ good.size() + 8 });
+	LAB3_CHECK(!Opens(section));
+
+	LAB3_CHECK_THROWS(TicketSegmentReader("TicketSegmentTest.missing.seg"), runtime_error);
+}
+
+/** CheckCorruptRows()
+ *	A row whose offsets point outside the heap throws, and one that breaks
+ *	the ticket rules is reported by ToExtendedWorkTicket() and skipped by Load().
+ */
+static void CheckCorruptRows()
+{
+	const auto good = ReadFile(path);
+
+	// the end of row 0's description, past the end of the heap
+	auto offset = good;
+	Store(offset, Section(good, TicketSegmentHeader::DescriptionOffsets) + 8, uint64_t{ good.size() });
+	if (LAB3_CHECK(Opens(offset)))
+	{
+		const TicketSegmentReader reader(broken_path);
+		LAB3_CHECK_THROWS(reader[0].GetDescription(), runtime_error);
+		LAB3_CHECK_THROWS(reader[0].ToExtendedWorkTicket(), runtime_error);
+		LAB3_CHECK(reader[2].GetDescription() == "description 3");
+		WorkTicketStore store;
+		LAB3_CHECK_THROWS(reader.Load(store), runtime_error);
+	}
+
+	// a client index past the client table
+	auto client = good;
+	Store(client, Section(good, TicketSegmentHeader::ClientIndexes) + 4, uint32_t{ 7 });
+	if (LAB3_CHECK(Opens(client)))
+	{
+		const TicketSegmentReader reader(broken_path);
+		LAB3_CHECK_THROWS(reader[1].GetClientId(), runtime_error);
+		WorkTicketStore store;
+		LAB3_CHECK_THROWS(reader.Load(store), runtime_error);
+	}
+
+	// a day number no date has
+	auto day = good;
+	Store(day, Section(good, TicketSegmentHeader::DayNumbers), int32_t{ 0 });
+	if (LAB3_CHECK(Opens(day)))
+	{
+		const TicketSegmentReader reader(broken_path);
+		const auto ticket = reader[0].ToExtendedWorkTicket();
+		LAB3_CHECK(!ticket.HasValue() && ticket.Error().Code() == ValidationCode::InvalidDayNumber);
+		LAB3_CHECK(reader[1].ToExtendedWorkTicket().HasValue());
+	}
+
+	// a real date outside the years a ticket may have
+	TicketSegmentWriter writer;
+	writer.Add(1, "c", PackedDate(31, 12, 1999), "d", true);
+	writer.Add(2, "c", PackedDate(1, 1, 2000), "d", true);
+	writer.Add(0, "c", PackedDate(1, 1, 2000), "d", true);
+	writer.Write(broken_path);
+	{
+		const TicketSegmentReader reader(broken_path);
+		const auto early = reader[0].ToExtendedWorkTicket();
+		LAB3_CHECK(!early.HasValue() && early.Error().Code() == ValidationCode::InvalidTicketYear);
+		const auto zero = reader[2].ToExtendedWorkTicket();
+		LAB3_CHECK(!zero.HasValue() && zero.Error().Code() == ValidationCode::InvalidTicketNumber);
+		WorkTicketStore store;
+		LAB3_CHECK(reader.Load(store) == 1);
+		LAB3_CHECK(store.Size() == 1 && store.Find(2) != WorkTicketStore::no_row);
+	}
+}
+
+int main()
+{
+	CheckRoundTrip();
+	CheckCorruptHeaders();
+	CheckCorruptRows();
+	remove(path);
+	remove(broken_path);
+	return TestSupport::Result("TicketSegmentTest");
+}
@@ -0,0 +1,332 @@
+/** TicketSnapshotsTest.cpp - Snapshot and Log Recovery Test
+ *
+ *	Keeps a store and a TicketLog of its changes while snapshots are written,
+ *	in the background and not, then checks that Recover() from the newest
+ *	snapshot and the log after it gives the same tickets, dates and text
+ *	matches as the store. Also checks the fallbacks: a wrong log offset, a
+ *	torn newer snapshot, no snapshots and a lost log; that a failed
+ *	background write neither blocks nor haunts the next one; and that store
+ *	copies, snapshots and deferred indexes keep to their own changes, and
+ *	that deferred indexes are rebuilt once when several threads query them.
+ *
+ *	@version	2020.09
+ *	@see		TicketSnapshots.h
+*/
+
+#include <cstdio>		// for remove
+#include <exception>	// for exception
+#include <filesystem>	// for remove_all, copy_file and resize_file
+#include <fstream>		// for ofstream
+#include <stdexcept>	// for invalid_argument
+#include <string>		// for string
+#include <thread>		// for thread and yield
+#include <utility>		// for move
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../TicketSnapshots.h"
+
+using namespace std;
+
+static const string snapshot_folder = "TicketSnapshotsTest";
+static const string log_path = "TicketSnapshotsTest.log";
+
+/** CheckSame()
+ *	Whether two stores hold the same tickets, and answer date and text
+ *	queries the same way.
+ */
+static void CheckSame(const WorkTicketStore& expected, const WorkTicketStore& actual)
+{
+	LAB3_CHECK(expected.Size() == actual.Size());
+	for (WorkTicketStore::Row row = 0; row < expected.Size(); row++)
+	{
+		const auto match = actual.Find(expected.GetTicketNumber(row));
+		if (!LAB3_CHECK(match != WorkTicketStore::no_row))
+			continue;
+		LAB3_CHECK(expected.GetDate(row) == actual.GetDate(match));
+		LAB3_CHECK(expected.IsOpen(row) == actual.IsOpen(match));
+		LAB3_CHECK(expected.GetClientId(row) == actual.GetClientId(match));
+		LAB3_CHECK(expected.GetDescription(row) == actual.GetDescription(match));
+	}
+	LAB3_CHECK(expected.CountOpen() == actual.CountOpen());
+
+	const PackedDate first(1, 1, 2000), last(31, 12, 2099), from(1, 3, 2010), to(1, 3, 2030);
+	LAB3_CHECK(expected.CountByDate(first, last) == actual.CountByDate(first, last));
+	LAB3_CHECK(expected.CountByDate(from, to) == actual.CountByDate(from, to));
+	LAB3_CHECK(expected.SelectByDate(from, PackedDate(1, 3, 2011)).size() == actual.SelectByDate(from, PackedDate(1, 3, 2011)).size());
+	for (const auto query : { "printer", "floor 7", "toner", "replaced" })
+	{
+		LAB3_CHECK(expected.TextIndex().MatchAll(query) == actual.TextIndex().MatchAll(query));
+		LAB3_CHECK(expected.TextIndex().MatchPhrase(query) == actual.TextIndex().MatchPhrase(query));
+	}
+}
+
+/** Apply()
+ *	Makes change i to the store and logs it: 20,000 inserts, then closes,
+ *	rewrites and date changes.
+ */
+static void Apply(const int i, WorkTicketStore& store, TicketLog& log)
+{
+	const int ticketNumber = 1 + i % 20000;
+	if (i < 20000)
+	{
+		const auto client = "CLIENT-" + to_string(i % 50);
+		const PackedDate date(1 + i % 28, 1 + i % 12, 2000 + i % 100);
+		const auto description = "Printer on floor " + to_string(i % 40) + " will not print";
+		log.Insert(ticketNumber, client, date, description, true);
+		store.Insert(ticketNumber, client, date, description, true);
+	}
+	else if (i % 3 == 0)
+	{
+		log.Close(ticketNumber);
+		store.Close(ticketNumber);
+	}
+	else if (i % 3 == 1)
+	{
+		const auto description = "Toner replaced " + to_string(i);
+		log.SetWorkTicket(ticketNumber, "CLIENT-9", 2, 3, 2021, description);
+		store.SetWorkTicket(ticketNumber, "CLIENT-9", 2, 3, 2021, description);
+	}
+	else
+	{
+		log.SetDate(ticketNumber, 5, 6, 2015);
+		store.SetDate(ticketNumber, 5, 6, 2015);
+	}
+}
+
+/** WriteHistory()
+ *	34,000 changes with three snapshots among them, two written in the
+ *	background while changes carry on. The newest covers all but the last 1,000.
+ */
+static void WriteHistory(WorkTicketStore& live)
+{
+	TicketSnapshots snapshots(snapshot_folder);
+	TicketLog::Options options;
+	options.durability = TicketLog::Durability::Deferred;
+	TicketLog log(log_path, options);
+
+	int i = 0;
+	for (; i < 25000; i++)
+		Apply(i, live, log);
+	LAB3_CHECK(snapshots.WriteInBackground(live, log));
+	for (; i < 30000; i++)
+		Apply(i, live, log);
+	snapshots.Wait();
+	for (; i < 32000; i++)
+		Apply(i, live, log);
+	snapshots.Write(live, log.LastLsn());
+	for (; i < 33000; i++)
+		Apply(i, live, log);
+	LAB3_CHECK(snapshots.WriteInBackground(live, log));
+	snapshots.Wait();
+	for (; i < 34000; i++)
+		Apply(i, live, log);
+	LAB3_CHECK(snapshots.List().size() == 2); // the oldest is pruned
+}
+
+/** CheckRecovery()
+ *	Recovers from the newest snapshot and the log tail, replays the tail
+ *	from wrong offsets, and reopens the log where recovery left it.
+ */
+static void CheckRecovery(WorkTicketStore& live)
+{
+	WorkTicketStore recovered;
+	const TicketSnapshots snapshots(snapshot_folder);
+	const auto result = snapshots.Recover(recovered, log_path);
+	LAB3_CHECK(result.log.records == 1000 && result.log.replayed == 1000);
+	CheckSame(live, recovered);
+
+	// a wrong offset falls back to scanning the whole log
+	for (const auto offset : { uint64_t(17), result.logOffset - 3, result.logOffset + 5 })
+	{
+		WorkTicketStore store;
+		TicketSegmentReader(result.snapshot).Load(store);
+		LAB3_CHECK(TicketLog::Replay(log_path, store, result.snapshotLsn, offset).replayed == 1000);
+		CheckSame(live, store);
+	}
+
+	// reopening from where recovery stopped reads nothing again
+	{
+		TicketLog::Options options;
+		options.first_lsn = result.NextLsn();
+		options.scan_from = result.log.validBytes;
+		TicketLog log(log_path, options);
+		LAB3_CHECK(log.LastLsn() == 34000);
+		LAB3_CHECK(log.EndOffset() == result.log.validBytes);
+		LAB3_CHECK(log.Close(1) == 34001);
+		log.Flush();
+	}
+	const auto whole = TicketLog::Scan(log_path, [](const TicketLog::Record&) {});
+	LAB3_CHECK(whole.lastLsn == 34001 && whole.records == 34001);
+	live.Close(1);
+}
+
+/** CheckFallbacks()
+ *	A torn newer snapshot, a leftover temporary file, no snapshots and a lost log.
+ */
+static void CheckFallbacks(const WorkTicketStore& live)
+{
+	{
+		const auto newest = TicketSnapshots(snapshot_folder).List().back().second;
+		const auto torn = snapshot_folder + "/snapshot-00000000000099999999.seg";
+		const auto leftover = snapshot_folder + "/snapshot-00000000000099999998.seg.tmp";
+		filesystem::copy_file(newest, torn);
+		filesystem::resize_file(torn, filesystem::file_size(newest) / 2);
+		ofstream(leftover) << "junk";
+
+		const TicketSnapshots snapshots(snapshot_folder);
+		LAB3_CHECK(!filesystem::exists(leftover));
+		WorkTicketStore recovered;
+		const auto result = snapshots.Recover(recovered, log_path);
+		LAB3_CHECK(result.snapshot == newest);
+		LAB3_CHECK(result.NextLsn() == result.log.lastLsn + 1);
+		CheckSame(live, recovered);
+		LAB3_CHECK_THROWS(snapshots.Recover(recovered, log_path), invalid_argument); // not an empty store
+	}
+
+	// no snapshots: the whole log
+	filesystem::remove_all(snapshot_folder);
+	{
+		WorkTicketStore recovered;
+		const auto result = TicketSnapshots(snapshot_folder).Recover(recovered, log_path);
+		LAB3_CHECK(result.snapshot.empty());
+		CheckSame(live, recovered);
+	}
+
+	// a lost log: numbering carries on above the snapshot
+	{
+		TicketSnapshots snapshots(snapshot_folder);
+		snapshots.Write(live, 50000);
+		remove(log_path.c_str());
+		WorkTicketStore recovered;
+		const auto result = snapshots.Recover(recovered, log_path);
+		LAB3_CHECK(result.NextLsn() == 50001);
+		TicketLog::Options options;
+		options.first_lsn = result.NextLsn();
+		TicketLog log(log_path, options);
+		LAB3_CHECK(log.Close(1) == 50001);
+	}
+}
+
+/** CheckBackgroundFailure()
+ *	A background write into a folder that has gone fails; Wait() reports
+ *	it, and an unseen failure is not reported by the next, good, write.
+ */
+static void CheckBackgroundFailure()
+{
+	const auto folder = snapshot_folder + "-failing";
+	const auto path = log_path + "-failing";
+	filesystem::remove_all(folder);
+	remove(path.c_str());
+	{
+		TicketSnapshots snapshots(folder);
+		TicketLog log(path);
+		WorkTicketStore store;
+		store.Insert(1, "C", PackedDate(1, 1, 2020), "one", true);
+		log.Insert(1, "C", PackedDate(1, 1, 2020), "one", true);
+
+		filesystem::remove_all(folder);
+		LAB3_CHECK(snapshots.WriteInBackground(store, log));
+		LAB3_CHECK_THROWS(snapshots.Wait(), exception);
+		LAB3_CHECK(!snapshots.Writing());
+
+		// fails again, but no one waits to see it
+		LAB3_CHECK(snapshots.WriteInBackground(store, log));
+		while (snapshots.Writing())
+			this_thread::yield();
+
+		filesystem::create_directories(folder);
+		LAB3_CHECK(snapshots.WriteInBackground(store, log));
+		snapshots.Wait(); // would throw the earlier failure if it were kept
+		LAB3_CHECK(snapshots.List().size() == 1);
+	}
+	filesystem::remove_all(folder);
+	remove(path.c_str());
+}
+
+/** CheckCopies()
+ *	Copies share description text but not changes; snapshots outlive the store.
+ */
+static void CheckCopies()
+{
+	WorkTicketStore a;
+	a.Insert(1, "C", PackedDate(1, 1, 2020), "first", true);
+	WorkTicketStore b = a;
+	a.SetDescription(1, "changed in a");
+	b.SetDescription(1, "changed in b");
+	LAB3_CHECK(a.GetDescription(0) == "changed in a" && b.GetDescription(0) == "changed in b");
+
+	WorkTicketStore c = move(a);
+	c.Insert(2, "C", PackedDate(1, 1, 2020), "two", true);
+	LAB3_CHECK(c.GetDescription(0) == "changed in a");
+
+	const auto snapshot = b.TakeSnapshot();
+	b = WorkTicketStore();
+	LAB3_CHECK(snapshot.GetDescription(0) == "changed in b");
+
+	const string large(3 << 20, 'x');
+	c.Insert(3, "C", PackedDate(1, 1, 2020), large, false);
+	LAB3_CHECK(c.GetDescription(2) == large && c.GetDescription(1) == "two");
+}
+
+/** CheckDeferredIndexes()
+ *	Indexes built on first use include changes made before and after.
+ */
+static void CheckDeferredIndexes()
+{
+	WorkTicketStore store;
+	store.DeferIndexes();
+	for (int ticketNumber = 100; ticketNumber > 0; ticketNumber--)
+		store.Insert(ticketNumber, "C", PackedDate(1 + ticketNumber % 28, 1, 2020), "word" + to_string(ticketNumber % 3) + " shared", true);
+	store.SetDate(5, 1, 1, 2001);
+	store.SetDescription(6, "other");
+
+	const PackedDate day(1, 1, 2001);
+	LAB3_CHECK(store.CountByDate(day, day) == 1);
+	LAB3_CHECK(store.TextIndex().MatchAll("shared").size() == 99);
+	store.SetDescription(7, "other");
+	LAB3_CHECK(store.TextIndex().MatchAll("other").size() == 2);
+	store.SetDate(8, 1, 1, 2001);
+	LAB3_CHECK(store.CountByDate(day, day) == 2);
+
+	// readers and copiers race to the first use of both indexes
+	WorkTicketStore loaded;
+	loaded.DeferIndexes();
+	for (int ticketNumber = 20000; ticketNumber > 0; ticketNumber--)
+		loaded.Insert(ticketNumber, "C", PackedDate(1 + ticketNumber % 28, 1, 2020), "word" + to_string(ticketNumber % 7), true);
+	const PackedDate first(1, 1, 2020);
+	vector<thread> threads;
+	for (int t = 0; t < 8; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			if (t % 4 == 3)
+			{
+				const auto copy = loaded;
+				LAB3_CHECK(copy.CountByDate(first, first) == 714 && copy.TextIndex().MatchAll("word3").size() == 2857);
+				return;
+			}
+			for (int i = 0; i < 50; i++)
+				LAB3_CHECK(loaded.CountByDate(first, first) == 714 && loaded.TextIndex().MatchAll("word3").size() == 2857);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+}
+
+int main()
+{
+	filesystem::remove_all(snapshot_folder);
+	remove(log_path.c_str());
+
+	WorkTicketStore live;
+	WriteHistory(live);
+	CheckRecovery(live);
+	CheckFallbacks(live);
+	CheckBackgroundFailure();
+	CheckCopies();
+	CheckDeferredIndexes();
+
+	filesystem::remove_all(snapshot_folder);
+	remove(log_path.c_str());
+	return TestSupport::Result("TicketSnapshotsTest");
+}
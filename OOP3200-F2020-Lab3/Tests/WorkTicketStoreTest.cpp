@@ -0,0 +1,296 @@
+/** WorkTicketStoreTest.cpp - Columnar Work Ticket Store Test
+ *
+ *	Checks inserts, lookups, updates, closes, selections and snapshots
+ *	against a map of the same tickets, through enough tickets, sparse and
+ *	colliding numbers to grow the number index many times, with the indexes
+ *	kept up to date and deferred. Then checks that rewriting descriptions
+ *	over and over keeps the description heap within its bound while every
+ *	description, the text index and a snapshot taken before the rewrites
+ *	stay right.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicketStore.h
+*/
+
+#include <algorithm>	// for max and sort
+#include <climits>		// for INT_MAX
+#include <map>			// for map
+#include <random>		// for mt19937
+#include <stdexcept>	// for out_of_range
+#include <string>		// for string and to_string
+#include <vector>		// for vector
+#include "TestSupport.h"
+#include "../WorkTicketStore.h"
+
+using namespace std;
+
+/** Ticket
+ *	What the store should hold for one ticket.
+ */
+struct Ticket
+{
+	string clientId;
+	PackedDate date;
+	string description;
+	bool isOpen;
+};
+
+using Reference = map<int, Ticket>; // the store's tickets by number
+
+/** CheckSame()
+ *	The store holds what the map does, and selects and counts the same.
+ */
+static void CheckSame(const WorkTicketStore& store, const Reference& expected)
+{
+	LAB3_CHECK(store.Size() == expected.size());
+	size_t mismatches = 0;
+	for (const auto& entry : expected)
+	{
+		const auto row = store.Find(entry.first);
+		if (row == WorkTicketStore::no_row)
+		{
+			mismatches++;
+			continue;
+		}
+		const auto& ticket = entry.second;
+		mismatches += store.GetTicketNumber(row) != entry.first || store.GetClientId(row) != ticket.clientId || store.GetDate(row) != ticket.date
+			|| store.GetDescription(row) != ticket.description || store.IsOpen(row) != ticket.isOpen
+			|| store.OpenTickets().Contains(entry.first) != ticket.isOpen;
+	}
+	LAB3_CHECK(mismatches == 0);
+	LAB3_CHECK(!store.Contains(INT_MAX - 1) || expected.count(INT_MAX - 1) == 1);
+
+	// selections, in row order or (by date) in date order
+	size_t open = 0;
+	for (const auto& entry : expected)
+		open += entry.second.isOpen;
+	LAB3_CHECK(store.CountOpen() == open && store.SelectOpen().size() == open);
+	for (const auto row : store.SelectOpen())
+		LAB3_CHECK(store.IsOpen(row));
+
+	const PackedDate from(1, 3, 2010), to(31, 8, 2012);
+	vector<pair<PackedDate, int>> dated; // (date, number) of the tickets in range
+	for (const auto& entry : expected)
+		if (entry.second.date >= from && entry.second.date <= to)
+			dated.push_back({ entry.second.date, entry.first });
+	sort(dated.begin(), dated.end(), [](const pair<PackedDate, int>& a, const pair<PackedDate, int>& b) { return a.first != b.first ? a.first < b.first : a.second < b.second; });
+	const auto byDate = store.SelectByDate(from, to);
+	LAB3_CHECK(store.CountByDate(from, to) == dated.size());
+	if (LAB3_CHECK(byDate.size() == dated.size()))
+	{
+		mismatches = 0;
+		for (size_t i = 0; i < byDate.size(); i++)
+			mismatches += store.GetTicketNumber(byDate[i]) != dated[i].second;
+		LAB3_CHECK(mismatches == 0);
+	}
+
+	size_t client = 0;
+	for (const auto& entry : expected)
+		client += entry.second.clientId == "CLIENT-3";
+	const auto byClient = store.SelectByClient("CLIENT-3");
+	LAB3_CHECK(byClient.size() == client);
+	for (size_t i = 0; i < byClient.size(); i++)
+		LAB3_CHECK(store.GetClientId(byClient[i]) == "CLIENT-3" && (i == 0 || byClient[i - 1] < byClient[i]));
+	LAB3_CHECK(store.SelectByClient("never used by any ticket").empty());
+}
+
+/** CheckOperations()
+ *	Random inserts, updates and closes, with numbers that are consecutive,
+ *	sparse up to INT_MAX, and a prime apart so they share home slots.
+ */
+static void CheckOperations(const bool deferred)
+{
+	mt19937 random(deferred ? 11 : 5);
+	WorkTicketStore store;
+	Reference expected;
+	if (deferred)
+		store.DeferIndexes();
+
+	const auto number = [&random](const int i)
+	{
+		switch (i % 4)
+		{
+		case 0: return i;												// consecutive
+		case 1: return 1 + static_cast<int>(random() % INT_MAX);		// sparse
+		case 2: return 1 + (i % 1000) * 100003;							// colliding
+		default: return 1 + static_cast<int>(random() % 50000);			// often already there
+		}
+	};
+	const auto insert = [&](const int ticket_number, const int i)
+	{
+		const Ticket ticket{ "CLIENT-" + to_string(i % 7), PackedDate(1 + i % 28, 1 + i % 12, 2000 + i % 20), "job " + to_string(i), i % 3 != 0 };
+		const bool added = expected.count(ticket_number) == 0;
+		if (!LAB3_CHECK(store.Insert(ticket_number, ticket.clientId, ticket.date, ticket.description, ticket.isOpen) == added))
+			return;
+		if (added)
+			expected[ticket_number] = ticket;
+	};
+
+	for (int i = 1; i <= 60000; i++)
+		insert(number(i), i);
+	insert(INT_MAX, 1);
+	LAB3_CHECK(!store.Insert(0, "C", PackedDate(1, 1, 2020), "d", true) && !store.Insert(-5, "C", PackedDate(1, 1, 2020), "d", true));
+	CheckSame(store, expected);
+	const auto before = store.TakeSnapshot();
+	const auto copy = store;
+
+	// update, move and close a random sample
+	TicketBitmap closing;
+	for (int i = 0; i < 20000; i++)
+	{
+		auto entry = expected.lower_bound(1 + static_cast<int>(random() % INT_MAX));
+		if (entry == expected.end())
+			entry = expected.begin();
+		auto& ticket = entry->second;
+		switch (i % 6)
+		{
+		case 0:
+			LAB3_CHECK(store.SetWorkTicket(entry->first, "CLIENT-3", 2, 3, 2011, "rewritten " + to_string(i)));
+			ticket = { "CLIENT-3", PackedDate(2, 3, 2011), "rewritten " + to_string(i), ticket.isOpen };
+			break;
+		case 1:
+			LAB3_CHECK(store.SetDate(entry->first, 13, 1 + i % 12, 2010 + i % 5));
+			ticket.date = PackedDate(13, 1 + i % 12, 2010 + i % 5);
+			break;
+		case 2:
+			LAB3_CHECK(store.SetClientId(entry->first, "CLIENT-" + to_string(i % 9)));
+			ticket.clientId = "CLIENT-" + to_string(i % 9);
+			break;
+		case 3:
+			LAB3_CHECK(store.SetDescription(entry->first, "described " + to_string(i)));
+			ticket.description = "described " + to_string(i);
+			break;
+		case 4:
+			LAB3_CHECK(store.Close(entry->first));
+			ticket.isOpen = false;
+			break;
+		default:
+			closing.Add(entry->first);
+			break;
+		}
+	}
+	closing.Add(INT_MAX - 2); // not in the store; ignored
+	size_t closedNow = 0;
+	closing.ForEach([&](const int ticket_number)
+	{
+		const auto entry = expected.find(ticket_number);
+		if (entry != expected.end() && entry->second.isOpen)
+		{
+			entry->second.isOpen = false;
+			closedNow++;
+		}
+	});
+	LAB3_CHECK(store.Close(closing) == closedNow);
+	LAB3_CHECK(store.Close(closing) == 0);
+
+	// a missing ticket changes nothing, and a bad date throws as WorkTicket would
+	const int missing = expected.count(7) == 0 ? 7 : -7;
+	LAB3_CHECK(!store.SetWorkTicket(missing, "C", 1, 1, 2020, "d") && !store.SetDescription(missing, "d") && !store.Close(missing));
+	LAB3_CHECK(!store.SetDate(missing, 1, 1, 2020));
+	LAB3_CHECK_THROWS(store.SetDate(expected.begin()->first, 30, 2, 2020), out_of_range);
+	CheckSame(store, expected);
+
+	// the copy and the snapshot taken before the changes still hold the old tickets
+	LAB3_CHECK(before.Size() == copy.Size());
+	size_t mismatches = 0;
+	for (size_t row = 0; row < before.Size(); row++)
+	{
+		const auto copyRow = static_cast<WorkTicketStore::Row>(row);
+		mismatches += before.ticketNumbers[row] != copy.GetTicketNumber(copyRow) || before.dates[row] != copy.GetDate(copyRow)
+			|| (before.openFlags[row] != 0) != copy.IsOpen(copyRow) || before.clientHandles[row] != copy.GetClientHandle(copyRow)
+			|| before.GetDescription(row) != copy.GetDescription(copyRow);
+	}
+	LAB3_CHECK(mismatches == 0);
+	LAB3_CHECK(copy.CountOpen() > store.CountOpen());
+
+	// every row can still be copied out
+	mismatches = 0;
+	for (WorkTicketStore::Row row = 0; row < store.Size(); row += 97)
+	{
+		const auto ticket = store.GetExtendedWorkTicket(row);
+		mismatches += !ticket.HasValue() || ticket.Value().GetTicketNumber() != store.GetTicketNumber(row) || ticket.Value().GetPackedDate() != store.GetDate(row)
+			|| ticket.Value().IsOpen() != store.IsOpen(row) || ticket.Value().GetDescriptionView() != store.GetDescription(row);
+	}
+	LAB3_CHECK(mismatches == 0);
+}
+
+/** CheckSnapshotLifetime()
+ *	A snapshot's descriptions outlive the store.
+ */
+static void CheckSnapshotLifetime()
+{
+	WorkTicketStore::Snapshot snapshot;
+	{
+		WorkTicketStore store;
+		store.Reserve(1000, 1000 * 20);
+		for (int i = 1; i <= 1000; i++)
+			LAB3_CHECK(store.Insert(i, "C", PackedDate(1, 1, 2020), "description " + to_string(i), true));
+		snapshot = store.TakeSnapshot();
+		store.SetDescription(1, "changed");
+	}
+	size_t mismatches = 0;
+	for (size_t row = 0; row < snapshot.Size(); row++)
+		mismatches += snapshot.GetDescription(row) != "description " + to_string(row + 1);
+	LAB3_CHECK(snapshot.Size() == 1000 && mismatches == 0);
+}
+
+/** Description()
+ *	A 100 byte description that differs with each version of a ticket.
+ */
+static string Description(const int ticket_number, const int version)
+{
+	auto text = "ticket" + to_string(ticket_number) + " version" + to_string(version) + " ";
+	text.resize(100, 'x');
+	return text;
+}
+
+/** CheckDescriptionGrowth()
+ *	The heap stays under twice the live text plus a couple of chunks.
+ */
+static void CheckDescriptionGrowth()
+{
+	const int ticket_count = 2000;
+	const int versions = 100;
+	WorkTicketStore store;
+	for (int i = 1; i <= ticket_count; i++)
+		LAB3_CHECK(store.Insert(i, "C", PackedDate(1, 1, 2020), Description(i, 0), true));
+	const auto before = store.TakeSnapshot();
+
+	const size_t live = ticket_count * 100;		// bytes of description text
+	const size_t bound = 2 * live + 2 * (1 << 20);	// the most the heap may hold
+	size_t largest = 0;
+	for (int version = 1; version <= versions; version++)
+	{
+		for (int i = 1; i <= ticket_count; i++)
+			store.SetDescription(i, Description(i, version));
+		largest = max(largest, store.DescriptionHeapBytes());
+	}
+	LAB3_CHECK(largest <= bound);
+	LAB3_CHECK(largest < live * versions / 4); // far less than every version ever written
+
+	for (int i = 1; i <= ticket_count; i++)
+	{
+		const auto row = store.Find(i);
+		LAB3_CHECK(store.GetDescription(row) == Description(i, versions));
+		LAB3_CHECK(before.GetDescription(row) == Description(i, 0));
+	}
+	LAB3_CHECK(store.TextIndex().MatchAll("ticket7 version" + to_string(versions)).size() == 1);
+	LAB3_CHECK(store.TextIndex().MatchAll("version1").size() == 0);
+
+	// a copy compacts its own text without disturbing the original
+	auto copy = store;
+	for (int version = 0; version < 30; version++)
+		copy.SetDescription(1 + version % 3, string(40000, static_cast<char>('a' + version % 26)));
+	LAB3_CHECK(copy.GetDescription(copy.Find(1)) == string(40000, 'b'));
+	LAB3_CHECK(store.GetDescription(store.Find(1)) == Description(1, versions));
+	LAB3_CHECK(copy.GetDescription(copy.Find(4)) == Description(4, versions));
+}
+
+int main()
+{
+	CheckOperations(false);
+	CheckOperations(true);
+	CheckSnapshotLifetime();
+	CheckDescriptionGrowth();
+	return TestSupport::Result("WorkTicketStoreTest");
+}
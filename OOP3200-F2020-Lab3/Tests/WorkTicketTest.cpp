@@ -0,0 +1,131 @@
+/** WorkTicketTest.cpp - Work Ticket Validation Test
+ *
+ *	Checks that SetWorkTicket(), Validate(), TryMake(), the throwing
+ *	constructor, TicketReader, WorkTicketStore and TicketRegistry agree on
+ *	which tickets are valid, in particular that ticket number 0 is rejected
+ *	everywhere and is only the number of a default-constructed ticket.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+*/
+
+#include <stdexcept>	// for invalid_argument
+#include <string>		// for string and to_string
+#include "TestSupport.h"
+#include "../TicketReader.h"
+#include "../TicketRegistry.h"
+#include "../WorkTicketStore.h"
+
+using namespace std;
+
+/** Case
+ *	A ticket to try on every path.
+ */
+struct Case
+{
+	int ticketNumber;
+	const char* clientId;
+	int day;
+	int month;
+	int year;
+	const char* description;
+	ValidationCode expected;	// what Validate() must report
+};
+
+/** CheckAgreement()
+ *	Each path accepts a ticket exactly when Validate() does.
+ */
+static void CheckAgreement()
+{
+	const Case cases[] = {
+		{ 1, "C", 1, 1, 2000, "d", ValidationCode::Ok },
+		{ 2147483647, "C", 31, 12, 2099, "d", ValidationCode::Ok },
+		{ 0, "C", 1, 1, 2020, "d", ValidationCode::InvalidTicketNumber },
+		{ -1, "C", 1, 1, 2020, "d", ValidationCode::InvalidTicketNumber },
+		{ 3, "C", 1, 1, 1999, "d", ValidationCode::InvalidTicketYear },
+		{ 3, "C", 1, 1, 2100, "d", ValidationCode::InvalidTicketYear },
+		{ 3, "C", 29, 2, 2021, "d", ValidationCode::InvalidDay },
+		{ 3, "C", 1, 13, 2021, "d", ValidationCode::InvalidMonth },
+		{ 3, "", 1, 1, 2021, "d", ValidationCode::EmptyClientId },
+		{ 3, "C", 1, 1, 2021, "", ValidationCode::EmptyDescription },
+	};
+
+	for (const auto& c : cases)
+	{
+		const auto valid = c.expected == ValidationCode::Ok;
+		LAB3_CHECK(WorkTicket::Validate(c.ticketNumber, c.clientId, c.day, c.month, c.year, c.description).Code() == c.expected);
+		LAB3_CHECK(WorkTicket::TryMake(c.ticketNumber, c.clientId, c.day, c.month, c.year, c.description).HasValue() == valid);
+		LAB3_CHECK(ExtendedWorkTicket::TryMake(c.ticketNumber, c.clientId, c.day, c.month, c.year, c.description, false).HasValue() == valid);
+
+		WorkTicket ticket;
+		LAB3_CHECK(ticket.SetWorkTicket(c.ticketNumber, c.clientId, c.day, c.month, c.year, c.description) == valid);
+		LAB3_CHECK(ticket.GetTicketNumber() == (valid ? c.ticketNumber : 0));
+
+		ExtendedWorkTicket extended;
+		LAB3_CHECK(extended.SetWorkTicket(c.ticketNumber, c.clientId, c.day, c.month, c.year, c.description, false) == valid);
+		LAB3_CHECK(extended.IsOpen() == !valid);
+
+		// the throwing constructor throws what Validate() reports
+		bool thrown = false;
+		try
+		{
+			WorkTicket constructed(c.ticketNumber, c.clientId, c.day, c.month, c.year, c.description);
+		}
+		catch (const exception&)
+		{
+			thrown = true;
+		}
+		const auto constructorChecks = c.expected != ValidationCode::EmptyClientId && c.expected != ValidationCode::EmptyDescription;
+		LAB3_CHECK(thrown == (constructorChecks && !valid));
+
+		// stored and read tickets follow the same rules
+		const PackedDate date = MyDate::Validate(c.day, c.month, c.year).Ok() ? PackedDate(c.day, c.month, c.year) : PackedDate(1, 1, 1900);
+		WorkTicketStore store;
+		LAB3_CHECK(store.Insert(c.ticketNumber, c.clientId, date, c.description, true) == valid);
+		LAB3_CHECK(store.Size() == (valid ? 1u : 0u));
+		if (valid)
+		{
+			const auto copy = store.GetExtendedWorkTicket(0);
+			LAB3_CHECK(copy.HasValue() && copy.Value().GetTicketNumber() == c.ticketNumber && copy.Value().GetDate() == MyDate(c.day, c.month, c.year));
+			LAB3_CHECK(store.GetWorkTicket(0).HasValue());
+		}
+		TicketRegistry registry(1);
+		LAB3_CHECK(registry.Insert(c.ticketNumber, c.clientId, date, c.description, true) == valid);
+
+		TicketReader::Record record{};
+		const auto line = to_string(c.ticketNumber) + "\t" + c.clientId + "\t" + to_string(c.day) + "/" + to_string(c.month) + "/" + to_string(c.year) + "\t" + c.description;
+		LAB3_CHECK((TicketReader::ParseRecord(line, '\t', record) == nullptr) == valid);
+	}
+}
+
+/** CheckUpdates()
+ *	Updating a stored ticket follows the same rules.
+ */
+static void CheckUpdates()
+{
+	WorkTicketStore store;
+	TicketRegistry registry(1);
+	LAB3_CHECK(store.Insert(5, "C", PackedDate(1, 1, 2020), "d", true));
+	LAB3_CHECK(registry.Insert(5, "C", PackedDate(1, 1, 2020), "d", true));
+	LAB3_CHECK(store.SetWorkTicket(5, "C2", 2, 2, 2020, "d2"));
+	LAB3_CHECK(!store.SetWorkTicket(0, "C2", 2, 2, 2020, "d2"));
+	LAB3_CHECK(!store.SetWorkTicket(5, "", 2, 2, 2020, "d2"));
+	LAB3_CHECK(!store.SetWorkTicket(5, "C2", 2, 2, 2100, "d2"));
+	LAB3_CHECK(!store.SetClientId(5, "") && !store.SetDescription(5, ""));
+	LAB3_CHECK(store.GetClientId(0) == "C2" && store.GetDescription(0) == "d2");
+	LAB3_CHECK(store.GetExtendedWorkTicket(0).HasValue());
+	LAB3_CHECK(registry.SetWorkTicket(5, "C2", 2, 2, 2020, "d2"));
+	LAB3_CHECK(!registry.SetWorkTicket(0, "C2", 2, 2, 2020, "d2"));
+	LAB3_CHECK(!registry.SetWorkTicket(5, "C2", 2, 2, 2020, ""));
+
+	WorkTicket ticket;
+	LAB3_CHECK(ticket.GetTicketNumber() == 0);
+	LAB3_CHECK_THROWS(ticket.SetTicketNumber(0), invalid_argument);
+}
+
+int main()
+{
+	CheckAgreement();
+	CheckUpdates();
+	return TestSupport::Result("WorkTicketTest");
+}
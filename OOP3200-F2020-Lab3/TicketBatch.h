@@ -0,0 +1,123 @@
+/** TicketBatch.h - Arena-Backed Ticket Batch
+ *
+ *	The TicketBatch class holds a bulk load of ExtendedWorkTickets whose
+ *	descriptions are bump-allocated from large blocks owned by the batch
+ *	(a monotonic_buffer_resource) instead of one heap allocation each. The
+ *	blocks are all freed together when the batch is cleared or destroyed, so
+ *	releasing millions of tickets costs a handful of frees. Client IDs are
+ *	interned in ClientIdTable, which bump-allocates them the same way.
+ *
+ *	The ticket array lives in the arena too; call Reserve() first when the
+ *	count is known, since memory given up by growing the array is only
+ *	reclaimed when the whole batch is released.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+ *	@see		TicketReader.h
+*/
+
+#pragma once
+#ifndef _TICKET_BATCH_H
+
+#define _TICKET_BATCH_H
+
+#include <cstddef>			// for size_t
+#include <memory_resource>	// for monotonic_buffer_resource
+#include <string_view>		// for string_view
+#include <vector>			// for pmr::vector
+#include "ExtendedWorkTicket.h"
+#include "TicketReader.h"
+
+using namespace std;
+
+class TicketBatch
+{
+public:
+	static constexpr size_t default_block_size = 1 << 20; // the first arena block, in bytes
+
+	/** Default Constructor
+	 *	Creates an empty batch. The arena grows from the given block size.
+	 *	@param block_size (size_t) - the size of the first arena block
+	 */
+	explicit TicketBatch(const size_t block_size = default_block_size) : myArena(block_size), myTickets(&myArena) {}
+
+	TicketBatch(const TicketBatch&) = delete;
+	TicketBatch& operator=(const TicketBatch&) = delete;
+
+	/** Reserve()
+	 *	Reserves room for a number of tickets in one arena allocation.
+	 */
+	void Reserve(const size_t count) { myTickets.reserve(count); }
+
+	/** Add()
+	 *	Adds a ticket if the parameters are valid (see ExtendedWorkTicket::SetWorkTicket).
+	 *	@return (bool) - false if a parameter was invalid; nothing is added
+	 */
+	bool Add(int ticket_number, string_view client_id, int day, int month, int year, string_view description, bool is_open);
+
+	/** Load()
+	 *	Adds every valid record from a reader.
+	 *	@param reader (TicketReader by ref) - the records
+	 *	@return (size_t) - the number of tickets added
+	 */
+	size_t Load(TicketReader& reader);
+
+	/** Clear()
+	 *	Removes every ticket and frees all the arena blocks at once.
+	 */
+	void Clear();
+
+	/** Accessors
+	 *	Tickets are stored in the order they were added.
+	 */
+	size_t Size() const { return myTickets.size(); }
+	const ExtendedWorkTicket& operator[](const size_t index) const { return myTickets[index]; }
+	ExtendedWorkTicket& operator[](const size_t index) { return myTickets[index]; }
+	pmr::vector<ExtendedWorkTicket>::const_iterator begin() const { return myTickets.begin(); }
+	pmr::vector<ExtendedWorkTicket>::const_iterator end() const { return myTickets.end(); }
+
+private:
+	pmr::monotonic_buffer_resource myArena;		// owns every block; declared first so it outlives the tickets
+	pmr::vector<ExtendedWorkTicket> myTickets;	// passes the arena to each ticket it constructs
+};
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketBatch::Add
+bool TicketBatch::Add(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description, const bool is_open)
+{
+	// the ticket gets the arena from the vector
+	auto& ticket = myTickets.emplace_back();
+	if (ticket.SetWorkTicket(ticket_number, client_id, day, month, year, description, is_open))
+		return true;
+
+	myTickets.pop_back();
+	return false;
+}
+
+// TicketBatch::Load
+size_t TicketBatch::Load(TicketReader& reader)
+{
+	const auto before = myTickets.size(); // the size before loading
+	TicketReader::Record record{};		// the fields of each record
+
+	while (reader.Read(record))
+	{
+		const auto date = record.date.ToMyDate();
+		Add(record.ticketNumber, record.clientId, date.GetDay(), date.GetMonth(), date.GetYear(), record.description, record.isOpen);
+	}
+	return myTickets.size() - before;
+}
+
+// TicketBatch::Clear
+void TicketBatch::Clear()
+{
+	// the tickets must go before the memory they point into
+	myTickets.clear();
+	myTickets.shrink_to_fit();
+	myArena.release();
+}
+
+#endif
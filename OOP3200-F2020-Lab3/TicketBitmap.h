@@ -0,0 +1,633 @@
+/** TicketBitmap.h - Compressed Ticket Number Set
+ *
+ *	The TicketBitmap class holds a set of ticket numbers as a compressed
+ *	bitmap in the style of a Roaring bitmap. Ticket numbers are grouped by
+ *	their high 16 bits into containers of up to 65,536 numbers each. A
+ *	container that holds array_limit numbers or fewer keeps their low 16 bits
+ *	in a sorted array (two bytes each); a fuller one keeps one bit for every
+ *	possible number (8 KB), so a set never takes much more than two bytes a
+ *	number and a dense one takes about one bit.
+ *
+ *	Counting is a sum of container sizes, intersections and unions work a
+ *	container at a time, and two bitmap containers combine 64 numbers per
+ *	machine word with a popcount for the size of the result. Results of other
+ *	searches (e.g. TicketTextIndex::MatchAll() or
+ *	TicketDateIndex::TicketNumbers()) convert to a TicketBitmap to be
+ *	combined with one.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicketStore.h
+*/
+
+#pragma once
+#ifndef _TICKET_BITMAP_H
+
+#define _TICKET_BITMAP_H
+
+#include <algorithm>	// for sort, lower_bound and the set algorithms
+#include <cstddef>		// for size_t
+#include <cstdint>		// for fixed width integers
+#include <iterator>		// for back_inserter
+#include <vector>		// for the containers
+
+#ifdef _MSC_VER
+#include <intrin.h>		// for __popcnt64 and _BitScanForward64
+#endif
+
+using namespace std;
+
+class TicketBitmap
+{
+public:
+	static constexpr size_t array_limit = 4096;	// numbers a container holds as an array; 4096 * 2 bytes = one bitmap
+	static constexpr size_t bitmap_words = 1024;	// 65,536 bits
+
+	/** Constructors
+	 *	An empty set, or the set of the given ticket numbers in any order.
+	 *	Numbers that are not positive are ignored, as they are by Add().
+	 */
+	TicketBitmap() = default;
+	explicit TicketBitmap(const vector<int>& ticket_numbers);
+
+	/***************************************************************************
+	*	MUTATORS
+	***************************************************************************/
+
+	/** Add() / Remove()
+	 *	@return (bool) - false if the ticket number was already in (or not in)
+	 *	                 the set, or is not positive
+	 */
+	bool Add(int ticket_number);
+	bool Remove(int ticket_number);
+	void Clear() { myContainers.clear(); }
+
+	/***************************************************************************
+	*	QUERIES
+	***************************************************************************/
+
+	bool Contains(int ticket_number) const;
+	bool Empty() const { return myContainers.empty(); }
+
+	/** Count()
+	 *	The number of ticket numbers in the set, from the container sizes.
+	 */
+	size_t Count() const;
+
+	/** AndCount()
+	 *	The number of ticket numbers in both sets, without building their intersection.
+	 */
+	size_t AndCount(const TicketBitmap& other) const;
+
+	/** ForEach()
+	 *	Calls visit(ticket_number) for each ticket number, in ascending order.
+	 */
+	template <typename Visit>
+	void ForEach(Visit visit) const;
+
+	/** TicketNumbers()
+	 *	The ticket numbers, in ascending order.
+	 */
+	vector<int> TicketNumbers() const;
+
+	/** Bytes()
+	 *	The memory the containers use.
+	 */
+	size_t Bytes() const;
+
+	/***************************************************************************
+	*	SET OPERATIONS
+	***************************************************************************/
+
+	TicketBitmap operator&(const TicketBitmap& other) const;	// in both
+	TicketBitmap operator|(const TicketBitmap& other) const;	// in either
+	TicketBitmap operator-(const TicketBitmap& other) const;	// in this one but not the other
+	TicketBitmap& operator&=(const TicketBitmap& other) { return *this = *this & other; }
+	TicketBitmap& operator|=(const TicketBitmap& other) { return *this = *this | other; }
+	TicketBitmap& operator-=(const TicketBitmap& other) { return *this = *this - other; }
+	bool operator==(const TicketBitmap& other) const;
+	bool operator!=(const TicketBitmap& other) const { return !(*this == other); }
+
+private:
+	/** Container
+	 *	The ticket numbers that share their high 16 bits, as an array of their
+	 *	low 16 bits or as a bitmap.
+	 */
+	struct Container
+	{
+		uint16_t key = 0;			// the high 16 bits
+		uint32_t count = 0;			// the numbers held
+		vector<uint16_t> values;	// sorted low 16 bits, while count <= array_limit
+		vector<uint64_t> words;		// bitmap_words words, when count > array_limit
+
+		bool IsBitmap() const { return !words.empty(); }
+		bool Contains(const uint16_t low) const
+		{
+			return IsBitmap() ? (words[low >> 6] >> (low & 63) & 1) != 0 : binary_search(values.begin(), values.end(), low);
+		}
+	};
+
+	/** Bit Operations
+	 */
+	static size_t PopCount(uint64_t word);
+	static unsigned LowestBit(uint64_t word);
+
+	/** Container Operations
+	 *	Each result is an array or a bitmap according to its count.
+	 */
+	static void Normalize(Container& container);
+	static void CountWords(Container& container);
+	static Container And(const Container& a, const Container& b);
+	static Container Or(const Container& a, const Container& b);
+	static Container AndNot(const Container& a, const Container& b);
+	static size_t AndCount(const Container& a, const Container& b);
+
+	/** Find()
+	 *	Returns the container for a key, or where it would go.
+	 */
+	vector<Container>::iterator Find(uint16_t key);
+	vector<Container>::const_iterator Find(uint16_t key) const;
+
+	vector<Container> myContainers; // sorted by key, none empty
+};
+
+/***************************************************************************
+ *	CONSTRUCTOR AND MUTATOR DEFINITIONS
+ ***************************************************************************/
+
+ // TicketBitmap::Constructor
+TicketBitmap::TicketBitmap(const vector<int>& ticket_numbers)
+{
+	auto sorted = ticket_numbers;
+	sort(sorted.begin(), sorted.end());
+	sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+
+	// sorted, so each number goes at the end of the last container
+	for (const auto ticketNumber : sorted)
+	{
+		if (ticketNumber <= 0)
+			continue;
+		const auto key = static_cast<uint16_t>(static_cast<uint32_t>(ticketNumber) >> 16);
+		if (myContainers.empty() || myContainers.back().key != key)
+		{
+			if (!myContainers.empty())
+				Normalize(myContainers.back());
+			myContainers.emplace_back();
+			myContainers.back().key = key;
+		}
+		myContainers.back().values.push_back(static_cast<uint16_t>(ticketNumber));
+		myContainers.back().count++;
+	}
+	if (!myContainers.empty())
+		Normalize(myContainers.back());
+}
+
+// TicketBitmap::Add
+bool TicketBitmap::Add(const int ticket_number)
+{
+	if (ticket_number <= 0)
+		return false;
+
+	const auto key = static_cast<uint16_t>(static_cast<uint32_t>(ticket_number) >> 16);
+	const auto low = static_cast<uint16_t>(ticket_number);
+	auto container = Find(key);
+	if (container == myContainers.end() || container->key != key)
+	{
+		container = myContainers.emplace(container);
+		container->key = key;
+	}
+
+	if (container->IsBitmap())
+	{
+		auto& word = container->words[low >> 6];
+		const auto bit = uint64_t{ 1 } << (low & 63);
+		if ((word & bit) != 0)
+			return false;
+		word |= bit;
+	}
+	else
+	{
+		const auto at = lower_bound(container->values.begin(), container->values.end(), low);
+		if (at != container->values.end() && *at == low)
+			return false;
+		container->values.insert(at, low);
+	}
+	container->count++;
+	Normalize(*container);
+	return true;
+}
+
+// TicketBitmap::Remove
+bool TicketBitmap::Remove(const int ticket_number)
+{
+	if (ticket_number <= 0)
+		return false;
+
+	const auto key = static_cast<uint16_t>(static_cast<uint32_t>(ticket_number) >> 16);
+	const auto low = static_cast<uint16_t>(ticket_number);
+	const auto container = Find(key);
+	if (container == myContainers.end() || container->key != key)
+		return false;
+
+	if (container->IsBitmap())
+	{
+		auto& word = container->words[low >> 6];
+		const auto bit = uint64_t{ 1 } << (low & 63);
+		if ((word & bit) == 0)
+			return false;
+		word &= ~bit;
+	}
+	else
+	{
+		const auto at = lower_bound(container->values.begin(), container->values.end(), low);
+		if (at == container->values.end() || *at != low)
+			return false;
+		container->values.erase(at);
+	}
+
+	if (--container->count == 0)
+		myContainers.erase(container);
+	else
+		Normalize(*container);
+	return true;
+}
+
+/***************************************************************************
+ *	QUERY DEFINITIONS
+ ***************************************************************************/
+
+ // TicketBitmap::Contains
+bool TicketBitmap::Contains(const int ticket_number) const
+{
+	if (ticket_number <= 0)
+		return false;
+
+	const auto key = static_cast<uint16_t>(static_cast<uint32_t>(ticket_number) >> 16);
+	const auto container = Find(key);
+	return container != myContainers.end() && container->key == key && container->Contains(static_cast<uint16_t>(ticket_number));
+}
+
+// TicketBitmap::Count
+size_t TicketBitmap::Count() const
+{
+	size_t count = 0; // the numbers in the set
+	for (const auto& container : myContainers)
+		count += container.count;
+	return count;
+}
+
+// TicketBitmap::AndCount
+size_t TicketBitmap::AndCount(const TicketBitmap& other) const
+{
+	size_t count = 0; // the numbers in both
+	auto a = myContainers.begin();
+	auto b = other.myContainers.begin();
+	while (a != myContainers.end() && b != other.myContainers.end())
+	{
+		if (a->key < b->key)
+			++a;
+		else if (b->key < a->key)
+			++b;
+		else
+			count += AndCount(*a++, *b++);
+	}
+	return count;
+}
+
+// TicketBitmap::ForEach
+template <typename Visit>
+void TicketBitmap::ForEach(Visit visit) const
+{
+	for (const auto& container : myContainers)
+	{
+		const auto high = static_cast<uint32_t>(container.key) << 16;
+		if (container.IsBitmap())
+		{
+			for (size_t i = 0; i < bitmap_words; i++)
+			{
+				// visit the set bits, lowest first
+				for (auto word = container.words[i]; word != 0; word &= word - 1)
+					visit(static_cast<int>(high | static_cast<uint32_t>(i * 64 + LowestBit(word))));
+			}
+		}
+		else
+		{
+			for (const auto low : container.values)
+				visit(static_cast<int>(high | low));
+		}
+	}
+}
+
+// TicketBitmap::TicketNumbers
+vector<int> TicketBitmap::TicketNumbers() const
+{
+	vector<int> ticketNumbers; // the set, in order
+	ticketNumbers.reserve(Count());
+	ForEach([&ticketNumbers](const int ticket_number) { ticketNumbers.push_back(ticket_number); });
+	return ticketNumbers;
+}
+
+// TicketBitmap::Bytes
+size_t TicketBitmap::Bytes() const
+{
+	auto bytes = myContainers.capacity() * sizeof(Container); // the memory used
+	for (const auto& container : myContainers)
+		bytes += container.values.capacity() * sizeof(uint16_t) + container.words.capacity() * sizeof(uint64_t);
+	return bytes;
+}
+
+/***************************************************************************
+ *	SET OPERATION DEFINITIONS
+ ***************************************************************************/
+
+ // TicketBitmap::operator&
+TicketBitmap TicketBitmap::operator&(const TicketBitmap& other) const
+{
+	TicketBitmap result; // the numbers in both
+	auto a = myContainers.begin();
+	auto b = other.myContainers.begin();
+	while (a != myContainers.end() && b != other.myContainers.end())
+	{
+		if (a->key < b->key)
+			++a;
+		else if (b->key < a->key)
+			++b;
+		else
+		{
+			auto container = And(*a++, *b++);
+			if (container.count > 0)
+				result.myContainers.push_back(move(container));
+		}
+	}
+	return result;
+}
+
+// TicketBitmap::operator|
+TicketBitmap TicketBitmap::operator|(const TicketBitmap& other) const
+{
+	TicketBitmap result; // the numbers in either
+	auto a = myContainers.begin();
+	auto b = other.myContainers.begin();
+	while (a != myContainers.end() || b != other.myContainers.end())
+	{
+		if (b == other.myContainers.end() || (a != myContainers.end() && a->key < b->key))
+			result.myContainers.push_back(*a++);
+		else if (a == myContainers.end() || b->key < a->key)
+			result.myContainers.push_back(*b++);
+		else
+			result.myContainers.push_back(Or(*a++, *b++));
+	}
+	return result;
+}
+
+// TicketBitmap::operator-
+TicketBitmap TicketBitmap::operator-(const TicketBitmap& other) const
+{
+	TicketBitmap result; // the numbers only in this one
+	auto b = other.myContainers.begin();
+	for (const auto& a : myContainers)
+	{
+		while (b != other.myContainers.end() && b->key < a.key)
+			++b;
+		if (b == other.myContainers.end() || b->key != a.key)
+			result.myContainers.push_back(a);
+		else
+		{
+			auto container = AndNot(a, *b);
+			if (container.count > 0)
+				result.myContainers.push_back(move(container));
+		}
+	}
+	return result;
+}
+
+// TicketBitmap::operator==
+bool TicketBitmap::operator==(const TicketBitmap& other) const
+{
+	// containers are normalized, so equal sets have equal containers
+	if (myContainers.size() != other.myContainers.size())
+		return false;
+	for (size_t i = 0; i < myContainers.size(); i++)
+	{
+		const auto& a = myContainers[i];
+		const auto& b = other.myContainers[i];
+		if (a.key != b.key || a.count != b.count || a.values != b.values || a.words != b.words)
+			return false;
+	}
+	return true;
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketBitmap::PopCount
+size_t TicketBitmap::PopCount(const uint64_t word)
+{
+#ifdef _MSC_VER
+	return static_cast<size_t>(__popcnt64(word));
+#else
+	return static_cast<size_t>(__builtin_popcountll(word));
+#endif
+}
+
+// TicketBitmap::LowestBit
+unsigned TicketBitmap::LowestBit(const uint64_t word)
+{
+	// word is not zero
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanForward64(&bit, word);
+	return static_cast<unsigned>(bit);
+#else
+	return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+// TicketBitmap::Normalize
+void TicketBitmap::Normalize(Container& container)
+{
+	if (container.IsBitmap() && container.count <= array_limit)
+	{
+		// bitmap to array
+		vector<uint16_t> values;
+		values.reserve(container.count);
+		for (size_t i = 0; i < bitmap_words; i++)
+		{
+			for (auto word = container.words[i]; word != 0; word &= word - 1)
+				values.push_back(static_cast<uint16_t>(i * 64 + LowestBit(word)));
+		}
+		container.values = move(values);
+		container.words = vector<uint64_t>();
+	}
+	else if (!container.IsBitmap() && container.count > array_limit)
+	{
+		// array to bitmap
+		container.words.assign(bitmap_words, 0);
+		for (const auto low : container.values)
+			container.words[low >> 6] |= uint64_t{ 1 } << (low & 63);
+		container.values = vector<uint16_t>();
+	}
+}
+
+// TicketBitmap::CountWords
+void TicketBitmap::CountWords(Container& container)
+{
+	size_t count = 0; // set bits
+	for (const auto word : container.words)
+		count += PopCount(word);
+	container.count = static_cast<uint32_t>(count);
+}
+
+// TicketBitmap::And
+TicketBitmap::Container TicketBitmap::And(const Container& a, const Container& b)
+{
+	Container result; // the numbers in both
+	result.key = a.key;
+	if (a.IsBitmap() && b.IsBitmap())
+	{
+		result.words.resize(bitmap_words);
+		for (size_t i = 0; i < bitmap_words; i++)
+			result.words[i] = a.words[i] & b.words[i];
+		CountWords(result);
+	}
+	else if (a.IsBitmap() || b.IsBitmap())
+	{
+		// keep the array's numbers that are in the bitmap
+		const auto& array = a.IsBitmap() ? b : a;
+		const auto& bitmap = a.IsBitmap() ? a : b;
+		for (const auto low : array.values)
+		{
+			if (bitmap.Contains(low))
+				result.values.push_back(low);
+		}
+		result.count = static_cast<uint32_t>(result.values.size());
+	}
+	else
+	{
+		set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), back_inserter(result.values));
+		result.count = static_cast<uint32_t>(result.values.size());
+	}
+	Normalize(result);
+	return result;
+}
+
+// TicketBitmap::Or
+TicketBitmap::Container TicketBitmap::Or(const Container& a, const Container& b)
+{
+	Container result; // the numbers in either
+	result.key = a.key;
+	if (a.IsBitmap() || b.IsBitmap())
+	{
+		// start from a bitmap and set the other's bits
+		result.words = a.IsBitmap() ? a.words : b.words;
+		const auto& other = a.IsBitmap() ? b : a;
+		if (other.IsBitmap())
+		{
+			for (size_t i = 0; i < bitmap_words; i++)
+				result.words[i] |= other.words[i];
+		}
+		else
+		{
+			for (const auto low : other.values)
+				result.words[low >> 6] |= uint64_t{ 1 } << (low & 63);
+		}
+		CountWords(result);
+	}
+	else
+	{
+		set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), back_inserter(result.values));
+		result.count = static_cast<uint32_t>(result.values.size());
+	}
+	Normalize(result);
+	return result;
+}
+
+// TicketBitmap::AndNot
+TicketBitmap::Container TicketBitmap::AndNot(const Container& a, const Container& b)
+{
+	Container result; // the numbers in a but not b
+	result.key = a.key;
+	if (a.IsBitmap())
+	{
+		result.words = a.words;
+		if (b.IsBitmap())
+		{
+			for (size_t i = 0; i < bitmap_words; i++)
+				result.words[i] &= ~b.words[i];
+		}
+		else
+		{
+			for (const auto low : b.values)
+				result.words[low >> 6] &= ~(uint64_t{ 1 } << (low & 63));
+		}
+		CountWords(result);
+	}
+	else if (b.IsBitmap())
+	{
+		for (const auto low : a.values)
+		{
+			if (!b.Contains(low))
+				result.values.push_back(low);
+		}
+		result.count = static_cast<uint32_t>(result.values.size());
+	}
+	else
+	{
+		set_difference(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), back_inserter(result.values));
+		result.count = static_cast<uint32_t>(result.values.size());
+	}
+	Normalize(result);
+	return result;
+}
+
+// TicketBitmap::AndCount
+size_t TicketBitmap::AndCount(const Container& a, const Container& b)
+{
+	size_t count = 0; // the numbers in both
+	if (a.IsBitmap() && b.IsBitmap())
+	{
+		for (size_t i = 0; i < bitmap_words; i++)
+			count += PopCount(a.words[i] & b.words[i]);
+	}
+	else if (a.IsBitmap() || b.IsBitmap())
+	{
+		const auto& array = a.IsBitmap() ? b : a;
+		const auto& bitmap = a.IsBitmap() ? a : b;
+		for (const auto low : array.values)
+			count += bitmap.Contains(low);
+	}
+	else
+	{
+		// merge the two sorted arrays
+		auto i = a.values.begin();
+		auto j = b.values.begin();
+		while (i != a.values.end() && j != b.values.end())
+		{
+			if (*i < *j)
+				++i;
+			else if (*j < *i)
+				++j;
+			else
+			{
+				count++;
+				++i;
+				++j;
+			}
+		}
+	}
+	return count;
+}
+
+// TicketBitmap::Find
+vector<TicketBitmap::Container>::iterator TicketBitmap::Find(const uint16_t key)
+{
+	return lower_bound(myContainers.begin(), myContainers.end(), key, [](const Container& compare, const uint16_t value) { return compare.key < value; });
+}
+
+// TicketBitmap::Find (const)
+vector<TicketBitmap::Container>::const_iterator TicketBitmap::Find(const uint16_t key) const
+{
+	return lower_bound(myContainers.begin(), myContainers.end(), key, [](const Container& compare, const uint16_t value) { return compare.key < value; });
+}
+
+#endif
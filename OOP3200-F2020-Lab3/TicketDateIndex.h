@@ -0,0 +1,380 @@
+/** TicketDateIndex.h - Date-Ordered Ticket Index
+ *
+ *	The TicketDateIndex class keeps ticket numbers ordered by ticket date so
+ *	"all tickets between X and Y" is answered without looking at every ticket.
+ *	Each entry is one 64 bit key, the serial day number in the high half and
+ *	the ticket number in the low half, so dates compare as integers and never
+ *	go through MyDate::operator long().
+ *
+ *	The keys are kept in sorted blocks of at most max_block_size entries, like
+ *	the leaves of a B+-tree with a single internal level. Finding a date is a
+ *	binary search over the blocks and then within one block (O(log n)), a range
+ *	query then walks the blocks in order (O(log n + k)), and an insert or erase
+ *	only shifts entries within one block. A Fenwick tree over the block sizes
+ *	gives the number of entries before any block in O(log n), so Count() is
+ *	two searches and two prefix sums however wide the range is. Assign()
+ *	builds the whole index from a sort, for bulk loads.
+ *
+ *	@version	2020.09
+ *	@see		PackedDate.h
+ *	@see		WorkTicketStore.h
+*/
+
+#pragma once
+#ifndef _TICKET_DATE_INDEX_H
+
+#define _TICKET_DATE_INDEX_H
+
+#include <algorithm>	// for lower_bound, upper_bound, min, sort and unique
+#include <cstddef>		// for size_t
+#include <cstdint>		// for fixed width integers
+#include <iterator>		// for forward_iterator_tag
+#include <vector>		// for the blocks
+#include "PackedDate.h"
+
+using namespace std;
+
+class TicketDateIndex
+{
+public:
+	static constexpr size_t max_block_size = 512; // entries per block before it splits
+
+	/** Entry
+	 *	One ticket in the index.
+	 */
+	struct Entry
+	{
+		PackedDate date;	// the ticket date
+		int ticketNumber;	// the ticket number
+	};
+
+	/** const_iterator
+	 *	Walks the entries in date order (then ticket number order).
+	 */
+	class const_iterator
+	{
+	public:
+		using iterator_category = forward_iterator_tag;
+		using value_type = Entry;
+		using difference_type = ptrdiff_t;
+		using pointer = const Entry*;
+		using reference = Entry;
+
+		const_iterator() = default;
+		const_iterator(const TicketDateIndex* index, const size_t block, const size_t position) : myIndex(index), myBlock(block), myPosition(position) {}
+
+		Entry operator*() const { return ToEntry(myIndex->myBlocks[myBlock][myPosition]); }
+		const_iterator& operator++()
+		{
+			// move to the next entry, rolling over to the next block
+			if (++myPosition == myIndex->myBlocks[myBlock].size())
+			{
+				myBlock++;
+				myPosition = 0;
+			}
+			return *this;
+		}
+		const_iterator operator++(int) { auto original = *this; ++*this; return original; }
+		bool operator==(const const_iterator& compare) const { return myBlock == compare.myBlock && myPosition == compare.myPosition; }
+		bool operator!=(const const_iterator& compare) const { return !(*this == compare); }
+
+	private:
+		const TicketDateIndex* myIndex = nullptr;	// the index being walked
+		size_t myBlock = 0;							// the current block
+		size_t myPosition = 0;						// the position in the block
+	};
+
+	/** Range
+	 *	The entries between two iterators, usable in a range-based for loop.
+	 */
+	struct Range
+	{
+		const_iterator first;	// the first entry
+		const_iterator last;	// one past the last entry
+		const_iterator begin() const { return first; }
+		const_iterator end() const { return last; }
+	};
+
+	/***************************************************************************
+	*	MUTATORS
+	***************************************************************************/
+
+	/** Insert()
+	 *	Adds a ticket. Inserting the same date and ticket number twice keeps one entry.
+	 */
+	void Insert(PackedDate date, int ticket_number);
+
+	/** Erase()
+	 *	Removes a ticket.
+	 *	@return (bool) - false if the ticket was not in the index at that date
+	 */
+	bool Erase(PackedDate date, int ticket_number);
+
+	/** Assign()
+	 *	Replaces the contents with a set of entries in any order, in
+	 *	O(n log n) with one sort, instead of n inserts into random blocks.
+	 *	Blocks are left half full, as splits leave them.
+	 */
+	void Assign(const vector<Entry>& entries);
+
+	/** Move()
+	 *	Updates the index when a ticket's date changes.
+	 */
+	void Move(const int ticket_number, const PackedDate old_date, const PackedDate new_date)
+	{
+		if (old_date != new_date)
+		{
+			Erase(old_date, ticket_number);
+			Insert(new_date, ticket_number);
+		}
+	}
+
+	void Clear() { myBlocks.clear(); myBlockCounts.clear(); mySize = 0; }
+
+	/***************************************************************************
+	*	QUERIES
+	***************************************************************************/
+
+	size_t Size() const { return mySize; }
+
+	const_iterator begin() const { return const_iterator(this, 0, 0); }
+	const_iterator end() const { return const_iterator(this, myBlocks.size(), 0); }
+
+	/** Between()
+	 *	Returns the tickets dated from one date to another, inclusive, in O(log n).
+	 *	Iterating over them is O(k).
+	 */
+	Range Between(const PackedDate from, const PackedDate to) const
+	{
+		if (to < from)
+			return { end(), end() };
+		return { LowerBound(FirstKey(from)), LowerBound(KeyAfter(to)) };
+	}
+
+	/** Count()
+	 *	Counts the tickets dated from one date to another, inclusive, in
+	 *	O(log n): the entries before the end of the range less the entries
+	 *	before its start, each found with a search and a prefix sum.
+	 */
+	size_t Count(PackedDate from, PackedDate to) const;
+
+	/** TicketNumbers()
+	 *	Returns the numbers of the tickets dated from one date to another, inclusive, in date order.
+	 */
+	vector<int> TicketNumbers(PackedDate from, PackedDate to) const;
+
+private:
+	/** Key Conversions
+	 *	The day number goes in the high half so keys sort by date first.
+	 */
+	static uint64_t ToKey(const PackedDate date, const int ticket_number)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(date.DayNumber())) << 32) | static_cast<uint32_t>(ticket_number);
+	}
+	static uint64_t FirstKey(const PackedDate date) { return static_cast<uint64_t>(static_cast<uint32_t>(date.DayNumber())) << 32; }
+	static uint64_t KeyAfter(const PackedDate date) { return static_cast<uint64_t>(static_cast<uint32_t>(date.DayNumber()) + 1) << 32; }
+	static Entry ToEntry(const uint64_t key)
+	{
+		return { PackedDate(static_cast<long>(key >> 32)), static_cast<int>(static_cast<uint32_t>(key)) };
+	}
+
+	/** FindBlock()
+	 *	Returns the block that holds (or would hold) a key.
+	 */
+	size_t FindBlock(uint64_t key) const;
+
+	/** LowerBound()
+	 *	Returns an iterator to the first entry not less than a key.
+	 */
+	const_iterator LowerBound(uint64_t key) const;
+
+	/** EntriesBefore()
+	 *	Returns the number of entries before a key, in O(log n).
+	 */
+	size_t EntriesBefore(uint64_t key) const;
+
+	/** AddToBlockCount() / RebuildBlockCounts()
+	 *	Keep the Fenwick tree of block sizes up to date: AddToBlockCount()
+	 *	after an entry is added to or removed from a block, in O(log blocks),
+	 *	and RebuildBlockCounts() after blocks are added or removed, in
+	 *	O(blocks), as moving the blocks along already costs.
+	 */
+	void AddToBlockCount(size_t block, ptrdiff_t change);
+	void RebuildBlockCounts();
+
+	vector<vector<uint64_t>> myBlocks;	// sorted, non-empty blocks in key order
+	vector<size_t> myBlockCounts;		// Fenwick tree of the block sizes
+	size_t mySize = 0;					// the number of entries
+};
+
+/***************************************************************************
+ *	MUTATOR DEFINITIONS
+ ***************************************************************************/
+
+ // TicketDateIndex::Insert
+void TicketDateIndex::Insert(const PackedDate date, const int ticket_number)
+{
+	const auto key = ToKey(date, ticket_number);
+
+	if (myBlocks.empty())
+	{
+		myBlocks.push_back({ key });
+		mySize++;
+		RebuildBlockCounts();
+		return;
+	}
+
+	const auto blockIndex = FindBlock(key);
+	auto& block = myBlocks[blockIndex];
+	const auto position = lower_bound(block.begin(), block.end(), key);
+	if (position != block.end() && *position == key)
+		return; // already indexed
+
+	block.insert(position, key);
+	mySize++;
+
+	// split a full block in half
+	if (block.size() > max_block_size)
+	{
+		vector<uint64_t> upper(block.begin() + block.size() / 2, block.end());
+		block.resize(block.size() / 2);
+		myBlocks.insert(myBlocks.begin() + blockIndex + 1, move(upper));
+		RebuildBlockCounts();
+		return;
+	}
+	AddToBlockCount(blockIndex, 1);
+}
+
+// TicketDateIndex::Erase
+bool TicketDateIndex::Erase(const PackedDate date, const int ticket_number)
+{
+	const auto key = ToKey(date, ticket_number);
+
+	if (myBlocks.empty())
+		return false;
+
+	const auto blockIndex = FindBlock(key);
+	auto& block = myBlocks[blockIndex];
+	const auto position = lower_bound(block.begin(), block.end(), key);
+	if (position == block.end() || *position != key)
+		return false;
+
+	block.erase(position);
+	mySize--;
+
+	// blocks are never left empty
+	if (block.empty())
+	{
+		myBlocks.erase(myBlocks.begin() + blockIndex);
+		RebuildBlockCounts();
+	}
+	else
+	{
+		AddToBlockCount(blockIndex, -1);
+	}
+	return true;
+}
+
+// TicketDateIndex::Assign
+void TicketDateIndex::Assign(const vector<Entry>& entries)
+{
+	vector<uint64_t> keys; // every key, sorted
+	keys.reserve(entries.size());
+	for (const auto entry : entries)
+		keys.push_back(ToKey(entry.date, entry.ticketNumber));
+	sort(keys.begin(), keys.end());
+	keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+	myBlocks.clear();
+	for (size_t first = 0; first < keys.size(); first += max_block_size / 2)
+		myBlocks.emplace_back(keys.begin() + first, keys.begin() + min(first + max_block_size / 2, keys.size()));
+	mySize = keys.size();
+	RebuildBlockCounts();
+}
+
+/***************************************************************************
+ *	QUERY DEFINITIONS
+ ***************************************************************************/
+
+ // TicketDateIndex::Count
+size_t TicketDateIndex::Count(const PackedDate from, const PackedDate to) const
+{
+	if (to < from || myBlocks.empty())
+		return 0;
+	return EntriesBefore(KeyAfter(to)) - EntriesBefore(FirstKey(from));
+}
+
+// TicketDateIndex::TicketNumbers
+vector<int> TicketDateIndex::TicketNumbers(const PackedDate from, const PackedDate to) const
+{
+	vector<int> numbers; // the matching ticket numbers
+	for (const auto entry : Between(from, to))
+		numbers.push_back(entry.ticketNumber);
+	return numbers;
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketDateIndex::FindBlock
+size_t TicketDateIndex::FindBlock(const uint64_t key) const
+{
+	// the last block whose first key is not greater than the key
+	const auto after = upper_bound(myBlocks.begin(), myBlocks.end(), key,
+		[](const uint64_t value, const vector<uint64_t>& block) { return value < block.front(); });
+	return after == myBlocks.begin() ? 0 : (after - myBlocks.begin()) - 1;
+}
+
+// TicketDateIndex::LowerBound
+TicketDateIndex::const_iterator TicketDateIndex::LowerBound(const uint64_t key) const
+{
+	if (myBlocks.empty())
+		return end();
+
+	const auto blockIndex = FindBlock(key);
+	const auto& block = myBlocks[blockIndex];
+	const auto position = lower_bound(block.begin(), block.end(), key) - block.begin();
+
+	// past the end of this block is the start of the next one
+	if (static_cast<size_t>(position) == block.size())
+		return const_iterator(this, blockIndex + 1, 0);
+	return const_iterator(this, blockIndex, position);
+}
+
+// TicketDateIndex::EntriesBefore
+size_t TicketDateIndex::EntriesBefore(const uint64_t key) const
+{
+	const auto blockIndex = FindBlock(key);
+	const auto& block = myBlocks[blockIndex];
+	size_t count = lower_bound(block.begin(), block.end(), key) - block.begin(); // the entries before it in its block
+
+	// the sizes of the blocks before it, a Fenwick tree prefix sum
+	for (auto node = blockIndex; node > 0; node &= node - 1)
+		count += myBlockCounts[node - 1];
+	return count;
+}
+
+// TicketDateIndex::AddToBlockCount
+void TicketDateIndex::AddToBlockCount(const size_t block, const ptrdiff_t change)
+{
+	for (auto node = block + 1; node <= myBlockCounts.size(); node += node & (0 - node))
+		myBlockCounts[node - 1] += change;
+}
+
+// TicketDateIndex::RebuildBlockCounts
+void TicketDateIndex::RebuildBlockCounts()
+{
+	// each node adds itself to its parent, in O(blocks)
+	myBlockCounts.resize(myBlocks.size());
+	for (size_t block = 0; block < myBlocks.size(); block++)
+		myBlockCounts[block] = myBlocks[block].size();
+	for (size_t node = 1; node <= myBlockCounts.size(); node++)
+	{
+		const auto parent = node + (node & (0 - node));
+		if (parent <= myBlockCounts.size())
+			myBlockCounts[parent - 1] += myBlockCounts[node - 1];
+	}
+}
+
+#endif
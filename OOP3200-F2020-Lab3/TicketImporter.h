@@ -0,0 +1,422 @@
+/** TicketImporter.h - Parallel CSV/TSV Ticket Importer
+ *
+ *	The TicketImporter class loads large CSV or TSV exports of work tickets.
+ *	Each record holds the same fields as a TicketReader line:
+ *
+ *		ticket number, client ID, date, description [, open]
+ *
+ *	Fields may be quoted as in RFC 4180 ("a, b" and "say ""hi"""), and quoted
+ *	fields may span lines. A double quote may only appear inside a quoted field.
+ *
+ *	The text is split into one chunk per thread on record boundaries: a
+ *	parallel pass counts the quotes in each chunk so every boundary can be
+ *	moved to the next line break that is outside a quoted field. The chunks
+ *	are then parsed and validated in parallel with the TicketReader rules,
+ *	and the valid records are merged into the destination in file order.
+ *
+ *	@version	2020.09
+ *	@see		TicketReader.h
+ *	@see		WorkTicketStore.h
+ *	@see		TicketBatch.h
+*/
+
+#pragma once
+#ifndef _TICKET_IMPORTER_H
+
+#define _TICKET_IMPORTER_H
+
+#include <algorithm>	// for count and min
+#include <chrono>		// for steady_clock
+#include <deque>		// for unescaped fields
+#include <fstream>		// for ifstream
+#include <iomanip>		// for setprecision
+#include <ostream>		// for ostream
+#include <stdexcept>	// for runtime_error
+#include <string>		// for string
+#include <string_view>	// for string_view
+#include <thread>		// for thread
+#include <vector>		// for vector
+#include "TicketReader.h"
+#include "TicketBatch.h"
+#include "WorkTicketStore.h"
+
+using namespace std;
+
+class TicketImporter
+{
+public:
+	static constexpr size_t min_chunk_size = 256 * 1024; // bytes; smaller inputs use fewer threads
+
+	/** Result
+	 *	What an import did and how fast.
+	 */
+	struct Result
+	{
+		size_t records = 0;		// records imported
+		size_t invalid = 0;		// records skipped
+		size_t bytes = 0;		// size of the input
+		double seconds = 0;		// wall-clock time, including the merge
+		unsigned threads = 0;	// threads used to parse
+		vector<TicketReader::Error> errors;	// the skipped records, in file order
+
+		double RecordsPerSecond() const { return seconds > 0 ? records / seconds : 0; }
+		double MegabytesPerSecond() const { return seconds > 0 ? bytes / seconds / (1024 * 1024) : 0; }
+
+		/** operator << (Output)
+		 *	Writes a one line throughput report.
+		 */
+		friend ostream& operator<<(ostream& out, const Result& result)
+		{
+			return out << result.records << " records (" << result.invalid << " invalid) in " << fixed << setprecision(3) << result.seconds
+				<< " s on " << result.threads << " threads: " << setprecision(0) << result.RecordsPerSecond() << " records/s, "
+				<< setprecision(1) << result.MegabytesPerSecond() << " MB/s" << defaultfloat << setprecision(6);
+		}
+	};
+
+	/***************************************************************************
+	*	CONSTRUCTORS
+	***************************************************************************/
+
+	/** Constructor
+	 *	@param delimiter (char) - the field separator, e.g. ',' or '\t'
+	 *	@param has_header (bool) - true to skip the first record
+	 *	@param threads (unsigned) - the most threads to use; 0 for one per core
+	 */
+	explicit TicketImporter(const char delimiter = ',', const bool has_header = false, const unsigned threads = 0)
+		: myDelimiter(delimiter), myHasHeader(has_header), myThreads(threads != 0 ? threads : max(1u, thread::hardware_concurrency())) {}
+
+	/***************************************************************************
+	*	IMPORTING
+	***************************************************************************/
+
+	/** Import()
+	 *	Imports every valid record in a buffer. Ticket numbers the store
+	 *	already has are skipped and reported as errors.
+	 *	@param text (string_view) - the CSV or TSV text
+	 *	@param store (WorkTicketStore or TicketBatch by ref) - receives the tickets in file order
+	 *	@return (Result) - the counts, errors and throughput
+	 */
+	Result Import(string_view text, WorkTicketStore& store) const;
+	Result Import(string_view text, TicketBatch& batch) const;
+
+	/** ImportFile()
+	 *	Reads a whole file and imports it.
+	 *	@throws (runtime_error) if the file cannot be read
+	 */
+	Result ImportFile(const string& path, WorkTicketStore& store) const { const auto text = ReadFile(path); return Import(text, store); }
+	Result ImportFile(const string& path, TicketBatch& batch) const { const auto text = ReadFile(path); return Import(text, batch); }
+
+private:
+	/** Chunk
+	 *	The part of the input one thread parses, and what it found.
+	 */
+	struct Chunk
+	{
+		string_view text;						// whole records
+		size_t lineCount = 0;					// line breaks in the text
+		vector<TicketReader::Record> records;	// the valid records
+		vector<size_t> recordLines;				// the line each record starts on, relative to the chunk
+		deque<string> unescaped;				// storage for quoted fields with "" in them
+		vector<TicketReader::Error> errors;		// invalid records, with lines relative to the chunk
+	};
+
+	/** Parse()
+	 *	Splits the text into chunks and parses them in parallel. Line numbers
+	 *	in the results are made absolute.
+	 */
+	vector<Chunk> Parse(string_view text) const;
+
+	/** ParseChunk()
+	 *	Parses and validates every record in a chunk.
+	 */
+	void ParseChunk(Chunk& chunk, bool skip_first) const;
+
+	/** SplitRecord()
+	 *	Splits the record at the start of the text into fields, honouring
+	 *	quotes, and removes it (and its line break) from the text.
+	 *	@return (const char*) - nullptr if the record was well formed, otherwise why not
+	 */
+	const char* SplitRecord(string_view& text, string_view* fields, size_t& field_count, deque<string>& unescaped, size_t& lines) const;
+
+	/** Merge()
+	 *	Adds the parsed records to a destination in file order.
+	 *	@param insert (callable) - adds one record, returning false if it was rejected
+	 */
+	template <typename Insert>
+	Result Merge(string_view text, const Insert& insert) const;
+
+	static string ReadFile(const string& path);
+
+	char myDelimiter;	// the field separator
+	bool myHasHeader;	// skip the first record
+	unsigned myThreads;	// the most threads to use
+};
+
+/***************************************************************************
+ *	IMPORT DEFINITIONS
+ ***************************************************************************/
+
+ // TicketImporter::Import (WorkTicketStore)
+TicketImporter::Result TicketImporter::Import(const string_view text, WorkTicketStore& store) const
+{
+	return Merge(text, [&store](const TicketReader::Record& record)
+	{
+		return store.Insert(record.ticketNumber, record.clientId, record.date, record.description, record.isOpen);
+	});
+}
+
+// TicketImporter::Import (TicketBatch)
+TicketImporter::Result TicketImporter::Import(const string_view text, TicketBatch& batch) const
+{
+	return Merge(text, [&batch](const TicketReader::Record& record)
+	{
+		const auto date = record.date.ToMyDate();
+		return batch.Add(record.ticketNumber, record.clientId, date.GetDay(), date.GetMonth(), date.GetYear(), record.description, record.isOpen);
+	});
+}
+
+// TicketImporter::Merge
+template <typename Insert>
+TicketImporter::Result TicketImporter::Merge(const string_view text, const Insert& insert) const
+{
+	const auto start = chrono::steady_clock::now(); // when the import began
+	Result result;
+
+	auto chunks = Parse(text);
+	for (auto& chunk : chunks)
+	{
+		// interleave the chunk's errors with its records by line, keeping file order
+		auto error = chunk.errors.begin();
+		for (size_t i = 0; i < chunk.records.size(); i++)
+		{
+			for (; error != chunk.errors.end() && error->line < chunk.recordLines[i]; ++error)
+				result.errors.push_back(move(*error));
+
+			if (insert(chunk.records[i]))
+				result.records++;
+			else
+				result.errors.push_back({ chunk.recordLines[i], "duplicate ticket number" });
+		}
+		for (; error != chunk.errors.end(); ++error)
+			result.errors.push_back(move(*error));
+	}
+
+	result.invalid = result.errors.size();
+	result.bytes = text.size();
+	result.threads = static_cast<unsigned>(chunks.size());
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+/***************************************************************************
+ *	PARSING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketImporter::Parse
+vector<TicketImporter::Chunk> TicketImporter::Parse(const string_view text) const
+{
+	const auto chunkCount = max<size_t>(1, min<size_t>(myThreads, text.size() / min_chunk_size));
+	vector<size_t> quoteCounts(chunkCount);	// quotes in each raw chunk
+	vector<thread> workers;					// one per chunk after the first
+
+	// count the quotes in each equal-sized piece, in parallel
+	const auto rawStart = [&](const size_t i) { return text.size() * i / chunkCount; };
+	const auto countQuotes = [&](const size_t i) { quoteCounts[i] = count(text.begin() + rawStart(i), text.begin() + rawStart(i + 1), '"'); };
+	for (size_t i = 1; i < chunkCount; i++)
+		workers.emplace_back(countQuotes, i);
+	countQuotes(0);
+	for (auto& worker : workers)
+		worker.join();
+	workers.clear();
+
+	// move each boundary to the first line break outside quotes
+	vector<size_t> starts(chunkCount + 1, text.size()); // where each chunk begins
+	starts[0] = 0;
+	bool inQuotes = false; // whether the raw start of the next piece is inside a quoted field
+	for (size_t i = 1; i < chunkCount; i++)
+	{
+		inQuotes ^= quoteCounts[i - 1] % 2 != 0;
+		auto position = max(rawStart(i), starts[i - 1]);
+		auto quoted = inQuotes;
+		// a boundary before the previous one starts inside the same state it left
+		if (position != rawStart(i))
+			quoted = false;
+		while (position < text.size() && (quoted || text[position] != '\n'))
+		{
+			if (text[position] == '"')
+				quoted = !quoted;
+			position++;
+		}
+		starts[i] = min(position + 1, text.size());
+	}
+
+	// parse the chunks in parallel
+	vector<Chunk> chunks(chunkCount);
+	for (size_t i = 0; i < chunkCount; i++)
+		chunks[i].text = text.substr(starts[i], starts[i + 1] - starts[i]);
+	for (size_t i = 1; i < chunkCount; i++)
+		workers.emplace_back([&, i] { ParseChunk(chunks[i], false); });
+	ParseChunk(chunks[0], myHasHeader);
+	for (auto& worker : workers)
+		worker.join();
+
+	// make the line numbers absolute
+	size_t firstLine = 1; // the line each chunk starts on
+	for (auto& chunk : chunks)
+	{
+		for (auto& line : chunk.recordLines)
+			line += firstLine;
+		for (auto& error : chunk.errors)
+			error.line += firstLine;
+		firstLine += chunk.lineCount;
+	}
+	return chunks;
+}
+
+// TicketImporter::ParseChunk
+void TicketImporter::ParseChunk(Chunk& chunk, bool skip_first) const
+{
+	auto rest = chunk.text;		// the unparsed text
+	string_view fields[6];		// one more than a record may have, to detect extras
+	size_t fieldCount = 0;		// the fields in the current record
+	TicketReader::Record record{};
+
+	while (!rest.empty())
+	{
+		const auto line = chunk.lineCount; // the record's first line
+		const auto lineEnd = rest.find('\n');
+
+		// skip blank lines
+		if (rest.substr(0, lineEnd).find_first_not_of(" \t\r") == string_view::npos)
+		{
+			rest.remove_prefix(lineEnd == string_view::npos ? rest.size() : lineEnd + 1);
+			chunk.lineCount += lineEnd != string_view::npos;
+			continue;
+		}
+
+		const char* error = SplitRecord(rest, fields, fieldCount, chunk.unescaped, chunk.lineCount);
+		if (skip_first)
+		{
+			skip_first = false;
+			continue;
+		}
+		if (error == nullptr)
+			error = TicketReader::ValidateFields(fields, fieldCount, record);
+
+		if (error == nullptr)
+		{
+			chunk.records.push_back(record);
+			chunk.recordLines.push_back(line);
+		}
+		else
+		{
+			chunk.errors.push_back({ line, error });
+		}
+	}
+}
+
+// TicketImporter::SplitRecord
+const char* TicketImporter::SplitRecord(string_view& text, string_view* fields, size_t& field_count, deque<string>& unescaped, size_t& lines) const
+{
+	const char* error = nullptr;	// the first problem found
+	size_t position = 0;			// the current position in the text
+
+	field_count = 0;
+	while (true)
+	{
+		string_view field; // the current field's value
+
+		if (position < text.size() && text[position] == '"')
+		{
+			// quoted: runs to the next quote that is not doubled
+			const auto start = ++position;
+			string* buffer = nullptr; // only used when the field has "" in it
+			while (true)
+			{
+				const auto quote = text.find('"', position);
+				if (quote == string_view::npos)
+				{
+					lines += count(text.begin() + position, text.end(), '\n');
+					position = text.size();
+					error = "quoted field is not closed";
+					break;
+				}
+				lines += count(text.begin() + position, text.begin() + quote, '\n');
+				if (quote + 1 < text.size() && text[quote + 1] == '"')
+				{
+					if (buffer == nullptr)
+					{
+						unescaped.emplace_back();
+						buffer = &unescaped.back();
+						buffer->assign(text.data() + start, quote + 1 - start);
+					}
+					else
+					{
+						buffer->append(text.data() + position, quote + 1 - position);
+					}
+					position = quote + 2;
+					continue;
+				}
+				if (buffer != nullptr)
+					buffer->append(text.data() + position, quote - position);
+				field = buffer != nullptr ? string_view(*buffer) : text.substr(start, quote - start);
+				position = quote + 1;
+				break;
+			}
+
+			// only a delimiter or the end of the line may follow
+			if (position < text.size() && text[position] == '\r')
+				position++;
+			if (position < text.size() && text[position] != myDelimiter && text[position] != '\n' && error == nullptr)
+				error = "unexpected text after a quoted field";
+			while (position < text.size() && text[position] != myDelimiter && text[position] != '\n')
+				position++;
+		}
+		else
+		{
+			// unquoted: runs to the next delimiter or line break
+			auto end = position;
+			while (end < text.size() && text[end] != myDelimiter && text[end] != '\n')
+				end++;
+			field = text.substr(position, end - position);
+			if (!field.empty() && field.back() == '\r')
+				field.remove_suffix(1);
+			position = end;
+		}
+
+		if (field_count < 6)
+			fields[field_count++] = field;
+
+		// a delimiter starts another field; anything else ends the record
+		if (position < text.size() && text[position] == myDelimiter)
+		{
+			position++;
+			continue;
+		}
+		if (position < text.size())
+		{
+			position++; // the line break
+			lines++;
+		}
+		break;
+	}
+
+	text.remove_prefix(position);
+	return error;
+}
+
+// TicketImporter::ReadFile
+string TicketImporter::ReadFile(const string& path)
+{
+	ifstream file(path, ios::binary | ios::ate);
+	if (!file)
+		throw runtime_error("Could not open " + path + ". ");
+
+	string text(static_cast<size_t>(file.tellg()), '\0'); // the whole file
+	file.seekg(0);
+	if (!file.read(&text[0], static_cast<streamsize>(text.size())))
+		throw runtime_error("Could not read " + path + ". ");
+	return text;
+}
+
+#endif
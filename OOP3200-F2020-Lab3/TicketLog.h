@@ -0,0 +1,734 @@
+/** TicketLog.h - Write-Ahead Log of Ticket Changes
+ *
+ *	The TicketLog class makes changes to tickets durable by appending a
+ *	compact binary record of each one to a log file, and Replay() rebuilds a
+ *	WorkTicketStore from the log after a crash. A log file is a 16 byte
+ *	header followed by records, every field little-endian:
+ *
+ *		header		"WTKTLOG\0", version uint32, reserved uint32
+ *		record		size uint32		bytes from lsn to the end of the payload
+ *					crc uint32		CRC-32 of those bytes
+ *					lsn uint64		log sequence number, one higher than the last record's
+ *					type uint8		a RecordType
+ *					payload			the fields of that type, strings as a uint32 length and bytes
+ *
+ *	Calling fsync for every change would limit a log to a few hundred
+ *	changes a second. Instead, changes are appended to a buffer in memory
+ *	and a background thread writes the buffer and syncs the file, so every
+ *	change that arrives while one sync is in progress goes out with the next
+ *	(group commit). The Options choose when a call returns, and how long the
+ *	thread waits for more changes before it writes.
+ *
+ *	A crash can leave a partly written record at the end of the log. Replay
+ *	stops at the first record that is cut short, fails its checksum or is
+ *	out of sequence, and opening the log for writing cuts it off there.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicketStore.h
+ *	@see		TicketSegment.h
+*/
+
+#pragma once
+#ifndef _TICKET_LOG_H
+
+#define _TICKET_LOG_H
+
+#include <algorithm>			// for min and max
+#include <cerrno>				// for EINTR
+#include <chrono>				// for the commit delay
+#include <condition_variable>	// for waking the writer thread and waiting callers
+#include <cstdint>				// for fixed width integers
+#include <cstring>				// for memcmp
+#include <fstream>				// for reading a log
+#include <mutex>				// for mutex
+#include <stdexcept>			// for runtime_error
+#include <string>				// for the buffers
+#include <string_view>			// for string_view
+#include <thread>				// for the writer thread
+#include "ExtendedWorkTicket.h"
+#include "PackedDate.h"
+#include "TicketSegment.h"		// for LoadLittle and AppendLittle
+#include "WorkTicketStore.h"
+
+#ifndef _WIN32
+#include <fcntl.h>		// for open
+#include <unistd.h>		// for write, fsync and ftruncate
+#endif
+
+using namespace std;
+
+class TicketLog
+{
+public:
+	static constexpr char magic[8] = { 'W', 'T', 'K', 'T', 'L', 'O', 'G', '\0' };
+	static constexpr uint32_t version = 1;			// bumped when the record layout changes
+	static constexpr size_t header_size = 16;		// bytes before the first record
+	static constexpr size_t record_header_size = 8;	// the size and crc fields
+	static constexpr uint32_t max_record_size = 64 * 1024 * 1024; // anything larger is corrupt
+
+	/** RecordType
+	 *	The change a record describes, and so the fields in its payload.
+	 */
+	enum class RecordType : uint8_t
+	{
+		Insert = 1,		// ticket number, day number, open flag, client ID, description
+		SetWorkTicket,	// ticket number, day number, client ID, description
+		SetDate,		// ticket number, day number
+		SetClientId,	// ticket number, client ID
+		SetDescription,	// ticket number, description
+		Close			// ticket number
+	};
+
+	/** Durability
+	 *	When a call that appends a record returns.
+	 */
+	enum class Durability
+	{
+		Commit,		// once the record is synced to disk; the default
+		Deferred,	// at once; the record is synced within about commit_delay
+		Buffered	// at once; the record is written but never synced, so a crash of the machine can lose it
+	};
+
+	/** Options
+	 *	The latency and throughput trade-offs. A longer commit_delay puts
+	 *	more changes in each sync, so more changes a second can be made
+	 *	durable, but each one waits longer.
+	 */
+	struct Options
+	{
+		Durability durability = Durability::Commit;
+		chrono::microseconds commit_delay{ 0 };	// how long to wait for more changes before a write
+		size_t max_batch_bytes = 1024 * 1024;	// write at once when this much is waiting
+		uint64_t first_lsn = 1;					// the lowest sequence number for the next record, e.g. one past a snapshot's
+		uint64_t scan_from = 0;					// a record boundary the log is known to be valid up to; opening reads only from there,
+												// unless the record there is not first_lsn, when it reads the whole log as Replay() does
+	};
+
+	/** Record
+	 *	One decoded record. The strings view the log being read and are only
+	 *	valid during the call that is given the record.
+	 */
+	struct Record
+	{
+		uint64_t lsn = 0;				// the log sequence number
+		RecordType type = RecordType::Close;
+		int32_t ticketNumber = 0;		// every type
+		PackedDate date;				// Insert, SetWorkTicket and SetDate
+		bool isOpen = false;			// Insert
+		string_view clientId;			// Insert, SetWorkTicket and SetClientId
+		string_view description;		// Insert, SetWorkTicket and SetDescription
+	};
+
+	/** ScanResult
+	 *	What reading a log found.
+	 */
+	struct ScanResult
+	{
+		size_t records = 0;			// valid records
+		size_t replayed = 0;		// records applied by Replay()
+		uint64_t lastLsn = 0;		// the sequence number of the last valid record; 0 if none
+		uint64_t validBytes = 0;	// the length of the log up to the end of that record
+		uint64_t fileBytes = 0;		// the length of the file; more than validBytes after a crash
+	};
+
+	/** Stats
+	 *	What a log has done since it was opened.
+	 */
+	struct Stats
+	{
+		size_t records = 0;	// records appended
+		size_t bytes = 0;	// bytes written
+		size_t writes = 0;	// batches written
+		size_t syncs = 0;	// fsync calls
+	};
+
+	/***************************************************************************
+	*	OPENING AND CLOSING
+	***************************************************************************/
+
+	/** Constructor
+	 *	Opens a log for appending, creating it if it does not exist. A torn
+	 *	or corrupt tail is cut off, and sequence numbers carry on from the
+	 *	last valid record.
+	 *	@param path (string) - the log file
+	 *	@throws (runtime_error) if the file is not a ticket log or cannot be opened
+	 */
+	explicit TicketLog(const string& path) : TicketLog(path, Options()) {}
+	TicketLog(const string& path, Options options);
+
+	TicketLog(const TicketLog&) = delete;
+	TicketLog& operator=(const TicketLog&) = delete;
+
+	/** Destructor
+	 *	Writes and syncs every record appended, then closes the log.
+	 */
+	~TicketLog();
+
+	/***************************************************************************
+	*	APPENDING
+	*	Each records one change, made or about to be made to a store, and
+	*	returns its sequence number when the Durability option allows.
+	*	@throws (runtime_error) if an earlier write or sync of the log failed
+	***************************************************************************/
+
+	uint64_t Insert(const WorkTicket& ticket) { return Insert(ticket.GetTicketNumber(), ticket.GetClientIdView(), ticket.GetPackedDate(), ticket.GetDescriptionView(), true); }
+	uint64_t Insert(const ExtendedWorkTicket& ticket) { return Insert(ticket.GetTicketNumber(), ticket.GetClientIdView(), ticket.GetPackedDate(), ticket.GetDescriptionView(), ticket.IsOpen()); }
+	uint64_t Insert(const int ticket_number, const string_view client_id, const PackedDate date, const string_view description, const bool is_open)
+	{
+		return Append(RecordType::Insert, ticket_number, date, is_open, client_id, description);
+	}
+
+	/** SetWorkTicket() / SetDate()
+	 *	@throws (out_of_range) if the date is invalid
+	 */
+	uint64_t SetWorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
+	{
+		return Append(RecordType::SetWorkTicket, ticket_number, PackedDate(day, month, year), false, client_id, description);
+	}
+	uint64_t SetDate(const int ticket_number, const int day, const int month, const int year)
+	{
+		return Append(RecordType::SetDate, ticket_number, PackedDate(day, month, year), false, string_view(), string_view());
+	}
+	uint64_t SetClientId(const int ticket_number, const string_view client_id) { return Append(RecordType::SetClientId, ticket_number, PackedDate(), false, client_id, string_view()); }
+	uint64_t SetDescription(const int ticket_number, const string_view description) { return Append(RecordType::SetDescription, ticket_number, PackedDate(), false, string_view(), description); }
+	uint64_t Close(const int ticket_number) { return Append(RecordType::Close, ticket_number, PackedDate(), false, string_view(), string_view()); }
+
+	/** Flush()
+	 *	Waits until every record appended so far is written, and synced
+	 *	unless the log is Buffered, without waiting for the commit delay.
+	 *	@throws (runtime_error) if the write or sync failed
+	 */
+	void Flush();
+
+	/***************************************************************************
+	*	ACCESSORS
+	***************************************************************************/
+
+	uint64_t LastLsn() const { lock_guard<mutex> lock(myMutex); return myNextLsn - 1; }	// the last record appended
+	uint64_t EndOffset() const { lock_guard<mutex> lock(myMutex); return myEndOffset; }	// the length of the log once that record is written
+	uint64_t DurableLsn() const { lock_guard<mutex> lock(myMutex); return myDurableLsn; }	// the last record written and synced
+	Stats GetStats() const { lock_guard<mutex> lock(myMutex); return myStats; }
+	const string& Path() const { return myPath; }
+
+	/***************************************************************************
+	*	READING
+	***************************************************************************/
+
+	/** Scan()
+	 *	Calls visit(record) for each valid record of a log in order, stopping
+	 *	at the first that is cut short, corrupt or out of sequence. A file
+	 *	that does not exist, or ends inside the header, holds no records.
+	 *	@param from_offset (uint64_t) - where a record starts, e.g. an earlier EndOffset(), to
+	 *	                                read only the records after it; 0, or an offset past
+	 *	                                the end of the file, reads them all
+	 *	@throws (runtime_error) if the file is not a ticket log
+	 */
+	template <typename Visit>
+	static ScanResult Scan(const string& path, Visit visit, uint64_t from_offset = 0);
+
+	/** Replay()
+	 *	Applies the records of a log to a store, in order, as the changes
+	 *	were first made: to an empty store, or to one loaded from a snapshot
+	 *	taken at after_lsn. Records the store rejects, such as an Insert of a
+	 *	ticket it already has, change nothing, as they did the first time.
+	 *	@param after_lsn (uint64_t) - skip the records up to this one, e.g. those already in a snapshot
+	 *	@param from_offset (uint64_t) - where the record after after_lsn starts, if known, so
+	 *	                                the records before it are not read; if the record
+	 *	                                there is not the next one, the whole log is read
+	 *	@return (ScanResult) - what was found and applied
+	 */
+	static ScanResult Replay(const string& path, WorkTicketStore& store, uint64_t after_lsn = 0, uint64_t from_offset = 0);
+
+	/** Crc32()
+	 *	The CRC-32 (IEEE 802.3) of some bytes, eight at a time.
+	 *	@param crc (uint32_t) - the CRC of the bytes before these, to continue it
+	 */
+	static uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+
+private:
+	/** Append()
+	 *	Encodes a record onto the pending buffer and waits as the options say.
+	 */
+	uint64_t Append(RecordType type, int ticket_number, PackedDate date, bool is_open, string_view client_id, string_view description);
+
+	/** Decode()
+	 *	Decodes the payload of a record.
+	 *	@return (bool) - false if the payload does not match its type
+	 */
+	static bool Decode(const unsigned char* payload, size_t size, Record& record);
+
+	/** WriterLoop()
+	 *	The background thread: waits for records, writes them and syncs.
+	 */
+	void WriterLoop();
+
+	/** File Access
+	 *	Thin wrappers over the operating system's file calls.
+	 */
+	void OpenFile(uint64_t valid_bytes);
+	bool WriteFile(const string& bytes);
+	bool SyncFile();
+	void CloseFile();
+
+	string myPath;						// the log file
+	Options myOptions;					// when to write and sync
+	mutable mutex myMutex;				// guards everything below
+	condition_variable myWake;			// wakes the writer thread
+	condition_variable myWritten;		// wakes callers waiting for their records
+	string myPending;					// records appended and not yet being written
+	uint64_t myNextLsn = 1;				// the sequence number of the next record
+	uint64_t myEndOffset = 0;			// where the next record will start in the file
+	uint64_t myDurableLsn = 0;			// the last record written (and synced, unless Buffered)
+	size_t myFlushWaiters = 0;			// callers of Flush() waiting
+	bool myStopping = false;			// set by the destructor
+	string myError;						// why a write or sync failed; empty if none has
+	Stats myStats;						// counters
+	thread myWriter;					// runs WriterLoop()
+#ifdef _WIN32
+	HANDLE myFile = INVALID_HANDLE_VALUE;	// the open log
+#else
+	int myFile = -1;						// the open log
+#endif
+};
+
+/***************************************************************************
+ *	OPENING AND CLOSING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketLog::Constructor
+TicketLog::TicketLog(const string& path, const Options options) : myPath(path), myOptions(options)
+{
+	// opening truncates the log to what the scan found valid, so a scan_from that is
+	// neither where record first_lsn starts nor the end of the log is not trusted
+	uint64_t firstLsn = 0; // the sequence number of the first record read
+	auto found = Scan(path, [&firstLsn](const Record& record)
+	{
+		if (firstLsn == 0)
+			firstLsn = record.lsn;
+	}, options.scan_from);
+	const auto misplaced = found.records == 0 ? found.validBytes != found.fileBytes : firstLsn != options.first_lsn;
+	if (options.scan_from != 0 && misplaced)
+		found = Scan(path, [](const Record&) {});
+
+	OpenFile(found.validBytes);
+	myEndOffset = max<uint64_t>(found.validBytes, header_size);
+	myNextLsn = max(found.lastLsn + 1, options.first_lsn);
+	myDurableLsn = myNextLsn - 1;
+	myWriter = thread(&TicketLog::WriterLoop, this);
+}
+
+// TicketLog::Destructor
+TicketLog::~TicketLog()
+{
+	{
+		lock_guard<mutex> lock(myMutex);
+		myStopping = true;
+	}
+	myWake.notify_one();
+	myWriter.join();
+	CloseFile();
+}
+
+/***************************************************************************
+ *	APPENDING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketLog::Append
+uint64_t TicketLog::Append(const RecordType type, const int ticket_number, const PackedDate date, const bool is_open, const string_view client_id, const string_view description)
+{
+	const auto text = [this](const string_view value)
+	{
+		AppendLittle(myPending, static_cast<uint32_t>(value.size()));
+		myPending.append(value.data(), value.size());
+	};
+
+	unique_lock<mutex> lock(myMutex);
+	if (!myError.empty())
+		throw runtime_error(myError);
+
+	// encode the record in place, then fill in its size and checksum
+	const auto lsn = myNextLsn++;			// this record's sequence number
+	const auto start = myPending.size();	// where the record begins
+	const auto wasEmpty = start == 0;		// whether the writer thread is idle
+	try
+	{
+		myPending.append(record_header_size, '\0');
+		AppendLittle(myPending, lsn);
+		AppendLittle(myPending, static_cast<uint8_t>(type));
+		AppendLittle(myPending, ticket_number);
+		if (type == RecordType::Insert || type == RecordType::SetWorkTicket || type == RecordType::SetDate)
+			AppendLittle(myPending, date.DayNumber());
+		if (type == RecordType::Insert)
+			AppendLittle(myPending, static_cast<uint8_t>(is_open ? 1 : 0));
+		if (type == RecordType::Insert || type == RecordType::SetWorkTicket || type == RecordType::SetClientId)
+			text(client_id);
+		if (type == RecordType::Insert || type == RecordType::SetWorkTicket || type == RecordType::SetDescription)
+			text(description);
+	}
+	catch (...)
+	{
+		// out of memory: leave no half-encoded record behind
+		myPending.resize(start);
+		myNextLsn--;
+		throw;
+	}
+
+	const auto body = start + record_header_size;	// the checksummed bytes
+	const auto size = static_cast<uint32_t>(myPending.size() - body);
+	const auto crc = Crc32(myPending.data() + body, size);
+	for (size_t i = 0; i < 4; i++)
+	{
+		myPending[start + i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+		myPending[start + 4 + i] = static_cast<char>((crc >> (8 * i)) & 0xFF);
+	}
+	myStats.records++;
+	myEndOffset += myPending.size() - start;
+
+	if (wasEmpty || myPending.size() >= myOptions.max_batch_bytes)
+		myWake.notify_one();
+
+	if (myOptions.durability == Durability::Commit)
+	{
+		myWritten.wait(lock, [&]() { return myDurableLsn >= lsn || !myError.empty(); });
+		if (myDurableLsn < lsn)
+			throw runtime_error(myError);
+	}
+	return lsn;
+}
+
+// TicketLog::Flush
+void TicketLog::Flush()
+{
+	unique_lock<mutex> lock(myMutex);
+	const auto target = myNextLsn - 1; // the last record appended before the call
+
+	myFlushWaiters++;
+	myWake.notify_one();
+	myWritten.wait(lock, [&]() { return myDurableLsn >= target || !myError.empty(); });
+	myFlushWaiters--;
+	if (myDurableLsn < target)
+		throw runtime_error(myError);
+}
+
+/***************************************************************************
+ *	READING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketLog::Scan
+template <typename Visit>
+TicketLog::ScanResult TicketLog::Scan(const string& path, Visit visit, const uint64_t from_offset)
+{
+	ScanResult result;
+	ifstream file(path, ios::binary | ios::ate);
+	if (!file)
+		return result;
+
+	result.fileBytes = static_cast<uint64_t>(file.tellg());
+	if (result.fileBytes < header_size)
+		return result; // the crash came before the header was written
+
+	unsigned char header[header_size]; // magic and version
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(header), header_size))
+		throw runtime_error("Could not read ticket log " + path + ". ");
+	if (memcmp(header, magic, sizeof(magic)) != 0)
+		throw runtime_error("File " + path + " is not a ticket log. ");
+	if (LoadLittle<uint32_t>(header + sizeof(magic)) != version)
+		throw runtime_error("Ticket log " + path + " has an unsupported version. ");
+
+	// the records from the first one to be read to the end of the file
+	const auto start = from_offset >= header_size && from_offset <= result.fileBytes ? from_offset : header_size;
+	string contents(static_cast<size_t>(result.fileBytes - start), '\0');
+	file.seekg(static_cast<streamoff>(start));
+	if (!contents.empty() && !file.read(&contents[0], static_cast<streamsize>(contents.size())))
+		throw runtime_error("Could not read ticket log " + path + ". ");
+	const auto data = reinterpret_cast<const unsigned char*>(contents.data());
+
+	size_t offset = 0; // the start of the next record in contents
+	result.validBytes = start;
+	while (contents.size() - offset >= record_header_size)
+	{
+		const auto size = LoadLittle<uint32_t>(data + offset);
+		const auto body = data + offset + record_header_size;
+		if (size < 9 || size > max_record_size || size > contents.size() - offset - record_header_size)
+			break; // cut short
+		if (LoadLittle<uint32_t>(data + offset + 4) != Crc32(body, size))
+			break; // corrupt
+
+		Record record;
+		record.lsn = LoadLittle<uint64_t>(body);
+		record.type = static_cast<RecordType>(body[8]);
+		if (record.lsn <= result.lastLsn || !Decode(body + 9, size - 9, record))
+			break; // out of sequence or malformed
+
+		visit(record);
+		result.records++;
+		result.lastLsn = record.lsn;
+		offset += record_header_size + size;
+		result.validBytes = start + offset;
+	}
+	return result;
+}
+
+// TicketLog::Replay
+TicketLog::ScanResult TicketLog::Replay(const string& path, WorkTicketStore& store, const uint64_t after_lsn, const uint64_t from_offset)
+{
+	size_t replayed = 0;	// records applied
+	bool misplaced = false;	// the record at from_offset was not the one after after_lsn
+	auto result = Scan(path, [&](const Record& record)
+	{
+		if (from_offset != 0 && replayed == 0 && record.lsn != after_lsn + 1)
+			misplaced = true;
+		if (misplaced || record.lsn <= after_lsn)
+			return;
+
+		const auto date = record.date;
+		switch (record.type)
+		{
+		case RecordType::Insert:
+			store.Insert(record.ticketNumber, record.clientId, date, record.description, record.isOpen);
+			break;
+		case RecordType::SetWorkTicket:
+			store.SetWorkTicket(record.ticketNumber, record.clientId, date.GetDay(), date.GetMonth(), date.GetYear(), record.description);
+			break;
+		case RecordType::SetDate:
+			store.SetDate(record.ticketNumber, date.GetDay(), date.GetMonth(), date.GetYear());
+			break;
+		case RecordType::SetClientId:
+			store.SetClientId(record.ticketNumber, record.clientId);
+			break;
+		case RecordType::SetDescription:
+			store.SetDescription(record.ticketNumber, record.description);
+			break;
+		case RecordType::Close:
+			store.Close(record.ticketNumber);
+			break;
+		}
+		replayed++;
+	}, from_offset);
+
+	// the offset was not where the next record starts: read the whole log
+	if (from_offset != 0 && (misplaced || (result.records == 0 && result.validBytes != result.fileBytes)))
+		return Replay(path, store, after_lsn, 0);
+	result.replayed = replayed;
+	return result;
+}
+
+// TicketLog::Crc32
+uint32_t TicketLog::Crc32(const void* data, size_t size, uint32_t crc)
+{
+	// table[k][b] is the CRC of byte b followed by k zero bytes
+	static const auto table = []()
+	{
+		static uint32_t built[8][256];
+		for (uint32_t b = 0; b < 256; b++)
+		{
+			auto value = b; // the CRC so far
+			for (int bit = 0; bit < 8; bit++)
+				value = (value >> 1) ^ (0xEDB88320u & (0u - (value & 1)));
+			built[0][b] = value;
+		}
+		for (int k = 1; k < 8; k++)
+		{
+			for (uint32_t b = 0; b < 256; b++)
+				built[k][b] = (built[k - 1][b] >> 8) ^ built[0][built[k - 1][b] & 0xFF];
+		}
+		return built;
+	}();
+
+	auto bytes = static_cast<const unsigned char*>(data);
+	crc = ~crc;
+	for (; size >= 8; size -= 8, bytes += 8)
+	{
+		const auto low = crc ^ LoadLittle<uint32_t>(bytes);
+		const auto high = LoadLittle<uint32_t>(bytes + 4);
+		crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24]
+			^ table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+	}
+	for (; size > 0; size--, bytes++)
+		crc = (crc >> 8) ^ table[0][(crc ^ *bytes) & 0xFF];
+	return ~crc;
+}
+
+// TicketLog::Decode
+bool TicketLog::Decode(const unsigned char* payload, const size_t size, Record& record)
+{
+	size_t used = 0; // bytes decoded
+	const auto fits = [&](const size_t bytes) { return size - used >= bytes; };
+	const auto text = [&](string_view& value)
+	{
+		if (!fits(4))
+			return false;
+		const auto length = LoadLittle<uint32_t>(payload + used);
+		used += 4;
+		if (size - used < length)
+			return false;
+		value = string_view(reinterpret_cast<const char*>(payload + used), length);
+		used += length;
+		return true;
+	};
+	const auto type = record.type;
+	const auto hasDate = type == RecordType::Insert || type == RecordType::SetWorkTicket || type == RecordType::SetDate;
+	const auto hasClient = type == RecordType::Insert || type == RecordType::SetWorkTicket || type == RecordType::SetClientId;
+	const auto hasDescription = type == RecordType::Insert || type == RecordType::SetWorkTicket || type == RecordType::SetDescription;
+
+	if (type < RecordType::Insert || type > RecordType::Close || !fits(4))
+		return false;
+	record.ticketNumber = LoadLittle<int32_t>(payload);
+	used = 4;
+	if (hasDate)
+	{
+		if (!fits(4))
+			return false;
+		const auto dayNumber = LoadLittle<int32_t>(payload + used);
+		if (dayNumber <= 0 || dayNumber > MyDate::DayNumber(31, 12, 9999))
+			return false;
+		record.date = PackedDate(static_cast<long>(dayNumber));
+		used += 4;
+	}
+	if (type == RecordType::Insert)
+	{
+		if (!fits(1))
+			return false;
+		record.isOpen = payload[used++] != 0;
+	}
+	if ((hasClient && !text(record.clientId)) || (hasDescription && !text(record.description)))
+		return false;
+	return used == size;
+}
+
+/***************************************************************************
+ *	WRITER THREAD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketLog::WriterLoop
+void TicketLog::WriterLoop()
+{
+	string writing; // the batch being written; swapped with myPending so both buffers are reused
+	unique_lock<mutex> lock(myMutex);
+	while (true)
+	{
+		myWake.wait(lock, [this]() { return myStopping || !myPending.empty(); });
+		if (myPending.empty())
+			break; // stopping, with nothing left to write
+
+		// give more changes a chance to join the batch, unless someone is waiting on a flush
+		if (myOptions.commit_delay.count() > 0)
+		{
+			myWake.wait_for(lock, myOptions.commit_delay, [this]()
+			{
+				return myStopping || myFlushWaiters > 0 || myPending.size() >= myOptions.max_batch_bytes;
+			});
+		}
+
+		writing.swap(myPending);
+		const auto last = myNextLsn - 1; // the last record in the batch
+		lock.unlock();
+
+		const auto sync = myOptions.durability != Durability::Buffered;
+		const auto written = WriteFile(writing);
+		const auto synced = written && (!sync || SyncFile());
+
+		lock.lock();
+		myStats.writes++;
+		myStats.bytes += writing.size();
+		myStats.syncs += sync && written;
+		writing.clear();
+		if (!synced)
+		{
+			myError = "Could not " + string(written ? "sync" : "write") + " ticket log " + myPath + ". ";
+			myWritten.notify_all();
+			break;
+		}
+		myDurableLsn = last;
+		myWritten.notify_all();
+	}
+}
+
+/***************************************************************************
+ *	FILE ACCESS DEFINITIONS
+ ***************************************************************************/
+
+ // TicketLog::OpenFile
+void TicketLog::OpenFile(uint64_t valid_bytes)
+{
+	string header(magic, sizeof(magic)); // written if the file has no valid header
+	AppendLittle(header, version);
+	AppendLittle(header, static_cast<uint32_t>(0));
+
+#ifdef _WIN32
+	myFile = CreateFileA(myPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER end;
+	end.QuadPart = static_cast<LONGLONG>(valid_bytes);
+	if (myFile == INVALID_HANDLE_VALUE || !SetFilePointerEx(myFile, end, nullptr, FILE_BEGIN) || !SetEndOfFile(myFile))
+	{
+		CloseFile();
+		throw runtime_error("Could not open ticket log " + myPath + ". ");
+	}
+#else
+	myFile = open(myPath.c_str(), O_RDWR | O_CREAT, 0644);
+	if (myFile < 0 || ftruncate(myFile, static_cast<off_t>(valid_bytes)) != 0 || lseek(myFile, 0, SEEK_END) < 0)
+	{
+		CloseFile();
+		throw runtime_error("Could not open ticket log " + myPath + ". ");
+	}
+#endif
+
+	// a new log, or one that was cut off inside its header, starts again
+	if (valid_bytes < header_size && (!WriteFile(header) || !SyncFile()))
+	{
+		CloseFile();
+		throw runtime_error("Could not write ticket log " + myPath + ". ");
+	}
+}
+
+// TicketLog::WriteFile
+bool TicketLog::WriteFile(const string& bytes)
+{
+	size_t done = 0; // bytes written so far
+	while (done < bytes.size())
+	{
+#ifdef _WIN32
+		DWORD wrote = 0;
+		const auto chunk = static_cast<DWORD>(min<size_t>(bytes.size() - done, 1u << 30));
+		if (!::WriteFile(myFile, bytes.data() + done, chunk, &wrote, nullptr))
+			return false;
+#else
+		const auto wrote = write(myFile, bytes.data() + done, bytes.size() - done);
+		if (wrote < 0 && errno == EINTR)
+			continue;
+		if (wrote <= 0)
+			return false;
+#endif
+		done += static_cast<size_t>(wrote);
+	}
+	return true;
+}
+
+// TicketLog::SyncFile
+bool TicketLog::SyncFile()
+{
+#ifdef _WIN32
+	return FlushFileBuffers(myFile) != 0;
+#elif defined(__linux__)
+	return fdatasync(myFile) == 0;
+#else
+	return fsync(myFile) == 0;
+#endif
+}
+
+// TicketLog::CloseFile
+void TicketLog::CloseFile()
+{
+#ifdef _WIN32
+	if (myFile != INVALID_HANDLE_VALUE)
+		CloseHandle(myFile);
+	myFile = INVALID_HANDLE_VALUE;
+#else
+	if (myFile >= 0)
+		close(myFile);
+	myFile = -1;
+#endif
+}
+
+#endif
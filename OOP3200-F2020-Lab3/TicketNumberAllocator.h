@@ -0,0 +1,190 @@
+/** TicketNumberAllocator.h - Unique Ticket Number Allocator
+ *
+ *	The TicketNumberAllocator class hands out unique, positive ticket numbers
+ *	to any number of threads without a lock. Numbers come from one atomic
+ *	counter, but each thread reserves them a block at a time and hands them
+ *	out from its block, so threads only touch the shared counter once per
+ *	block. Within a thread the numbers always increase. Across threads a
+ *	number from one thread may be lower than one handed out earlier by
+ *	another; a block size of 1 makes every number higher than the last one,
+ *	at the cost of an atomic add per number.
+ *
+ *	Numbers in a block that is never used up are never handed out, so the
+ *	numbers may have gaps. At startup, Recover() raises the counter above
+ *	every ticket that was persisted, so numbers are not reused after a
+ *	restart.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+ *	@see		TicketRegistry.h
+*/
+
+#pragma once
+#ifndef _TICKET_NUMBER_ALLOCATOR_H
+
+#define _TICKET_NUMBER_ALLOCATOR_H
+
+#include <algorithm>	// for find_if and max_element
+#include <atomic>		// for the counter
+#include <climits>		// for INT_MAX
+#include <cstdint>		// for fixed width integers
+#include <iterator>		// for begin and end
+#include <stdexcept>	// for invalid_argument and overflow_error
+#include "WorkTicketStore.h"
+#include "TicketSegment.h"
+
+using namespace std;
+
+class TicketNumberAllocator
+{
+public:
+	static constexpr int default_block_size = 64;	// numbers a thread reserves at a time
+	static constexpr size_t blocks_per_thread = 4;	// allocators a thread can use in turn without abandoning blocks
+
+	/** Constructor
+	 *	@param block_size (int) - numbers each thread reserves at a time; 1 for strict order
+	 *	@param high_water_mark (int) - the highest number already used; numbers start above it
+	 *	@throws (invalid_argument) if block_size is not positive or high_water_mark is negative
+	 */
+	explicit TicketNumberAllocator(int block_size = default_block_size, int high_water_mark = 0);
+
+	TicketNumberAllocator(const TicketNumberAllocator&) = delete;
+	TicketNumberAllocator& operator=(const TicketNumberAllocator&) = delete;
+
+	/** Next()
+	 *	Returns an unused ticket number. Lock-free; the calling thread touches
+	 *	the shared counter only when its block runs out.
+	 *	@return (int) - a number no other call has returned
+	 *	@throws (overflow_error) once every number up to INT_MAX is reserved
+	 */
+	int Next();
+
+	/** Observe()
+	 *	Makes sure a number that is already in use will not be handed out,
+	 *	by raising the counter above it. Meant for startup, before Next() is
+	 *	called; it does not affect numbers already reserved by a thread.
+	 */
+	void Observe(int ticket_number);
+
+	/** Recover()
+	 *	Observes the highest ticket number in a store or a segment file.
+	 */
+	void Recover(const WorkTicketStore& store);
+	void Recover(const TicketSegmentReader& segment);
+
+	/** HighWaterMark()
+	 *	The highest number reserved so far, whether or not it was handed out.
+	 */
+	int HighWaterMark() const { return static_cast<int>(min<int64_t>(myNext.load(memory_order_relaxed) - 1, INT_MAX)); }
+
+	int BlockSize() const { return myBlockSize; }
+
+private:
+	/** Block
+	 *	The numbers a thread has reserved and not yet handed out. A thread
+	 *	keeps one for each of the last blocks_per_thread allocators it used;
+	 *	using one more abandons the rest of the oldest.
+	 */
+	struct Block
+	{
+		uint64_t owner = 0;	// the id of the allocator it came from
+		int64_t next = 0;	// the next number to hand out
+		int64_t end = 0;	// one past the last number, which may be INT_MAX + 1
+	};
+
+	/** Reserve()
+	 *	Takes count numbers from the shared counter.
+	 *	@return (Block) - the numbers, fewer than count near INT_MAX
+	 */
+	Block Reserve(int count);
+
+	static atomic<uint64_t> next_id;	// allocator ids; unlike addresses they are never reused, so a stale Block is never mistaken for a new allocator's
+
+	const uint64_t myId;			// this allocator's id
+	const int myBlockSize;			// numbers reserved at a time
+	atomic<int64_t> myNext;			// the lowest number not yet reserved; 64 bits so it cannot wrap
+};
+
+atomic<uint64_t> TicketNumberAllocator::next_id{ 1 };
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketNumberAllocator::Constructor
+TicketNumberAllocator::TicketNumberAllocator(const int block_size, const int high_water_mark)
+	: myId(next_id.fetch_add(1, memory_order_relaxed)), myBlockSize(block_size), myNext(static_cast<int64_t>(high_water_mark) + 1)
+{
+	if (block_size <= 0)
+		throw invalid_argument("The block size must be positive. ");
+	if (high_water_mark < 0)
+		throw invalid_argument("The high-water mark cannot be negative. ");
+}
+
+// TicketNumberAllocator::Next
+int TicketNumberAllocator::Next()
+{
+	if (myBlockSize == 1)
+		return static_cast<int>(Reserve(1).next);
+
+	static thread_local Block blocks[blocks_per_thread];	// this thread's reserved numbers
+	static thread_local size_t oldest = 0;					// the block to give up next
+
+	// find this allocator's block, or take over the oldest
+	auto block = find_if(begin(blocks), end(blocks), [this](const Block& candidate) { return candidate.owner == myId; });
+	if (block == end(blocks))
+	{
+		block = &blocks[oldest];
+		oldest = (oldest + 1) % blocks_per_thread;
+		*block = Reserve(myBlockSize);
+	}
+	else if (block->next == block->end)
+	{
+		*block = Reserve(myBlockSize);
+	}
+	return static_cast<int>(block->next++);
+}
+
+// TicketNumberAllocator::Observe
+void TicketNumberAllocator::Observe(const int ticket_number)
+{
+	const auto needed = static_cast<int64_t>(ticket_number) + 1; // the counter must be at least this
+	auto current = myNext.load(memory_order_relaxed);
+	while (current < needed && !myNext.compare_exchange_weak(current, needed, memory_order_relaxed))
+	{
+		// a failed exchange reloads current; another thread may already have raised it far enough
+	}
+}
+
+// TicketNumberAllocator::Recover (store)
+void TicketNumberAllocator::Recover(const WorkTicketStore& store)
+{
+	const auto& numbers = store.TicketNumbers();
+	if (!numbers.empty())
+		Observe(*max_element(numbers.begin(), numbers.end()));
+}
+
+// TicketNumberAllocator::Recover (segment)
+void TicketNumberAllocator::Recover(const TicketSegmentReader& segment)
+{
+	int highest = 0; // the highest ticket number in the segment
+	for (size_t row = 0; row < segment.Size(); row++)
+		highest = max(highest, segment[row].GetTicketNumber());
+	Observe(highest);
+}
+
+// TicketNumberAllocator::Reserve
+TicketNumberAllocator::Block TicketNumberAllocator::Reserve(const int count)
+{
+	const auto first = myNext.fetch_add(count, memory_order_relaxed); // the first number reserved
+	if (first > INT_MAX)
+		throw overflow_error("There are no ticket numbers left. ");
+
+	Block block;
+	block.owner = myId;
+	block.next = first;
+	block.end = min<int64_t>(first + count, static_cast<int64_t>(INT_MAX) + 1);
+	return block;
+}
+
+#endif
@@ -0,0 +1,284 @@
+/** TicketReader.h - Streaming Work Ticket Reader
+ *
+ *	The TicketReader class loads work tickets from any istream or memory buffer
+ *	without prompting. Each line holds one record:
+ *
+ *		ticket number <tab> client ID <tab> date <tab> description [<tab> open]
+ *
+ *	The date may be dd/mm/yyyy or yyyy-mm-dd (see DateParser). The optional
+ *	open field is 1/0, true/false or open/closed and defaults to open. Blank
+ *	lines are skipped. A record that breaks the WorkTicket::SetWorkTicket rules
+ *	is skipped and recorded with its line number; nothing is thrown.
+ *
+ *	A single line buffer and record are reused for every line, and the fields
+ *	are passed to the ticket as views of that line, so reading a record does
+ *	not allocate beyond what the ticket's own description needs.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+ *	@see		DateParser.h
+*/
+
+#pragma once
+#ifndef _TICKET_READER_H
+
+#define _TICKET_READER_H
+
+#include <charconv>		// for from_chars
+#include <istream>		// for istream
+#include <string>		// for string and getline
+#include <string_view>	// for string_view
+#include <vector>		// for vector
+#include "WorkTicket.h"
+#include "ExtendedWorkTicket.h"
+#include "DateParser.h"
+
+using namespace std;
+
+class TicketReader
+{
+public:
+
+	/** Record
+	 *	The fields of one parsed record. The strings view the line they came
+	 *	from and are only valid until the next line is read.
+	 */
+	struct Record
+	{
+		int ticketNumber;			// positive ticket number
+		string_view clientId;		// non-empty client ID
+		PackedDate date;			// date in 2000-2099
+		string_view description;	// non-empty description
+		bool isOpen;				// open flag (true if not given)
+	};
+
+	/** Error
+	 *	A record that was skipped.
+	 */
+	struct Error
+	{
+		size_t line;		// the line number, starting at 1
+		string message;		// why it was skipped
+	};
+
+	/***************************************************************************
+	*	CONSTRUCTORS
+	***************************************************************************/
+
+	/** Stream Constructor
+	 *	Reads records from a stream, one line at a time.
+	 *	@param in (istream by ref) - the stream to read from
+	 *	@param delimiter (char) - the field separator; defaults to tab
+	 */
+	explicit TicketReader(istream& in, const char delimiter = '\t') : myStream(&in), myDelimiter(delimiter) {}
+
+	/** Buffer Constructor
+	 *	Reads records from memory without copying it. The buffer must outlive the reader.
+	 *	@param buffer (string_view) - the records
+	 *	@param delimiter (char) - the field separator; defaults to tab
+	 */
+	explicit TicketReader(const string_view buffer, const char delimiter = '\t') : myBuffer(buffer), myDelimiter(delimiter) {}
+
+	/***************************************************************************
+	*	READING
+	***************************************************************************/
+
+	/** Read()
+	 *	Reads the next valid record into a ticket, skipping invalid ones.
+	 *	@param ticket (WorkTicket or ExtendedWorkTicket by ref) - stores the record
+	 *	@return (bool) - true if a record was read, false at the end of the input
+	 */
+	bool Read(WorkTicket& ticket);
+	bool Read(ExtendedWorkTicket& ticket);
+
+	/** Read()
+	 *	Reads the next valid record without storing it in a ticket.
+	 *	@param record (Record by ref) - stores the fields; valid until the next read
+	 *	@return (bool) - true if a record was read, false at the end of the input
+	 */
+	bool Read(Record& record);
+
+	/** ParseRecord()
+	 *	Splits one line into fields and validates them with the same rules as
+	 *	WorkTicket::SetWorkTicket, plus a positive ticket number.
+	 *	@param line (string_view) - the record, without the line ending
+	 *	@param delimiter (char) - the field separator
+	 *	@param record (Record by ref) - stores the fields
+	 *	@return (const char*) - nullptr if valid, otherwise why it is not
+	 */
+	static const char* ParseRecord(string_view line, char delimiter, Record& record);
+
+	/** ValidateFields()
+	 *	Validates a record that is already split into fields, e.g. by a CSV
+	 *	parser that handles quoting. The rules are the same as ParseRecord's.
+	 *	@param fields (string_view*) - number, client ID, date, description and optionally the open flag
+	 *	@param field_count (size_t) - the number of fields
+	 *	@param record (Record by ref) - stores the fields
+	 *	@return (const char*) - nullptr if valid, otherwise why it is not
+	 */
+	static const char* ValidateFields(const string_view* fields, size_t field_count, Record& record);
+
+	/***************************************************************************
+	*	ACCESSORS
+	***************************************************************************/
+
+	size_t GetLineNumber() const { return myLineNumber; }		// lines read so far
+	size_t GetRecordCount() const { return myRecordCount; }		// valid records read so far
+	const vector<Error>& GetErrors() const { return myErrors; }	// records skipped so far
+
+private:
+	/** NextLine()
+	 *	Gets the next line from the stream or buffer, without its line ending.
+	 *	@return (bool) - false at the end of the input
+	 */
+	bool NextLine(string_view& line);
+
+	istream* myStream = nullptr;	// the stream being read, or nullptr for a buffer
+	string_view myBuffer;			// the unread part of the buffer
+	char myDelimiter;				// the field separator
+	string myLine;					// reused line buffer for streams
+	size_t myLineNumber = 0;		// lines read so far
+	size_t myRecordCount = 0;		// valid records read so far
+	vector<Error> myErrors;			// records skipped so far
+};
+
+/***************************************************************************
+ *	READING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketReader::Read (Record)
+bool TicketReader::Read(Record& record)
+{
+	string_view line;	// the current line
+
+	while (NextLine(line))
+	{
+		if (line.find_first_not_of(" \t") == string_view::npos)
+			continue; // skip blank lines
+
+		const auto error = ParseRecord(line, myDelimiter, record);
+		if (error == nullptr)
+		{
+			myRecordCount++;
+			return true;
+		}
+		myErrors.push_back({ myLineNumber, error });
+	}
+	return false;
+}
+
+// TicketReader::Read (WorkTicket)
+bool TicketReader::Read(WorkTicket& ticket)
+{
+	Record record{};	// the fields of the next record
+
+	if (!Read(record))
+		return false;
+
+	const auto date = record.date.ToMyDate();
+	return ticket.SetWorkTicket(record.ticketNumber, record.clientId, date.GetDay(), date.GetMonth(), date.GetYear(), record.description);
+}
+
+// TicketReader::Read (ExtendedWorkTicket)
+bool TicketReader::Read(ExtendedWorkTicket& ticket)
+{
+	Record record{};	// the fields of the next record
+
+	if (!Read(record))
+		return false;
+
+	const auto date = record.date.ToMyDate();
+	return ticket.SetWorkTicket(record.ticketNumber, record.clientId, date.GetDay(), date.GetMonth(), date.GetYear(), record.description, record.isOpen);
+}
+
+// TicketReader::ParseRecord
+const char* TicketReader::ParseRecord(const string_view line, const char delimiter, Record& record)
+{
+	string_view fields[5];	// number, client, date, description, open
+	size_t fieldCount = 0;	// the number of fields found
+	size_t start = 0;		// the start of the current field
+
+	// split the line
+	while (fieldCount < 5)
+	{
+		const auto end = line.find(delimiter, start);
+		fields[fieldCount++] = line.substr(start, end == string_view::npos ? string_view::npos : end - start);
+		if (end == string_view::npos)
+			break;
+		start = end + 1;
+		if (fieldCount == 5)
+			return "too many fields";
+	}
+	return ValidateFields(fields, fieldCount, record);
+}
+
+// TicketReader::ValidateFields
+const char* TicketReader::ValidateFields(const string_view* fields, const size_t field_count, Record& record)
+{
+	if (field_count < 4)
+		return "expected ticket number, client ID, date and description";
+	if (field_count > 5)
+		return "too many fields";
+
+	// ticket number
+	const auto number = fields[0];
+	const auto result = from_chars(number.data(), number.data() + number.size(), record.ticketNumber);
+	if (result.ec != errc() || result.ptr != number.data() + number.size())
+		return "ticket number is not a whole number";
+	if (record.ticketNumber <= 0)
+		return "ticket number must be greater than zero";
+
+	// client ID and description
+	record.clientId = fields[1];
+	record.description = fields[3];
+	if (record.clientId.empty())
+		return "client ID is empty";
+	if (record.description.empty())
+		return "description is empty";
+
+	// date
+	const auto dateStatus = DateParser::Parse(fields[2], record.date);
+	if (dateStatus != DateParser::Status::Ok)
+		return DateParser::Describe(dateStatus);
+	if (record.date.GetYear() < 2000 || record.date.GetYear() > 2099)
+		return "year must be between 2000 and 2099";
+
+	// open flag
+	record.isOpen = true;
+	if (field_count == 5)
+	{
+		const auto open = fields[4];
+		if (open == "0" || open == "false" || open == "closed")
+			record.isOpen = false;
+		else if (!(open == "1" || open == "true" || open == "open"))
+			return "open flag must be 1/0, true/false or open/closed";
+	}
+	return nullptr;
+}
+
+// TicketReader::NextLine
+bool TicketReader::NextLine(string_view& line)
+{
+	if (myStream != nullptr)
+	{
+		if (!getline(*myStream, myLine))
+			return false;
+		line = myLine;
+	}
+	else
+	{
+		if (myBuffer.empty())
+			return false;
+		const auto end = myBuffer.find('\n');
+		line = myBuffer.substr(0, end);
+		myBuffer.remove_prefix(end == string_view::npos ? myBuffer.size() : end + 1);
+	}
+
+	// accept Windows line endings
+	if (!line.empty() && line.back() == '\r')
+		line.remove_suffix(1);
+	myLineNumber++;
+	return true;
+}
+
+#endif
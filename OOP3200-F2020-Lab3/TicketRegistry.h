@@ -0,0 +1,457 @@
+/** TicketRegistry.h - Concurrent Work Ticket Registry
+ *
+ *	The TicketRegistry class holds work tickets that many threads create,
+ *	look up, update and close at the same time. Tickets are spread over a
+ *	power-of-two number of shards by the low bits of their ticket numbers,
+ *	so consecutive tickets land in different shards. Each shard has its own
+ *	open-addressing hash table, its own description text and its own writer
+ *	mutex, so writers only wait for other writers to the same shard.
+ *
+ *	Lookups take no lock and write no shared memory. Each shard has a
+ *	sequence number that a writer makes odd before it changes the shard and
+ *	even again afterwards (a seqlock); a reader copies the fields of a ticket
+ *	and tries again if the sequence number changed while it did. Closing a
+ *	ticket changes a single field, so it does not touch the sequence number
+ *	and never makes a reader try again.
+ *
+ *	Like the description heap of a WorkTicketStore, text that is replaced is
+ *	left where it is, and so are the tables a shard outgrows, since a reader
+ *	may still be looking at them. Both are freed with the registry, so the
+ *	string_views handed out stay valid until then.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicketStore.h
+ *	@see		ClientIdTable.h
+*/
+
+#pragma once
+#ifndef _TICKET_REGISTRY_H
+
+#define _TICKET_REGISTRY_H
+
+#include <atomic>			// for the slots and sequence numbers
+#include <cstddef>			// for size_t
+#include <cstdint>			// for fixed width integers
+#include <cstring>			// for memcpy
+#include <memory>			// for unique_ptr
+#include <mutex>			// for mutex
+#include <string_view>		// for string_view
+#include <thread>			// for yield
+#include <vector>			// for the text chunks and tables
+#include "WorkTicket.h"
+#include "ExtendedWorkTicket.h"
+#include "PackedDate.h"
+#include "ClientIdTable.h"
+
+using namespace std;
+
+class TicketRegistry
+{
+public:
+	static constexpr size_t default_shards = 64;	// enough for 32 threads to rarely meet
+
+	/** TicketView
+	 *	A copy of the fields of one ticket, taken without locking. The
+	 *	description views text owned by the registry.
+	 */
+	struct TicketView
+	{
+		int32_t ticketNumber = 0;	// the ticket number
+		uint32_t clientHandle = 0;	// a ClientIdTable handle
+		PackedDate date;			// the ticket date
+		bool isOpen = false;		// true until the ticket is closed
+		string_view description;	// valid for the life of the registry
+
+		string_view ClientId() const { return ClientIdTable::Shared().View(clientHandle); }
+	};
+
+	/** Constructor
+	 *	Creates an empty registry.
+	 *	@param shard_count (size_t) - rounded up to a power of two
+	 */
+	explicit TicketRegistry(size_t shard_count = default_shards);
+
+	TicketRegistry(const TicketRegistry&) = delete;
+	TicketRegistry& operator=(const TicketRegistry&) = delete;
+
+	/***************************************************************************
+	*	WRITERS
+	*	Each locks only the shard of the ticket it changes.
+	***************************************************************************/
+
+	/** Insert()
+	 *	Adds a ticket, if it is valid by WorkTicket::Validate(), so every
+	 *	ticket in the registry can be copied out into an ExtendedWorkTicket.
+	 *	WorkTickets are added as open.
+	 *	@return (bool) - false if the ticket is invalid or its number is
+	 *	                 already in the registry; nothing is added
+	 */
+	bool Insert(const WorkTicket& ticket) { return Insert(ticket.GetTicketNumber(), ticket.GetClientIdView(), ticket.GetPackedDate(), ticket.GetDescriptionView(), true); }
+	bool Insert(const ExtendedWorkTicket& ticket) { return Insert(ticket.GetTicketNumber(), ticket.GetClientIdView(), ticket.GetPackedDate(), ticket.GetDescriptionView(), ticket.IsOpen()); }
+	bool Insert(int ticket_number, string_view client_id, PackedDate date, string_view description, bool is_open);
+
+	/** SetWorkTicket()
+	 *	Changes the client ID, date and description of a ticket, if all the
+	 *	parameters are valid. The rules are the same as WorkTicketStore's.
+	 *	@return (bool) - false if the ticket is not found or a parameter is invalid
+	 */
+	bool SetWorkTicket(int ticket_number, string_view client_id, int day, int month, int year, string_view description);
+
+	/** Close()
+	 *	Closes a ticket.
+	 *	@return (bool) - false if there is no such ticket
+	 */
+	bool Close(int ticket_number);
+
+	/***************************************************************************
+	*	READERS
+	*	Each may run at the same time as any writer and never blocks one.
+	***************************************************************************/
+
+	/** Find()
+	 *	Copies the fields of a ticket without locking.
+	 *	@param view (TicketView by ref) - set to the ticket if it is found
+	 *	@return (bool) - false if there is no such ticket
+	 */
+	bool Find(int ticket_number, TicketView& view) const;
+
+	/** Find() (ExtendedWorkTicket)
+	 *	Copies a ticket out into a standalone object.
+	 *	@return (bool) - false if there is no such ticket, or it could not
+	 *	                 be set on the object, which is then left unchanged
+	 */
+	bool Find(int ticket_number, ExtendedWorkTicket& ticket) const;
+
+	bool Contains(const int ticket_number) const { TicketView view; return Find(ticket_number, view); }
+
+	/** Size()
+	 *	Counts the tickets; only exact while no thread is inserting.
+	 */
+	size_t Size() const;
+
+	size_t ShardCount() const { return myShardMask + 1; }
+
+private:
+	static constexpr uint32_t initial_table_bits = 4;	// 16 slots per shard to start with
+	static constexpr size_t chunk_size = 64 * 1024;		// bytes per description chunk
+
+	/** Slot
+	 *	One ticket in a shard's table; a ticket number of 0 marks an empty
+	 *	slot. Every field is atomic because readers copy them while a writer
+	 *	may be changing them.
+	 */
+	struct Slot
+	{
+		atomic<int32_t> ticketNumber;			// 0 if the slot is empty
+		atomic<uint32_t> clientHandle;			// a ClientIdTable handle
+		atomic<PackedDate> date;				// the ticket date
+		atomic<uint8_t> isOpen;					// 1 if open, 0 if closed
+		atomic<uint32_t> descriptionLength;		// the length of the description
+		atomic<const char*> description;		// the description text, in the shard's chunks
+	};
+
+	/** Table
+	 *	A linear-probing hash table of 2^bits slots, kept at most half full.
+	 */
+	struct Table
+	{
+		explicit Table(const uint32_t table_bits) : bits(table_bits), slots(new Slot[size_t(1) << table_bits]()) {}
+		size_t Capacity() const { return size_t(1) << bits; }
+
+		uint32_t bits;				// log2 of the number of slots
+		unique_ptr<Slot[]> slots;	// the slots
+	};
+
+	/** Shard
+	 *	The tickets whose numbers share their low bits. On its own cache line
+	 *	so that threads working in different shards do not slow each other.
+	 */
+	struct alignas(64) Shard
+	{
+		atomic<uint32_t> sequence{ 0 };				// odd while a writer is changing the shard
+		atomic<const Table*> table{ nullptr };		// the current table
+		atomic<size_t> size{ 0 };					// the tickets in the shard
+		mutex writer;								// held by the thread changing the shard
+		vector<unique_ptr<Table>> tables;			// every table the shard has had; the last is current
+		vector<unique_ptr<char[]>> chunks;			// description text
+		char* chunk = nullptr;						// the chunk being filled
+		size_t chunkUsed = chunk_size;				// bytes used in that chunk
+	};
+
+	Shard& ShardOf(const int ticket_number) const { return myShards[static_cast<uint32_t>(ticket_number) & myShardMask]; }
+
+	/** Probe()
+	 *	Finds the slot of a ticket, or the empty slot where it would go.
+	 *	@return (Slot*) - the slot, or nullptr if the table is full and the ticket is not in it
+	 */
+	static Slot* Probe(const Table& table, int ticket_number);
+
+	/** Writer Helpers
+	 *	Called with the shard's writer mutex held. Nothing that can throw is
+	 *	done between BeginWrite() and EndWrite(), or readers would wait forever.
+	 */
+	static void BeginWrite(Shard& shard);
+	static void EndWrite(Shard& shard);
+	static string_view StoreText(Shard& shard, string_view text);
+	static const Table* Grown(Shard& shard);	// builds a table twice the size, not yet published
+
+	unique_ptr<Shard[]> myShards;	// the shards
+	uint32_t myShardMask;			// shard count - 1
+};
+
+/***************************************************************************
+ *	WRITER DEFINITIONS
+ ***************************************************************************/
+
+ // TicketRegistry::Constructor
+TicketRegistry::TicketRegistry(const size_t shard_count)
+{
+	size_t count = 1; // the shard count, rounded up
+	while (count < shard_count)
+		count *= 2;
+
+	myShards.reset(new Shard[count]);
+	myShardMask = static_cast<uint32_t>(count - 1);
+	for (size_t i = 0; i < count; i++)
+	{
+		myShards[i].tables.emplace_back(new Table(initial_table_bits));
+		myShards[i].table.store(myShards[i].tables.back().get(), memory_order_release);
+	}
+}
+
+// TicketRegistry::Insert
+bool TicketRegistry::Insert(const int ticket_number, const string_view client_id, const PackedDate date, const string_view description, const bool is_open)
+{
+	// the same rules as WorkTicket::SetWorkTicket, which Find() copies tickets out with
+	if (!WorkTicket::Validate(ticket_number, client_id, date, description).Ok())
+		return false;
+
+	auto& shard = ShardOf(ticket_number);
+	lock_guard<mutex> lock(shard.writer);
+
+	const Table* table = shard.table.load(memory_order_relaxed); // the table to insert into
+	if (Probe(*table, ticket_number)->ticketNumber.load(memory_order_relaxed) != 0)
+		return false;
+
+	// everything that allocates happens before readers are told to wait
+	const auto handle = ClientIdTable::Shared().Intern(client_id);
+	const auto text = StoreText(shard, description);
+	const auto size = shard.size.load(memory_order_relaxed);
+	const auto grown = (size + 1) * 2 > table->Capacity() ? Grown(shard) : nullptr;
+
+	BeginWrite(shard);
+	if (grown != nullptr)
+	{
+		shard.table.store(grown, memory_order_release);
+		table = grown;
+	}
+	auto& slot = *Probe(*table, ticket_number);
+	slot.clientHandle.store(handle, memory_order_relaxed);
+	slot.date.store(date, memory_order_relaxed);
+	slot.isOpen.store(is_open ? 1 : 0, memory_order_relaxed);
+	slot.descriptionLength.store(static_cast<uint32_t>(text.size()), memory_order_relaxed);
+	slot.description.store(text.data(), memory_order_relaxed);
+	slot.ticketNumber.store(ticket_number, memory_order_relaxed);
+	shard.size.store(size + 1, memory_order_relaxed);
+	EndWrite(shard);
+	return true;
+}
+
+// TicketRegistry::SetWorkTicket
+bool TicketRegistry::SetWorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
+{
+	// the same rules as WorkTicket::SetWorkTicket
+	if (!WorkTicket::Validate(ticket_number, client_id, day, month, year, description).Ok())
+		return false;
+
+	auto& shard = ShardOf(ticket_number);
+	lock_guard<mutex> lock(shard.writer);
+
+	auto& slot = *Probe(*shard.table.load(memory_order_relaxed), ticket_number);
+	if (slot.ticketNumber.load(memory_order_relaxed) != ticket_number)
+		return false;
+
+	const PackedDate date(MyDate::DayNumber(day, month, year)); // the new date
+	const auto handle = ClientIdTable::Shared().Intern(client_id);
+	const auto text = StoreText(shard, description);
+
+	BeginWrite(shard);
+	slot.clientHandle.store(handle, memory_order_relaxed);
+	slot.date.store(date, memory_order_relaxed);
+	slot.descriptionLength.store(static_cast<uint32_t>(text.size()), memory_order_relaxed);
+	slot.description.store(text.data(), memory_order_relaxed);
+	EndWrite(shard);
+	return true;
+}
+
+// TicketRegistry::Close
+bool TicketRegistry::Close(const int ticket_number)
+{
+	if (ticket_number <= 0)
+		return false;
+
+	auto& shard = ShardOf(ticket_number);
+	lock_guard<mutex> lock(shard.writer); // keeps the table from being replaced under us
+
+	auto& slot = *Probe(*shard.table.load(memory_order_relaxed), ticket_number);
+	if (slot.ticketNumber.load(memory_order_relaxed) != ticket_number)
+		return false;
+
+	// one field, so a reader sees the ticket either open or closed, never torn
+	slot.isOpen.store(0, memory_order_relaxed);
+	return true;
+}
+
+/***************************************************************************
+ *	READER DEFINITIONS
+ ***************************************************************************/
+
+ // TicketRegistry::Find
+bool TicketRegistry::Find(const int ticket_number, TicketView& view) const
+{
+	if (ticket_number <= 0)
+		return false;
+
+	const auto& shard = ShardOf(ticket_number);
+	while (true)
+	{
+		const auto before = shard.sequence.load(memory_order_acquire); // the sequence number before copying
+		if (before & 1)
+		{
+			this_thread::yield(); // a writer is in the shard
+			continue;
+		}
+
+		// copy the fields; they may be torn until the sequence number is checked
+		const auto& slot = *Probe(*shard.table.load(memory_order_acquire), ticket_number);
+		const auto found = slot.ticketNumber.load(memory_order_relaxed) == ticket_number;
+		TicketView copy; // the fields as read
+		if (found)
+		{
+			copy.ticketNumber = ticket_number;
+			copy.clientHandle = slot.clientHandle.load(memory_order_relaxed);
+			copy.date = slot.date.load(memory_order_relaxed);
+			copy.isOpen = slot.isOpen.load(memory_order_relaxed) != 0;
+			copy.description = string_view(slot.description.load(memory_order_relaxed), slot.descriptionLength.load(memory_order_relaxed));
+		}
+
+		atomic_thread_fence(memory_order_acquire);
+		if (shard.sequence.load(memory_order_relaxed) == before)
+		{
+			if (found)
+				view = copy;
+			return found;
+		}
+	}
+}
+
+// TicketRegistry::Find (ExtendedWorkTicket)
+bool TicketRegistry::Find(const int ticket_number, ExtendedWorkTicket& ticket) const
+{
+	TicketView view;
+	if (!Find(ticket_number, view))
+		return false;
+
+	const auto date = view.date.ToMyDate();
+	return ticket.SetWorkTicket(view.ticketNumber, view.ClientId(), date.GetDay(), date.GetMonth(), date.GetYear(), view.description, view.isOpen);
+}
+
+// TicketRegistry::Size
+size_t TicketRegistry::Size() const
+{
+	size_t size = 0; // the tickets in every shard
+	for (size_t i = 0; i <= myShardMask; i++)
+		size += myShards[i].size.load(memory_order_relaxed);
+	return size;
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketRegistry::Probe
+TicketRegistry::Slot* TicketRegistry::Probe(const Table& table, const int ticket_number)
+{
+	// Fibonacci hashing; the low bits already chose the shard
+	const auto mask = table.Capacity() - 1;
+	auto index = static_cast<size_t>((static_cast<uint32_t>(ticket_number) * 2654435769u) >> (32 - table.bits));
+	for (size_t probes = 0; probes <= mask; probes++, index = (index + 1) & mask)
+	{
+		const auto found = table.slots[index].ticketNumber.load(memory_order_relaxed);
+		if (found == ticket_number || found == 0)
+			return &table.slots[index];
+	}
+
+	// only a reader racing a writer can see a full table; its copy is thrown away
+	return &table.slots[0];
+}
+
+// TicketRegistry::BeginWrite
+void TicketRegistry::BeginWrite(Shard& shard)
+{
+	shard.sequence.store(shard.sequence.load(memory_order_relaxed) + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release); // the odd number is seen before any change
+}
+
+// TicketRegistry::EndWrite
+void TicketRegistry::EndWrite(Shard& shard)
+{
+	shard.sequence.store(shard.sequence.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+// TicketRegistry::StoreText
+string_view TicketRegistry::StoreText(Shard& shard, const string_view text)
+{
+	if (text.empty())
+		return string_view();
+
+	// long descriptions get a chunk of their own
+	if (text.size() > chunk_size / 4)
+	{
+		shard.chunks.emplace_back(new char[text.size()]);
+		memcpy(shard.chunks.back().get(), text.data(), text.size());
+		return string_view(shard.chunks.back().get(), text.size());
+	}
+
+	// start a new chunk when this one is full; its tail is left unused
+	if (shard.chunkUsed + text.size() > chunk_size)
+	{
+		shard.chunks.emplace_back(new char[chunk_size]);
+		shard.chunk = shard.chunks.back().get();
+		shard.chunkUsed = 0;
+	}
+
+	const auto destination = shard.chunk + shard.chunkUsed;
+	memcpy(destination, text.data(), text.size());
+	shard.chunkUsed += text.size();
+	return string_view(destination, text.size());
+}
+
+// TicketRegistry::Grown
+const TicketRegistry::Table* TicketRegistry::Grown(Shard& shard)
+{
+	const auto& old = *shard.tables.back();
+	unique_ptr<Table> table(new Table(old.bits + 1)); // the bigger table
+
+	// no writer can change the old table while we hold the mutex, and readers only read it
+	for (size_t i = 0; i < old.Capacity(); i++)
+	{
+		const auto& from = old.slots[i];
+		const auto ticketNumber = from.ticketNumber.load(memory_order_relaxed);
+		if (ticketNumber == 0)
+			continue;
+
+		auto& to = *Probe(*table, ticketNumber);
+		to.clientHandle.store(from.clientHandle.load(memory_order_relaxed), memory_order_relaxed);
+		to.date.store(from.date.load(memory_order_relaxed), memory_order_relaxed);
+		to.isOpen.store(from.isOpen.load(memory_order_relaxed), memory_order_relaxed);
+		to.descriptionLength.store(from.descriptionLength.load(memory_order_relaxed), memory_order_relaxed);
+		to.description.store(from.description.load(memory_order_relaxed), memory_order_relaxed);
+		to.ticketNumber.store(ticketNumber, memory_order_relaxed);
+	}
+
+	shard.tables.push_back(move(table));
+	return shard.tables.back().get();
+}
+
+#endif
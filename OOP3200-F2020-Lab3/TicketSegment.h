@@ -0,0 +1,592 @@
+/** TicketSegment.h - Binary Ticket Segment Files
+ *
+ *	A segment file stores a batch of tickets in a versioned, little-endian
+ *	binary format that can be used straight from a memory mapping:
+ *
+ *		header			128 bytes (see TicketSegmentHeader)
+ *		ticket numbers	int32[ticket count]
+ *		day numbers		int32[ticket count]		(see PackedDate)
+ *		open flags		uint8[ticket count]		(1 open, 0 closed)
+ *		client indexes	uint32[ticket count]	(into the client table)
+ *		client offsets	uint64[client count + 1]	(into the client heap)
+ *		client heap		the distinct client IDs, back to back
+ *		description offsets	uint64[ticket count + 1]	(into the description heap)
+ *		description heap	the descriptions, back to back
+ *
+ *	Every section starts on an 8 byte boundary and its offset is recorded in
+ *	the header. TicketSegmentWriter builds and writes a segment;
+ *	TicketSegmentReader maps one and exposes each ticket as a TicketView that
+ *	reads the mapped bytes on demand, so opening a segment does no work
+ *	proportional to its size.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicketStore.h
+*/
+
+#pragma once
+#ifndef _TICKET_SEGMENT_H
+
+#define _TICKET_SEGMENT_H
+
+#include <cstdint>			// for fixed width integers
+#include <cstring>			// for memcmp
+#include <fstream>			// for ofstream
+#include <stdexcept>		// for runtime_error
+#include <string>			// for string
+#include <string_view>		// for string_view
+#include <unordered_map>	// for the writer's client table
+#include <vector>			// for the writer's columns
+#include "ClientIdTable.h"
+#include "ExtendedWorkTicket.h"
+#include "PackedDate.h"
+#include "WorkTicketStore.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>		// for open
+#include <sys/mman.h>	// for mmap
+#include <sys/stat.h>	// for fstat
+#include <unistd.h>		// for close
+#endif
+
+using namespace std;
+
+/** TicketSegmentHeader
+ *	The layout of the first 128 bytes of a segment. Every field is little-endian.
+ */
+struct TicketSegmentHeader
+{
+	static constexpr char magic[8] = { 'W', 'T', 'K', 'T', 'S', 'E', 'G', '\0' };
+	static constexpr uint32_t version = 1;		// bumped when the layout changes
+	static constexpr size_t size = 128;			// bytes, including the reserved tail
+
+	// byte offsets of the fields
+	static constexpr size_t magic_at = 0;			// char[8]
+	static constexpr size_t version_at = 8;			// uint32
+	static constexpr size_t header_size_at = 12;	// uint32
+	static constexpr size_t ticket_count_at = 16;	// uint64
+	static constexpr size_t client_count_at = 24;	// uint64
+	static constexpr size_t file_size_at = 32;		// uint64
+	static constexpr size_t sections_at = 40;		// uint64[section_count], the section offsets
+	static constexpr size_t log_lsn_at = 104;		// uint64, for a snapshot: the last log record it includes; otherwise 0
+	static constexpr size_t log_offset_at = 112;	// uint64, for a snapshot: where the log record after it starts; otherwise 0
+
+	/** Section
+	 *	The sections in file order.
+	 */
+	enum Section
+	{
+		TicketNumbers,
+		DayNumbers,
+		OpenFlags,
+		ClientIndexes,
+		ClientOffsets,
+		ClientHeap,
+		DescriptionOffsets,
+		DescriptionHeap,
+		section_count
+	};
+};
+
+/***************************************************************************
+ *	LITTLE-ENDIAN ENCODING
+ *	Byte by byte, so the format is the same on any host. Compilers turn
+ *	these into single loads and stores on little-endian machines.
+ ***************************************************************************/
+
+template <typename T>
+T LoadLittle(const unsigned char* bytes)
+{
+	uint64_t value = 0; // the assembled bits
+	for (size_t i = 0; i < sizeof(T); i++)
+		value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+	return static_cast<T>(value);
+}
+
+template <typename T>
+void AppendLittle(string& out, const T value)
+{
+	const auto bits = static_cast<uint64_t>(value); // the bits to store
+	for (size_t i = 0; i < sizeof(T); i++)
+		out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+}
+
+/***************************************************************************
+ *	TicketSegmentWriter
+ ***************************************************************************/
+
+class TicketSegmentWriter
+{
+public:
+
+	/** Add()
+	 *	Adds a ticket to the segment. WorkTickets are added as open.
+	 */
+	void Add(const WorkTicket& ticket) { Add(ticket.GetTicketNumber(), ticket.GetClientHandle(), ticket.GetPackedDate(), ticket.GetDescriptionView(), true); }
+	void Add(const ExtendedWorkTicket& ticket) { Add(ticket.GetTicketNumber(), ticket.GetClientHandle(), ticket.GetPackedDate(), ticket.GetDescriptionView(), ticket.IsOpen()); }
+	void Add(const int ticket_number, const string_view client_id, const PackedDate date, const string_view description, const bool is_open)
+	{
+		Add(ticket_number, ClientIdTable::Shared().Intern(client_id), date, description, is_open);
+	}
+
+	/** Add()
+	 *	Adds every ticket in a store or a store snapshot, in row order.
+	 */
+	void Add(const WorkTicketStore& store);
+	void Add(const WorkTicketStore::Snapshot& snapshot);
+
+	/** Size()
+	 *	Returns the number of tickets added so far.
+	 */
+	size_t Size() const { return myTicketNumbers.size(); }
+
+	/** Write()
+	 *	Writes the segment to a file, replacing it.
+	 *	@param path (string) - the file to write
+	 *	@throws (runtime_error) if the file cannot be written
+	 */
+	void Write(const string& path) const;
+
+	/** Clear()
+	 *	Removes every ticket so the writer can build another segment.
+	 */
+	void Clear();
+
+	/** SetLogPosition()
+	 *	Records, for a snapshot, the TicketLog position it was taken at.
+	 *	@param lsn (uint64_t) - the last log record whose change the segment includes
+	 *	@param offset (uint64_t) - the log's EndOffset() at that record
+	 */
+	void SetLogPosition(const uint64_t lsn, const uint64_t offset) { myLogLsn = lsn; myLogOffset = offset; }
+
+private:
+	/** Add()
+	 *	Adds a ticket whose client ID is already interned.
+	 */
+	void Add(int ticket_number, uint32_t client_handle, PackedDate date, string_view description, bool is_open);
+
+	static constexpr size_t buffer_size = 1 << 16; // bytes encoded before each file write
+
+	/** Pad()
+	 *	Pads the output to the next 8 byte boundary. Sections are laid out
+	 *	from the header, so this relies on the header size being a multiple of 8.
+	 */
+	static void Pad(string& out) { out.append((8 - out.size() % 8) % 8, '\0'); }
+
+	// columns, one entry per ticket
+	vector<int32_t> myTicketNumbers;		// ticket numbers
+	vector<int32_t> myDayNumbers;			// ticket dates
+	vector<uint8_t> myOpenFlags;			// 1 if open, 0 if closed
+	vector<uint32_t> myClientIndexes;		// index into the segment's client table
+	vector<uint64_t> myDescriptionOffsets{ 0 };	// start of each description, plus the end of the last
+
+	string myDescriptionHeap;						// description text
+	vector<uint64_t> myClientOffsets{ 0 };			// start of each client ID, plus the end of the last
+	string myClientHeap;							// distinct client ID text
+	unordered_map<uint32_t, uint32_t> myClients;	// ClientIdTable handle to segment client index
+	uint64_t myLogLsn = 0;							// see SetLogPosition()
+	uint64_t myLogOffset = 0;						// see SetLogPosition()
+};
+
+/***************************************************************************
+ *	TicketSegmentReader
+ ***************************************************************************/
+
+class TicketSegmentReader
+{
+public:
+
+	/** TicketView
+	 *	One ticket in a mapped segment. Reads its fields from the mapping on
+	 *	demand; valid as long as the reader is open.
+	 */
+	class TicketView
+	{
+	public:
+		TicketView(const TicketSegmentReader* reader, const size_t row) : myReader(reader), myRow(row) {}
+
+		int GetTicketNumber() const { return LoadLittle<int32_t>(myReader->Column(TicketSegmentHeader::TicketNumbers) + myRow * 4); }
+		PackedDate GetPackedDate() const { return PackedDate(static_cast<long>(LoadLittle<int32_t>(myReader->Column(TicketSegmentHeader::DayNumbers) + myRow * 4))); }
+		bool IsOpen() const { return myReader->Column(TicketSegmentHeader::OpenFlags)[myRow] != 0; }
+		string_view GetClientId() const;
+		string_view GetDescription() const;
+
+		/** ToExtendedWorkTicket()
+		 *	Copies the ticket out into a standalone object.
+		 *	@return (Expected<ExtendedWorkTicket>) - the ticket, or the rule its row breaks
+		 *	@throws (runtime_error) if the row's client or description is out of range
+		 */
+		Expected<ExtendedWorkTicket> ToExtendedWorkTicket() const;
+
+	private:
+		const TicketSegmentReader* myReader;	// the segment
+		size_t myRow;							// the ticket's position in the segment
+	};
+
+	/***************************************************************************
+	*	CONSTRUCTORS
+	***************************************************************************/
+
+	/** Constructor
+	 *	Maps a segment file and checks its header. Only the header is read.
+	 *	@param path (string) - the segment file
+	 *	@throws (runtime_error) if the file cannot be mapped or is not a valid segment
+	 */
+	explicit TicketSegmentReader(const string& path);
+
+	TicketSegmentReader(const TicketSegmentReader&) = delete;
+	TicketSegmentReader& operator=(const TicketSegmentReader&) = delete;
+
+	~TicketSegmentReader();
+
+	/***************************************************************************
+	*	ACCESSORS
+	***************************************************************************/
+
+	size_t Size() const { return myTicketCount; }		// the number of tickets
+	size_t ClientCount() const { return myClientCount; }	// the number of distinct client IDs
+	uint64_t LogLsn() const { return LoadLittle<uint64_t>(myData + TicketSegmentHeader::log_lsn_at); }			// see TicketSegmentWriter::SetLogPosition()
+	uint64_t LogOffset() const { return LoadLittle<uint64_t>(myData + TicketSegmentHeader::log_offset_at); }	// see TicketSegmentWriter::SetLogPosition()
+	TicketView operator[](const size_t row) const { return TicketView(this, row); }
+
+	/** Load()
+	 *	Inserts every ticket into a store, skipping ticket numbers it already
+	 *	has. Each distinct client ID is interned once. Loading into an empty
+	 *	store defers its date and text indexes (see WorkTicketStore::DeferIndexes()).
+	 *	Rows the store rejects (see WorkTicket::Validate()) are skipped too.
+	 *	@return (size_t) - the number of tickets inserted
+	 *	@throws (runtime_error) if a row's client or description is out of range
+	 *	@throws (out_of_range) if a row's day number is out of range
+	 */
+	size_t Load(WorkTicketStore& store) const;
+
+private:
+	/** Column()
+	 *	Returns the first byte of a section.
+	 */
+	const unsigned char* Column(const int section) const { return myData + mySections[section]; }
+
+	/** HeapString()
+	 *	Returns entry i of an offsets section as a view of its heap section.
+	 *	@throws (runtime_error) if the offsets point outside the heap
+	 */
+	string_view HeapString(int offsets, int heap, size_t heap_end, size_t i) const;
+
+	/** Fail()
+	 *	Unmaps the file and throws.
+	 */
+	[[noreturn]] void Fail(const string& path, const char* reason);
+
+	void Unmap();
+
+	const unsigned char* myData = nullptr;					// the mapped file
+	size_t mySize = 0;										// its size in bytes
+	size_t myTicketCount = 0;								// tickets in the segment
+	size_t myClientCount = 0;								// distinct client IDs
+	uint64_t mySections[TicketSegmentHeader::section_count] = {};	// section offsets
+#ifdef _WIN32
+	HANDLE myFile = INVALID_HANDLE_VALUE;	// the open file
+	HANDLE myMapping = nullptr;				// the file mapping
+#endif
+};
+
+/***************************************************************************
+ *	WRITER DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSegmentWriter::Add (store)
+void TicketSegmentWriter::Add(const WorkTicketStore& store)
+{
+	for (WorkTicketStore::Row row = 0; row < store.Size(); row++)
+		Add(store.GetTicketNumber(row), store.GetClientHandle(row), store.GetDate(row), store.GetDescription(row), store.IsOpen(row));
+}
+
+// TicketSegmentWriter::Add (snapshot)
+void TicketSegmentWriter::Add(const WorkTicketStore::Snapshot& snapshot)
+{
+	for (size_t row = 0; row < snapshot.Size(); row++)
+		Add(snapshot.ticketNumbers[row], snapshot.clientHandles[row], snapshot.dates[row], snapshot.GetDescription(row), snapshot.openFlags[row] != 0);
+}
+
+// TicketSegmentWriter::Add (interned)
+void TicketSegmentWriter::Add(const int ticket_number, const uint32_t client_handle, const PackedDate date, const string_view description, const bool is_open)
+{
+	// store each distinct client ID once per segment
+	const auto client = myClients.emplace(client_handle, static_cast<uint32_t>(myClients.size()));
+	if (client.second)
+	{
+		const auto text = ClientIdTable::Shared().View(client_handle);
+		myClientHeap.append(text.data(), text.size());
+		myClientOffsets.push_back(myClientHeap.size());
+	}
+
+	myTicketNumbers.push_back(ticket_number);
+	myDayNumbers.push_back(date.DayNumber());
+	myOpenFlags.push_back(is_open ? 1 : 0);
+	myClientIndexes.push_back(client.first->second);
+	myDescriptionHeap.append(description.data(), description.size());
+	myDescriptionOffsets.push_back(myDescriptionHeap.size());
+}
+
+// TicketSegmentWriter::Write
+void TicketSegmentWriter::Write(const string& path) const
+{
+	const uint64_t count = myTicketNumbers.size();				// tickets in the segment
+	const uint64_t sizes[TicketSegmentHeader::section_count] = {	// section sizes in file order
+		count * 4, count * 4, count, count * 4,
+		myClientOffsets.size() * 8, myClientHeap.size(),
+		myDescriptionOffsets.size() * 8, myDescriptionHeap.size() };
+	uint64_t sections[TicketSegmentHeader::section_count] = {};	// section offsets
+	uint64_t fileSize = TicketSegmentHeader::size;					// the end of the last section
+
+	// lay out the sections, each on an 8 byte boundary
+	for (int section = 0; section < TicketSegmentHeader::section_count; section++)
+	{
+		fileSize = (fileSize + 7) / 8 * 8;
+		sections[section] = fileSize;
+		fileSize += sizes[section];
+	}
+
+	// the header
+	string out; // encoding buffer, flushed to the file as it fills
+	out.append(TicketSegmentHeader::magic, sizeof(TicketSegmentHeader::magic));
+	AppendLittle(out, TicketSegmentHeader::version);
+	AppendLittle(out, static_cast<uint32_t>(TicketSegmentHeader::size));
+	AppendLittle(out, count);
+	AppendLittle(out, static_cast<uint64_t>(myClientOffsets.size() - 1));
+	AppendLittle(out, fileSize);
+	for (const auto section : sections)
+		AppendLittle(out, section);
+	AppendLittle(out, myLogLsn);
+	AppendLittle(out, myLogOffset);
+	out.resize(TicketSegmentHeader::size, '\0');
+
+	ofstream file(path, ios::binary | ios::trunc);
+	const auto flush = [&](const size_t threshold)
+	{
+		if (out.size() >= threshold)
+		{
+			file.write(out.data(), static_cast<streamsize>(out.size()));
+			out.clear();
+		}
+	};
+	const auto column = [&](const auto& values)
+	{
+		for (const auto value : values)
+		{
+			AppendLittle(out, value);
+			flush(buffer_size);
+		}
+		Pad(out);
+	};
+
+	// the sections, in the order laid out above
+	column(myTicketNumbers);
+	column(myDayNumbers);
+	column(myOpenFlags);
+	column(myClientIndexes);
+	column(myClientOffsets);
+	out += myClientHeap;
+	Pad(out);
+	column(myDescriptionOffsets);
+	flush(0);
+	file.write(myDescriptionHeap.data(), static_cast<streamsize>(myDescriptionHeap.size()));
+
+	if (!file.flush())
+		throw runtime_error("Could not write ticket segment " + path + ". ");
+}
+
+// TicketSegmentWriter::Clear
+void TicketSegmentWriter::Clear()
+{
+	myTicketNumbers.clear();
+	myDayNumbers.clear();
+	myOpenFlags.clear();
+	myClientIndexes.clear();
+	myDescriptionOffsets.assign(1, 0);
+	myDescriptionHeap.clear();
+	myClientOffsets.assign(1, 0);
+	myClientHeap.clear();
+	myClients.clear();
+	myLogLsn = myLogOffset = 0;
+}
+
+/***************************************************************************
+ *	READER DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSegmentReader::Constructor
+TicketSegmentReader::TicketSegmentReader(const string& path)
+{
+#ifdef _WIN32
+	myFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER fileSize;
+	if (myFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(myFile, &fileSize))
+		Fail(path, "could not be opened");
+	mySize = static_cast<size_t>(fileSize.QuadPart);
+	if (mySize < TicketSegmentHeader::size)
+		Fail(path, "is too short");
+	myMapping = CreateFileMappingA(myFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (myMapping == nullptr)
+		Fail(path, "could not be mapped");
+	myData = static_cast<const unsigned char*>(MapViewOfFile(myMapping, FILE_MAP_READ, 0, 0, 0));
+	if (myData == nullptr)
+		Fail(path, "could not be mapped");
+#else
+	const int file = open(path.c_str(), O_RDONLY);
+	struct stat status;
+	if (file < 0 || fstat(file, &status) != 0)
+	{
+		if (file >= 0)
+			close(file);
+		Fail(path, "could not be opened");
+	}
+	mySize = static_cast<size_t>(status.st_size);
+	if (mySize < TicketSegmentHeader::size)
+	{
+		close(file);
+		Fail(path, "is too short");
+	}
+	void* mapping = mmap(nullptr, mySize, PROT_READ, MAP_SHARED, file, 0);
+	close(file); // the mapping keeps the file open
+	if (mapping == MAP_FAILED)
+		Fail(path, "could not be mapped");
+	myData = static_cast<const unsigned char*>(mapping);
+#endif
+
+	// check the header; the columns are not touched
+	if (memcmp(myData + TicketSegmentHeader::magic_at, TicketSegmentHeader::magic, sizeof(TicketSegmentHeader::magic)) != 0)
+		Fail(path, "is not a ticket segment");
+	if (LoadLittle<uint32_t>(myData + TicketSegmentHeader::version_at) != TicketSegmentHeader::version)
+		Fail(path, "has an unsupported version");
+	if (LoadLittle<uint64_t>(myData + TicketSegmentHeader::file_size_at) != mySize)
+		Fail(path, "is truncated");
+
+	myTicketCount = static_cast<size_t>(LoadLittle<uint64_t>(myData + TicketSegmentHeader::ticket_count_at));
+	myClientCount = static_cast<size_t>(LoadLittle<uint64_t>(myData + TicketSegmentHeader::client_count_at));
+	for (int section = 0; section < TicketSegmentHeader::section_count; section++)
+		mySections[section] = LoadLittle<uint64_t>(myData + TicketSegmentHeader::sections_at + section * 8);
+
+	// every section must fit between the previous one and the end of the file
+	if (myTicketCount > mySize || myClientCount > mySize)
+		Fail(path, "has a corrupt header");
+	const uint64_t minimum[TicketSegmentHeader::section_count] = {
+		myTicketCount * 4, myTicketCount * 4, myTicketCount, myTicketCount * 4,
+		(myClientCount + 1) * 8, 0, (myTicketCount + 1) * 8, 0 };
+	uint64_t previous = TicketSegmentHeader::size; // the end of the previous section
+	for (int section = 0; section < TicketSegmentHeader::section_count; section++)
+	{
+		if (mySections[section] < previous || mySections[section] % 8 != 0 || mySections[section] > mySize
+			|| minimum[section] > mySize - mySections[section])
+			Fail(path, "has a corrupt header");
+		previous = mySections[section] + minimum[section];
+	}
+}
+
+// TicketSegmentReader::Destructor
+TicketSegmentReader::~TicketSegmentReader()
+{
+	Unmap();
+}
+
+// TicketSegmentReader::Load
+size_t TicketSegmentReader::Load(WorkTicketStore& store) const
+{
+	size_t inserted = 0; // tickets added to the store
+
+	// intern each client ID once, not once per ticket
+	vector<uint32_t> handles(myClientCount); // client index to ClientIdTable handle
+	for (size_t client = 0; client < myClientCount; client++)
+		handles[client] = ClientIdTable::Shared().Intern(HeapString(TicketSegmentHeader::ClientOffsets, TicketSegmentHeader::ClientHeap, mySections[TicketSegmentHeader::DescriptionOffsets], client));
+
+	if (store.Size() == 0)
+		store.DeferIndexes();
+	store.Reserve(store.Size() + myTicketCount, mySize - mySections[TicketSegmentHeader::DescriptionHeap]);
+	const auto clients = Column(TicketSegmentHeader::ClientIndexes); // the client index column
+	for (size_t row = 0; row < myTicketCount; row++)
+	{
+		const auto ticket = (*this)[row];
+		const auto client = LoadLittle<uint32_t>(clients + row * 4);
+		if (client >= myClientCount)
+			throw runtime_error("Ticket segment client index is out of range. ");
+		inserted += store.Insert(ticket.GetTicketNumber(), handles[client], ticket.GetPackedDate(), ticket.GetDescription(), ticket.IsOpen());
+	}
+	return inserted;
+}
+
+// TicketSegmentReader::HeapString
+string_view TicketSegmentReader::HeapString(const int offsets, const int heap, const size_t heap_end, const size_t i) const
+{
+	const auto entry = Column(offsets) + i * 8;				// the entry's offsets
+	const auto begin = LoadLittle<uint64_t>(entry);		// start, relative to the heap
+	const auto end = LoadLittle<uint64_t>(entry + 8);	// end, relative to the heap
+
+	if (begin > end || end > heap_end - mySections[heap])
+		throw runtime_error("Ticket segment string is out of range. ");
+	return string_view(reinterpret_cast<const char*>(Column(heap)) + begin, static_cast<size_t>(end - begin));
+}
+
+// TicketSegmentReader::Fail
+void TicketSegmentReader::Fail(const string& path, const char* reason)
+{
+	Unmap();
+	throw runtime_error("Ticket segment " + path + " " + reason + ". ");
+}
+
+// TicketSegmentReader::Unmap
+void TicketSegmentReader::Unmap()
+{
+#ifdef _WIN32
+	if (myData != nullptr)
+		UnmapViewOfFile(myData);
+	if (myMapping != nullptr)
+		CloseHandle(myMapping);
+	if (myFile != INVALID_HANDLE_VALUE)
+		CloseHandle(myFile);
+	myMapping = nullptr;
+	myFile = INVALID_HANDLE_VALUE;
+#else
+	if (myData != nullptr)
+		munmap(const_cast<unsigned char*>(myData), mySize);
+#endif
+	myData = nullptr;
+}
+
+/***************************************************************************
+ *	VIEW DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSegmentReader::TicketView::GetClientId
+string_view TicketSegmentReader::TicketView::GetClientId() const
+{
+	const auto client = LoadLittle<uint32_t>(myReader->Column(TicketSegmentHeader::ClientIndexes) + myRow * 4);
+	if (client >= myReader->myClientCount)
+		throw runtime_error("Ticket segment client index is out of range. ");
+	return myReader->HeapString(TicketSegmentHeader::ClientOffsets, TicketSegmentHeader::ClientHeap, myReader->mySections[TicketSegmentHeader::DescriptionOffsets], client);
+}
+
+// TicketSegmentReader::TicketView::GetDescription
+string_view TicketSegmentReader::TicketView::GetDescription() const
+{
+	return myReader->HeapString(TicketSegmentHeader::DescriptionOffsets, TicketSegmentHeader::DescriptionHeap, myReader->mySize, myRow);
+}
+
+// TicketSegmentReader::TicketView::ToExtendedWorkTicket
+Expected<ExtendedWorkTicket> TicketSegmentReader::TicketView::ToExtendedWorkTicket() const
+{
+	// a day number GetPackedDate() would throw on is reported like any other rule
+	const auto dayNumber = LoadLittle<int32_t>(myReader->Column(TicketSegmentHeader::DayNumbers) + myRow * 4);
+	const auto dateError = MyDate::ValidateDayNumber(dayNumber);
+	if (!dateError.Ok())
+		return dateError;
+
+	int day = 0, month = 0, year = 0;
+	MyDate::FromDayNumber(dayNumber, day, month, year);
+	return ExtendedWorkTicket::TryMake(GetTicketNumber(), GetClientId(), day, month, year, GetDescription(), IsOpen());
+}
+
+#endif
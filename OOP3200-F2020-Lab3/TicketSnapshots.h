@@ -0,0 +1,366 @@
+/** TicketSnapshots.h - Point-in-Time Snapshots and Fast Startup
+ *
+ *	The TicketSnapshots class keeps a directory of snapshots of a
+ *	WorkTicketStore, each a ticket segment (see TicketSegment.h) holding
+ *	every ticket, open or closed, as of one TicketLog record. A snapshot is
+ *	named after that record's sequence number, snapshot-<lsn>.seg, and is
+ *	written to a temporary file, synced and renamed, so a crash never leaves
+ *	a partly written snapshot under a snapshot's name.
+ *
+ *	WriteInBackground() holds up changes to the store only while its
+ *	columns are copied (see WorkTicketStore::TakeSnapshot()); the segment
+ *	is built and written on a background thread. At startup, Recover() loads
+ *	the newest snapshot and replays only the log records after it, instead
+ *	of replaying the whole log or rebuilding every ticket from text. Each
+ *	snapshot records where in the log its last record ends, so the records
+ *	before it are not even read.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicketStore.h
+ *	@see		TicketSegment.h
+ *	@see		TicketLog.h
+*/
+
+#pragma once
+#ifndef _TICKET_SNAPSHOTS_H
+
+#define _TICKET_SNAPSHOTS_H
+
+#include <algorithm>		// for sort
+#include <atomic>			// for the writing flag
+#include <cstdint>			// for fixed width integers
+#include <cstdio>			// for snprintf
+#include <exception>		// for exception_ptr
+#include <filesystem>		// for directory_iterator, rename and remove
+#include <memory>			// for unique_ptr
+#include <stdexcept>		// for runtime_error and invalid_argument
+#include <string>			// for string
+#include <thread>			// for the background writer
+#include <utility>			// for pair and exchange
+#include <vector>			// for the snapshot list
+#include "WorkTicketStore.h"
+#include "TicketSegment.h"
+#include "TicketLog.h"
+
+#ifndef _WIN32
+#include <fcntl.h>		// for open
+#include <unistd.h>		// for fsync
+#endif
+
+using namespace std;
+
+class TicketSnapshots
+{
+public:
+	static constexpr size_t default_keep = 2; // snapshots kept after each write
+
+	/** Recovery
+	 *	What Recover() found.
+	 */
+	struct Recovery
+	{
+		string snapshot;			// the snapshot loaded; empty if there was none
+		uint64_t snapshotLsn = 0;	// the last log record it includes
+		size_t snapshotTickets = 0;	// tickets loaded from it
+		uint64_t logOffset = 0;		// where the log record after it starts, if the snapshot recorded it
+		TicketLog::ScanResult log;	// the log records found, and replayed after the snapshot
+
+		/** NextLsn()
+		 *	The lowest sequence number the log can give its next record. To
+		 *	reopen the log without reading it again, pass it as
+		 *	TicketLog::Options::first_lsn, which also keeps the numbers above
+		 *	the snapshot's if the log was lost, and pass log.validBytes as
+		 *	TicketLog::Options::scan_from.
+		 */
+		uint64_t NextLsn() const { return (log.lastLsn > snapshotLsn ? log.lastLsn : snapshotLsn) + 1; }
+	};
+
+	/***************************************************************************
+	*	CONSTRUCTORS
+	***************************************************************************/
+
+	/** Constructor
+	 *	Creates the directory if need be and removes any temporary file left
+	 *	by a write that a crash interrupted.
+	 *	@param directory (string) - where the snapshots are kept
+	 *	@param keep (size_t) - how many of the newest snapshots to keep
+	 *	@throws (invalid_argument) if keep is 0
+	 */
+	explicit TicketSnapshots(const string& directory, size_t keep = default_keep);
+
+	TicketSnapshots(const TicketSnapshots&) = delete;
+	TicketSnapshots& operator=(const TicketSnapshots&) = delete;
+
+	/** Destructor
+	 *	Waits for a background write to finish. An error from it is dropped;
+	 *	call Wait() first to see it.
+	 */
+	~TicketSnapshots();
+
+	/***************************************************************************
+	*	WRITING
+	***************************************************************************/
+
+	/** Write()
+	 *	Writes a snapshot and waits for it to be synced, then removes all but
+	 *	the newest snapshots.
+	 *	@param lsn (uint64_t) - the last log record whose change the store or snapshot includes
+	 *	@param log_offset (uint64_t) - the log's EndOffset() after that record, or 0 if not known
+	 *	@throws (runtime_error) if the snapshot cannot be written
+	 */
+	void Write(const WorkTicketStore& store, const uint64_t lsn, const uint64_t log_offset = 0) { Write(store.TakeSnapshot(), lsn, log_offset); }
+	void Write(const WorkTicketStore::Snapshot& snapshot, uint64_t lsn, uint64_t log_offset = 0);
+
+	/** WriteInBackground()
+	 *	Copies the store's columns and writes them out on another thread.
+	 *	Call it with changes to the store held off, e.g. under the lock that
+	 *	orders them with their log records; it returns as soon as the columns
+	 *	are copied. The snapshot covers every record in the log at that
+	 *	moment, and is not named until the log has synced them, so a snapshot
+	 *	never holds a change the log could still lose. The log must stay open
+	 *	until the write finishes. A failure of the previous write that Wait()
+	 *	was not called to see is dropped.
+	 *	@return (bool) - false, doing nothing, if the previous write is still running
+	 *	@throws (bad_alloc or system_error) if the copy or the thread cannot be made; no write is started
+	 */
+	bool WriteInBackground(const WorkTicketStore& store, TicketLog& log);
+
+	/** Wait()
+	 *	Waits for a background write to finish.
+	 *	@throws (runtime_error) if it failed
+	 */
+	void Wait();
+
+	bool Writing() const { return myWriting.load(); }
+
+	/***************************************************************************
+	*	READING
+	***************************************************************************/
+
+	/** List()
+	 *	The snapshots in the directory, oldest first.
+	 *	@return (vector) - (lsn, path) pairs
+	 */
+	vector<pair<uint64_t, string>> List() const;
+
+	/** Recover()
+	 *	Loads the newest snapshot that opens into an empty store, then replays
+	 *	the log records after it. A snapshot whose header or size is wrong is
+	 *	passed over for the one before it. The store's date and text indexes
+	 *	are rebuilt the first time they are used.
+	 *	@param store (WorkTicketStore) - an empty store
+	 *	@param log_path (string) - the log; one that does not exist holds no records
+	 *	@throws (invalid_argument) if the store is not empty
+	 *	@throws (runtime_error) if the snapshot or the log cannot be read
+	 */
+	Recovery Recover(WorkTicketStore& store, const string& log_path) const;
+
+	const string& Directory() const { return myDirectory; }
+
+private:
+	/** PathOf()
+	 *	The file name of the snapshot at a sequence number; zero padded, so
+	 *	the names sort in order.
+	 */
+	string PathOf(uint64_t lsn) const;
+
+	/** SyncFile()
+	 *	Syncs a file, or on POSIX systems a directory, to disk.
+	 *	@return (bool) - false if it could not be opened or synced
+	 */
+	static bool SyncFile(const string& path, bool is_directory);
+
+	string myDirectory;					// where the snapshots are kept
+	size_t myKeep;						// snapshots kept after each write
+	thread myWriter;					// the background write, if any
+	atomic<bool> myWriting{ false };	// set while the background write runs
+	exception_ptr myError;				// how it failed, if it did
+};
+
+/***************************************************************************
+ *	CONSTRUCTOR DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSnapshots::Constructor
+TicketSnapshots::TicketSnapshots(const string& directory, const size_t keep) : myDirectory(directory), myKeep(keep)
+{
+	if (keep == 0)
+		throw invalid_argument("At least one snapshot must be kept. ");
+
+	filesystem::create_directories(myDirectory);
+	for (const auto& entry : filesystem::directory_iterator(myDirectory))
+	{
+		const auto name = entry.path().filename().string();
+		if (name.rfind("snapshot-", 0) == 0 && entry.path().extension() == ".tmp")
+			filesystem::remove(entry.path());
+	}
+}
+
+// TicketSnapshots::Destructor
+TicketSnapshots::~TicketSnapshots()
+{
+	if (myWriter.joinable())
+		myWriter.join();
+}
+
+/***************************************************************************
+ *	WRITING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSnapshots::Write
+void TicketSnapshots::Write(const WorkTicketStore::Snapshot& snapshot, const uint64_t lsn, const uint64_t log_offset)
+{
+	const auto path = PathOf(lsn);		// the snapshot's name
+	const auto temporary = path + ".tmp";	// where it is written
+
+	TicketSegmentWriter writer;
+	writer.Add(snapshot);
+	writer.SetLogPosition(lsn, log_offset);
+	writer.Write(temporary);
+	if (!SyncFile(temporary, false))
+		throw runtime_error("Could not sync ticket snapshot " + temporary + ". ");
+
+	// the rename is what makes the snapshot visible, all at once
+	filesystem::rename(temporary, path);
+	if (!SyncFile(myDirectory, true))
+		throw runtime_error("Could not sync snapshot directory " + myDirectory + ". ");
+
+	const auto snapshots = List();
+	for (size_t i = 0; i + myKeep < snapshots.size(); i++)
+		filesystem::remove(snapshots[i].second);
+}
+
+// TicketSnapshots::WriteInBackground
+bool TicketSnapshots::WriteInBackground(const WorkTicketStore& store, TicketLog& log)
+{
+	if (myWriting.exchange(true))
+		return false;
+	if (myWriter.joinable())
+		myWriter.join(); // finished, but not yet joined
+	myError = nullptr;
+
+	try
+	{
+		// the only part done while changes are held off
+		auto snapshot = make_unique<WorkTicketStore::Snapshot>(store.TakeSnapshot());
+		const auto lsn = log.LastLsn();
+		const auto offset = log.EndOffset();
+
+		myWriter = thread([this, &log, lsn, offset, snapshot = move(snapshot)]()
+		{
+			try
+			{
+				log.Flush();
+				Write(*snapshot, lsn, offset);
+			}
+			catch (...)
+			{
+				myError = current_exception();
+			}
+			myWriting.store(false);
+		});
+	}
+	catch (...)
+	{
+		myWriting.store(false); // no thread is running to clear it
+		throw;
+	}
+	return true;
+}
+
+// TicketSnapshots::Wait
+void TicketSnapshots::Wait()
+{
+	if (myWriter.joinable())
+		myWriter.join();
+	if (myError)
+		rethrow_exception(exchange(myError, nullptr));
+}
+
+/***************************************************************************
+ *	READING DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSnapshots::List
+vector<pair<uint64_t, string>> TicketSnapshots::List() const
+{
+	vector<pair<uint64_t, string>> snapshots; // (lsn, path)
+	for (const auto& entry : filesystem::directory_iterator(myDirectory))
+	{
+		// "snapshot-", digits, ".seg"
+		const auto name = entry.path().filename().string();
+		if (name.size() <= 13 || name.rfind("snapshot-", 0) != 0 || entry.path().extension() != ".seg"
+			|| name.find_first_not_of("0123456789", 9) != name.size() - 4)
+			continue;
+		snapshots.emplace_back(stoull(name.substr(9, name.size() - 13)), entry.path().string());
+	}
+	sort(snapshots.begin(), snapshots.end());
+	return snapshots;
+}
+
+// TicketSnapshots::Recover
+TicketSnapshots::Recovery TicketSnapshots::Recover(WorkTicketStore& store, const string& log_path) const
+{
+	if (store.Size() != 0)
+		throw invalid_argument("Tickets can only be recovered into an empty store. ");
+
+	Recovery recovery;
+	const auto snapshots = List();
+	for (auto snapshot = snapshots.rbegin(); snapshot != snapshots.rend(); ++snapshot)
+	{
+		unique_ptr<TicketSegmentReader> reader; // the newest snapshot that opens
+		try
+		{
+			reader = make_unique<TicketSegmentReader>(snapshot->second);
+		}
+		catch (const runtime_error&)
+		{
+			continue; // try the one before it
+		}
+
+		recovery.snapshot = snapshot->second;
+		recovery.snapshotLsn = snapshot->first;
+		recovery.logOffset = reader->LogOffset();
+		recovery.snapshotTickets = reader->Load(store);
+		break;
+	}
+
+	recovery.log = TicketLog::Replay(log_path, store, recovery.snapshotLsn, recovery.logOffset);
+	return recovery;
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketSnapshots::PathOf
+string TicketSnapshots::PathOf(const uint64_t lsn) const
+{
+	char name[48]; // "snapshot-" and 20 digits
+	snprintf(name, sizeof(name), "snapshot-%020llu.seg", static_cast<unsigned long long>(lsn));
+	return (filesystem::path(myDirectory) / name).string();
+}
+
+// TicketSnapshots::SyncFile
+bool TicketSnapshots::SyncFile(const string& path, const bool is_directory)
+{
+#ifdef _WIN32
+	if (is_directory)
+		return true; // renames are made durable by the file system
+	const auto file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	const auto synced = FlushFileBuffers(file) != 0;
+	CloseHandle(file);
+	return synced;
+#else
+	const int file = open(path.c_str(), is_directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+	if (file < 0)
+		return false;
+	const auto synced = fsync(file) == 0;
+	close(file);
+	return synced;
+#endif
+}
+
+#endif
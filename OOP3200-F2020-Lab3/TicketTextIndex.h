@@ -0,0 +1,793 @@
+/** TicketTextIndex.h - Full-Text Index of Ticket Descriptions
+ *
+ *	The TicketTextIndex class finds tickets by the words in their
+ *	descriptions without scanning every description. Text is split into
+ *	words of letters and digits, compared without regard to case; every
+ *	other character separates words, so "Password-Reset" holds the words
+ *	"password" and "reset".
+ *
+ *	Each word has a posting list: the numbers of the tickets that contain it,
+ *	in order, with the positions of the word in each description. A list is
+ *	kept in blocks of at most max_block_tickets tickets, like the blocks of a
+ *	TicketDateIndex. Within a block every ticket number is stored as a
+ *	variable-length difference from the one before it, and its positions the
+ *	same way in a separate stream, so a posting usually takes three or four
+ *	bytes and a search that does not need positions never reads them. The
+ *	first and last ticket number of every block are kept uncompressed, which
+ *	lets a search skip whole blocks without decoding them; a block that is
+ *	needed is decoded all at once into an array.
+ *
+ *	MatchAll() intersects the lists of its words: the two shortest are
+ *	merged a block at a time, skipping blocks that cannot overlap, and the
+ *	rest are only checked at the tickets left. MatchAny() merges the lists;
+ *	MatchPhrase() intersects them and then checks that the words are
+ *	adjacent and in order.
+ *
+ *	Adding a ticket with a higher number than any before it appends to the
+ *	end of each list. Other changes re-encode one block per word.
+ *
+ *	@version	2020.09
+ *	@see		TicketDateIndex.h
+ *	@see		WorkTicketStore.h
+*/
+
+#pragma once
+#ifndef _TICKET_TEXT_INDEX_H
+
+#define _TICKET_TEXT_INDEX_H
+
+#include <algorithm>		// for sort, partition_point and binary_search
+#include <cstddef>			// for size_t
+#include <cstdint>			// for fixed width integers
+#include <string>			// for string
+#include <string_view>		// for string_view
+#include <unordered_map>	// for the word dictionary
+#include <utility>			// for pair
+#include <vector>			// for the posting lists
+
+using namespace std;
+
+class TicketTextIndex
+{
+public:
+	static constexpr size_t max_block_tickets = 128; // tickets per block before it splits
+	static constexpr size_t sparse_ratio = 32;	// how much longer a list must be to be searched rather than merged
+
+	/***************************************************************************
+	*	MUTATORS
+	*	Each takes the description text that is (or was) indexed for a ticket.
+	***************************************************************************/
+
+	/** Add()
+	 *	Indexes the words of a ticket's description.
+	 */
+	void Add(int ticket_number, string_view text);
+
+	/** Remove()
+	 *	Removes a ticket's description from the index.
+	 *	@param text (string_view) - the description that was added
+	 */
+	void Remove(int ticket_number, string_view text);
+
+	/** Replace()
+	 *	Updates the index when a ticket's description changes.
+	 */
+	void Replace(const int ticket_number, const string_view old_text, const string_view new_text)
+	{
+		if (old_text != new_text)
+		{
+			Remove(ticket_number, old_text);
+			Add(ticket_number, new_text);
+		}
+	}
+
+	void Clear() { myWords.clear(); myLists.clear(); }
+
+	/***************************************************************************
+	*	QUERIES
+	*	Each returns ticket numbers in ascending order. Words are found the
+	*	same way they are indexed, so punctuation and case are ignored.
+	***************************************************************************/
+
+	/** MatchAll()
+	 *	Finds the tickets whose descriptions contain every word.
+	 *	@param words (string_view) - e.g. "printer toner"
+	 */
+	vector<int> MatchAll(string_view words) const;
+
+	/** MatchAny()
+	 *	Finds the tickets whose descriptions contain at least one of the words.
+	 */
+	vector<int> MatchAny(string_view words) const;
+
+	/** MatchPhrase()
+	 *	Finds the tickets whose descriptions contain the words next to each
+	 *	other and in order.
+	 *	@param phrase (string_view) - e.g. "password reset"
+	 */
+	vector<int> MatchPhrase(string_view phrase) const;
+
+	/** TicketCount()
+	 *	Counts the tickets that contain a word.
+	 */
+	size_t TicketCount(string_view word) const;
+
+	size_t WordCount() const { return myWords.size(); }
+
+	/** PostingBytes()
+	 *	The size of the encoded posting lists, not counting the dictionary.
+	 */
+	size_t PostingBytes() const;
+
+	/** Tokenize()
+	 *	Splits text into lower case words and calls visit(word, position) for
+	 *	each, where position counts words from 0. The word is only valid
+	 *	during the call.
+	 */
+	template <typename Visit>
+	static void Tokenize(string_view text, Visit visit);
+
+private:
+	/** Block
+	 *	Up to max_block_tickets postings, as varints. For each ticket, the
+	 *	ticket stream holds the difference from the previous ticket number
+	 *	(from first, for the first ticket) and the position stream holds the
+	 *	number of positions, the first position and the differences between
+	 *	the rest.
+	 */
+	struct Block
+	{
+		int32_t first = 0;			// the lowest ticket number in the block
+		int32_t last = 0;			// the highest ticket number in the block
+		uint32_t count = 0;			// the number of tickets in the block
+		vector<uint8_t> tickets;	// the encoded ticket numbers
+		vector<uint8_t> positions;	// the encoded positions
+	};
+	using PostingList = vector<Block>;
+
+	/** Posting
+	 *	One ticket of a block being rebuilt; the positions stay encoded.
+	 */
+	struct Posting
+	{
+		int32_t ticketNumber;	// the ticket number
+		const uint8_t* begin;	// its encoded positions
+		const uint8_t* end;		// one past them
+	};
+
+	/** Cursor
+	 *	Walks the tickets of one posting list in order, decoding a block at a
+	 *	time. Positions are only decoded when asked for.
+	 */
+	class Cursor
+	{
+	public:
+		explicit Cursor(const PostingList& list) : myList(&list) { Load(0); }
+
+		const PostingList& List() const { return *myList; }
+		bool AtEnd() const { return myBlock == myList->size(); }
+		int32_t TicketNumber() const { return myTickets[myIndex]; }
+
+		/** Next()
+		 *	Moves to the next ticket.
+		 */
+		void Next();
+
+		/** SeekTo()
+		 *	Moves to the first ticket numbered at least ticket_number, skipping
+		 *	the blocks that end before it without decoding them.
+		 */
+		void SeekTo(int32_t ticket_number);
+
+		/** Positions()
+		 *	Decodes the word positions in the current ticket.
+		 */
+		void Positions(vector<uint32_t>& positions);
+
+		/** MergeBlock()
+		 *	Appends the tickets both cursors have from here to the end of the
+		 *	first of their blocks to run out, and moves that cursor on to its
+		 *	next block. The merge has no data-dependent branches, so it runs at
+		 *	the same speed however the two lists interleave.
+		 */
+		void MergeBlock(Cursor& other, vector<int>& tickets);
+
+	private:
+		void Load(size_t block);	// decodes the ticket numbers of a block
+
+		const PostingList* myList;				// the list being walked
+		size_t myBlock = 0;						// the current block
+		uint32_t myIndex = 0;					// the current ticket in the block
+		uint32_t myCount = 0;					// the tickets in the block
+		int32_t myTickets[max_block_tickets];	// the decoded ticket numbers
+		const uint8_t* myPositions = nullptr;	// the positions of ticket myPositionsIndex
+		uint32_t myPositionsIndex = 0;			// how far the positions have been read
+	};
+
+	/** Varints
+	 *	Seven bits per byte, low bits first; the high bit means another byte follows.
+	 */
+	static void AppendVarint(vector<uint8_t>& bytes, uint32_t value);
+	static uint32_t ReadVarint(const uint8_t*& next);
+	static const uint8_t* SkipPositions(const uint8_t* next);
+
+	/** Posting List Updates
+	 */
+	static void AddPosting(PostingList& list, int32_t ticket_number, const vector<uint8_t>& positions);
+	static void RemovePosting(PostingList& list, int32_t ticket_number);
+	static void Decode(const Block& block, vector<Posting>& postings);
+	static Block Encode(const vector<Posting>& postings, size_t from, size_t to);
+	static void AppendPosting(Block& block, int32_t ticket_number, const uint8_t* positions, const uint8_t* positions_end);
+	static size_t FindBlock(const PostingList& list, int32_t ticket_number);
+	static size_t Length(const PostingList& list);
+
+	/** Query Helpers
+	 */
+	const PostingList* FindList(const string& word) const;
+	vector<const PostingList*> FindLists(string_view words) const;
+	static vector<int> Intersect(vector<const PostingList*> lists); // non-null and distinct
+
+	unordered_map<string, uint32_t> myWords;	// word to posting list
+	vector<PostingList> myLists;				// posting lists, by word
+
+	// scratch space reused by Add() and Remove()
+	vector<pair<uint32_t, uint32_t>> myOccurrences;	// (word, position)
+	vector<uint8_t> myPositionBytes;				// encoded positions of one word
+};
+
+/***************************************************************************
+ *	MUTATOR DEFINITIONS
+ ***************************************************************************/
+
+ // TicketTextIndex::Add
+void TicketTextIndex::Add(const int ticket_number, const string_view text)
+{
+	// find (or create) the posting list of every word
+	myOccurrences.clear();
+	Tokenize(text, [this](const string& word, const uint32_t position)
+	{
+		auto found = myWords.find(word);
+		if (found == myWords.end())
+		{
+			found = myWords.emplace(word, static_cast<uint32_t>(myLists.size())).first;
+			myLists.emplace_back();
+		}
+		myOccurrences.emplace_back(found->second, position);
+	});
+
+	// one posting per distinct word, holding all its positions
+	sort(myOccurrences.begin(), myOccurrences.end());
+	for (size_t i = 0; i < myOccurrences.size(); )
+	{
+		const auto list = myOccurrences[i].first;
+		auto end = i; // one past the last occurrence of this word
+		while (end < myOccurrences.size() && myOccurrences[end].first == list)
+			end++;
+
+		myPositionBytes.clear();
+		AppendVarint(myPositionBytes, static_cast<uint32_t>(end - i));
+		for (auto j = i; j < end; j++)
+			AppendVarint(myPositionBytes, myOccurrences[j].second - (j == i ? 0 : myOccurrences[j - 1].second));
+		AddPosting(myLists[list], ticket_number, myPositionBytes);
+		i = end;
+	}
+}
+
+// TicketTextIndex::Remove
+void TicketTextIndex::Remove(const int ticket_number, const string_view text)
+{
+	myOccurrences.clear();
+	Tokenize(text, [this](const string& word, const uint32_t position)
+	{
+		const auto found = myWords.find(word);
+		if (found != myWords.end())
+			myOccurrences.emplace_back(found->second, position);
+	});
+
+	// each word once; a word with no tickets left keeps its empty list
+	sort(myOccurrences.begin(), myOccurrences.end());
+	for (size_t i = 0; i < myOccurrences.size(); i++)
+	{
+		if (i == 0 || myOccurrences[i].first != myOccurrences[i - 1].first)
+			RemovePosting(myLists[myOccurrences[i].first], ticket_number);
+	}
+}
+
+/***************************************************************************
+ *	QUERY DEFINITIONS
+ ***************************************************************************/
+
+ // TicketTextIndex::MatchAll
+vector<int> TicketTextIndex::MatchAll(const string_view words) const
+{
+	const auto lists = FindLists(words);
+	if (lists.empty() || lists.front() == nullptr) // sorted, so a missing word comes first
+		return {};
+	return Intersect(lists);
+}
+
+// TicketTextIndex::MatchAny
+vector<int> TicketTextIndex::MatchAny(const string_view words) const
+{
+	vector<int> tickets; // the matching tickets
+	vector<Cursor> cursors;
+	for (const auto list : FindLists(words))
+	{
+		if (list != nullptr)
+			cursors.emplace_back(*list);
+	}
+
+	// merge: take the lowest ticket number, then step every list that has it
+	while (true)
+	{
+		auto lowest = INT32_MAX;
+		auto done = true;
+		for (const auto& cursor : cursors)
+		{
+			if (!cursor.AtEnd())
+			{
+				lowest = min(lowest, cursor.TicketNumber());
+				done = false;
+			}
+		}
+		if (done)
+			return tickets;
+
+		tickets.push_back(lowest);
+		for (auto& cursor : cursors)
+		{
+			if (!cursor.AtEnd() && cursor.TicketNumber() == lowest)
+				cursor.Next();
+		}
+	}
+}
+
+// TicketTextIndex::MatchPhrase
+vector<int> TicketTextIndex::MatchPhrase(const string_view phrase) const
+{
+	vector<int> tickets; // the matching tickets
+
+	// the list of each word of the phrase, in phrase order
+	vector<const PostingList*> words;
+	Tokenize(phrase, [this, &words](const string& word, uint32_t) { words.push_back(FindList(word)); });
+	if (words.empty() || find(words.begin(), words.end(), nullptr) != words.end())
+		return tickets;
+
+	// the tickets with every word, from intersecting each distinct list once
+	auto lists = words;
+	sort(lists.begin(), lists.end());
+	lists.erase(unique(lists.begin(), lists.end()), lists.end());
+	const auto candidates = Intersect(lists);
+
+	// then a cursor per distinct list, to read positions, and the cursor of each word
+	vector<Cursor> cursors;
+	for (const auto list : lists)
+		cursors.emplace_back(*list);
+	vector<size_t> cursorOf; // by word
+	for (const auto word : words)
+		cursorOf.push_back(static_cast<size_t>(find(lists.begin(), lists.end(), word) - lists.begin()));
+
+	vector<vector<uint32_t>> positions(cursors.size()); // decoded per cursor
+	for (const auto ticketNumber : candidates)
+	{
+		for (size_t i = 0; i < cursors.size(); i++)
+		{
+			cursors[i].SeekTo(ticketNumber);
+			cursors[i].Positions(positions[i]);
+		}
+
+		// the phrase starts at a position of the first word...
+		for (const auto start : positions[cursorOf[0]])
+		{
+			// ...if every later word is that many positions after it
+			auto found = true;
+			for (size_t word = 1; word < words.size() && found; word++)
+			{
+				const auto& later = positions[cursorOf[word]];
+				found = binary_search(later.begin(), later.end(), start + static_cast<uint32_t>(word));
+			}
+			if (found)
+			{
+				tickets.push_back(ticketNumber);
+				break;
+			}
+		}
+	}
+	return tickets;
+}
+
+// TicketTextIndex::TicketCount
+size_t TicketTextIndex::TicketCount(const string_view word) const
+{
+	size_t count = 0; // the tickets containing the word
+	Tokenize(word, [this, &count](const string& token, uint32_t)
+	{
+		if (const auto list = FindList(token))
+			count += Length(*list);
+	});
+	return count;
+}
+
+// TicketTextIndex::PostingBytes
+size_t TicketTextIndex::PostingBytes() const
+{
+	size_t bytes = 0; // the encoded size
+	for (const auto& list : myLists)
+	{
+		for (const auto& block : list)
+			bytes += block.tickets.size() + block.positions.size();
+	}
+	return bytes;
+}
+
+// TicketTextIndex::Tokenize
+template <typename Visit>
+void TicketTextIndex::Tokenize(const string_view text, Visit visit)
+{
+	string word;		// the current word, in lower case
+	uint32_t position = 0;	// the number of words before it
+
+	for (size_t i = 0; i <= text.size(); i++)
+	{
+		const auto c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+
+		// letters, digits and non-ASCII bytes belong to words
+		if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80)
+			word += static_cast<char>(c);
+		else if (c >= 'A' && c <= 'Z')
+			word += static_cast<char>(c - 'A' + 'a');
+		else if (!word.empty())
+		{
+			visit(static_cast<const string&>(word), position++);
+			word.clear();
+		}
+	}
+}
+
+/***************************************************************************
+ *	CURSOR DEFINITIONS
+ ***************************************************************************/
+
+ // TicketTextIndex::Cursor::Next
+void TicketTextIndex::Cursor::Next()
+{
+	if (++myIndex == myCount)
+		Load(myBlock + 1);
+}
+
+// TicketTextIndex::Cursor::SeekTo
+void TicketTextIndex::Cursor::SeekTo(const int32_t ticket_number)
+{
+	if (AtEnd() || TicketNumber() >= ticket_number)
+		return;
+
+	// skip whole blocks that end before the ticket, galloping ahead then searching back
+	const auto& blocks = *myList;
+	if (blocks[myBlock].last < ticket_number)
+	{
+		auto low = myBlock + 1;	// the first block that might hold the ticket
+		size_t step = 1;		// the gallop stride
+		while (low + step < blocks.size() && blocks[low + step - 1].last < ticket_number)
+		{
+			low += step;
+			step *= 2;
+		}
+		const auto high = min(low + step, blocks.size()); // a block past the ticket, or the end
+		const auto block = partition_point(blocks.begin() + static_cast<ptrdiff_t>(low), blocks.begin() + static_cast<ptrdiff_t>(high),
+			[ticket_number](const Block& compare) { return compare.last < ticket_number; });
+		Load(static_cast<size_t>(block - blocks.begin()));
+		if (AtEnd())
+			return;
+	}
+
+	// then search within the block, which ends at or after the ticket
+	myIndex = static_cast<uint32_t>(lower_bound(myTickets + myIndex, myTickets + myCount, ticket_number) - myTickets);
+}
+
+// TicketTextIndex::Cursor::Positions
+void TicketTextIndex::Cursor::Positions(vector<uint32_t>& positions)
+{
+	// catch the position stream up to the current ticket
+	for (; myPositionsIndex < myIndex; myPositionsIndex++)
+		myPositions = SkipPositions(myPositions);
+
+	auto next = myPositions;
+	const auto count = ReadVarint(next);
+	positions.resize(count);
+	uint32_t position = 0; // the previous position
+	for (uint32_t i = 0; i < count; i++)
+	{
+		position += ReadVarint(next);
+		positions[i] = position;
+	}
+}
+
+// TicketTextIndex::Cursor::MergeBlock
+void TicketTextIndex::Cursor::MergeBlock(Cursor& other, vector<int>& tickets)
+{
+	int32_t matched[max_block_tickets]; // tickets in both
+	size_t count = 0;					// how many
+	auto i = myIndex;
+	auto j = other.myIndex;
+	while (i < myCount && j < other.myCount)
+	{
+		const auto mine = myTickets[i];
+		const auto theirs = other.myTickets[j];
+		matched[count] = mine;
+		count += mine == theirs;
+		i += mine <= theirs;
+		j += theirs <= mine;
+	}
+	tickets.insert(tickets.end(), matched, matched + count);
+
+	myIndex = i;
+	other.myIndex = j;
+	if (i == myCount)
+		Load(myBlock + 1);
+	if (j == other.myCount)
+		other.Load(other.myBlock + 1);
+}
+
+// TicketTextIndex::Cursor::Load
+void TicketTextIndex::Cursor::Load(const size_t block)
+{
+	myBlock = block;
+	myIndex = 0;
+	if (AtEnd())
+		return;
+
+	const auto& loaded = (*myList)[block];
+	auto next = loaded.tickets.data();
+	auto ticketNumber = loaded.first; // the previous ticket number
+	for (uint32_t i = 0; i < loaded.count; i++)
+	{
+		ticketNumber += static_cast<int32_t>(ReadVarint(next));
+		myTickets[i] = ticketNumber;
+	}
+	myCount = loaded.count;
+	myPositions = loaded.positions.data();
+	myPositionsIndex = 0;
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // TicketTextIndex::AppendVarint
+void TicketTextIndex::AppendVarint(vector<uint8_t>& bytes, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// TicketTextIndex::ReadVarint
+uint32_t TicketTextIndex::ReadVarint(const uint8_t*& next)
+{
+	// most differences and positions fit in one byte
+	if (*next < 0x80)
+		return *next++;
+
+	uint32_t value = 0; // the decoded value
+	for (auto shift = 0; ; shift += 7)
+	{
+		const auto byte = *next++;
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if (byte < 0x80)
+			return value;
+	}
+}
+
+// TicketTextIndex::SkipPositions
+const uint8_t* TicketTextIndex::SkipPositions(const uint8_t* next)
+{
+	// the positions are varints, so count bytes without the high bit
+	for (auto count = ReadVarint(next); count > 0; count--)
+	{
+		while (*next++ >= 0x80) {}
+	}
+	return next;
+}
+
+// TicketTextIndex::AddPosting
+void TicketTextIndex::AddPosting(PostingList& list, const int32_t ticket_number, const vector<uint8_t>& positions)
+{
+	// usually the highest ticket number so far: append to the last block
+	if (list.empty() || ticket_number > list.back().last)
+	{
+		if (list.empty() || list.back().count >= max_block_tickets)
+		{
+			list.emplace_back();
+			list.back().first = ticket_number;
+			list.back().last = ticket_number;
+		}
+		AppendPosting(list.back(), ticket_number, positions.data(), positions.data() + positions.size());
+		return;
+	}
+
+	// otherwise rebuild the block it belongs in, replacing any posting it already has
+	const auto index = FindBlock(list, ticket_number);
+	vector<Posting> postings;
+	Decode(list[index], postings);
+	const Posting added{ ticket_number, positions.data(), positions.data() + positions.size() };
+	const auto at = partition_point(postings.begin(), postings.end(),
+		[ticket_number](const Posting& compare) { return compare.ticketNumber < ticket_number; });
+	if (at != postings.end() && at->ticketNumber == ticket_number)
+		*at = added;
+	else
+		postings.insert(at, added);
+
+	// split a full block in half
+	if (postings.size() > max_block_tickets)
+	{
+		auto upper = Encode(postings, postings.size() / 2, postings.size());
+		list[index] = Encode(postings, 0, postings.size() / 2);
+		list.insert(list.begin() + static_cast<ptrdiff_t>(index) + 1, move(upper));
+	}
+	else
+	{
+		list[index] = Encode(postings, 0, postings.size());
+	}
+}
+
+// TicketTextIndex::RemovePosting
+void TicketTextIndex::RemovePosting(PostingList& list, const int32_t ticket_number)
+{
+	const auto index = FindBlock(list, ticket_number);
+	if (index == list.size() || list[index].first > ticket_number)
+		return;
+
+	vector<Posting> postings;
+	Decode(list[index], postings);
+	const auto at = partition_point(postings.begin(), postings.end(),
+		[ticket_number](const Posting& compare) { return compare.ticketNumber < ticket_number; });
+	if (at == postings.end() || at->ticketNumber != ticket_number)
+		return;
+	postings.erase(at);
+
+	if (postings.empty())
+		list.erase(list.begin() + static_cast<ptrdiff_t>(index));
+	else
+		list[index] = Encode(postings, 0, postings.size());
+}
+
+// TicketTextIndex::Decode
+void TicketTextIndex::Decode(const Block& block, vector<Posting>& postings)
+{
+	postings.clear();
+	postings.reserve(block.count + 1);
+	auto next = block.tickets.data();
+	auto positions = block.positions.data();
+	auto ticketNumber = block.first; // the previous ticket number
+	for (uint32_t i = 0; i < block.count; i++)
+	{
+		ticketNumber += static_cast<int32_t>(ReadVarint(next));
+		const auto end = SkipPositions(positions);
+		postings.push_back({ ticketNumber, positions, end });
+		positions = end;
+	}
+}
+
+// TicketTextIndex::Encode
+TicketTextIndex::Block TicketTextIndex::Encode(const vector<Posting>& postings, const size_t from, const size_t to)
+{
+	Block block; // the encoded postings
+	block.first = postings[from].ticketNumber;
+	block.last = postings[from].ticketNumber;
+	for (auto i = from; i < to; i++)
+		AppendPosting(block, postings[i].ticketNumber, postings[i].begin, postings[i].end);
+	return block;
+}
+
+// TicketTextIndex::AppendPosting
+void TicketTextIndex::AppendPosting(Block& block, const int32_t ticket_number, const uint8_t* positions, const uint8_t* positions_end)
+{
+	// ticket_number is at least block.last
+	AppendVarint(block.tickets, static_cast<uint32_t>(ticket_number - block.last));
+	block.positions.insert(block.positions.end(), positions, positions_end);
+	block.last = ticket_number;
+	block.count++;
+}
+
+// TicketTextIndex::FindBlock
+size_t TicketTextIndex::FindBlock(const PostingList& list, const int32_t ticket_number)
+{
+	// the first block that ends at or after the ticket
+	const auto block = partition_point(list.begin(), list.end(),
+		[ticket_number](const Block& compare) { return compare.last < ticket_number; });
+	return static_cast<size_t>(block - list.begin());
+}
+
+// TicketTextIndex::Length
+size_t TicketTextIndex::Length(const PostingList& list)
+{
+	size_t count = 0; // the tickets in the list
+	for (const auto& block : list)
+		count += block.count;
+	return count;
+}
+
+// TicketTextIndex::FindList
+const TicketTextIndex::PostingList* TicketTextIndex::FindList(const string& word) const
+{
+	const auto found = myWords.find(word);
+	return found == myWords.end() || myLists[found->second].empty() ? nullptr : &myLists[found->second];
+}
+
+// TicketTextIndex::FindLists
+vector<const TicketTextIndex::PostingList*> TicketTextIndex::FindLists(const string_view words) const
+{
+	// each word once; nullptr for a word no ticket contains
+	vector<const PostingList*> lists;
+	Tokenize(words, [this, &lists](const string& word, uint32_t) { lists.push_back(FindList(word)); });
+	sort(lists.begin(), lists.end());
+	lists.erase(unique(lists.begin(), lists.end()), lists.end());
+	return lists;
+}
+
+// TicketTextIndex::Intersect
+vector<int> TicketTextIndex::Intersect(vector<const PostingList*> lists)
+{
+	// shortest first: the fewer tickets in play, the less there is to decode
+	sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) { return Length(*a) < Length(*b); });
+
+	vector<int> tickets; // the tickets in every list
+	Cursor first(*lists[0]);
+	if (lists.size() == 1)
+	{
+		tickets.reserve(Length(*lists[0]));
+		for (; !first.AtEnd(); first.Next())
+			tickets.push_back(first.TicketNumber());
+		return tickets;
+	}
+
+	Cursor second(*lists[1]);
+	if (Length(*lists[1]) / Length(*lists[0]) >= sparse_ratio)
+	{
+		// a much shorter list: look each of its tickets up in the other
+		for (; !first.AtEnd(); first.Next())
+		{
+			second.SeekTo(first.TicketNumber());
+			if (second.AtEnd())
+				break;
+			if (second.TicketNumber() == first.TicketNumber())
+				tickets.push_back(first.TicketNumber());
+		}
+	}
+
+	// similar lists: skip each to the other, then merge the blocks they meet in
+	while (!first.AtEnd())
+	{
+		second.SeekTo(first.TicketNumber());
+		if (second.AtEnd())
+			break;
+		first.SeekTo(second.TicketNumber());
+		if (first.AtEnd())
+			break;
+		first.MergeBlock(second, tickets);
+		if (first.AtEnd() || second.AtEnd())
+			break;
+	}
+
+	// each longer list only has to be checked at the tickets left
+	for (size_t i = 2; i < lists.size() && !tickets.empty(); i++)
+	{
+		Cursor cursor(*lists[i]);
+		size_t kept = 0; // tickets still in every list
+		for (const auto ticketNumber : tickets)
+		{
+			cursor.SeekTo(ticketNumber);
+			if (cursor.AtEnd())
+				break;
+			if (cursor.TicketNumber() == ticketNumber)
+				tickets[kept++] = ticketNumber;
+		}
+		tickets.resize(kept);
+	}
+	return tickets;
+}
+
+#endif
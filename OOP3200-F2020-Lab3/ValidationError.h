@@ -0,0 +1,190 @@
+/** ValidationError.h - Non-Throwing Validation Results
+ *
+ *	The ValidationError class reports why a date or work ticket is invalid
+ *	without throwing. It holds only an error code and the offending values;
+ *	the message is formatted when Message() is called, so checking dirty
+ *	input costs a few comparisons, not a string build and a stack unwind.
+ *	Throw() raises the same exception, with the same message, that the
+ *	throwing API always has, so that API is a thin wrapper over this one.
+ *
+ *	Expected<T> holds either a value or the ValidationError that prevented
+ *	it, and is returned by the TryMake() factories.
+ *
+ *	@version	2020.09
+ *	@see		MyDate.h
+ *	@see		WorkTicket.h
+*/
+
+#pragma once
+#ifndef _VALIDATION_ERROR_H
+
+#define _VALIDATION_ERROR_H
+
+#include <cstdint>		// for uint8_t
+#include <cstdio>		// for snprintf
+#include <optional>		// for optional
+#include <stdexcept>	// for standard exceptions
+#include <string>		// for string
+#include <utility>		// for move
+
+using namespace std;
+
+/** ValidationCode
+ *	What was wrong. Ok means nothing was.
+ */
+enum class ValidationCode : uint8_t
+{
+	Ok,					// valid
+	InvalidDayNumber,	// a day number below 1 or after 31/12/9999
+	InvalidYear,		// a year outside 1-9999
+	InvalidMonth,		// a month outside 1-12
+	InvalidDay,			// a day outside the month
+	InvalidSubscript,	// a MyDate subscript other than 'd', 'm' or 'y'
+	InvalidTicketNumber,	// a ticket number that is not positive
+	InvalidTicketYear,	// a ticket year outside 2000-2099
+	EmptyClientId,		// a ticket with no client ID
+	EmptyDescription	// a ticket with no description
+};
+
+class ValidationError
+{
+public:
+
+	/** Default Constructor
+	 *	No error.
+	 */
+	constexpr ValidationError() = default;
+
+	/** Parameterized Constructor
+	 *	Records an error without formatting anything.
+	 *	@param code (ValidationCode) - what was wrong
+	 *	@param value (long) - the offending value
+	 *	@param name (const char*) - a static string for the message, e.g. the month name of an invalid day
+	 *	@param year (int) - the year of an invalid day
+	 *	@param limit (int) - the largest valid value, e.g. the days in the month
+	 */
+	constexpr ValidationError(const ValidationCode code, const long value = 0, const char* name = nullptr, const int year = 0, const int limit = 0)
+		: myCode(code), myValue(value), myName(name), myYear(year), myLimit(limit) {}
+
+	/** Accessors
+	 */
+	constexpr bool Ok() const { return myCode == ValidationCode::Ok; }
+	constexpr ValidationCode Code() const { return myCode; }
+	constexpr long Value() const { return myValue; }
+
+	/** Message()
+	 *	Formats the message the throwing API uses for this error.
+	 *	@return (string) - the message, or "" if there is no error
+	 */
+	string Message() const;
+
+	/** Throw()
+	 *	Throws the exception the throwing API uses for this error:
+	 *	invalid_argument for subscript and ticket errors, out_of_range for the rest.
+	 *	Must not be called when Ok().
+	 */
+	[[noreturn]] void Throw() const;
+
+	/** ThrowIfError()
+	 *	Throws if there is an error; does nothing if Ok(). Usable in constexpr functions.
+	 */
+	constexpr void ThrowIfError() const
+	{
+		if (!Ok())
+			Throw();
+	}
+
+private:
+	ValidationCode myCode = ValidationCode::Ok;	// what was wrong
+	long myValue = 0;							// the offending value
+	const char* myName = nullptr;				// static text for the message
+	int myYear = 0;								// the year of an invalid day
+	int myLimit = 0;							// the largest valid value
+};
+
+/** Expected
+ *	Either a valid T or the reason there is none.
+ */
+template <typename T>
+class Expected
+{
+public:
+	Expected(T value) : myValue(move(value)) {}
+	Expected(const ValidationError error) : myError(error) {}
+
+	bool HasValue() const { return myValue.has_value(); }
+	explicit operator bool() const { return HasValue(); }
+
+	/** Value()
+	 *	@return (T by ref) - the value
+	 *	@throws (invalid_argument or out_of_range) the error, if there is no value
+	 */
+	T& Value() { if (!myValue) myError.Throw(); return *myValue; }
+	const T& Value() const { if (!myValue) myError.Throw(); return *myValue; }
+
+	const ValidationError& Error() const { return myError; }
+
+private:
+	optional<T> myValue;		// the value, if valid
+	ValidationError myError;	// the error, if not
+};
+
+/***************************************************************************
+ *	METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // ValidationError::Message
+string ValidationError::Message() const
+{
+	// the same text the throwing API has always used
+	char message[128];
+	switch (myCode)
+	{
+	case ValidationCode::InvalidDayNumber:
+		snprintf(message, sizeof(message), "%ld is an invalid value for a day number.\nValue must be greater than 0.", myValue);
+		break;
+	case ValidationCode::InvalidYear:
+		snprintf(message, sizeof(message), "%ld is an invalid value for year.\nValue must be between %04d and %04d inclusive.", myValue, 1, 9999);
+		break;
+	case ValidationCode::InvalidMonth:
+		snprintf(message, sizeof(message), "%ld is an invalid value for month.\nValue must be between %d and %d inclusive.", myValue, 1, 12);
+		break;
+	case ValidationCode::InvalidDay:
+		snprintf(message, sizeof(message), "%ld is an invalid value for a day in %s %04d.\nValue must be between %d and %d inclusive.",
+			myValue, myName, myYear, 1, myLimit);
+		break;
+	case ValidationCode::InvalidSubscript:
+		snprintf(message, sizeof(message), "%c is an invalid parameter. Options are \'d\', \'m\', or \'y\'", static_cast<char>(myValue));
+		break;
+	case ValidationCode::InvalidTicketNumber:
+		return "Ticket number must be greater than zero. ";
+	case ValidationCode::InvalidTicketYear:
+		snprintf(message, sizeof(message), "Year must be between %d and %d. ", 2000, 2099);
+		break;
+	case ValidationCode::EmptyClientId:
+		return "Client ID must not be empty. ";
+	case ValidationCode::EmptyDescription:
+		return "Description must not be empty. ";
+	default:
+		return "";
+	}
+	return message;
+}
+
+// ValidationError::Throw
+void ValidationError::Throw() const
+{
+	switch (myCode)
+	{
+	case ValidationCode::InvalidSubscript:
+	case ValidationCode::InvalidTicketNumber:
+	case ValidationCode::InvalidTicketYear:
+	case ValidationCode::EmptyClientId:
+	case ValidationCode::EmptyDescription:
+		throw invalid_argument(Message());
+	default:
+		throw out_of_range(Message());
+	}
+}
+
+#endif
@@ -18,8 +18,15 @@
 #include <iomanip> 		// for output formatting
 #include <stdexcept>	// for invalid_argument
 #include <sstream>		// for stringstream
+#include <memory_resource>	// for polymorphic_allocator
+#include <string>		// for pmr::string
+#include <string_view>	// for string_view
 #include <utility>
 #include "MyDate.h" 	// version 2018.01
+#include "PackedDate.h"	// compact storage for the ticket date
+#include "ClientIdTable.h"	// interned client IDs
+#include "ValidationError.h"	// for non-throwing validation
+#include "Instrumentation.h"	// for LAB3_COUNT and LAB3_TIME
 
 using namespace std;
 
@@ -34,8 +41,21 @@ public:
 	*	strings.
 	***************************************************************************/
 
-	WorkTicket() : myTicketNumber(0), myClientId(""), myDate(1, 1, 2000), myDescription("") { }
-	WorkTicket(int ticket_number, const string& client_id, int day, int month, int year, const string& description);
+	WorkTicket() : myTicketNumber(0), myClientHandle(ClientIdTable::empty_handle), myDate(1, 1, 2000), myDescription("") { }
+	WorkTicket(int ticket_number, string_view client_id, int day, int month, int year, string_view description);
+
+	/***************************************************************************
+	*	Allocator-aware constructors.
+	*	The description is allocated from the given memory resource, e.g. the
+	*	arena of a TicketBatch. Copies made without an allocator use the
+	*	default heap, as before. pmr containers pass their allocator to these
+	*	constructors automatically.
+	***************************************************************************/
+	using allocator_type = pmr::polymorphic_allocator<char>;
+
+	explicit WorkTicket(const allocator_type& allocator) : myTicketNumber(0), myClientHandle(ClientIdTable::empty_handle), myDate(1, 1, 2000), myDescription(allocator) { }
+	WorkTicket(const WorkTicket& original, const allocator_type& allocator);
+	WorkTicket(WorkTicket&& original, const allocator_type& allocator);
 
 	/***************************************************************************
 	*	 Copy constructor
@@ -44,6 +64,14 @@ public:
 	***************************************************************************/
 	WorkTicket(const WorkTicket& original);
 
+	/***************************************************************************
+	*	 Move constructor
+	*	 Takes over the description of a WorkTicket object that is about to be
+	*	 destroyed instead of copying it. It cannot throw, so vectors of
+	*	 tickets move rather than copy them when they grow.
+	***************************************************************************/
+	WorkTicket(WorkTicket&& original) noexcept;
+
 	/***************************************************************************
 	*	SetWorkTicket()
 	*	a mutator method to set all the attributes of the object to the
@@ -52,11 +80,31 @@ public:
 	*	rules are explained for work ticket number and date. Client number
 	*	and Description must be at least one character long. If no problems are
 	*	detected, return TRUE.  Otherwise return FALSE.
+	*	The strings are taken as views: the client ID is interned and the
+	*	description is copied once, straight into the ticket's own allocator.
 	***************************************************************************/
 
-	bool SetWorkTicket(int ticket_number, const string& client_id, int day, int month, int year, const string&
+	bool SetWorkTicket(int ticket_number, string_view client_id, int day, int month, int year, string_view
 	                   description);
 
+	/***************************************************************************
+	*	Non-throwing validation.
+	*	Each Validate method returns the error the matching mutator would
+	*	throw, or an Ok error if it would not. Validate() checks every rule:
+	*	a positive ticket number, a valid date in 2000-2099 and a non-empty
+	*	client ID and description. TryMake() builds a ticket the same way
+	*	without throwing.
+	*	These are the rules of every path that sets, stores, reads or logs
+	*	a ticket, including SetWorkTicket(): ticket number 0 is only ever
+	*	the number of a default-constructed ticket, and is never valid.
+	***************************************************************************/
+
+	static ValidationError ValidateTicketNumber(int ticket_number);
+	static ValidationError ValidateDate(int day, int month, int year);
+	static ValidationError Validate(int ticket_number, string_view client_id, int day, int month, int year, string_view description);
+	static ValidationError Validate(int ticket_number, string_view client_id, PackedDate date, string_view description);
+	static Expected<WorkTicket> TryMake(int ticket_number, string_view client_id, int day, int month, int year, string_view description);
+
 	/***************************************************************************
 	*	ShowWorkTicket( )
 	*	An accessor method to display all the object's attributes neatly in
@@ -74,23 +122,29 @@ public:
 	void SetTicketNumber(int ticketNumber);
 	int GetTicketNumber() const { return myTicketNumber; }
 
-	// Client ID
-	void SetClientId(string clientId) { myClientId = std::move(clientId); }
-	string GetClientId() const { return myClientId; }
+	// Client ID (interned; see ClientIdTable)
+	void SetClientId(const string_view clientId) { myClientHandle = ClientIdTable::Shared().Intern(clientId); }
+	string GetClientId() const { return string(GetClientIdView()); }
+	string_view GetClientIdView() const { return ClientIdTable::Shared().View(myClientHandle); } // no copy
+	uint32_t GetClientHandle() const { return myClientHandle; } // equal handles mean equal client IDs
 
 	// Decsription
-	void SetDescription(string description) { myDescription = std::move(description); }
-	string GetDescription() const { return myDescription; }
+	void SetDescription(const string_view description) { myDescription.assign(description.data(), description.size()); }
+	string GetDescription() const { return string(myDescription.data(), myDescription.size()); }
+	string_view GetDescriptionView() const { return myDescription; } // no copy
+	allocator_type GetAllocator() const { return myDescription.get_allocator(); }
 
 	// Date
 	void SetDate(int day, int month, int year);
-	const MyDate& GetDate() const { return myDate; }
+	MyDate GetDate() const { return myDate.ToMyDate(); }
+	PackedDate GetPackedDate() const { return myDate; }
 
 	/***************************************************************************
 	*	Operators (LAB C2).
 	*	Include a set (mutator) and get (accessor) method for each attribute.
 	***************************************************************************/
 	WorkTicket& operator=(const WorkTicket& original); // Assignment
+	WorkTicket& operator=(WorkTicket&& original) noexcept(is_nothrow_move_assignable<pmr::string>::value); // Move assignment (copies if the allocators differ)
 	operator string () const;	// (string)
 	bool operator==(const WorkTicket& original); // Equality
 	friend ostream& operator<<(ostream& out, const WorkTicket& ticket); // Output
@@ -104,9 +158,9 @@ private:
 	***************************************************************************/
 
 	int myTicketNumber;	// Work Ticket Number - A whole, positive number.
-	string myClientId;		// Client ID - The alpha-numeric code assigned to the client.
-	MyDate myDate; 		// Work Ticket Date - the date the workticket was created     
-	string myDescription;  // Issue Description - A description of the issue the client is having.
+	uint32_t myClientHandle;	// Client ID - The alpha-numeric code assigned to the client, as a ClientIdTable handle.
+	PackedDate myDate; 	// Work Ticket Date - the date the workticket was created (4 bytes)
+	pmr::string myDescription;  // Issue Description - A description of the issue the client is having.
 };  // end of WorkTicket class
 
 /***************************************************************************
@@ -119,7 +173,7 @@ private:
 ***************************************************************************/
 
 // WorkTicket::Parameterized Constructor definition
-WorkTicket::WorkTicket(const int ticket_number, const string& client_id, const int month, const int day, const int year, const string& description)
+WorkTicket::WorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
 {
 	// Set each data member with appropriate validation:
 	SetTicketNumber(ticket_number);
@@ -129,41 +183,24 @@ WorkTicket::WorkTicket(const int ticket_number, const string& client_id, const i
 }
 
 // WorkTicket::SetTicket definition
-bool WorkTicket::SetWorkTicket(const int ticket_number, const string& client_id, int day, int month, int year, const string& description)
+bool WorkTicket::SetWorkTicket(const int ticket_number, const string_view client_id, int day, int month, int year, const string_view description)
 {
-	MyDate workingDate;
-	const auto min_year = 2000;
-	const auto max_year = 2099;
-	auto valid = true; // flag for if parameters are valid
-
-	// check numeric parameters
-	if (ticket_number < 0 || year < min_year || year > max_year)
-		valid = false;
-	// check string parameters     
-	else if (client_id.length() < 1 || description.length() < 1)
-		valid = false;
-	else
-	{
-		try
-		{
-			// sets the date (may throw an exception even if rules are met)
-			workingDate.SetDate(day, month, year);
-		}
-		catch (...)
-		{
-			valid = false;
-		}
-	}
+	LAB3_TIME(SetWorkTicket);
+
+	// check every parameter
+	const auto valid = Validate(ticket_number, client_id, day, month, year, description).Ok();
 
 	if (valid) // all parameters are valid
 	{
+		// intern the client ID first so a full table leaves the ticket unchanged
+		myClientHandle = ClientIdTable::Shared().Intern(client_id);
+
 		// set the workticket date         
-		myDate = workingDate;
+		myDate = PackedDate(MyDate::DayNumber(day, month, year));
 
 		// set atributes to parameter values
 		myTicketNumber = ticket_number;
-		myClientId = client_id;
-		myDescription = description;
+		myDescription.assign(description.data(), description.size());
 	}
 	// return true or false based on parameter validity
 	return valid;
@@ -174,7 +211,7 @@ void WorkTicket::ShowWorkTicket() const
 {
 	// display the attributes of the object neatly to the console
 	cout << "\nWork Ticket #: " << myTicketNumber
-		<< "\nClient ID:     " << myClientId
+		<< "\nClient ID:     " << GetClientIdView()
 		<< "\nDate:          " << myDate
 		<< "\nIssue:         " << myDescription << endl;
 }
@@ -185,34 +222,88 @@ void WorkTicket::SetTicketNumber(const int ticketNumber)
 	// If a work ticket number is set to a zero or a negative number, 
 	// an invalid_argument exception should be thrown, with an 
 	// appropriate message.
-	if (ticketNumber > 0)
-	{
-		myTicketNumber = ticketNumber;
-	}
-	else
+	const auto error = ValidateTicketNumber(ticketNumber);
+	if (!error.Ok())
 	{
-		throw invalid_argument("Ticket number must be greater than zero. ");
+		LAB3_COUNT(TicketNumberThrow);
+		error.Throw();
 	}
+	myTicketNumber = ticketNumber;
 }
 
 // WorkTicket::ShowTicket definition
 void WorkTicket::SetDate(const int day, const int month, const int year)
 {
 	//  An invalid_argument exception should be thrown, with an 
-	//  appropriate message if the day, month, or year is set out of range.
+	//  appropriate message if the year is out of range; MyDate's
+	//  out_of_range exception if the day or month is.
+	const auto error = ValidateDate(day, month, year);
+	if (!error.Ok())
+	{
+		LAB3_COUNT(TicketDateThrow);
+		error.Throw();
+	}
+	myDate = PackedDate(MyDate::DayNumber(day, month, year));
+}
+
+/***************************************************************************
+*	 Non-Throwing Validation Definitions
+*	 - ValidateTicketNumber()
+*	 - ValidateDate()
+*	 - Validate()
+*	 - TryMake()
+***************************************************************************/
 
+// WorkTicket::ValidateTicketNumber definition
+ValidationError WorkTicket::ValidateTicketNumber(const int ticket_number)
+{
+	return ticket_number > 0 ? ValidationError() : ValidationError(ValidationCode::InvalidTicketNumber, ticket_number);
+}
+
+// WorkTicket::ValidateDate definition
+ValidationError WorkTicket::ValidateDate(const int day, const int month, const int year)
+{
 	const int MIN_YEAR = 2000;
 	const int MAX_YEAR = 2099;
-	if (year >= MIN_YEAR && year <= MAX_YEAR) // unique year requirements 
-	{
-		myDate.SetDate(day, month, year); // day and month validated in the method
-	}
-	else
-	{
-		stringstream errorString;
-		errorString << "Year must be between " << MIN_YEAR << " and " << MAX_YEAR << ". ";
-		throw invalid_argument(errorString.str());
-	}
+	if (year < MIN_YEAR || year > MAX_YEAR) // unique year requirements 
+		return ValidationError(ValidationCode::InvalidTicketYear, year);
+	return MyDate::Validate(day, month, year); // day and month validated as MyDate does
+}
+
+// WorkTicket::Validate definition
+ValidationError WorkTicket::Validate(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
+{
+	const auto numberError = ValidateTicketNumber(ticket_number);
+	if (!numberError.Ok())
+		return numberError;
+	const auto dateError = ValidateDate(day, month, year);
+	if (!dateError.Ok())
+		return dateError;
+	if (client_id.empty())
+		return ValidationError(ValidationCode::EmptyClientId);
+	if (description.empty())
+		return ValidationError(ValidationCode::EmptyDescription);
+	return ValidationError();
+}
+
+// WorkTicket::Validate (PackedDate) definition
+ValidationError WorkTicket::Validate(const int ticket_number, const string_view client_id, const PackedDate date, const string_view description)
+{
+	int day = 0, month = 0, year = 0;
+	MyDate::FromDayNumber(date.DayNumber(), day, month, year); // a PackedDate is always a real date
+	return Validate(ticket_number, client_id, day, month, year, description);
+}
+
+// WorkTicket::TryMake definition
+Expected<WorkTicket> WorkTicket::TryMake(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
+{
+	const auto error = Validate(ticket_number, client_id, day, month, year, description);
+	if (!error.Ok())
+		return error;
+
+	WorkTicket ticket;
+	ticket.SetWorkTicket(ticket_number, client_id, day, month, year, description); // already validated
+	return ticket;
 }
 
 /***************************************************************************
@@ -234,11 +325,34 @@ WorkTicket::WorkTicket(const WorkTicket& original)
 		cout << "\nA WorkTicket object was COPIED.\n";
 	*/
 	myTicketNumber = original.myTicketNumber;
-	myClientId = original.myClientId;
+	myClientHandle = original.myClientHandle;
 	myDate = original.myDate;
 	myDescription = original.myDescription;
 
 	//cout << "\nA WorkTicket object was COPIED.\n";
+	LAB3_COUNT(TicketCopy);
+}
+
+// WorkTicket::Allocator-Extended Copy Constructor definition
+WorkTicket::WorkTicket(const WorkTicket& original, const allocator_type& allocator)
+	: myTicketNumber(original.myTicketNumber), myClientHandle(original.myClientHandle), myDate(original.myDate),
+	myDescription(original.myDescription, allocator)
+{
+	LAB3_COUNT(TicketCopy);
+}
+
+// WorkTicket::Move Constructor definition
+WorkTicket::WorkTicket(WorkTicket&& original) noexcept
+	: myTicketNumber(original.myTicketNumber), myClientHandle(original.myClientHandle), myDate(original.myDate),
+	myDescription(move(original.myDescription))
+{
+}
+
+// WorkTicket::Allocator-Extended Move Constructor definition
+WorkTicket::WorkTicket(WorkTicket&& original, const allocator_type& allocator)
+	: myTicketNumber(original.myTicketNumber), myClientHandle(original.myClientHandle), myDate(original.myDate),
+	myDescription(move(original.myDescription), allocator) // moves if the allocators match, copies if not
+{
 }
 
 // WorkTicket::Assignment operator (=) definition (Lab C2)
@@ -251,11 +365,22 @@ WorkTicket& WorkTicket::operator=(const WorkTicket& original)
 	*/
 
 	myTicketNumber = original.myTicketNumber;
-	myClientId = original.myClientId;
+	myClientHandle = original.myClientHandle;
 	myDate = original.myDate;
 	myDescription = original.myDescription;
 
 	//cout << "\nA WorkTicket object was ASSIGNED.\n";
+	LAB3_COUNT(TicketAssign);
+	return *this;
+}
+
+// WorkTicket::Move Assignment operator (=) definition
+WorkTicket& WorkTicket::operator=(WorkTicket&& original) noexcept(is_nothrow_move_assignable<pmr::string>::value)
+{
+	myTicketNumber = original.myTicketNumber;
+	myClientHandle = original.myClientHandle;
+	myDate = original.myDate;
+	myDescription = move(original.myDescription);
 	return *this;
 }
 
@@ -266,10 +391,12 @@ WorkTicket::operator string () const
 		in the following format: Work Ticket # Number - Client ID (Date): Description; e.g.:
 		"Work Ticket # 2 - ABC123 (10/3/2012): User cannot locate \'any\' key"
 	*/
+	LAB3_TIME(TicketString);
+	LAB3_COUNT(StringStream);
 
 	stringstream strStream;
 	strStream << "Work Ticket # " << myTicketNumber
-		<< " - " << myClientId
+		<< " - " << GetClientIdView()
 		<< " (" << myDate << "): "
 		<< myDescription;
 	return strStream.str();
@@ -286,7 +413,7 @@ bool WorkTicket::operator==(const WorkTicket& original)
 	*/
 
 	return myTicketNumber == original.myTicketNumber &&
-		myClientId == original.myClientId &&
+		myClientHandle == original.myClientHandle && // interned, so no string compare
 		myDate == original.myDate &&
 		myDescription == original.myDescription;
 } // end of WorkTicket equality operator
@@ -298,9 +425,11 @@ ostream& operator<<(ostream& out, const WorkTicket& ticket)
 	   object's attributes neatly on the console or to any ostream. This will
 	   duplicate the functionality of the ShowWorkTicket() method however keep
 	   the original method intact for legacy reasons. */
+	LAB3_TIME(TicketOutput);
+	LAB3_COUNT(StreamOutput);
 
 	out << "\nWork Ticket #: " << ticket.myTicketNumber
-		<< "\nClient ID:     " << ticket.myClientId
+		<< "\nClient ID:     " << ticket.GetClientIdView()
 		<< "\nDate:          " << ticket.myDate
 		<< "\nIssue:         " << ticket.myDescription << endl;
 	return out;
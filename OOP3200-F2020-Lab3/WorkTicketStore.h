@@ -0,0 +1,838 @@
+/** WorkTicketStore.h - Columnar Work Ticket Store
+ *
+ *	The WorkTicketStore class holds large numbers of work tickets in a
+ *	structure-of-arrays layout: ticket numbers, packed dates, open flags,
+ *	client ID handles and description pointers each live in their own
+ *	contiguous array, and the description text lives in a heap of large
+ *	chunks. A changed description is written to the end of the heap; once
+ *	the text it replaced outweighs the live text, and a chunk, the live text
+ *	is copied into new chunks. So the heap never holds much more than twice
+ *	the live text, however often descriptions change, and a description
+ *	view is only valid until the next mutator call.
+ *	A scan only touches the columns it needs, e.g. counting open tickets reads
+ *	one byte per ticket. Tickets are found by number in O(1) through a flat
+ *	open-addressing hash index on the ticket number column, by date range in O(log n + k)
+ *	through a TicketDateIndex, and by the words in their descriptions through
+ *	a TicketTextIndex. Both indexes are kept up to date by every mutator, as
+ *	is a TicketBitmap of the open tickets, which counts them with a popcount
+ *	and intersects them with the results of other searches.
+ *
+ *	Tickets are addressed by row (their position in the columns). Rows are
+ *	assigned in insertion order and never move.
+ *
+ *	TakeSnapshot() copies the columns, and shares the description text,
+ *	which is never changed once written, so a consistent copy of millions of
+ *	tickets costs one pass over memory and can be written out on another
+ *	thread while the store goes on changing. A bulk load can defer the date
+ *	and text indexes with DeferIndexes(); each is then rebuilt in one pass
+ *	the first time it is used, which is much faster than keeping it up to
+ *	date one ticket at a time. The rebuild runs once under a lock, so const
+ *	queries from several threads are as safe with deferred indexes as without.
+ *
+ *	@version	2020.09
+ *	@see		WorkTicket.h
+ *	@see		ExtendedWorkTicket.h
+*/
+
+#pragma once
+#ifndef _WORK_TICKET_STORE_H
+
+#define _WORK_TICKET_STORE_H
+
+#include <algorithm>		// for copy, max, is_sorted, sort and lower_bound
+#include <atomic>			// for the deferred index flags
+#include <cstdint>			// for fixed width integers
+#include <memory>			// for shared_ptr
+#include <mutex>			// for the deferred index rebuild
+#include <string>			// for string
+#include <string_view>		// for string_view
+#include <utility>			// for exchange and move
+#include <vector>			// for the columns
+#include "WorkTicket.h"
+#include "ExtendedWorkTicket.h"
+#include "PackedDate.h"
+#include "ClientIdTable.h"
+#include "TicketDateIndex.h"
+#include "TicketTextIndex.h"
+#include "TicketBitmap.h"
+
+using namespace std;
+
+class WorkTicketStore
+{
+public:
+	using Row = uint32_t;	// position of a ticket in the columns
+	static constexpr Row no_row = UINT32_MAX;	// returned by Find() when there is no such ticket
+
+	/***************************************************************************
+	*	INSERTION
+	***************************************************************************/
+
+	/** Insert()
+	 *	Adds a ticket. WorkTickets are added as open.
+	 *	@return (bool) - false if the ticket breaks the WorkTicket::Validate()
+	 *	                 rules or is already in the store; nothing is added
+	 */
+	bool Insert(const WorkTicket& ticket) { return Insert(ticket.GetTicketNumber(), ticket.GetClientIdView(), ticket.GetPackedDate(), ticket.GetDescriptionView(), true); }
+	bool Insert(const ExtendedWorkTicket& ticket) { return Insert(ticket.GetTicketNumber(), ticket.GetClientIdView(), ticket.GetPackedDate(), ticket.GetDescriptionView(), ticket.IsOpen()); }
+	bool Insert(const int ticket_number, const string_view client_id, const PackedDate date, const string_view description, const bool is_open)
+	{
+		return Insert(ticket_number, ClientIdTable::Shared().Intern(client_id), date, description, is_open);
+	}
+
+	/** Insert()
+	 *	Adds a ticket whose client ID is already interned, e.g. by a loader
+	 *	that interns each distinct client ID once.
+	 *	@param client_handle (uint32_t) - a ClientIdTable::Shared() handle
+	 */
+	bool Insert(int ticket_number, uint32_t client_handle, PackedDate date, string_view description, bool is_open);
+
+	/** Reserve()
+	 *	Reserves room in every column for a number of tickets.
+	 *	@param count (size_t) - the number of tickets
+	 *	@param description_bytes (size_t) - the total length of their descriptions
+	 */
+	void Reserve(size_t count, size_t description_bytes = 0);
+
+	/** DeferIndexes()
+	 *	Stops keeping the date and text indexes up to date until each is next
+	 *	used, when it is rebuilt from the columns in one pass. For bulk loads;
+	 *	TicketSegmentReader::Load() calls it on an empty store. The first
+	 *	const call to need an index rebuilds it while any others wait.
+	 */
+	void DeferIndexes()
+	{
+		myDateIndex.Defer();
+		myTextIndex.Defer();
+	}
+
+	/***************************************************************************
+	*	LOOKUP
+	***************************************************************************/
+
+	/** Find()
+	 *	Finds the row of a ticket in O(1).
+	 *	@param ticket_number (int) - the ticket number
+	 *	@return (Row) - the row, or no_row if there is no such ticket
+	 */
+	Row Find(int ticket_number) const;
+	bool Contains(const int ticket_number) const { return Find(ticket_number) != no_row; }
+	size_t Size() const { return myTicketNumbers.size(); }
+
+	/** DescriptionHeapBytes()
+	 *	The bytes allocated for description text, including text that has
+	 *	been replaced but not yet compacted away.
+	 */
+	size_t DescriptionHeapBytes() const { return myDescriptionHeap.Bytes(); }
+
+	/** Row Accessors (Gets)
+	 *	Read one field of the ticket in a row.
+	 */
+	int GetTicketNumber(const Row row) const { return myTicketNumbers[row]; }
+	PackedDate GetDate(const Row row) const { return myDates[row]; }
+	bool IsOpen(const Row row) const { return myOpenFlags[row] != 0; }
+	uint32_t GetClientHandle(const Row row) const { return myClientHandles[row]; }
+	string_view GetClientId(const Row row) const { return ClientIdTable::Shared().View(myClientHandles[row]); }
+	string_view GetDescription(const Row row) const { return string_view(myDescriptionTexts[row], myDescriptionLengths[row]); }
+
+	/** GetWorkTicket() / GetExtendedWorkTicket()
+	 *	Copies the ticket in a row out into a standalone object.
+	 *	@return (Expected) - the ticket, or the rule the row breaks; the
+	 *	                     mutators keep every row valid, so this is only
+	 *	                     an error if the store is damaged
+	 */
+	Expected<WorkTicket> GetWorkTicket(Row row) const;
+	Expected<ExtendedWorkTicket> GetExtendedWorkTicket(Row row) const;
+
+	/** FindClient()
+	 *	Returns the handle of a client ID, for comparing against the client
+	 *	handle column without comparing strings. Handles are shared with
+	 *	WorkTicket::GetClientHandle().
+	 *	@return (uint32_t) - the handle, or ClientIdTable::no_handle if the client ID was never used
+	 */
+	uint32_t FindClient(const string_view client_id) const { return ClientIdTable::Shared().Find(client_id); }
+
+	/***************************************************************************
+	*	MUTATORS
+	*	Each takes a ticket number and returns false if there is no such
+	*	ticket. The validation rules are the same as WorkTicket::Validate()'s,
+	*	so SetClientId() and SetDescription() also return false, changing
+	*	nothing, for an empty client ID or description.
+	***************************************************************************/
+
+	/** SetWorkTicket()
+	 *	Changes every field of a ticket, if all the parameters are valid.
+	 *	@return (bool) - false if the ticket is not found or a parameter is invalid
+	 */
+	bool SetWorkTicket(int ticket_number, string_view client_id, int day, int month, int year, string_view description);
+
+	/** SetDate()
+	 *	@throws (invalid_argument or out_of_range) as WorkTicket::SetDate does
+	 */
+	bool SetDate(int ticket_number, int day, int month, int year);
+	bool SetClientId(int ticket_number, string_view client_id);
+	bool SetDescription(int ticket_number, string_view description);
+	bool Close(int ticket_number);
+
+	/** Close() (batch)
+	 *	Closes every ticket in a set; numbers not in the store are ignored.
+	 *	@return (size_t) - the number of tickets that were open
+	 */
+	size_t Close(const TicketBitmap& tickets);
+
+	/***************************************************************************
+	*	COLUMNS AND SCANS
+	***************************************************************************/
+
+	/** Column Accessors
+	 *	Direct read-only access to a whole column, indexed by row.
+	 */
+	const vector<int32_t>& TicketNumbers() const { return myTicketNumbers; }
+	const vector<PackedDate>& Dates() const { return myDates; }
+	const vector<uint8_t>& OpenFlags() const { return myOpenFlags; }
+	const vector<uint32_t>& ClientHandles() const { return myClientHandles; }
+
+	/** DateIndex()
+	 *	The tickets in date order, for range queries and ordered iteration.
+	 */
+	const TicketDateIndex& DateIndex() const;
+
+	/** CountByDate()
+	 *	Counts the tickets dated from one date to another, inclusive, using the date index.
+	 */
+	size_t CountByDate(const PackedDate from, const PackedDate to) const { return DateIndex().Count(from, to); }
+
+	/** TextIndex()
+	 *	The words of every description, for MatchAll(), MatchAny() and
+	 *	MatchPhrase() searches by ticket number.
+	 */
+	const TicketTextIndex& TextIndex() const;
+
+	/** OpenTickets()
+	 *	The numbers of the open tickets, e.g. to intersect with
+	 *	TicketBitmap(TextIndex().MatchAll("printer")).
+	 */
+	const TicketBitmap& OpenTickets() const { return myOpenTickets; }
+
+	/** CountOpen()
+	 *	Counts the open tickets, or the open tickets in a set, from the open
+	 *	ticket bitmap without looking at the tickets.
+	 */
+	size_t CountOpen() const { return myOpenTickets.Count(); }
+	size_t CountOpen(const TicketBitmap& tickets) const { return myOpenTickets.AndCount(tickets); }
+
+	/** SelectOpen() / SelectByDate() / SelectByClient()
+	 *	Returns the rows that match. SelectOpen() and SelectByClient() read only
+	 *	the column they filter on; SelectByDate() uses the date index and returns
+	 *	the rows in date order.
+	 */
+	vector<Row> SelectOpen() const;
+	vector<Row> SelectByDate(PackedDate from, PackedDate to) const; // inclusive
+	vector<Row> SelectByClient(string_view client_id) const;
+
+	/***************************************************************************
+	*	SNAPSHOTS
+	***************************************************************************/
+
+	/** Snapshot
+	 *	Every ticket as it was when TakeSnapshot() was called, in row order.
+	 *	The columns are copies; the description text is shared with the store,
+	 *	and kept alive by the snapshot, so it stays valid whatever the store
+	 *	does afterwards, including being destroyed.
+	 */
+	struct Snapshot
+	{
+		vector<int32_t> ticketNumbers;				// ticket numbers
+		vector<PackedDate> dates;					// ticket dates
+		vector<uint8_t> openFlags;					// 1 if open, 0 if closed
+		vector<uint32_t> clientHandles;				// ClientIdTable handles
+		vector<const char*> descriptionTexts;		// start of each description
+		vector<uint32_t> descriptionLengths;		// length of each description
+		vector<shared_ptr<const char[]>> chunks;	// the text they point into
+
+		size_t Size() const { return ticketNumbers.size(); }
+		string_view GetDescription(const size_t row) const { return string_view(descriptionTexts[row], descriptionLengths[row]); }
+	};
+
+	/** TakeSnapshot()
+	 *	Copies the columns, about 25 bytes per ticket, without copying any
+	 *	description text. The only part of saving a store that has to hold
+	 *	off changes to it.
+	 */
+	Snapshot TakeSnapshot() const;
+
+private:
+	/** DescriptionHeap
+	 *	Description text, in chunks that are never moved or changed once
+	 *	written, so pointers into them stay valid. A copy shares the chunks
+	 *	written so far and starts a new one for its own text.
+	 */
+	class DescriptionHeap
+	{
+	public:
+		static constexpr size_t chunk_size = 1 << 20; // bytes in a chunk, unless a reserve or a description needs more
+
+		DescriptionHeap() = default;
+		DescriptionHeap(const DescriptionHeap& other) : myChunks(other.myChunks), myBytes(other.myBytes) {}
+		DescriptionHeap(DescriptionHeap&& other) noexcept { *this = move(other); }
+		DescriptionHeap& operator=(const DescriptionHeap& other);
+		DescriptionHeap& operator=(DescriptionHeap&& other) noexcept;
+
+		/** Append()
+		 *	Copies text into the heap.
+		 *	@return (const char*) - where the copy starts
+		 */
+		const char* Append(string_view text);
+
+		/** Reserve()
+		 *	Makes sure the next bytes appended fit in one chunk.
+		 */
+		void Reserve(size_t bytes);
+
+		const vector<shared_ptr<const char[]>>& Chunks() const { return myChunks; }
+		size_t Bytes() const { return myBytes; } // the size of every chunk
+
+	private:
+		vector<shared_ptr<const char[]>> myChunks;	// every chunk, the last one being filled
+		char* myNext = nullptr;						// the free space in the last chunk
+		char* myEnd = nullptr;						// the end of the last chunk
+		size_t myBytes = 0;							// the size of every chunk
+	};
+
+	/** DeferredIndex
+	 *	An index that can be left out of date until it is next used. Use()
+	 *	rebuilds it at most once, under a lock, however many const callers
+	 *	race to it; copying takes the other's lock, so a copy never sees a
+	 *	rebuild half done. Mutators check Deferred() and skip a deferred index.
+	 */
+	template <typename Index>
+	class DeferredIndex
+	{
+	public:
+		DeferredIndex() = default;
+		DeferredIndex(const DeferredIndex& other) { *this = other; }
+		DeferredIndex(DeferredIndex&& other) noexcept { *this = move(other); }
+		DeferredIndex& operator=(const DeferredIndex& other);
+		DeferredIndex& operator=(DeferredIndex&& other) noexcept;
+
+		bool Deferred() const { return myDeferred.load(memory_order_acquire); }
+		void Defer() { myDeferred.store(true, memory_order_release); }
+
+		/** Get()
+		 *	The index, for a mutator to keep up to date when it is not deferred.
+		 */
+		Index& Get() { return myIndex; }
+
+		/** Use()
+		 *	The index, first calling rebuild(Index&) if it is deferred.
+		 */
+		template <typename Rebuild>
+		const Index& Use(Rebuild rebuild) const;
+
+	private:
+		mutable Index myIndex;						// the index
+		mutable atomic<bool> myDeferred{ false };	// set by Defer() until the next rebuild
+		mutable mutex myMutex;						// held by a rebuild and by copies
+	};
+
+	/** NumberIndex
+	 *	Ticket numbers to rows: one flat array of (number, row) slots, with
+	 *	linear probing, kept at most three quarters full. Loading millions of tickets
+	 *	allocates nothing per ticket, and since tickets are never removed there
+	 *	are no tombstones. A ticket's first slot is its number modulo the
+	 *	(prime) slot count: ticket numbers are mostly consecutive, and this
+	 *	keeps consecutive numbers in consecutive slots, so loading tickets in
+	 *	order walks the array in order instead of missing the cache every time.
+	 */
+	class NumberIndex
+	{
+	public:
+		Row Find(int32_t ticket_number) const;
+
+		/** Insert()
+		 *	@param ticket_number (int32_t) - a positive ticket number
+		 *	@return (bool) - false, changing nothing, if the number is already indexed
+		 */
+		bool Insert(int32_t ticket_number, Row row);
+
+		/** Reserve()
+		 *	Makes room for a number of tickets without growing again.
+		 */
+		void Reserve(size_t count);
+
+	private:
+		/** Slot
+		 *	One ticket; a ticket number of 0 marks an empty slot.
+		 */
+		struct Slot
+		{
+			int32_t ticketNumber;	// the ticket number, or 0
+			Row row;				// its row
+		};
+
+		size_t Home(const int32_t ticket_number) const { return static_cast<uint32_t>(ticket_number) % mySlots.size(); }
+
+		/** Rehash()
+		 *	Moves every ticket into a table of at least a number of slots.
+		 */
+		void Rehash(size_t minimum);
+
+		vector<Slot> mySlots;	// a prime number of slots, or none
+		size_t mySize = 0;		// the slots in use
+	};
+
+	/** AppendDescription()
+	 *	Copies a description into the heap and points a row at it. The text
+	 *	it replaces is counted as dead, and the heap is compacted once there
+	 *	is more dead text than live text and at least a chunk of it.
+	 */
+	void AppendDescription(Row row, string_view description);
+
+	/** CompactDescriptions()
+	 *	Copies every live description into a new heap. Snapshots keep the
+	 *	old chunks alive for as long as they need them.
+	 */
+	void CompactDescriptions();
+
+	// columns, one entry per ticket
+	vector<int32_t> myTicketNumbers;		// ticket numbers
+	vector<PackedDate> myDates;				// ticket dates
+	vector<uint8_t> myOpenFlags;			// 1 if open, 0 if closed
+	vector<uint32_t> myClientHandles;		// ClientIdTable handles
+	vector<const char*> myDescriptionTexts;	// start of the description in the heap
+	vector<uint32_t> myDescriptionLengths;	// length of the description
+
+	DescriptionHeap myDescriptionHeap;		// all description text
+	size_t myLiveDescriptionBytes = 0;		// the length of every row's description
+	size_t myDeadDescriptionBytes = 0;		// replaced text still in the heap
+	NumberIndex myIndex;					// ticket number to row
+	DeferredIndex<TicketDateIndex> myDateIndex;	// ticket numbers by date
+	DeferredIndex<TicketTextIndex> myTextIndex;	// ticket numbers by description word
+	TicketBitmap myOpenTickets;				// the numbers of the open tickets
+};
+
+/***************************************************************************
+ *	INSERTION DEFINITIONS
+ ***************************************************************************/
+
+ // WorkTicketStore::Insert
+bool WorkTicketStore::Insert(const int ticket_number, const uint32_t client_handle, const PackedDate date, const string_view description, const bool is_open)
+{
+	const auto row = static_cast<Row>(myTicketNumbers.size()); // the new row
+
+	// the same rules as WorkTicket::SetWorkTicket, so every row can be copied out
+	if (!WorkTicket::Validate(ticket_number, ClientIdTable::Shared().View(client_handle), date, description).Ok()
+		|| !myIndex.Insert(ticket_number, row))
+		return false;
+
+	myTicketNumbers.push_back(ticket_number);
+	myDates.push_back(date);
+	myOpenFlags.push_back(is_open ? 1 : 0);
+	myClientHandles.push_back(client_handle);
+	myDescriptionTexts.push_back(nullptr);
+	myDescriptionLengths.push_back(0);
+	AppendDescription(row, description);
+	if (!myDateIndex.Deferred())
+		myDateIndex.Get().Insert(date, ticket_number);
+	if (!myTextIndex.Deferred())
+		myTextIndex.Get().Add(ticket_number, description);
+	if (is_open)
+		myOpenTickets.Add(ticket_number);
+	return true;
+}
+
+// WorkTicketStore::Reserve
+void WorkTicketStore::Reserve(const size_t count, const size_t description_bytes)
+{
+	myTicketNumbers.reserve(count);
+	myDates.reserve(count);
+	myOpenFlags.reserve(count);
+	myClientHandles.reserve(count);
+	myDescriptionTexts.reserve(count);
+	myDescriptionLengths.reserve(count);
+	myDescriptionHeap.Reserve(description_bytes);
+	myIndex.Reserve(count);
+}
+
+/***************************************************************************
+ *	LOOKUP DEFINITIONS
+ ***************************************************************************/
+
+ // WorkTicketStore::Find
+WorkTicketStore::Row WorkTicketStore::Find(const int ticket_number) const
+{
+	return myIndex.Find(ticket_number);
+}
+
+// WorkTicketStore::GetWorkTicket
+Expected<WorkTicket> WorkTicketStore::GetWorkTicket(const Row row) const
+{
+	const auto date = myDates[row].ToMyDate();
+	return WorkTicket::TryMake(myTicketNumbers[row], GetClientId(row), date.GetDay(), date.GetMonth(), date.GetYear(), GetDescription(row));
+}
+
+// WorkTicketStore::GetExtendedWorkTicket
+Expected<ExtendedWorkTicket> WorkTicketStore::GetExtendedWorkTicket(const Row row) const
+{
+	const auto date = myDates[row].ToMyDate();
+	return ExtendedWorkTicket::TryMake(myTicketNumbers[row], GetClientId(row), date.GetDay(), date.GetMonth(), date.GetYear(), GetDescription(row), IsOpen(row));
+}
+
+/***************************************************************************
+ *	MUTATOR DEFINITIONS
+ ***************************************************************************/
+
+ // WorkTicketStore::SetWorkTicket
+bool WorkTicketStore::SetWorkTicket(const int ticket_number, const string_view client_id, const int day, const int month, const int year, const string_view description)
+{
+	const auto row = Find(ticket_number);
+
+	// the same rules as WorkTicket::SetWorkTicket
+	if (row == no_row || !WorkTicket::Validate(ticket_number, client_id, day, month, year, description).Ok())
+		return false;
+
+	const PackedDate date(MyDate::DayNumber(day, month, year)); // the new date
+	if (!myDateIndex.Deferred())
+		myDateIndex.Get().Move(ticket_number, myDates[row], date);
+	myDates[row] = date;
+	myClientHandles[row] = ClientIdTable::Shared().Intern(client_id);
+	if (!myTextIndex.Deferred())
+		myTextIndex.Get().Replace(ticket_number, GetDescription(row), description);
+	AppendDescription(row, description);
+	return true;
+}
+
+// WorkTicketStore::SetDate
+bool WorkTicketStore::SetDate(const int ticket_number, const int day, const int month, const int year)
+{
+	const auto row = Find(ticket_number);
+	if (row == no_row)
+		return false;
+
+	// validate and throw exactly as a WorkTicket would
+	WorkTicket::ValidateDate(day, month, year).ThrowIfError();
+	const PackedDate date(MyDate::DayNumber(day, month, year)); // the new date
+	if (!myDateIndex.Deferred())
+		myDateIndex.Get().Move(ticket_number, myDates[row], date);
+	myDates[row] = date;
+	return true;
+}
+
+// WorkTicketStore::SetClientId
+bool WorkTicketStore::SetClientId(const int ticket_number, const string_view client_id)
+{
+	const auto row = Find(ticket_number);
+	if (row == no_row || client_id.empty())
+		return false;
+
+	myClientHandles[row] = ClientIdTable::Shared().Intern(client_id);
+	return true;
+}
+
+// WorkTicketStore::SetDescription
+bool WorkTicketStore::SetDescription(const int ticket_number, const string_view description)
+{
+	const auto row = Find(ticket_number);
+	if (row == no_row || description.empty())
+		return false;
+
+	if (!myTextIndex.Deferred())
+		myTextIndex.Get().Replace(ticket_number, GetDescription(row), description);
+	AppendDescription(row, description);
+	return true;
+}
+
+// WorkTicketStore::Close
+bool WorkTicketStore::Close(const int ticket_number)
+{
+	const auto row = Find(ticket_number);
+	if (row == no_row)
+		return false;
+
+	myOpenFlags[row] = 0;
+	myOpenTickets.Remove(ticket_number);
+	return true;
+}
+
+// WorkTicketStore::Close (batch)
+size_t WorkTicketStore::Close(const TicketBitmap& tickets)
+{
+	// only open tickets can be closed, and only stored tickets are open
+	const auto closing = myOpenTickets & tickets;
+	closing.ForEach([this](const int ticket_number) { myOpenFlags[myIndex.Find(ticket_number)] = 0; });
+	myOpenTickets -= closing;
+	return closing.Count();
+}
+
+/***************************************************************************
+ *	SCAN DEFINITIONS
+ ***************************************************************************/
+
+ // WorkTicketStore::DateIndex
+const TicketDateIndex& WorkTicketStore::DateIndex() const
+{
+	return myDateIndex.Use([this](TicketDateIndex& index)
+	{
+		// sorting every entry at once beats inserting them one at a time
+		vector<TicketDateIndex::Entry> entries(myTicketNumbers.size());
+		for (Row row = 0; row < entries.size(); row++)
+			entries[row] = { myDates[row], myTicketNumbers[row] };
+		index.Assign(entries);
+	});
+}
+
+// WorkTicketStore::TextIndex
+const TicketTextIndex& WorkTicketStore::TextIndex() const
+{
+	return myTextIndex.Use([this](TicketTextIndex& index)
+	{
+		// in ticket number order, so every posting is appended to the end of its list
+		vector<Row> rows(myTicketNumbers.size());
+		for (Row row = 0; row < rows.size(); row++)
+			rows[row] = row;
+		if (!is_sorted(myTicketNumbers.begin(), myTicketNumbers.end()))
+			sort(rows.begin(), rows.end(), [this](const Row a, const Row b) { return myTicketNumbers[a] < myTicketNumbers[b]; });
+
+		index.Clear();
+		for (const auto row : rows)
+			index.Add(myTicketNumbers[row], GetDescription(row));
+	});
+}
+
+ // WorkTicketStore::SelectOpen
+vector<WorkTicketStore::Row> WorkTicketStore::SelectOpen() const
+{
+	vector<Row> rows; // the matching rows
+	for (Row row = 0; row < myOpenFlags.size(); row++)
+	{
+		if (myOpenFlags[row] != 0)
+			rows.push_back(row);
+	}
+	return rows;
+}
+
+// WorkTicketStore::SelectByDate
+vector<WorkTicketStore::Row> WorkTicketStore::SelectByDate(const PackedDate from, const PackedDate to) const
+{
+	vector<Row> rows; // the matching rows
+	const auto& index = DateIndex();
+	rows.reserve(index.Count(from, to));
+	for (const auto entry : index.Between(from, to))
+		rows.push_back(myIndex.Find(entry.ticketNumber));
+	return rows;
+}
+
+// WorkTicketStore::SelectByClient
+vector<WorkTicketStore::Row> WorkTicketStore::SelectByClient(const string_view client_id) const
+{
+	vector<Row> rows; // the matching rows
+	const auto handle = FindClient(client_id);
+	if (handle == ClientIdTable::no_handle)
+		return rows;
+
+	// compare handles, not strings
+	for (Row row = 0; row < myClientHandles.size(); row++)
+	{
+		if (myClientHandles[row] == handle)
+			rows.push_back(row);
+	}
+	return rows;
+}
+
+/***************************************************************************
+ *	SNAPSHOT DEFINITIONS
+ ***************************************************************************/
+
+ // WorkTicketStore::TakeSnapshot
+WorkTicketStore::Snapshot WorkTicketStore::TakeSnapshot() const
+{
+	Snapshot snapshot;
+	snapshot.ticketNumbers = myTicketNumbers;
+	snapshot.dates = myDates;
+	snapshot.openFlags = myOpenFlags;
+	snapshot.clientHandles = myClientHandles;
+	snapshot.descriptionTexts = myDescriptionTexts;
+	snapshot.descriptionLengths = myDescriptionLengths;
+	snapshot.chunks = myDescriptionHeap.Chunks();
+	return snapshot;
+}
+
+/***************************************************************************
+ *	PRIVATE METHOD DEFINITIONS
+ ***************************************************************************/
+
+ // WorkTicketStore::AppendDescription
+void WorkTicketStore::AppendDescription(const Row row, const string_view description)
+{
+	// a replaced description is left in the heap; rows never share text
+	myDeadDescriptionBytes += myDescriptionLengths[row];
+	myLiveDescriptionBytes += description.size() - myDescriptionLengths[row];
+	myDescriptionTexts[row] = myDescriptionHeap.Append(description);
+	myDescriptionLengths[row] = static_cast<uint32_t>(description.size());
+
+	if (myDeadDescriptionBytes > max(myLiveDescriptionBytes, DescriptionHeap::chunk_size))
+		CompactDescriptions();
+}
+
+// WorkTicketStore::CompactDescriptions
+void WorkTicketStore::CompactDescriptions()
+{
+	DescriptionHeap heap; // the live text, in row order
+	heap.Reserve(myLiveDescriptionBytes);
+	for (Row row = 0; row < myDescriptionTexts.size(); row++)
+		myDescriptionTexts[row] = heap.Append(GetDescription(row));
+	myDescriptionHeap = move(heap);
+	myDeadDescriptionBytes = 0;
+}
+
+// WorkTicketStore::NumberIndex::Find
+WorkTicketStore::Row WorkTicketStore::NumberIndex::Find(const int32_t ticket_number) const
+{
+	if (mySlots.empty() || ticket_number <= 0)
+		return no_row;
+
+	for (auto index = Home(ticket_number); ; index = index + 1 == mySlots.size() ? 0 : index + 1)
+	{
+		// the table is never full, so an empty slot ends every search
+		if (mySlots[index].ticketNumber == ticket_number)
+			return mySlots[index].row;
+		if (mySlots[index].ticketNumber == 0)
+			return no_row;
+	}
+}
+
+// WorkTicketStore::NumberIndex::Insert
+bool WorkTicketStore::NumberIndex::Insert(const int32_t ticket_number, const Row row)
+{
+	if ((mySize + 1) * 4 > mySlots.size() * 3)
+		Rehash(mySlots.size() * 2);
+
+	auto index = Home(ticket_number);
+	for (; mySlots[index].ticketNumber != 0; index = index + 1 == mySlots.size() ? 0 : index + 1)
+	{
+		if (mySlots[index].ticketNumber == ticket_number)
+			return false;
+	}
+	mySlots[index] = { ticket_number, row };
+	mySize++;
+	return true;
+}
+
+// WorkTicketStore::NumberIndex::Reserve
+void WorkTicketStore::NumberIndex::Reserve(const size_t count)
+{
+	if (count * 4 > mySlots.size() * 3)
+		Rehash(count * 4 / 3 + 1);
+}
+
+// WorkTicketStore::NumberIndex::Rehash
+void WorkTicketStore::NumberIndex::Rehash(const size_t minimum)
+{
+	// primes just under powers of two, as far as 2^32
+	static const uint32_t primes[] = { 13, 31, 61, 127, 251, 509, 1021, 2039, 4093, 8191, 16381, 32749, 65521, 131071, 262139, 524287,
+		1048573, 2097143, 4194301, 8388593, 16777213, 33554393, 67108859, 134217689, 268435399, 536870909, 1073741789, 2147483647, 4294967291u };
+	const auto prime = *lower_bound(begin(primes), end(primes) - 1, minimum);
+
+	vector<Slot> old(prime, Slot{ 0, 0 });
+	old.swap(mySlots);
+	for (const auto slot : old)
+	{
+		if (slot.ticketNumber == 0)
+			continue;
+		auto index = Home(slot.ticketNumber);
+		while (mySlots[index].ticketNumber != 0)
+			index = index + 1 == mySlots.size() ? 0 : index + 1;
+		mySlots[index] = slot;
+	}
+}
+
+// WorkTicketStore::DescriptionHeap::operator= (copy)
+WorkTicketStore::DescriptionHeap& WorkTicketStore::DescriptionHeap::operator=(const DescriptionHeap& other)
+{
+	// the shared chunks are full as far as this copy is concerned
+	myChunks = other.myChunks;
+	myNext = myEnd = nullptr;
+	myBytes = other.myBytes;
+	return *this;
+}
+
+// WorkTicketStore::DescriptionHeap::operator= (move)
+WorkTicketStore::DescriptionHeap& WorkTicketStore::DescriptionHeap::operator=(DescriptionHeap&& other) noexcept
+{
+	myChunks = move(other.myChunks);
+	myNext = exchange(other.myNext, nullptr);
+	myEnd = exchange(other.myEnd, nullptr);
+	myBytes = exchange(other.myBytes, 0);
+	other.myChunks.clear();
+	return *this;
+}
+
+// WorkTicketStore::DeferredIndex::operator= (copy)
+template <typename Index>
+WorkTicketStore::DeferredIndex<Index>& WorkTicketStore::DeferredIndex<Index>::operator=(const DeferredIndex& other)
+{
+	if (this == &other)
+		return *this;
+
+	// a const caller of other may be rebuilding it
+	lock_guard<mutex> lock(other.myMutex);
+	myIndex = other.myIndex;
+	myDeferred.store(other.myDeferred.load(memory_order_relaxed), memory_order_release);
+	return *this;
+}
+
+// WorkTicketStore::DeferredIndex::operator= (move)
+template <typename Index>
+WorkTicketStore::DeferredIndex<Index>& WorkTicketStore::DeferredIndex<Index>::operator=(DeferredIndex&& other) noexcept
+{
+	// a store being moved from has no other users
+	myIndex = move(other.myIndex);
+	myDeferred.store(other.myDeferred.load(memory_order_relaxed), memory_order_release);
+	return *this;
+}
+
+// WorkTicketStore::DeferredIndex::Use
+template <typename Index>
+template <typename Rebuild>
+const Index& WorkTicketStore::DeferredIndex<Index>::Use(Rebuild rebuild) const
+{
+	if (myDeferred.load(memory_order_acquire))
+	{
+		// whoever gets the lock first rebuilds; the rest find it done
+		lock_guard<mutex> lock(myMutex);
+		if (myDeferred.load(memory_order_relaxed))
+		{
+			rebuild(myIndex);
+			myDeferred.store(false, memory_order_release);
+		}
+	}
+	return myIndex;
+}
+
+// WorkTicketStore::DescriptionHeap::Append
+const char* WorkTicketStore::DescriptionHeap::Append(const string_view text)
+{
+	if (myNext == nullptr || static_cast<size_t>(myEnd - myNext) < text.size())
+		Reserve(max(text.size(), chunk_size));
+
+	const auto start = myNext; // where the text goes
+	copy(text.begin(), text.end(), myNext);
+	myNext += text.size();
+	return start;
+}
+
+// WorkTicketStore::DescriptionHeap::Reserve
+void WorkTicketStore::DescriptionHeap::Reserve(const size_t bytes)
+{
+	if (bytes == 0 || (myNext != nullptr && static_cast<size_t>(myEnd - myNext) >= bytes))
+		return;
+
+	// the rest of the last chunk is left unused
+	const shared_ptr<char[]> chunk(new char[bytes]);
+	myChunks.push_back(chunk);
+	myNext = chunk.get();
+	myEnd = myNext + bytes;
+	myBytes += bytes;
+}
+
+#endif